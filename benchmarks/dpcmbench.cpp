@@ -0,0 +1,258 @@
+/**
+ * Benchmark of the DPCM sound decoder against the original implementation, which
+ * appended each decoded sample to a QByteArray. Both decoders are run over the same
+ * input and their output is compared before any timing is reported.
+ *
+ * Usage: dpcmbench [file.nnv ...]
+ * With no arguments, a synthetic DPCM stream is used. Otherwise, every sound in
+ * each of the provided (extracted and decompressed) NNV files is decoded.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QtGlobal>
+#include "dpcmdecoder.h"
+#include "nnvcontainer.h"
+
+#define BENCH_ITERATIONS 200
+#define SYNTHETIC_LENGTH (512 * 1024)
+
+static const int8_t s_legacyDeltaTable[240] =
+{
+  0, -7,    -6,    -5,    -4,    -3,    -2,    -1,    0, 1,    2,    3,    4,    5,    6,    7,
+  0, -0x0A, -8,    -6,    -5,    -3,    -2,    -1,    0, 1,    2,    3,    5,    6,    8,    0x0A,
+  0, -0x10, -0x0D, -0x0A, -8,    -6,    -4,    -2,    0, 2,    4,    6,    8,    0x0A, 0x0D, 0x10,
+  0, -0x17, -0x13, -0x0F, -0x0B, -8,    -5,    -2,    0, 2,    5,    8,    0x0B, 0x0F, 0x13, 0x17,
+  0, -0x1E, -0x18, -0x13, -0x0F, -0x0A, -7,    -3,    0, 3,    7,    0x0A, 0x0F, 0x13, 0x18, 0x1E,
+  0, -0x26, -0x1F, -0x18, -0x12, -0x0D, -8,    -4,    0, 4,    8,    0x0D, 0x12, 0x18, 0x1F, 0x26,
+  0, -0x2E, -0x25, -0x1D, -0x16, -0x10, -0x0A, -5,    0, 5,    0x0A, 0x10, 0x16, 0x1D, 0x25, 0x2E,
+  0, -0x36, -0x2C, -0x23, -0x1A, -0x13, -0x0C, -6,    0, 6,    0x0C, 0x13, 0x1A, 0x23, 0x2C, 0x36,
+  0, -0x3F, -0x33, -0x28, -0x1F, -0x16, -0x0E, -7,    0, 7,    0x0E, 0x16, 0x1F, 0x28, 0x33, 0x3F,
+  0, -0x49, -0x3B, -0x2F, -0x23, -0x19, -0x10, -8,    0, 7,    0x10, 0x19, 0x23, 0x2E, 0x3A, 0x48,
+  0, -0x53, -0x43, -0x35, -0x28, -0x1D, -0x12, -9,    0, 9,    0x12, 0x1C, 0x28, 0x35, 0x43, 0x52,
+  0, -0x5D, -0x4B, -0x3C, -0x2D, -0x20, -0x14, -0x0A, 0, 0x0A, 0x14, 0x20, 0x2D, 0x3B, 0x4B, 0x5C,
+  0, -0x68, -0x54, -0x43, -0x33, -0x24, -0x17, -0x0B, 0, 0x0B, 0x17, 0x24, 0x32, 0x42, 0x54, 0x67,
+  0, -0x74, -0x5E, -0x4A, -0x38, -0x28, -0x19, -0x0C, 0, 0x0C, 0x19, 0x28, 0x38, 0x4A, 0x5D, 0x73,
+  0, -0x80, -0x68, -0x52, -0x3E, -0x2C, -0x1C, -0x0D, 0, 0x0D, 0x1C, 0x2C, 0x3E, 0x51, 0x67, 0x7F
+};
+
+/**
+ * The original decoder, kept as the reference for correctness and speed.
+ */
+static void legacyDecode(const uint8_t* encoded, int length, QByteArray& decoded)
+{
+  bool upper_nibble = true;
+  bool cmd_nibble = false;
+  bool repeat_cmd = false;
+  int repeat_idx = 0;
+  int repeat_count = 0;
+  bool repeat_count_first_nibble = false;
+  int inpos = 0;
+  unsigned int delta_table_offset = 0;
+  uint8_t nibble;
+  uint8_t last_value = 0x80;
+
+  while (inpos < length)
+  {
+    if (upper_nibble)
+    {
+      nibble = encoded[inpos] >> 4;
+      upper_nibble = false;
+    }
+    else
+    {
+      nibble = encoded[inpos] & 0x0F;
+      upper_nibble = true;
+      inpos++;
+    }
+
+    if (repeat_cmd)
+    {
+      if (!repeat_count_first_nibble)
+      {
+        repeat_count = (nibble << 4);
+        repeat_count_first_nibble = true;
+      }
+      else
+      {
+        repeat_count |= nibble;
+        if (repeat_count == 0)
+        {
+          repeat_count = 0x100;
+        }
+
+        for (repeat_idx = 0; repeat_idx < repeat_count; repeat_idx++)
+        {
+          decoded.append(static_cast<int8_t>(last_value));
+        }
+        repeat_cmd = false;
+        repeat_count_first_nibble = false;
+      }
+    }
+    else if (cmd_nibble)
+    {
+      cmd_nibble = false;
+      if (nibble < 0xF)
+      {
+        delta_table_offset = 0x10 * nibble;
+      }
+      else
+      {
+        repeat_cmd = true;
+        repeat_count_first_nibble = false;
+      }
+    }
+    else if (nibble == 0)
+    {
+      cmd_nibble = true;
+    }
+    else
+    {
+      last_value += s_legacyDeltaTable[delta_table_offset + nibble];
+      decoded.append(static_cast<int8_t>(last_value));
+    }
+  }
+}
+
+/**
+ * Builds a DPCM stream consisting mostly of samples, with occasional subtable
+ * changes and repeat commands (including odd nibble alignments).
+ */
+static QByteArray makeSyntheticStream(int length)
+{
+  QByteArray stream;
+  uint32_t seed = 12345;
+  int nibbleCount = 0;
+  uint8_t current = 0;
+
+  auto nextRandom = [&seed]() { seed = (seed * 1103515245u) + 12345u; return (seed >> 16) & 0x7FFF; };
+  auto putNibble = [&](uint8_t nibble)
+  {
+    if ((nibbleCount++ % 2) == 0)
+    {
+      current = static_cast<uint8_t>(nibble << 4);
+    }
+    else
+    {
+      stream.append(static_cast<char>(current | nibble));
+    }
+  };
+
+  while (stream.size() < length)
+  {
+    const int choice = nextRandom() % 100;
+    if (choice < 2)
+    {
+      putNibble(0);
+      putNibble(nextRandom() % 15);
+    }
+    else if (choice < 3)
+    {
+      putNibble(0);
+      putNibble(0xF);
+      putNibble(nextRandom() % 16);
+      putNibble(nextRandom() % 16);
+    }
+    else
+    {
+      putNibble(1 + (nextRandom() % 15));
+    }
+  }
+
+  return stream;
+}
+
+int main(int argc, char** argv)
+{
+  QList<QByteArray> sounds;
+
+  if (argc < 2)
+  {
+    sounds.append(makeSyntheticStream(SYNTHETIC_LENGTH));
+  }
+  else
+  {
+    for (int argIdx = 1; argIdx < argc; argIdx++)
+    {
+      QFile nnvFile(argv[argIdx]);
+      NnvContainer container;
+      if (nnvFile.open(QIODevice::ReadOnly) && container.parse(nnvFile.readAll()))
+      {
+        for (int soundId = 0; soundId < container.soundCount(); soundId++)
+        {
+          const uint8_t* encoded = nullptr;
+          int length = 0;
+          if (container.soundData(soundId, encoded, length))
+          {
+            sounds.append(QByteArray(reinterpret_cast<const char*>(encoded), length));
+          }
+        }
+      }
+      else
+      {
+        fprintf(stderr, "Failed to read NNV file %s\n", argv[argIdx]);
+        return 1;
+      }
+    }
+  }
+
+  qint64 encodedBytes = 0;
+  qint64 decodedBytes = 0;
+
+  foreach (const QByteArray& sound, sounds)
+  {
+    const uint8_t* encoded = reinterpret_cast<const uint8_t*>(sound.constData());
+    QByteArray legacy;
+    legacyDecode(encoded, sound.size(), legacy);
+
+    QByteArray current(DpcmDecoder::decodedLength(encoded, sound.size()), 0);
+    DpcmDecoder::decode(encoded, sound.size(), reinterpret_cast<uint8_t*>(current.data()));
+
+    if (legacy != current)
+    {
+      fprintf(stderr, "Decoder output mismatch (legacy %d bytes, current %d bytes)\n",
+              legacy.size(), current.size());
+      return 1;
+    }
+
+    encodedBytes += sound.size();
+    decodedBytes += current.size();
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+  for (int iter = 0; iter < BENCH_ITERATIONS; iter++)
+  {
+    foreach (const QByteArray& sound, sounds)
+    {
+      QByteArray legacy;
+      legacyDecode(reinterpret_cast<const uint8_t*>(sound.constData()), sound.size(), legacy);
+    }
+  }
+  const qint64 legacyNs = timer.nsecsElapsed();
+
+  timer.restart();
+  for (int iter = 0; iter < BENCH_ITERATIONS; iter++)
+  {
+    foreach (const QByteArray& sound, sounds)
+    {
+      const uint8_t* encoded = reinterpret_cast<const uint8_t*>(sound.constData());
+      QByteArray current(DpcmDecoder::decodedLength(encoded, sound.size()), Qt::Uninitialized);
+      DpcmDecoder::decode(encoded, sound.size(), reinterpret_cast<uint8_t*>(current.data()));
+    }
+  }
+  const qint64 currentNs = timer.nsecsElapsed();
+
+  const double totalMB = (static_cast<double>(decodedBytes) * BENCH_ITERATIONS) / (1024.0 * 1024.0);
+  printf("%d sound(s), %lld encoded bytes, %lld decoded bytes, %d iterations\n",
+         sounds.size(), static_cast<long long>(encodedBytes), static_cast<long long>(decodedBytes), BENCH_ITERATIONS);
+  printf("legacy decoder:       %8.2f ms (%8.1f MB/s)\n", legacyNs / 1.0e6, totalMB / (legacyNs / 1.0e9));
+  printf("table-driven decoder: %8.2f ms (%8.1f MB/s)\n", currentNs / 1.0e6, totalMB / (currentNs / 1.0e9));
+  printf("speedup: %.2fx\n", static_cast<double>(legacyNs) / qMax(currentNs, Q_INT64_C(1)));
+
+  return 0;
+}
+
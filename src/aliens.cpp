@@ -62,7 +62,7 @@ void Aliens::clear()
  * @return Container of alien data structs. If the data table could not be read, this
  * list will be empty.
  */
-QMap<int,Alien> Aliens::getList()
+const DenseIdTable<Alien>& Aliens::getList()
 {
   if (m_alienList.isEmpty())
   {
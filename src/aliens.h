@@ -7,6 +7,7 @@
 #include "enums.h"
 #include "palette.h"
 #include "dattable.h"
+#include "denseidtable.h"
 
 #define ANM_RECORD_SIZE_BYTES 16
 #define ANM_FIRST_RECORD_OFFSET 0x1A
@@ -27,12 +28,26 @@ typedef struct __attribute__((packed)) AlienTableEntry
 
 static_assert(sizeof(AlienTableEntry) == 8, "AlienTableEntry packing does not match game data");
 
+constexpr FieldDescriptor s_alienTableFields[] =
+{
+  TABLE_GAMETEXT_FIELD(AlienTableEntry, nameOffset),
+  TABLE_FIELD(AlienTableEntry, race),
+  TABLE_UNKNOWN_FIELD(AlienTableEntry, unknown)
+};
+
+template <>
+struct TableSchema<AlienTableEntry>
+{
+  static constexpr const FieldDescriptor* fields() { return s_alienTableFields; }
+  static constexpr int fieldCount() { return sizeof(s_alienTableFields) / sizeof(FieldDescriptor); }
+};
+
 class Aliens : DatTable<AlienTableEntry>
 {
 public:
   Aliens(DatLibrary& lib, Palette& pal);
   void clear();
-  QMap<int,Alien> getList();
+  const DenseIdTable<Alien>& getList();
   QString getName(int id);
   AlienRace getRace(int id);
   bool getAlien(int id, Alien& alien);
@@ -44,7 +59,7 @@ protected:
 private:
   Palette* m_pal;
   static const QVector<QString> s_animationMap;
-  QMap<int,Alien> m_alienList;
+  DenseIdTable<Alien> m_alienList;
 
   QMap< int, QVector<int> > getListOfFrames(const QByteArray& anmData) const;
   bool buildFrame(QVector<int> delIdList, QString delFilenamePrefix, const QVector<QRgb> pal, QImage& frame) const;
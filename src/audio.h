@@ -5,25 +5,33 @@
 #include <QByteArray>
 #include <QString>
 #include <QStringList>
+#include <QHash>
+#include <QPair>
+#include <QMutex>
 #include "datlibrary.h"
+#include "nnvcontainer.h"
+#include "dpcmstreamdevice.h"
 
-#define NNV_INDEX_SIZE 8
+#define NNV_SAMPLE_RATE 7042
 
 class Audio
 {
 public:
   Audio(DatLibrary& lib);
+  void clear();
+  bool getContainer(DatFileType dat, QString nnvContainer, NnvContainer& container);
   bool readSound(DatFileType dat, QString nnvContainer, int soundId, QByteArray& pcmData);
+  bool openSoundStream(DatFileType dat, QString nnvContainer, int soundId, DpcmStreamDevice& stream);
   int getNumberOfSoundsInNNV(DatFileType dat, QString nnvContainer);
   QMap<DatFileType, QStringList> getAllSoundList();
   bool writeWavFile(const QString filename, const QByteArray& pcmData);
+  bool writeWavFile(const QString filename, QIODevice& pcmSource, int sampleRate = NNV_SAMPLE_RATE, int bitsPerSample = 8);
+  static bool writeWav(QIODevice& output, QIODevice& pcmSource, int sampleRate = NNV_SAMPLE_RATE, int bitsPerSample = 8);
 
 private:
-  static const int8_t s_deltaTable[];
   DatLibrary* m_lib;
-
-  static int getStartLocation(const QByteArray& nnvData, int soundId);
-  static int getSoundDataLength(const QByteArray& nnvData, int soundId);
+  QHash<QPair<int,QString>,NnvContainer> m_containers;
+  QMutex m_containerMutex;
   static void decode(const uint8_t* encoded, int length, QByteArray& decoded);
 };
 
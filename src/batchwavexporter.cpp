@@ -0,0 +1,302 @@
+#include <QtConcurrent>
+#include <QBuffer>
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include "batchwavexporter.h"
+#include "dpcmstreamdevice.h"
+#include "resamplingdevice.h"
+
+WavWriteQueue::WavWriteQueue(int capacity) :
+  m_capacity(capacity),
+  m_closed(false),
+  m_aborted(false)
+{
+
+}
+
+/**
+ * Empties the queue and makes it ready to accept items again.
+ */
+void WavWriteQueue::reset()
+{
+  QMutexLocker locker(&m_mutex);
+  m_items.clear();
+  m_closed = false;
+  m_aborted = false;
+}
+
+/**
+ * Adds a file to the queue, waiting for space if the queue is full.
+ * @return True if the file was queued; false if the queue was aborted.
+ */
+bool WavWriteQueue::push(const QString& path, const QByteArray& data)
+{
+  QMutexLocker locker(&m_mutex);
+
+  while (!m_aborted && (m_items.count() >= m_capacity))
+  {
+    m_notFull.wait(&m_mutex);
+  }
+
+  if (!m_aborted)
+  {
+    m_items.enqueue(QPair<QString,QByteArray>(path, data));
+    m_notEmpty.wakeOne();
+  }
+
+  return !m_aborted;
+}
+
+/**
+ * Removes the next file from the queue, waiting for one to arrive if the queue is empty.
+ * @return True if a file was removed; false if the queue was closed and has been drained,
+ * or if it was aborted.
+ */
+bool WavWriteQueue::pop(QString& path, QByteArray& data)
+{
+  QMutexLocker locker(&m_mutex);
+
+  while (!m_aborted && !m_closed && m_items.isEmpty())
+  {
+    m_notEmpty.wait(&m_mutex);
+  }
+
+  const bool status = !m_aborted && !m_items.isEmpty();
+  if (status)
+  {
+    const QPair<QString,QByteArray> item = m_items.dequeue();
+    path = item.first;
+    data = item.second;
+    m_notFull.wakeOne();
+  }
+
+  return status;
+}
+
+/**
+ * Indicates that no more files will be added. Consumers finish once the queue is empty.
+ */
+void WavWriteQueue::close()
+{
+  QMutexLocker locker(&m_mutex);
+  m_closed = true;
+  m_notEmpty.wakeAll();
+}
+
+/**
+ * Discards any queued files and releases all producers and consumers that are waiting.
+ */
+void WavWriteQueue::abort()
+{
+  QMutexLocker locker(&m_mutex);
+  m_aborted = true;
+  m_items.clear();
+  m_notEmpty.wakeAll();
+  m_notFull.wakeAll();
+}
+
+/**
+ * Decodes the sound described by the job and queues its .WAV file contents. A sound that
+ * cannot be read is queued with empty contents, so that the failure is still counted.
+ */
+void BatchWavEncoder::operator()(const BatchWavJob& job) const
+{
+  if (cancelled->loadAcquire())
+  {
+    return;
+  }
+
+  QByteArray wavData;
+  DpcmStreamDevice stream;
+
+  if (audio->openSoundStream(job.dat, job.nnvName, job.soundId, stream))
+  {
+    QBuffer wavBuffer(&wavData);
+    wavBuffer.open(QIODevice::WriteOnly);
+    bool status = false;
+
+    if (sampleRate == NNV_SAMPLE_RATE)
+    {
+      status = Audio::writeWav(wavBuffer, stream);
+    }
+    else
+    {
+      ResamplingDevice resampled(NNV_SAMPLE_RATE, sampleRate);
+      status = resampled.setSource(&stream) &&
+               resampled.open(QIODevice::ReadOnly) &&
+               Audio::writeWav(wavBuffer, resampled, sampleRate, 16);
+    }
+
+    wavBuffer.close();
+    if (!status)
+    {
+      wavData.clear();
+    }
+  }
+
+  queue->push(job.outputPath, wavData);
+}
+
+BatchWavExporter::BatchWavExporter(Audio& audio, QObject* parent) :
+  QObject(parent),
+  m_audio(&audio),
+  m_queue(BATCH_WAV_QUEUE_CAPACITY),
+  m_cancelled(0),
+  m_encoding(false),
+  m_runningWriters(0),
+  m_written(0),
+  m_failed(0)
+{
+  m_writerPool.setMaxThreadCount(BATCH_WAV_WRITER_COUNT);
+  connect(&m_encodeWatcher, &QFutureWatcher<void>::finished, this, &BatchWavExporter::onEncodingFinished);
+}
+
+BatchWavExporter::~BatchWavExporter()
+{
+  cancel();
+  waitForFinished();
+}
+
+/**
+ * Starts exporting the provided list of sounds at the provided sample rate. Output
+ * from the native rate is 8-bit; all other rates are resampled to 16-bit. The
+ * progress() signal is emitted as each file is written, and finished() is emitted
+ * once every file has been written or the export has been cancelled.
+ * @return True if the export was started; false if one is already running or there
+ * is nothing to export.
+ */
+bool BatchWavExporter::start(const QList<BatchWavJob>& jobs, int sampleRate)
+{
+  if (isRunning() || jobs.isEmpty())
+  {
+    return false;
+  }
+
+  m_jobs = jobs;
+  m_written = 0;
+  m_failed = 0;
+  m_cancelled.storeRelease(0);
+  m_queue.reset();
+  m_encoding = true;
+
+  m_runningWriters = BATCH_WAV_WRITER_COUNT;
+  for (int writer = 0; writer < BATCH_WAV_WRITER_COUNT; writer++)
+  {
+    QtConcurrent::run(&m_writerPool, this, &BatchWavExporter::writeFiles);
+  }
+
+  BatchWavEncoder encoder;
+  encoder.audio = m_audio;
+  encoder.queue = &m_queue;
+  encoder.cancelled = &m_cancelled;
+  encoder.sampleRate = sampleRate;
+  m_encodeWatcher.setFuture(QtConcurrent::map(m_jobs, encoder));
+
+  return true;
+}
+
+/**
+ * Stops the export. Sounds that are still being decoded are discarded, files that are
+ * still queued are not written, and the finished() signal is emitted once the worker
+ * threads have stopped.
+ */
+void BatchWavExporter::cancel()
+{
+  if (isRunning())
+  {
+    m_cancelled.storeRelease(1);
+    m_encodeWatcher.cancel();
+    m_queue.abort();
+  }
+}
+
+/**
+ * Blocks until all of the worker threads have stopped. The finished() signal is
+ * still delivered afterward through the event loop.
+ */
+void BatchWavExporter::waitForFinished()
+{
+  m_encodeWatcher.waitForFinished();
+  m_writerPool.waitForDone();
+}
+
+/**
+ * Returns true if sounds are still being decoded or written.
+ */
+bool BatchWavExporter::isRunning() const
+{
+  return m_encoding || (m_runningWriters > 0);
+}
+
+/**
+ * Writes files from the queue until it is closed and empty, or aborted. This is run on
+ * each of the writer threads, and reports each file back to the exporter's thread.
+ */
+void BatchWavExporter::writeFiles()
+{
+  QString path;
+  QByteArray data;
+
+  while (m_queue.pop(path, data))
+  {
+    bool status = false;
+
+    if (!data.isEmpty() && QDir().mkpath(QFileInfo(path).absolutePath()))
+    {
+      QFile outFile(path);
+      if (outFile.open(QIODevice::WriteOnly))
+      {
+        status = (outFile.write(data) == data.size());
+        outFile.close();
+      }
+    }
+
+    QMetaObject::invokeMethod(this, "onFileWritten", Qt::QueuedConnection, Q_ARG(bool, status));
+  }
+
+  QMetaObject::invokeMethod(this, "onWriterFinished", Qt::QueuedConnection);
+}
+
+/**
+ * Lets the writers finish once every sound has been decoded and queued.
+ */
+void BatchWavExporter::onEncodingFinished()
+{
+  m_encoding = false;
+  m_queue.close();
+  checkFinished();
+}
+
+void BatchWavExporter::onFileWritten(bool success)
+{
+  if (success)
+  {
+    m_written++;
+  }
+  else
+  {
+    m_failed++;
+  }
+
+  emit progress(m_written + m_failed, m_jobs.count());
+}
+
+void BatchWavExporter::onWriterFinished()
+{
+  m_runningWriters--;
+  checkFinished();
+}
+
+/**
+ * Announces the end of the export once both the encoding and all of the writers
+ * have finished. Either may finish first when the export is cancelled.
+ */
+void BatchWavExporter::checkFinished()
+{
+  if (!m_encoding && (m_runningWriters == 0))
+  {
+    emit finished(m_written, m_failed, m_cancelled.loadAcquire() != 0);
+  }
+}
+
@@ -0,0 +1,110 @@
+#pragma once
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QList>
+#include <QQueue>
+#include <QPair>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QThreadPool>
+#include <QFutureWatcher>
+#include "datlibrary.h"
+#include "audio.h"
+
+#define BATCH_WAV_QUEUE_CAPACITY 16
+#define BATCH_WAV_WRITER_COUNT 2
+
+/**
+ * Identifies a single sound to be exported, and the path of the .WAV file to create.
+ */
+struct BatchWavJob
+{
+  DatFileType dat;
+  QString nnvName;
+  int soundId;
+  QString outputPath;
+};
+
+/**
+ * Queue of finished .WAV file contents waiting to be written to disk. Producers block
+ * while the queue is full, so the amount of encoded data held in memory is bounded.
+ */
+class WavWriteQueue
+{
+public:
+  WavWriteQueue(int capacity);
+  void reset();
+  bool push(const QString& path, const QByteArray& data);
+  bool pop(QString& path, QByteArray& data);
+  void close();
+  void abort();
+
+private:
+  int m_capacity;
+  QQueue<QPair<QString,QByteArray>> m_items;
+  bool m_closed;
+  bool m_aborted;
+  QMutex m_mutex;
+  QWaitCondition m_notEmpty;
+  QWaitCondition m_notFull;
+};
+
+/**
+ * Function object that is run on the worker threads to decode a single sound,
+ * encode it as a .WAV file in memory, and hand it to the write queue.
+ */
+struct BatchWavEncoder
+{
+  Audio* audio;
+  WavWriteQueue* queue;
+  QAtomicInt* cancelled;
+  int sampleRate;
+
+  void operator()(const BatchWavJob& job) const;
+};
+
+/**
+ * Exports many sounds to .WAV files at once. Sounds are decoded (and resampled, if a
+ * rate other than the native one is selected) in parallel on the global thread pool,
+ * while a small number of dedicated threads write the finished files to disk.
+ */
+class BatchWavExporter : public QObject
+{
+  Q_OBJECT
+
+public:
+  BatchWavExporter(Audio& audio, QObject* parent = nullptr);
+  ~BatchWavExporter();
+
+  bool start(const QList<BatchWavJob>& jobs, int sampleRate);
+  void cancel();
+  void waitForFinished();
+  bool isRunning() const;
+
+signals:
+  void progress(int completed, int total);
+  void finished(int written, int failed, bool cancelled);
+
+private slots:
+  void onFileWritten(bool success);
+  void onWriterFinished();
+  void onEncodingFinished();
+
+private:
+  Audio* m_audio;
+  QList<BatchWavJob> m_jobs;
+  WavWriteQueue m_queue;
+  QAtomicInt m_cancelled;
+  QThreadPool m_writerPool;
+  QFutureWatcher<void> m_encodeWatcher;
+  bool m_encoding;
+  int m_runningWriters;
+  int m_written;
+  int m_failed;
+
+  void writeFiles();
+  void checkFinished();
+};
+
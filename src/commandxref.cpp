@@ -0,0 +1,233 @@
+#include <QtConcurrent>
+#include "commandxref.h"
+
+/**
+ * Reads the strings of the text file described by the job and returns an entry for each
+ * embedded command in them.
+ */
+QVector<CommandXrefEntry> CommandXrefScanner::operator()(const CommandXrefJob& job) const
+{
+  QVector<CommandXrefEntry> entries;
+
+  if (job.source == TextSearchSource::Dialogue)
+  {
+    foreach (const ConvDialogueLine& line, convText->getDialogueLines(job.tableType, job.id))
+    {
+      addCommands(entries, line.text, job, line.offset, TextSearchIndexer::dialogueTarget(job.tableType, job.id, line));
+    }
+  }
+  else
+  {
+    const bool isMissionText = (job.source == TextSearchSource::MissionText);
+    const QString idxFilename = isMissionText ? "MISTEXT.IDX" : "OBJTEXT.IDX";
+    const TextSearchTargetType ownerType = isMissionText ? TextSearchTargetType::Mission : TextSearchTargetType::Object;
+    QByteArray idxData;
+    QByteArray txtData;
+
+    if (lib->getFileByName(DatFileType::CONVERSE, idxFilename, idxData) &&
+        lib->getFileByName(DatFileType::CONVERSE, job.filename, txtData))
+    {
+      const QMap<int,int> stringOwners =
+        TextSearchIndexer::readTextOwners(idxData, txtData.size(),
+                                          isMissionText ? MISTEXT_FIRST_RECORD : OBJTEXT_FIRST_RECORD,
+                                          isMissionText ? owners.missionTextOwners : owners.objectTextOwners);
+
+      for (QMap<int,int>::const_iterator it = stringOwners.constBegin(); it != stringOwners.constEnd(); ++it)
+      {
+        const GameTextString str = gtext->parseString(txtData.constData() + it.key(), txtData.size() - it.key());
+        const TextSearchTarget owner =
+          TextSearchIndexer::makeTarget((it.value() >= 0) ? ownerType : TextSearchTargetType::None, it.value());
+        addCommands(entries, str, job, it.key(), owner);
+      }
+    }
+  }
+
+  return entries;
+}
+
+/**
+ * Adds an entry for each command embedded in the provided string.
+ */
+void CommandXrefScanner::addCommands(QVector<CommandXrefEntry>& entries, const GameTextString& str, const CommandXrefJob& job,
+                                     int offset, const TextSearchTarget& owner) const
+{
+  if (str.commandCount > 0)
+  {
+    const QString text = gtext->renderPlainText(str);
+
+    typedef QPair<GTxtCmd,int> CommandPair;
+    foreach (const CommandPair& cmd, gtext->renderCommands(str))
+    {
+      CommandXrefEntry entry;
+      entry.command = cmd.first;
+      entry.param = cmd.second;
+      entry.source = job.source;
+      entry.filename = job.filename;
+      entry.offset = offset;
+      entry.text = text;
+      entry.owner = owner;
+      entries.append(entry);
+    }
+  }
+}
+
+CommandXrefIndex::CommandXrefIndex()
+{
+
+}
+
+quint32 CommandXrefIndex::key(GTxtCmd command, int param)
+{
+  return (static_cast<quint32>(command) << 24) | (static_cast<quint32>(param) & 0xFFFFFF);
+}
+
+/**
+ * Replaces the contents of the index with the provided entries.
+ */
+void CommandXrefIndex::build(const QVector<CommandXrefEntry>& entries)
+{
+  clear();
+  m_entries = entries;
+
+  for (int i = 0; i < m_entries.size(); i++)
+  {
+    m_lookup[key(m_entries[i].command, m_entries[i].param)].append(i);
+  }
+}
+
+void CommandXrefIndex::clear()
+{
+  m_entries.clear();
+  m_lookup.clear();
+}
+
+bool CommandXrefIndex::isEmpty() const
+{
+  return m_entries.isEmpty();
+}
+
+int CommandXrefIndex::entryCount() const
+{
+  return m_entries.size();
+}
+
+/**
+ * Returns every occurrence of the provided command with the provided parameter value,
+ * in the order in which the files were scanned.
+ */
+QVector<CommandXrefEntry> CommandXrefIndex::find(GTxtCmd command, int param) const
+{
+  QVector<CommandXrefEntry> found;
+
+  foreach (int entryIndex, m_lookup.value(key(command, param)))
+  {
+    found.append(m_entries.at(entryIndex));
+  }
+
+  return found;
+}
+
+CommandXref::CommandXref(DatLibrary& lib, GameText& gtext, ConversationText& convText, QObject* parent) :
+  QObject(parent),
+  m_lib(&lib),
+  m_gtext(&gtext),
+  m_convText(&convText)
+{
+  connect(&m_watcher, &QFutureWatcher<QVector<CommandXrefEntry> >::finished, this, &CommandXref::onFinished);
+}
+
+CommandXref::~CommandXref()
+{
+  cancel();
+}
+
+/**
+ * Starts scanning every text file that may contain embedded commands. The finished()
+ * signal is emitted once the index has been built.
+ * @return The number of files to be scanned.
+ */
+int CommandXref::start(const TextSearchOwners& owners)
+{
+  cancel();
+  m_jobs.clear();
+  m_index.clear();
+
+  foreach (QString filename, m_lib->getFilenamesByExtension(DatFileType::CONVERSE, ".TXT"))
+  {
+    CommandXrefJob job;
+    job.source = TextSearchSource::Dialogue;
+    job.filename = filename;
+
+    if (ConversationText::parseTLKXFilename(filename, job.tableType, job.id))
+    {
+      m_jobs.append(job);
+    }
+  }
+
+  CommandXrefJob missionJob;
+  missionJob.source = TextSearchSource::MissionText;
+  missionJob.filename = "MISTEXT.TXT";
+  missionJob.tableType = ConvTableType_Invalid;
+  missionJob.id = -1;
+  m_jobs.append(missionJob);
+
+  CommandXrefJob objectJob = missionJob;
+  objectJob.source = TextSearchSource::ObjectText;
+  objectJob.filename = "OBJTEXT.TXT";
+  m_jobs.append(objectJob);
+
+  CommandXrefScanner scanner;
+  scanner.lib = m_lib;
+  scanner.gtext = m_gtext;
+  scanner.convText = m_convText;
+  scanner.owners = owners;
+  m_watcher.setFuture(QtConcurrent::mapped(m_jobs, scanner));
+
+  return m_jobs.count();
+}
+
+/**
+ * Stops scanning any files that have not yet been started, and waits for those that
+ * are in progress.
+ */
+void CommandXref::cancel()
+{
+  if (m_watcher.isRunning())
+  {
+    m_watcher.cancel();
+    m_watcher.waitForFinished();
+  }
+}
+
+bool CommandXref::isRunning() const
+{
+  return m_watcher.isRunning();
+}
+
+/**
+ * Returns the index built by the most recent completed scan.
+ */
+const CommandXrefIndex& CommandXref::index() const
+{
+  return m_index;
+}
+
+/**
+ * Collects the entries found in every file and indexes them.
+ */
+void CommandXref::onFinished()
+{
+  const bool cancelled = m_watcher.isCanceled();
+
+  if (!cancelled)
+  {
+    QVector<CommandXrefEntry> entries;
+    foreach (const QVector<CommandXrefEntry>& fileEntries, m_watcher.future().results())
+    {
+      entries += fileEntries;
+    }
+    m_index.build(entries);
+  }
+
+  emit finished(cancelled);
+}
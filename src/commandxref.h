@@ -0,0 +1,110 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QFutureWatcher>
+#include "datlibrary.h"
+#include "gametext.h"
+#include "conversationtext.h"
+#include "textsearchindex.h"
+
+/**
+ * A single embedded command found in the game text, along with the string that contains
+ * it (identified by its file and byte offset) and the owner of that string.
+ */
+struct CommandXrefEntry
+{
+  GTxtCmd command;
+  int param;
+  TextSearchSource source;
+  QString filename;
+  int offset;
+  QString text;
+  TextSearchTarget owner;
+};
+
+/**
+ * Describes a single text file to be scanned. The table type and ID select the TLKX file
+ * of an alien or race when the source is dialogue.
+ */
+struct CommandXrefJob
+{
+  TextSearchSource source;
+  QString filename;
+  ConvTableType tableType;
+  int id;
+};
+
+/**
+ * Function object that is run on the worker threads to extract the embedded commands
+ * from every string in a single text file.
+ */
+struct CommandXrefScanner
+{
+  typedef QVector<CommandXrefEntry> result_type;
+
+  DatLibrary* lib;
+  GameText* gtext;
+  ConversationText* convText;
+  TextSearchOwners owners;
+
+  QVector<CommandXrefEntry> operator()(const CommandXrefJob& job) const;
+  void addCommands(QVector<CommandXrefEntry>& entries, const GameTextString& str, const CommandXrefJob& job,
+                   int offset, const TextSearchTarget& owner) const;
+};
+
+/**
+ * Reverse index from an embedded command and its parameter (such as "grant knowledge of
+ * fact 12") to every string in which that command appears.
+ */
+class CommandXrefIndex
+{
+public:
+  CommandXrefIndex();
+  void build(const QVector<CommandXrefEntry>& entries);
+  void clear();
+  bool isEmpty() const;
+  int entryCount() const;
+
+  QVector<CommandXrefEntry> find(GTxtCmd command, int param) const;
+
+private:
+  QVector<CommandXrefEntry> m_entries;
+  QHash<quint32,QVector<int> > m_lookup;
+
+  static quint32 key(GTxtCmd command, int param);
+};
+
+/**
+ * Scans every TLKX dialogue file, MISTEXT.TXT and OBJTEXT.TXT in parallel on the global
+ * thread pool and builds a CommandXrefIndex from the embedded commands found in them.
+ */
+class CommandXref : public QObject
+{
+  Q_OBJECT
+
+public:
+  CommandXref(DatLibrary& lib, GameText& gtext, ConversationText& convText, QObject* parent = nullptr);
+  ~CommandXref();
+
+  int start(const TextSearchOwners& owners);
+  void cancel();
+  bool isRunning() const;
+  const CommandXrefIndex& index() const;
+
+signals:
+  void finished(bool cancelled);
+
+private slots:
+  void onFinished();
+
+private:
+  DatLibrary* m_lib;
+  GameText* m_gtext;
+  ConversationText* m_convText;
+  QList<CommandXrefJob> m_jobs;
+  QFutureWatcher<QVector<CommandXrefEntry> > m_watcher;
+  CommandXrefIndex m_index;
+};
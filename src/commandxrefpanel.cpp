@@ -0,0 +1,100 @@
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include "commandxrefpanel.h"
+
+CommandXrefPanel::CommandXrefPanel(QWidget* parent) :
+  QWidget(parent),
+  m_label(new QLabel(this)),
+  m_table(new QTableWidget(0, 3, this)),
+  m_id(-1)
+{
+  QVBoxLayout* layout = new QVBoxLayout(this);
+  layout->setContentsMargins(0, 0, 0, 0);
+  layout->addWidget(m_label);
+  layout->addWidget(m_table);
+
+  m_table->setHorizontalHeaderLabels(QStringList() << "Command" << "Location" << "Text");
+  m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  m_table->setSelectionMode(QAbstractItemView::SingleSelection);
+  m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+  m_table->setWordWrap(false);
+  m_table->verticalHeader()->setVisible(false);
+  m_table->horizontalHeader()->setHighlightSections(false);
+  m_table->horizontalHeader()->setStretchLastSection(true);
+
+  connect(m_table, &QTableWidget::cellDoubleClicked, this, &CommandXrefPanel::onCellDoubleClicked);
+  clear();
+}
+
+/**
+ * Sets the list of commands (each taking the ID shown by this panel as its parameter)
+ * that this panel looks for.
+ */
+void CommandXrefPanel::setCommands(const QVector<GTxtCmd>& commands)
+{
+  m_commands = commands;
+}
+
+QVector<GTxtCmd> CommandXrefPanel::commands() const
+{
+  return m_commands;
+}
+
+/**
+ * Returns the ID whose references are currently displayed, or -1 if there is none.
+ */
+int CommandXrefPanel::currentId() const
+{
+  return m_id;
+}
+
+void CommandXrefPanel::clear()
+{
+  m_id = -1;
+  m_entries.clear();
+  m_table->setRowCount(0);
+  m_label->setText("Granted in game text:");
+}
+
+/**
+ * Clears the panel and displays the reason why no references can be shown.
+ */
+void CommandXrefPanel::setUnavailable(QString reason)
+{
+  clear();
+  m_label->setText(QString("Granted in game text: %1").arg(reason));
+}
+
+/**
+ * Displays the provided references to the provided ID, along with a description of the
+ * location of each one.
+ */
+void CommandXrefPanel::setEntries(int id, const QVector<CommandXrefEntry>& entries, const QStringList& locations)
+{
+  clear();
+  m_id = id;
+  m_entries = entries;
+
+  m_table->setRowCount(entries.size());
+  for (int row = 0; row < entries.size(); row++)
+  {
+    m_table->setItem(row, 0, new QTableWidgetItem(g_gameTextCommandName.value(entries[row].command)));
+    m_table->setItem(row, 1, new QTableWidgetItem(locations.value(row)));
+    m_table->setItem(row, 2, new QTableWidgetItem(entries[row].text.simplified()));
+  }
+  m_table->resizeColumnToContents(0);
+  m_table->resizeColumnToContents(1);
+
+  m_label->setText(entries.isEmpty() ? QString("Granted in game text: (nowhere)") :
+                                       QString("Granted in game text (%1):").arg(entries.size()));
+}
+
+void CommandXrefPanel::onCellDoubleClicked(int row, int column)
+{
+  Q_UNUSED(column)
+
+  if ((row >= 0) && (row < m_entries.size()))
+  {
+    emit targetActivated(m_entries[row].owner);
+  }
+}
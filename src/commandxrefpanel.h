@@ -0,0 +1,42 @@
+#pragma once
+#include <QWidget>
+#include <QLabel>
+#include <QTableWidget>
+#include <QStringList>
+#include <QVector>
+#include "commandxref.h"
+
+/**
+ * Panel that lists the strings of game text in which a particular fact, place, object or
+ * mission is granted, revealed or completed by an embedded command. Each panel is given
+ * the commands that it looks for, and double-clicking a row announces the owner of the
+ * string so that it can be shown.
+ */
+class CommandXrefPanel : public QWidget
+{
+  Q_OBJECT
+
+public:
+  CommandXrefPanel(QWidget* parent = nullptr);
+
+  void setCommands(const QVector<GTxtCmd>& commands);
+  QVector<GTxtCmd> commands() const;
+  int currentId() const;
+
+  void clear();
+  void setUnavailable(QString reason);
+  void setEntries(int id, const QVector<CommandXrefEntry>& entries, const QStringList& locations);
+
+signals:
+  void targetActivated(TextSearchTarget target);
+
+private slots:
+  void onCellDoubleClicked(int row, int column);
+
+private:
+  QLabel* m_label;
+  QTableWidget* m_table;
+  QVector<GTxtCmd> m_commands;
+  QVector<CommandXrefEntry> m_entries;
+  int m_id;
+};
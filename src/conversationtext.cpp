@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <QtEndian>
+#include <QMutexLocker>
 
 ConversationText::ConversationText(DatLibrary& lib, Aliens& aliens, GameText& gtext) :
   m_lib(&lib),
@@ -12,6 +13,16 @@ ConversationText::ConversationText(DatLibrary& lib, Aliens& aliens, GameText& gt
 
 }
 
+/**
+ * Discards the topic indices built from the TLKT tables.
+ */
+void ConversationText::clear()
+{
+  QMutexLocker locker(&m_indexMutex);
+  m_individualIndex.clear();
+  m_raceIndex.clear();
+}
+
 /**
  * Gets a list of dialog lines, each one being a response from the specified alien about the
  * thing with the provided ID in the specified conversation topic category.
@@ -19,41 +30,106 @@ ConversationText::ConversationText(DatLibrary& lib, Aliens& aliens, GameText& gt
 QString ConversationText::getConversationText(int alienId, ConvTopicCategory topic, int thingId, QVector<QPair<GTxtCmd, int> >& commands)
 {
   QString dialogLine;
-  QByteArray tlktData;
-  ConvTableType tableType = ConvTableType_Individual;
-  int alienOrRaceId = alienId;
+  ConvTableType tableType = ConvTableType_Invalid;
+  int alienOrRaceId = -1;
+  int tlknIndex = -1;
 
-  getTLKTData(tableType, alienOrRaceId, tlktData);
+  if (findTLKNIndex(alienId, static_cast<int>(m_aliens->getRace(alienId)), topic, thingId, tableType, alienOrRaceId, tlknIndex))
+  {
+    ConvTableData data;
+    getTableData(tableType, alienOrRaceId, data);
+    dialogLine = getResponseText(tlknIndex, data, commands);
+  }
 
-  int tlknIndex = getTLKNIndex(topic, thingId, tlktData);
+  return dialogLine;
+}
 
-  // if the individual-specific tables didn't have any entries for this topic,
-  // fall back to the generic tables used by all members of an alien race
-  if (tlknIndex < 0)
+/**
+ * Gets the response from the specified alien (a member of the specified race) about the thing
+ * with the provided ID in the specified conversation topic category, along with the type of
+ * table in which the response was found (or ConvTableType_Invalid if there is no response). The
+ * race is passed in (rather than looked up) so that this may be called from any thread, and the
+ * contents of the alien's and the race's tables are passed in so that a caller looking up many
+ * responses only needs to read them once.
+ */
+QString ConversationText::getConversationText(int alienId, int raceId, ConvTopicCategory topic, int thingId,
+                                              const ConvTableData& individualData, const ConvTableData& raceData,
+                                              QVector<QPair<GTxtCmd,int> >& commands, ConvTableType& tableType)
+{
+  QString dialogLine;
+  int alienOrRaceId = -1;
+  int tlknIndex = -1;
+
+  if (findTLKNIndex(alienId, raceId, topic, thingId, tableType, alienOrRaceId, tlknIndex))
   {
-    tableType = ConvTableType_Race;
-    alienOrRaceId = static_cast<int>(m_aliens->getRace(alienId));
-    getTLKTData(tableType, alienOrRaceId, tlktData);
-    tlknIndex = getTLKNIndex(topic, thingId, tlktData);
+    dialogLine = getResponseText(tlknIndex, (tableType == ConvTableType_Race) ? raceData : individualData, commands);
   }
-
-  if (tlknIndex >= 0)
+  else
   {
-    QByteArray tlknData;
-    getTLKNData(tableType, alienOrRaceId, tlknData);
+    tableType = ConvTableType_Invalid;
+  }
+
+  return dialogLine;
+}
+
+/**
+ * Reads the TLKN table and the TLKX files for either the race or individual alien specified by "id".
+ * @return True if all three files were read; false otherwise.
+ */
+bool ConversationText::getTableData(ConvTableType tableType, int id, ConvTableData& data)
+{
+  return getTLKNData(tableType, id, data.tlknData) &&
+         getTLKXData(tableType, id, data.tlkxIndexData, data.tlkxStrData);
+}
 
-    // get the list of indices in the table of pointers to dialog strings
-    int tlkxIndex = getTLKXIndex(tlknIndex, tlknData);
+/**
+ * Renders the line of dialogue that the specified TLKN record leads to, or returns an empty
+ * string if the record or its line is not in the provided table data.
+ */
+QString ConversationText::getResponseText(int tlknIndex, const ConvTableData& data, QVector<QPair<GTxtCmd,int> >& commands)
+{
+  QString dialogLine;
+
+  if (((tlknIndex + 1) * TLKN_RECORDSIZE) <= data.tlknData.size())
+  {
+    // get the index in the table of pointers to dialog strings
+    const int tlkxIndex = getTLKXIndex(tlknIndex, data.tlknData);
+    const int lineCount = (data.tlkxIndexData.size() / TLKX_RECORDSIZE) - 1;
+    const int offset = (tlkxIndex < lineCount) ? getTLKXStringOffset(tlkxIndex, data.tlkxIndexData) : -1;
 
-    QByteArray tlkxIndexData;
-    QByteArray tlkxStrData;
-    getTLKXData(tableType, alienOrRaceId, tlkxIndexData, tlkxStrData);
-    dialogLine = getTLKXString(tlkxIndex, tlkxIndexData, tlkxStrData, commands);
+    if ((offset >= 0) && (offset < data.tlkxStrData.size()))
+    {
+      dialogLine = getTLKXString(tlkxIndex, data.tlkxIndexData, data.tlkxStrData, commands);
+    }
   }
 
   return dialogLine;
 }
 
+/**
+ * Finds the response to the provided topic, first in the tables specific to the alien and then
+ * (if the individual-specific tables didn't have any entries for this topic) in the generic tables
+ * used by all members of the alien's race. The table in which the response was found is returned
+ * along with its TLKN index.
+ * @return True if a response was found; false otherwise.
+ */
+bool ConversationText::findTLKNIndex(int alienId, int raceId, ConvTopicCategory topic, int thingId,
+                                     ConvTableType& tableType, int& alienOrRaceId, int& tlknIndex)
+{
+  tableType = ConvTableType_Individual;
+  alienOrRaceId = alienId;
+  tlknIndex = getTLKNIndex(tableType, alienOrRaceId, topic, thingId);
+
+  if (tlknIndex < 0)
+  {
+    tableType = ConvTableType_Race;
+    alienOrRaceId = raceId;
+    tlknIndex = getTLKNIndex(tableType, alienOrRaceId, topic, thingId);
+  }
+
+  return (tlknIndex >= 0);
+}
+
 /**
  * Opens the conversation line files -- one for each of the indices and strings -- for either the
  * race or individual alien specified by "id". Returns true if both files were opened and the data
@@ -93,17 +169,79 @@ QString ConversationText::getTLKXString(int tlkxIndex,
                                         const QByteArray& tlkxIndexData,
                                         const QByteArray& tlkxStrData,
                                         QVector<QPair<GTxtCmd,int> >& commands)
+{
+  const int tlkxStrOffset = getTLKXStringOffset(tlkxIndex, tlkxIndexData);
+
+  const QString line = m_gtext->readString(tlkxStrData.data() + tlkxStrOffset, commands, true);
+
+  return line;
+}
+
+/**
+ * Returns the offset of the string data for the specified line in a TLKX .TXT file, read from
+ * the corresponding .IDX file. The first record in the index is not used for a line.
+ */
+int ConversationText::getTLKXStringOffset(int tlkxIndex, const QByteArray& tlkxIndexData)
 {
   const uint8_t* idxData = reinterpret_cast<const uint8_t*>(tlkxIndexData.data());
 
   const int tlkxIndexOffset = (tlkxIndex * TLKX_RECORDSIZE) + TLKX_RECORDSIZE;
   uint32_t tlkxStrOffset = 0;
   memcpy(&tlkxStrOffset, &idxData[tlkxIndexOffset], TLKX_RECORDSIZE);
-  tlkxStrOffset = qFromLittleEndian<quint32>(tlkxStrOffset);
 
-  const QString line = m_gtext->readString(tlkxStrData.data() + tlkxStrOffset, commands, true);
+  return static_cast<int>(qFromLittleEndian<quint32>(tlkxStrOffset));
+}
 
-  return line;
+/**
+ * Reads every line of dialogue in the TLKX files for either the race or individual alien specified
+ * by "id", and finds the topics (from the TLKT and TLKN tables) that lead to each line. Lines that
+ * no topic leads to are included with an empty list of topics.
+ */
+QVector<ConvDialogueLine> ConversationText::getDialogueLines(ConvTableType tableType, int id)
+{
+  QVector<ConvDialogueLine> lines;
+  QHash<int,int> lineLookup;
+  QByteArray tlkxIndexData;
+  QByteArray tlkxStrData;
+
+  if (getTLKXData(tableType, id, tlkxIndexData, tlkxStrData))
+  {
+    const int lineCount = (tlkxIndexData.size() / TLKX_RECORDSIZE) - 1;
+    lines.reserve(qMax(lineCount, 0));
+
+    for (int tlkxIndex = 0; tlkxIndex < lineCount; tlkxIndex++)
+    {
+      const int offset = getTLKXStringOffset(tlkxIndex, tlkxIndexData);
+      if ((offset >= 0) && (offset < tlkxStrData.size()))
+      {
+        ConvDialogueLine line;
+        line.tlkxIndex = tlkxIndex;
+        line.offset = offset;
+        line.text = m_gtext->parseString(tlkxStrData.constData() + offset, tlkxStrData.size() - offset);
+        lineLookup.insert(tlkxIndex, lines.size());
+        lines.append(line);
+      }
+    }
+
+    QByteArray tlktData;
+    QByteArray tlknData;
+    getTLKTData(tableType, id, tlktData);
+    getTLKNData(tableType, id, tlknData);
+
+    foreach (const ConvTopicResponse& response, readTLKTResponses(tlktData))
+    {
+      if (((response.tlknIndex + 1) * TLKN_RECORDSIZE) <= tlknData.size())
+      {
+        const int lineIdx = lineLookup.value(getTLKXIndex(response.tlknIndex, tlknData), -1);
+        if (lineIdx >= 0)
+        {
+          lines[lineIdx].topics.append(QPair<ConvTopicCategory,int>(response.topic, response.thingId));
+        }
+      }
+    }
+  }
+
+  return lines;
 }
 
 /**
@@ -146,6 +284,33 @@ bool ConversationText::getTLKTData(ConvTableType tableType, int id, QByteArray&
   return status;
 }
 
+/**
+ * Determines whether the provided filename is that of a TLKXC or TLKXR strings file and, if
+ * so, the table type and the alien or race ID that it belongs to.
+ * @return True if the filename is that of a TLKX strings file; false otherwise.
+ */
+bool ConversationText::parseTLKXFilename(const QString& filename, ConvTableType& tableType, int& id)
+{
+  const QString upperName = filename.toUpper();
+  bool ok = false;
+
+  if (upperName.endsWith(".TXT"))
+  {
+    if (upperName.startsWith("TLKXC"))
+    {
+      tableType = ConvTableType_Individual;
+      id = upperName.mid(5, 3).toInt(&ok);
+    }
+    else if (upperName.startsWith("TLKXR"))
+    {
+      tableType = ConvTableType_Race;
+      id = upperName.mid(5, 3).toInt(&ok);
+    }
+  }
+
+  return ok;
+}
+
 const QString ConversationText::getTLKNCFilename(int id)
 {
   return QString("TLKNC%1.TAB").arg(id, 3, 10, QChar('0'));
@@ -200,18 +365,45 @@ int ConversationText::getTLKXIndex(int tlknIndex, const QByteArray& tlknData)
 }
 
 /**
- * Gets the list of indices from the provided TLKT data that match the specified thing ID in the specified
- * conversation topic category. If none match, an empty list is returned.
+ * Returns the key used in a TLKTIndex for the provided topic. Greetings are not about any
+ * particular thing, so their thing ID is ignored.
  */
-int ConversationText::getTLKNIndex(ConvTopicCategory topic, int requestedId, const QByteArray& tlktData)
+quint32 ConversationText::topicKey(ConvTopicCategory topic, int thingId)
 {
-  int index = -1;
-  int highestPriority = 0;
+  if ((topic == ConvTopicCategory_GreetingInitial) || (topic == ConvTopicCategory_GreetingSubsequent))
+  {
+    thingId = 0;
+  }
+
+  return (static_cast<quint32>(topic) << 24) | (static_cast<quint32>(thingId) & 0xFFFFFF);
+}
+
+/**
+ * Adds a single response to the provided list.
+ */
+void ConversationText::addTLKTResponse(QVector<ConvTopicResponse>& responses, ConvTopicCategory topic,
+                                       int thingId, int priority, int tlknIndex)
+{
+  ConvTopicResponse response;
+  response.topic = topic;
+  response.thingId = thingId;
+  response.priority = priority;
+  response.tlknIndex = tlknIndex;
+  responses.append(response);
+}
+
+/**
+ * Reads every entry in the provided TLKT data and returns the topics that each one responds to,
+ * in the order in which they appear in the table.
+ */
+QVector<ConvTopicResponse> ConversationText::readTLKTResponses(const QByteArray& tlktData)
+{
+  QVector<ConvTopicResponse> responses;
 
   const uint8_t* data = reinterpret_cast<const uint8_t*>(tlktData.data());
   int offset = 0;
 
-  while (offset < tlktData.size())
+  while ((offset + TLKT_RECORDSIZE) <= tlktData.size())
   {
     const int firstByte = data[offset];
     const int priority  = data[offset + 1];
@@ -221,97 +413,178 @@ int ConversationText::getTLKNIndex(ConvTopicCategory topic, int requestedId, con
     const int miscId    = data[offset + 7];
     const int tlknIndex = data[offset + 8] + (0x100 * data[offset + 9]);
 
-    if (priority >= highestPriority)
+    switch (firstByte)
     {
-      if ((topic == ConvTopicCategory_GreetingInitial) && (firstByte == TLKN_CMD_GREETFIRST))
-      {
-        index = tlknIndex;
-      highestPriority = priority;
-      }
-      else if ((topic == ConvTopicCategory_GreetingSubsequent) && (firstByte == TLKN_CMD_GREETNEXT))
-      {
-        index = tlknIndex;
-      highestPriority = priority;
-      }
-      else if ((topic == ConvTopicCategory_DisplayObject) && (firstByte == TLKN_CMD_DISPOBJECT) && (objectId == requestedId))
-      {
-        index = tlknIndex;
-      highestPriority = priority;
-      }
-      else if ((topic == ConvTopicCategory_GiveObject) && (firstByte == TLKN_CMD_GIVEOBJECT) && (objectId == requestedId))
-      {
-        index = tlknIndex;
-      highestPriority = priority;
-      }
-      else if ((topic == ConvTopicCategory_SeesObject) && (firstByte == TLKN_CMD_SEESOBJ) && (objectId == requestedId))
-      {
-        index = tlknIndex;
-      highestPriority = priority;
-      }
-      else if ((topic == ConvTopicCategory_AskAboutRace) && (firstByte == TLKN_CMD_ASKABOUTRACE) && (miscId == requestedId))
-      {
-        index = tlknIndex;
-      highestPriority = priority;
-      }
-      else if ((topic == ConvTopicCategory_AskAboutPerson) && (firstByte == TLKN_CMD_ASKABOUT) && (alienId == requestedId))
-      {
-        index = tlknIndex;
-      highestPriority = priority;
-      }
-      else if ((topic == ConvTopicCategory_AskAboutObject) && (firstByte == TLKN_CMD_ASKABOUT) && (objectId == requestedId))
-      {
-        index = tlknIndex;
-      highestPriority = priority;
-      }
-      else if ((topic == ConvTopicCategory_AskAboutLocation) && (firstByte == TLKN_CMD_ASKABOUT) && (placeId == requestedId))
-      {
-        index = tlknIndex;
-      highestPriority = priority;
-      }
-      else if ((topic == ConvTopicCategory_GiveFact) && (firstByte == TLKN_CMD_ASKABOUT) && (miscId == requestedId))
-      {
-        index = tlknIndex;
-      highestPriority = priority;
-      }
-
+    case TLKN_CMD_GREETFIRST:
+      addTLKTResponse(responses, ConvTopicCategory_GreetingInitial, 0, priority, tlknIndex);
+      break;
+    case TLKN_CMD_GREETNEXT:
+      addTLKTResponse(responses, ConvTopicCategory_GreetingSubsequent, 0, priority, tlknIndex);
+      break;
+    case TLKN_CMD_DISPOBJECT:
+      addTLKTResponse(responses, ConvTopicCategory_DisplayObject, objectId, priority, tlknIndex);
+      break;
+    case TLKN_CMD_GIVEOBJECT:
+      addTLKTResponse(responses, ConvTopicCategory_GiveObject, objectId, priority, tlknIndex);
+      break;
+    case TLKN_CMD_SEESOBJ:
+      addTLKTResponse(responses, ConvTopicCategory_SeesObject, objectId, priority, tlknIndex);
+      break;
+    case TLKN_CMD_ASKABOUTRACE:
+      addTLKTResponse(responses, ConvTopicCategory_AskAboutRace, miscId, priority, tlknIndex);
+      break;
+    case TLKN_CMD_ASKABOUT:
+      // a single "ask about" entry can answer questions about a person, object, place, or fact
+      addTLKTResponse(responses, ConvTopicCategory_AskAboutPerson, alienId, priority, tlknIndex);
+      addTLKTResponse(responses, ConvTopicCategory_AskAboutObject, objectId, priority, tlknIndex);
+      addTLKTResponse(responses, ConvTopicCategory_AskAboutLocation, placeId, priority, tlknIndex);
+      addTLKTResponse(responses, ConvTopicCategory_GiveFact, miscId, priority, tlknIndex);
+      break;
+    default:
+      break;
     }
 
     offset += TLKT_RECORDSIZE;
   }
 
-  return index;
+  return responses;
 }
 
 /**
- * Returns true if there are lines of dialogue associated specifically with the given alien ID,
- * about the provided topic ID in the provided category. Return false if the game will select
- * a generic fallback dialogue line for the provided combination.
+ * Builds a map from each topic that the provided TLKT data responds to, to the TLKN index of
+ * the highest-priority response. When priorities are equal, the game uses the entry that
+ * appears later in the table.
  */
-bool ConversationText::doesInterestingDialogExist(int alienId, ConvTopicCategory category, int thingId)
+TLKTIndex ConversationText::buildTLKTIndex(const QByteArray& tlktData)
 {
-  bool status = false;
+  QHash<quint32,int> priorities;
+  TLKTIndex index;
 
-  QByteArray tlktData;
-  ConvTableType tableType = ConvTableType_Individual;
-  int alienOrRaceId = alienId;
+  foreach (const ConvTopicResponse& response, readTLKTResponses(tlktData))
+  {
+    const quint32 key = topicKey(response.topic, response.thingId);
+    if (response.priority >= priorities.value(key, 0))
+    {
+      priorities.insert(key, response.priority);
+      index.insert(key, response.tlknIndex);
+    }
+  }
+
+  return index;
+}
+
+/**
+ * Returns the index of the specified TLKT table. Each table is read and indexed the first
+ * time it is needed, so that later lookups do not need to decompress or scan it again.
+ * The table is read and indexed without holding the lock, so that threads indexing
+ * different tables do not wait on one another; if two threads index the same table at
+ * once, the first index to be stored is kept.
+ */
+TLKTIndex ConversationText::getTLKTIndex(ConvTableType tableType, int id)
+{
+  QHash<int,TLKTIndex>& indices = (tableType == ConvTableType_Race) ? m_raceIndex : m_individualIndex;
 
-  getTLKTData(tableType, alienOrRaceId, tlktData);
+  {
+    QMutexLocker locker(&m_indexMutex);
+    QHash<int,TLKTIndex>::const_iterator it = indices.constFind(id);
+    if (it != indices.constEnd())
+    {
+      return it.value();
+    }
+  }
 
-  int tlknIndex = getTLKNIndex(category, thingId, tlktData);
+  QByteArray tlktData;
+  getTLKTData(tableType, id, tlktData);
+  const TLKTIndex index = buildTLKTIndex(tlktData);
 
-  if (tlknIndex >= 0)
+  QMutexLocker locker(&m_indexMutex);
+  QHash<int,TLKTIndex>::const_iterator it = indices.constFind(id);
+  if (it == indices.constEnd())
   {
-    status = true;
+    it = indices.insert(id, index);
   }
-  else
+
+  return it.value();
+}
+
+/**
+ * Gets the TLKN index of the response to the provided topic from the specified TLKT table.
+ * @return TLKN index of the highest-priority response, or -1 if the table has no response.
+ */
+int ConversationText::getTLKNIndex(ConvTableType tableType, int id, ConvTopicCategory topic, int thingId)
+{
+  return getTLKTIndex(tableType, id).value(topicKey(topic, thingId), -1);
+}
+
+/**
+ * Returns every response that the specified alien can give, along with the topic that leads
+ * to each one. As in findTLKNIndex(), the alien's own tables take precedence, and the race's
+ * tables supply the responses to any topics that the alien's tables do not cover. The race
+ * is passed in (rather than looked up) so that this may be called from any thread.
+ */
+QVector<ConvResponse> ConversationText::getAllResponses(int alienId, int raceId)
+{
+  QVector<ConvResponse> responses;
+  const TLKTIndex individualIndex = getTLKTIndex(ConvTableType_Individual, alienId);
+
+  addResponses(responses, ConvTableType_Individual, alienId, individualIndex, TLKTIndex());
+  addResponses(responses, ConvTableType_Race, raceId, getTLKTIndex(ConvTableType_Race, raceId), individualIndex);
+
+  return responses;
+}
+
+/**
+ * Adds the response to each topic in the provided TLKT index, except for the topics that
+ * are also in the overriding index.
+ */
+void ConversationText::addResponses(QVector<ConvResponse>& responses, ConvTableType tableType, int id,
+                                    const TLKTIndex& index, const TLKTIndex& overrides)
+{
+  QByteArray tlknData;
+  QByteArray tlkxIndexData;
+  QByteArray tlkxStrData;
+
+  if (!index.isEmpty() &&
+      getTLKNData(tableType, id, tlknData) &&
+      getTLKXData(tableType, id, tlkxIndexData, tlkxStrData))
   {
-    tableType = ConvTableType_Race;
-    alienOrRaceId = static_cast<int>(m_aliens->getRace(alienId));
-    getTLKTData(tableType, alienOrRaceId, tlktData);
-    tlknIndex = getTLKNIndex(category, thingId, tlktData);
+    const int lineCount = (tlkxIndexData.size() / TLKX_RECORDSIZE) - 1;
 
-    status = (tlknIndex >= 0);
+    for (TLKTIndex::const_iterator it = index.constBegin(); it != index.constEnd(); ++it)
+    {
+      if (!overrides.contains(it.key()) && (((it.value() + 1) * TLKN_RECORDSIZE) <= tlknData.size()))
+      {
+        const int tlkxIndex = getTLKXIndex(it.value(), tlknData);
+        const int offset = (tlkxIndex < lineCount) ? getTLKXStringOffset(tlkxIndex, tlkxIndexData) : -1;
+
+        if ((offset >= 0) && (offset < tlkxStrData.size()))
+        {
+          ConvResponse response;
+          response.topic = static_cast<ConvTopicCategory>(it.key() >> 24);
+          response.thingId = static_cast<int>(it.key() & 0xFFFFFF);
+          response.tableType = tableType;
+          response.tableId = id;
+          response.tlkxIndex = tlkxIndex;
+          response.commands =
+            m_gtext->renderCommands(m_gtext->parseString(tlkxStrData.constData() + offset, tlkxStrData.size() - offset));
+          responses.append(response);
+        }
+      }
+    }
   }
+}
 
-  return status;
+/**
+ * Returns true if there are lines of dialogue associated specifically with the given alien ID,
+ * about the provided topic ID in the provided category. Return false if the game will select
+ * a generic fallback dialogue line for the provided combination.
+ */
+bool ConversationText::doesInterestingDialogExist(int alienId, ConvTopicCategory category, int thingId)
+{
+  ConvTableType tableType = ConvTableType_Invalid;
+  int alienOrRaceId = -1;
+  int tlknIndex = -1;
+
+  return findTLKNIndex(alienId, static_cast<int>(m_aliens->getRace(alienId)), category, thingId,
+                       tableType, alienOrRaceId, tlknIndex);
 }
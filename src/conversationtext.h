@@ -4,6 +4,8 @@
 #include <QStringList>
 #include <QByteArray>
 #include <QList>
+#include <QHash>
+#include <QMutex>
 #include "datlibrary.h"
 #include "gametext.h"
 #include "aliens.h"
@@ -42,24 +44,105 @@ enum ConvTableType
   ConvTableType_Invalid
 };
 
+/**
+ * A single entry in a TLKTC or TLKTR table, which selects the response (by TLKN index)
+ * that is given when the player raises the topic with the specified thing ID.
+ */
+struct ConvTopicResponse
+{
+  ConvTopicCategory topic;
+  int thingId;
+  int priority;
+  int tlknIndex;
+};
+
+/**
+ * A single line of dialogue in a TLKXC or TLKXR file, along with the topics that lead to
+ * it. The offset is the position of the line's string data in the .TXT file.
+ */
+struct ConvDialogueLine
+{
+  int tlkxIndex;
+  int offset;
+  GameTextString text;
+  QVector<QPair<ConvTopicCategory,int> > topics;
+};
+
+/**
+ * A response that an alien gives to a topic, identified by the table (individual or race)
+ * in which it was found and its line in that table's TLKX file, along with the commands
+ * embedded in the line.
+ */
+struct ConvResponse
+{
+  ConvTopicCategory topic;
+  int thingId;
+  ConvTableType tableType;
+  int tableId;
+  int tlkxIndex;
+  QVector<QPair<GTxtCmd,int> > commands;
+};
+
+/**
+ * Contents of the TLKN table and TLKX index and strings files for a single alien or race,
+ * read once so that any number of its responses can be looked up without decompressing
+ * the files again.
+ */
+struct ConvTableData
+{
+  QByteArray tlknData;
+  QByteArray tlkxIndexData;
+  QByteArray tlkxStrData;
+};
+
+/**
+ * Map from a conversation topic (category and thing ID) to the TLKN index of the
+ * highest-priority response for that topic in a single TLKTC or TLKTR table.
+ */
+typedef QHash<quint32,int> TLKTIndex;
+
 class ConversationText
 {
 public:
   ConversationText(DatLibrary& lib, Aliens& aliens, GameText& gtext);
+  void clear();
   QString getConversationText(int alienId, ConvTopicCategory topic, int thingId, QVector<QPair<GTxtCmd,int> >& commands);
+  QString getConversationText(int alienId, int raceId, ConvTopicCategory topic, int thingId,
+                              const ConvTableData& individualData, const ConvTableData& raceData,
+                              QVector<QPair<GTxtCmd,int> >& commands, ConvTableType& tableType);
+  bool getTableData(ConvTableType tableType, int id, ConvTableData& data);
   bool doesInterestingDialogExist(int alienId, ConvTopicCategory category, int thingId);
+  QVector<ConvDialogueLine> getDialogueLines(ConvTableType tableType, int id);
+  QVector<ConvResponse> getAllResponses(int alienId, int raceId);
+
+  static QVector<ConvTopicResponse> readTLKTResponses(const QByteArray& tlktData);
+  static bool parseTLKXFilename(const QString& filename, ConvTableType& tableType, int& id);
 
 private:
   DatLibrary* m_lib;
   Aliens* m_aliens;
   GameText* m_gtext;
+  QHash<int,TLKTIndex> m_individualIndex;
+  QHash<int,TLKTIndex> m_raceIndex;
+  QMutex m_indexMutex;
 
   bool getTLKTData(ConvTableType tableType, int id, QByteArray& data);
   bool getTLKNData(ConvTableType tableType, int id, QByteArray& data);
   bool getTLKXData(ConvTableType tableType, int id, QByteArray& indexData, QByteArray& strData);
 
-  //! Searches the provided TLKTR or TLKTC file to get a list of TLKN indices that match the provided criteria
-  int getTLKNIndex(ConvTopicCategory topic, int thingId, const QByteArray& tlktData);
+  TLKTIndex getTLKTIndex(ConvTableType tableType, int id);
+  void addResponses(QVector<ConvResponse>& responses, ConvTableType tableType, int id,
+                    const TLKTIndex& index, const TLKTIndex& overrides);
+
+  //! Returns the TLKN index for the provided topic in the TLKTR or TLKTC table, or -1 if there is none
+  int getTLKNIndex(ConvTableType tableType, int id, ConvTopicCategory topic, int thingId);
+  bool findTLKNIndex(int alienId, int raceId, ConvTopicCategory topic, int thingId,
+                     ConvTableType& tableType, int& alienOrRaceId, int& tlknIndex);
+
+  static TLKTIndex buildTLKTIndex(const QByteArray& tlktData);
+  static void addTLKTResponse(QVector<ConvTopicResponse>& responses, ConvTopicCategory topic,
+                              int thingId, int priority, int tlknIndex);
+  static quint32 topicKey(ConvTopicCategory topic, int thingId);
 
   const QString getTLKNCFilename(int id);
   const QString getTLKNRFilename(int id);
@@ -72,8 +155,10 @@ private:
 
   //! Reads data from the provided TLKNC or TLKNR data to provide an index into a TLKXC/TLKXR file
   int getTLKXIndex(int tlknIndex, const QByteArray& tlknData);
+  static int getTLKXStringOffset(int tlkxIndex, const QByteArray& tlkxIndexData);
 
   QString getTLKXString(int tlkxIndex, const QByteArray& tlkxIndexData, const QByteArray& tlkxStrData, QVector<QPair<GTxtCmd,int> >& commands);
+  QString getResponseText(int tlknIndex, const ConvTableData& data, QVector<QPair<GTxtCmd,int> >& commands);
 };
 
 #endif // CONVERSATIONTEXT_H
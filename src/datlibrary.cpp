@@ -4,6 +4,7 @@
 #include <QtEndian>
 #include <QImage>
 #include <QRgb>
+#include <QHash>
 #include <string.h>
 
 const QMap<DatFileType,QString> DatLibrary::s_datFileNames
@@ -41,6 +42,8 @@ bool DatLibrary::openData(QString pathToGameDir)
     }
   }
 
+  indexGameText();
+
   return status;
 }
 
@@ -55,6 +58,8 @@ void DatLibrary::closeData()
   }
 
   m_gameText.clear();
+  m_gameTextIndex.clear();
+  m_gameTextStrings.clear();
 }
 
 /**
@@ -275,28 +280,82 @@ bool DatLibrary::lzDecompress(QByteArray compressedfile, QByteArray& decompresse
   return status;
 }
 
+/**
+ * Reads GAMETEXT.TXT and decodes each of its null-terminated strings once, so that later
+ * lookups by offset do not need to scan or decode anything. Strings with identical text
+ * share a single QString.
+ */
+void DatLibrary::indexGameText()
+{
+  m_gameText.clear();
+  m_gameTextIndex.clear();
+  m_gameTextStrings.clear();
+
+  if (getFileByName(DatFileType::CONVERSE, "GAMETEXT.TXT", m_gameText))
+  {
+    const char* rawdata = m_gameText.constData();
+    const int size = m_gameText.size();
+    QHash<QString,int> interned;
+    int offset = 0;
+
+    while (offset < size)
+    {
+      const char* terminator = static_cast<const char*>(memchr(rawdata + offset, 0, size - offset));
+      const int length = terminator ? static_cast<int>(terminator - (rawdata + offset)) : (size - offset);
+      const QString txt = QString::fromUtf8(rawdata + offset, length);
+
+      QHash<QString,int>::const_iterator it = interned.constFind(txt);
+      if (it == interned.constEnd())
+      {
+        it = interned.insert(txt, m_gameTextStrings.size());
+        m_gameTextStrings.append(txt);
+      }
+
+      m_gameTextIndex.insert(offset, it.value());
+      offset += length + 1;
+    }
+  }
+}
+
 /**
  * Convenience function that returns the string at the specified offset in GAMETEXT.TXT.
  * This function is provided because the GAMETEXT strings are used by many different parts of the game.
  * @return The null-terminated string found at the specified offset, or an empty string if
  * an invalid offset was specified.
  */
-QString DatLibrary::getGameText(int offset)
+QString DatLibrary::getGameText(int offset) const
 {
   QString txt("");
 
-  if (m_gameText.isEmpty())
+  if ((offset >= 0) && (offset < m_gameText.size()))
   {
-    QString filename("GAMETEXT.TXT");
-    getFileByName(DatFileType::CONVERSE, filename, m_gameText);
+    const int stringIndex = m_gameTextIndex.value(offset, -1);
+    if (stringIndex >= 0)
+    {
+      txt = m_gameTextStrings.at(stringIndex);
+    }
+    else
+    {
+      // offsets that point into the middle of a string are rare enough that they are
+      // simply decoded when requested
+      txt = QString::fromUtf8(m_gameText.constData() + offset);
+    }
   }
 
-  if (offset < m_gameText.size())
+  return txt;
+}
+
+/**
+ * Returns every string in GAMETEXT.TXT, keyed by the offset at which it begins.
+ */
+QMap<int,QString> DatLibrary::getAllGameText() const
+{
+  QMap<int,QString> strings;
+
+  for (QHash<int,int>::const_iterator it = m_gameTextIndex.constBegin(); it != m_gameTextIndex.constEnd(); ++it)
   {
-    const char* rawdata = m_gameText.data();
-    txt = QString::fromUtf8(rawdata + offset);
+    strings.insert(it.key(), m_gameTextStrings.at(it.value()));
   }
 
-  return txt;
+  return strings;
 }
-
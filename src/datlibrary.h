@@ -3,6 +3,7 @@
 #include <QByteArray>
 #include <QString>
 #include <QMap>
+#include <QHash>
 #include <QImage>
 #include <QVector>
 #include <QRgb>
@@ -52,14 +53,18 @@ public:
   static const QMap<DatFileType,QString> s_datFileNames;
 
   bool getFileByName(DatFileType dat, QString filename, QByteArray& filedata) const;
-  QString getGameText(int offset);
+  QString getGameText(int offset) const;
+  QMap<int,QString> getAllGameText() const;
   QStringList getFilenamesByExtension(DatFileType dat, QString extension);
 
 private:
   QByteArray m_datContents[static_cast<int>(DatFileType::NumFiles)];
   QByteArray m_gameText; // keep a copy of GAMETEXT.TXT since it is referenced frequently
+  QHash<int,int> m_gameTextIndex; // index into m_gameTextStrings for the offset of each string
+  QVector<QString> m_gameTextStrings;
 
   bool lzDecompress(QByteArray compressedfile, QByteArray& decompressedFile, int skipUncompressedBytes) const;
   bool getFileAtIndex(DatFileType dat, unsigned int index, QByteArray& decompressedFile) const;
+  void indexGameText();
 };
 
@@ -3,15 +3,18 @@
 #include <QMap>
 #include <QString>
 #include "datlibrary.h"
+#include "tableschema.h"
 
 /**
  * Template for classes that handle the game's data table files. The base functionality
  * in this template provides the ability to sequence through the entries in such a
- * data table.
+ * data table. Every entry struct must have a TableSchema describing its fields.
  */
 template <typename StructType>
 class DatTable
 {
+  static_assert(tableSchemaMatches<StructType>(), "Data table entry struct has no matching schema");
+
 public:
   void clear()
   {
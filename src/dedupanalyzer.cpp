@@ -0,0 +1,413 @@
+#include <algorithm>
+#include <QtConcurrent>
+#include <QCryptographicHash>
+#include "dedupanalyzer.h"
+#include "nnvcontainer.h"
+#include "dpcmdecoder.h"
+
+#define DEDUP_REPORT_MAX_GROUPS 40
+
+namespace
+{
+  /**
+   * Hashes the pixel data and color table of a decoded image. Only the visible part of
+   * each scanline is included, so that images with different row padding still match.
+   */
+  QByteArray hashImage(const QImage& img)
+  {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    const int format = static_cast<int>(img.format());
+    const int dims[2] = { img.width(), img.height() };
+    hash.addData(reinterpret_cast<const char*>(&format), sizeof(format));
+    hash.addData(reinterpret_cast<const char*>(dims), sizeof(dims));
+
+    const int lineBytes = (img.width() * img.depth() + 7) / 8;
+    for (int y = 0; y < img.height(); y++)
+    {
+      hash.addData(reinterpret_cast<const char*>(img.constScanLine(y)), lineBytes);
+    }
+
+    const QVector<QRgb> colors = img.colorTable();
+    hash.addData(reinterpret_cast<const char*>(colors.constData()), colors.size() * static_cast<int>(sizeof(QRgb)));
+
+    return hash.result();
+  }
+
+  DedupItem makeItem(DedupPayloadType type, const DedupJob& job, int index, const QByteArray& hash, qint64 size)
+  {
+    DedupItem item;
+    item.type = type;
+    item.dat = job.dat;
+    item.name = job.filename;
+    item.index = index;
+    item.hash = hash;
+    item.size = size;
+    return item;
+  }
+}
+
+/**
+ * Reads and hashes the DAT entry, and then decodes and hashes any sounds or images that
+ * it contains. Decoded sizes are used for the decoded payloads, since those are what
+ * the caches would hold.
+ */
+QVector<DedupItem> DedupHasher::operator()(const DedupJob& job) const
+{
+  QVector<DedupItem> items;
+  QByteArray data;
+
+  if (lib->getFileByName(job.dat, job.filename, data))
+  {
+    items.append(makeItem(DedupPayloadType::DatEntry, job, 0,
+                          QCryptographicHash::hash(data, QCryptographicHash::Sha1), data.size()));
+
+    const QString upperName = job.filename.toUpper();
+    if (upperName.endsWith(".NNV"))
+    {
+      NnvContainer container;
+      if (container.parse(data))
+      {
+        for (int soundId = 0; soundId < container.soundCount(); soundId++)
+        {
+          const uint8_t* encoded = nullptr;
+          int length = 0;
+          if (container.soundData(soundId, encoded, length))
+          {
+            QByteArray pcm(DpcmDecoder::decodedLength(encoded, length), Qt::Uninitialized);
+            DpcmDecoder::decode(encoded, length, reinterpret_cast<uint8_t*>(pcm.data()));
+            items.append(makeItem(DedupPayloadType::Sound, job, soundId,
+                                  QCryptographicHash::hash(pcm, QCryptographicHash::Sha1), pcm.size()));
+          }
+        }
+      }
+    }
+    else if (upperName.endsWith(QString(STAMP_EXTENSION).toUpper()) || upperName.endsWith(QString(ROLL_EXTENSION).toUpper()))
+    {
+      StampFile file;
+      if (stamps->getStampFile(job.dat, job.filename, file))
+      {
+        StampDecoder decoder;
+        decoder.palette = file.palette;
+        for (int stampIndex = 0; stampIndex < file.stamps.count(); stampIndex++)
+        {
+          const QImage img = decoder(file.stamps.at(stampIndex));
+          if (!img.isNull())
+          {
+            items.append(makeItem(DedupPayloadType::Stamp, job, stampIndex, hashImage(img), img.sizeInBytes()));
+          }
+        }
+      }
+    }
+    else if (upperName.endsWith(".LBM"))
+    {
+      QImage img;
+      if (fullscreenImages->getImage(job.dat, job.filename, img))
+      {
+        items.append(makeItem(DedupPayloadType::FullscreenImage, job, 0, hashImage(img), img.sizeInBytes()));
+      }
+    }
+  }
+
+  return items;
+}
+
+DedupIndex::DedupIndex()
+{
+
+}
+
+/**
+ * Groups the provided items by their content hash, assigning one payload ID to each
+ * distinct hash.
+ */
+void DedupIndex::build(const QVector<DedupItem>& items)
+{
+  clear();
+  m_items = items;
+  m_itemPayloadIds.resize(m_items.count());
+
+  QHash<QByteArray,int> hashToPayload;
+  for (int itemIndex = 0; itemIndex < m_items.count(); itemIndex++)
+  {
+    const DedupItem& item = m_items.at(itemIndex);
+    int payloadId = hashToPayload.value(item.hash, -1);
+
+    if (payloadId < 0)
+    {
+      payloadId = m_payloadItems.count();
+      hashToPayload.insert(item.hash, payloadId);
+      m_payloadItems.append(QVector<int>());
+    }
+
+    m_payloadItems[payloadId].append(itemIndex);
+    m_itemPayloadIds[itemIndex] = payloadId;
+    m_itemLookup.insert(itemKey(item.type, item.dat, item.name, item.index), itemIndex);
+  }
+}
+
+void DedupIndex::clear()
+{
+  m_items.clear();
+  m_itemPayloadIds.clear();
+  m_payloadItems.clear();
+  m_itemLookup.clear();
+}
+
+bool DedupIndex::isEmpty() const
+{
+  return m_items.isEmpty();
+}
+
+/**
+ * Returns the ID of the unique content of the specified payload, or -1 if the payload
+ * was not part of the analysis. The index selects a sound within an NNV container or a
+ * stamp within a roll, and is zero for other payloads.
+ */
+int DedupIndex::payloadId(DedupPayloadType type, DatFileType dat, const QString& name, int index) const
+{
+  const int itemIndex = m_itemLookup.value(itemKey(type, dat, name, index), -1);
+  return (itemIndex >= 0) ? m_itemPayloadIds.at(itemIndex) : -1;
+}
+
+/**
+ * Returns every item whose content matches the provided payload ID.
+ */
+QVector<DedupItem> DedupIndex::duplicatesOf(int payloadId) const
+{
+  QVector<DedupItem> items;
+
+  if ((payloadId >= 0) && (payloadId < m_payloadItems.count()))
+  {
+    foreach (int itemIndex, m_payloadItems.at(payloadId))
+    {
+      items.append(m_items.at(itemIndex));
+    }
+  }
+
+  return items;
+}
+
+/**
+ * Returns the IDs of all payloads whose content is shared by more than one item.
+ */
+QList<int> DedupIndex::duplicatedPayloadIds() const
+{
+  QList<int> ids;
+
+  for (int payloadId = 0; payloadId < m_payloadItems.count(); payloadId++)
+  {
+    if (m_payloadItems.at(payloadId).count() > 1)
+    {
+      ids.append(payloadId);
+    }
+  }
+
+  return ids;
+}
+
+/**
+ * Summarizes the duplication found for each type of payload, with the number of bytes
+ * that caches would avoid holding and the number of exports that would be skipped if
+ * each unique payload were only decoded once, followed by the largest duplicate groups.
+ */
+QString DedupIndex::report() const
+{
+  QString text;
+  const DedupPayloadType types[] = { DedupPayloadType::DatEntry, DedupPayloadType::Sound,
+                                     DedupPayloadType::Stamp, DedupPayloadType::FullscreenImage };
+
+  for (DedupPayloadType type : types)
+  {
+    QHash<int,int> payloadCounts;
+    int itemCount = 0;
+    qint64 totalBytes = 0;
+    qint64 savedBytes = 0;
+
+    for (int itemIndex = 0; itemIndex < m_items.count(); itemIndex++)
+    {
+      const DedupItem& item = m_items.at(itemIndex);
+      if (item.type == type)
+      {
+        const int payloadId = m_itemPayloadIds.at(itemIndex);
+        if (payloadCounts.contains(payloadId))
+        {
+          savedBytes += item.size;
+        }
+        payloadCounts[payloadId]++;
+        itemCount++;
+        totalBytes += item.size;
+      }
+    }
+
+    text += QString("%1: %2 items, %3 unique, %4 redundant copies; %5 of %6 KB could be shared\n")
+              .arg(typeName(type))
+              .arg(itemCount)
+              .arg(payloadCounts.count())
+              .arg(itemCount - payloadCounts.count())
+              .arg(savedBytes / 1024)
+              .arg(totalBytes / 1024);
+  }
+
+  // list the duplicate groups that waste the most memory
+  QList<int> ids = duplicatedPayloadIds();
+  std::sort(ids.begin(), ids.end(), [this](int a, int b) {
+    const qint64 wasteA = m_items.at(m_payloadItems.at(a).first()).size * (m_payloadItems.at(a).count() - 1);
+    const qint64 wasteB = m_items.at(m_payloadItems.at(b).first()).size * (m_payloadItems.at(b).count() - 1);
+    return wasteA > wasteB;
+  });
+
+  text += QString("\n%1 duplicate groups").arg(ids.count());
+  if (ids.count() > DEDUP_REPORT_MAX_GROUPS)
+  {
+    text += QString(" (largest %1 shown)").arg(DEDUP_REPORT_MAX_GROUPS);
+  }
+  text += ":\n";
+
+  foreach (int payloadId, ids.mid(0, DEDUP_REPORT_MAX_GROUPS))
+  {
+    QStringList names;
+    foreach (int itemIndex, m_payloadItems.at(payloadId))
+    {
+      const DedupItem& item = m_items.at(itemIndex);
+      const QString datName = DatLibrary::s_datFileNames.value(item.dat);
+      names.append((item.type == DedupPayloadType::Sound) || (item.type == DedupPayloadType::Stamp) ?
+                   QString("%1/%2[%3]").arg(datName).arg(item.name).arg(item.index) :
+                   QString("%1/%2").arg(datName).arg(item.name));
+    }
+
+    const DedupItem& first = m_items.at(m_payloadItems.at(payloadId).first());
+    text += QString("  %1, %2 bytes: %3\n").arg(typeName(first.type)).arg(first.size).arg(names.join(", "));
+  }
+
+  return text;
+}
+
+QString DedupIndex::itemKey(DedupPayloadType type, DatFileType dat, const QString& name, int index)
+{
+  return QString("%1|%2|%3|%4").arg(QString::number(static_cast<int>(type)), QString::number(static_cast<int>(dat)),
+                                    name.toUpper(), QString::number(index));
+}
+
+QString DedupIndex::typeName(DedupPayloadType type)
+{
+  switch (type)
+  {
+  case DedupPayloadType::DatEntry:
+    return "DAT entries";
+  case DedupPayloadType::Sound:
+    return "Sounds";
+  case DedupPayloadType::Stamp:
+    return "Stamp images";
+  case DedupPayloadType::FullscreenImage:
+    return "Fullscreen images";
+  }
+
+  return QString();
+}
+
+DedupAnalyzer::DedupAnalyzer(DatLibrary& lib, StampImages& stamps, FullscreenImages& fsImages, QObject* parent) :
+  QObject(parent),
+  m_lib(&lib),
+  m_stamps(&stamps),
+  m_fullscreenImages(&fsImages)
+{
+  connect(&m_watcher, &QFutureWatcher<QVector<DedupItem>>::progressValueChanged, this, &DedupAnalyzer::onProgressValueChanged);
+  connect(&m_watcher, &QFutureWatcher<QVector<DedupItem>>::finished, this, &DedupAnalyzer::onFinished);
+}
+
+DedupAnalyzer::~DedupAnalyzer()
+{
+  cancel();
+}
+
+/**
+ * Starts hashing every entry in every DAT file. The progress() signal reports the
+ * number of entries completed, and finished() is emitted once the index is built.
+ * @return The number of entries to be analyzed, or zero if an analysis is already
+ * running or there is nothing to analyze.
+ */
+int DedupAnalyzer::start()
+{
+  if (isRunning())
+  {
+    return 0;
+  }
+
+  m_jobs.clear();
+  m_index.clear();
+
+  for (int datIdx = 0; datIdx < static_cast<int>(DatFileType::NumFiles); datIdx++)
+  {
+    const DatFileType dat = static_cast<DatFileType>(datIdx);
+    foreach (QString filename, m_lib->getFilenamesByExtension(dat, ""))
+    {
+      DedupJob job;
+      job.dat = dat;
+      job.filename = filename;
+      m_jobs.append(job);
+    }
+  }
+
+  if (!m_jobs.isEmpty())
+  {
+    DedupHasher hasher;
+    hasher.lib = m_lib;
+    hasher.stamps = m_stamps;
+    hasher.fullscreenImages = m_fullscreenImages;
+    m_watcher.setFuture(QtConcurrent::mapped(m_jobs, hasher));
+  }
+
+  return m_jobs.count();
+}
+
+/**
+ * Stops hashing any entries that have not yet been started, and waits for those that
+ * are in progress.
+ */
+void DedupAnalyzer::cancel()
+{
+  if (m_watcher.isRunning())
+  {
+    m_watcher.cancel();
+    m_watcher.waitForFinished();
+  }
+}
+
+bool DedupAnalyzer::isRunning() const
+{
+  return m_watcher.isRunning();
+}
+
+/**
+ * Returns the index built by the most recent completed analysis.
+ */
+const DedupIndex& DedupAnalyzer::index() const
+{
+  return m_index;
+}
+
+void DedupAnalyzer::onProgressValueChanged(int value)
+{
+  emit progress(value, m_jobs.count());
+}
+
+/**
+ * Collects the hashed items from every entry and groups them.
+ */
+void DedupAnalyzer::onFinished()
+{
+  const bool cancelled = m_watcher.isCanceled();
+
+  if (!cancelled)
+  {
+    QVector<DedupItem> items;
+    foreach (const QVector<DedupItem>& entryItems, m_watcher.future().results())
+    {
+      items += entryItems;
+    }
+    m_index.build(items);
+  }
+
+  emit finished(cancelled);
+}
+
@@ -0,0 +1,123 @@
+#pragma once
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QFutureWatcher>
+#include "datlibrary.h"
+#include "stampimages.h"
+#include "fullscreenimages.h"
+
+enum class DedupPayloadType
+{
+  DatEntry,
+  Sound,
+  Stamp,
+  FullscreenImage
+};
+
+/**
+ * Identifies a single payload and records its content hash and size. The name is the
+ * filename of the DAT entry that holds the payload, and the index selects a sound
+ * within an NNV container or a stamp within a roll (and is zero otherwise).
+ */
+struct DedupItem
+{
+  DedupPayloadType type;
+  DatFileType dat;
+  QString name;
+  int index;
+  QByteArray hash;
+  qint64 size;
+};
+
+/**
+ * Describes a single DAT entry to be analyzed.
+ */
+struct DedupJob
+{
+  DatFileType dat;
+  QString filename;
+};
+
+/**
+ * Function object that is run on the worker threads to hash a single DAT entry,
+ * along with every sound or image that is decoded from it.
+ */
+struct DedupHasher
+{
+  typedef QVector<DedupItem> result_type;
+
+  DatLibrary* lib;
+  StampImages* stamps;
+  FullscreenImages* fullscreenImages;
+
+  QVector<DedupItem> operator()(const DedupJob& job) const;
+};
+
+/**
+ * Results of a deduplication analysis. Every analyzed payload is assigned the ID of
+ * its unique content, so that identical payloads (such as the same sound stored in two
+ * NNV containers) share one ID. Caches can look up payloadId() and use it as a key in
+ * place of the asset's name, so that they hold a single decoded copy of each unique
+ * payload.
+ */
+class DedupIndex
+{
+public:
+  DedupIndex();
+  void build(const QVector<DedupItem>& items);
+  void clear();
+  bool isEmpty() const;
+
+  int payloadId(DedupPayloadType type, DatFileType dat, const QString& name, int index = 0) const;
+  QVector<DedupItem> duplicatesOf(int payloadId) const;
+  QList<int> duplicatedPayloadIds() const;
+  QString report() const;
+
+private:
+  QVector<DedupItem> m_items;
+  QVector<int> m_itemPayloadIds;
+  QVector<QVector<int>> m_payloadItems;
+  QHash<QString,int> m_itemLookup;
+
+  static QString itemKey(DedupPayloadType type, DatFileType dat, const QString& name, int index);
+  static QString typeName(DedupPayloadType type);
+};
+
+/**
+ * Hashes every entry in every DAT file, and every sound and image decoded from them,
+ * in parallel on the global thread pool, and builds a DedupIndex from the results.
+ */
+class DedupAnalyzer : public QObject
+{
+  Q_OBJECT
+
+public:
+  DedupAnalyzer(DatLibrary& lib, StampImages& stamps, FullscreenImages& fsImages, QObject* parent = nullptr);
+  ~DedupAnalyzer();
+
+  int start();
+  void cancel();
+  bool isRunning() const;
+  const DedupIndex& index() const;
+
+signals:
+  void progress(int completed, int total);
+  void finished(bool cancelled);
+
+private slots:
+  void onProgressValueChanged(int value);
+  void onFinished();
+
+private:
+  DatLibrary* m_lib;
+  StampImages* m_stamps;
+  FullscreenImages* m_fullscreenImages;
+  QList<DedupJob> m_jobs;
+  QFutureWatcher<QVector<DedupItem>> m_watcher;
+  DedupIndex m_index;
+};
+
@@ -0,0 +1,144 @@
+#pragma once
+#include <QVector>
+#include <QBitArray>
+#include <QList>
+
+/**
+ * Container for the records read from a data table, stored in a vector indexed directly
+ * by ID. IDs in the game's tables are small and mostly contiguous, so a lookup is a
+ * single bounds check and validity bit test rather than a tree walk. Iteration visits
+ * only the valid records, in order of ID, and yields references to the stored records
+ * so that callers can read the whole table without copying it.
+ */
+template <typename T>
+class DenseIdTable
+{
+public:
+  class const_iterator
+  {
+  public:
+    const_iterator(const DenseIdTable<T>* table, int id) :
+      m_table(table),
+      m_id(id)
+    {
+      skipInvalid();
+    }
+
+    int key() const { return m_id; }
+    const T& value() const { return m_table->m_records.at(m_id); }
+    const T& operator*() const { return value(); }
+    const T* operator->() const { return &value(); }
+    bool operator==(const const_iterator& other) const { return m_id == other.m_id; }
+    bool operator!=(const const_iterator& other) const { return m_id != other.m_id; }
+
+    const_iterator& operator++()
+    {
+      m_id++;
+      skipInvalid();
+      return *this;
+    }
+
+  private:
+    const DenseIdTable<T>* m_table;
+    int m_id;
+
+    void skipInvalid()
+    {
+      while ((m_id < m_table->m_valid.size()) && !m_table->m_valid.testBit(m_id))
+      {
+        m_id++;
+      }
+    }
+  };
+
+  DenseIdTable() :
+    m_count(0)
+  {
+
+  }
+
+  void clear()
+  {
+    m_records.clear();
+    m_valid.clear();
+    m_count = 0;
+  }
+
+  bool isEmpty() const
+  {
+    return (m_count == 0);
+  }
+
+  int count() const
+  {
+    return m_count;
+  }
+
+  bool contains(int id) const
+  {
+    return (id >= 0) && (id < m_valid.size()) && m_valid.testBit(id);
+  }
+
+  /**
+   * Stores a record with the provided ID, growing the table if necessary.
+   */
+  void insert(int id, const T& record)
+  {
+    if (id >= 0)
+    {
+      if (id >= m_records.size())
+      {
+        m_records.resize(id + 1);
+        m_valid.resize(id + 1);
+      }
+
+      if (!m_valid.testBit(id))
+      {
+        m_valid.setBit(id);
+        m_count++;
+      }
+      m_records[id] = record;
+    }
+  }
+
+  /**
+   * Returns a pointer to the record with the provided ID, or a null pointer if there is none.
+   */
+  const T* find(int id) const
+  {
+    return contains(id) ? &m_records.at(id) : nullptr;
+  }
+
+  /**
+   * Returns the record with the provided ID, which must be in the table.
+   */
+  const T& operator[](int id) const
+  {
+    return m_records.at(id);
+  }
+
+  T value(int id, const T& defaultValue = T()) const
+  {
+    return contains(id) ? m_records.at(id) : defaultValue;
+  }
+
+  QList<int> keys() const
+  {
+    QList<int> ids;
+    for (const_iterator it = constBegin(); it != constEnd(); ++it)
+    {
+      ids.append(it.key());
+    }
+    return ids;
+  }
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, m_valid.size()); }
+  const_iterator constBegin() const { return begin(); }
+  const_iterator constEnd() const { return end(); }
+
+private:
+  QVector<T> m_records;
+  QBitArray m_valid;
+  int m_count;
+};
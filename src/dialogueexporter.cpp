@@ -0,0 +1,422 @@
+#include <QtConcurrent>
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include "dialogueexporter.h"
+#include "enums.h"
+
+DialogueWriteQueue::DialogueWriteQueue(int window) :
+  m_window(window),
+  m_next(0),
+  m_closed(false),
+  m_aborted(false)
+{
+
+}
+
+/**
+ * Empties the queue and makes it ready to accept the first alien again.
+ */
+void DialogueWriteQueue::reset()
+{
+  QMutexLocker locker(&m_mutex);
+  m_items.clear();
+  m_next = 0;
+  m_closed = false;
+  m_aborted = false;
+}
+
+/**
+ * Adds an alien to the queue, waiting while it is too far ahead of the next one to be written.
+ * @return True if the alien was queued; false if the queue was aborted.
+ */
+bool DialogueWriteQueue::push(int index, const DialogueExportChunk& chunk)
+{
+  QMutexLocker locker(&m_mutex);
+
+  while (!m_aborted && (index >= m_next + m_window))
+  {
+    m_space.wait(&m_mutex);
+  }
+
+  if (!m_aborted)
+  {
+    m_items.insert(index, chunk);
+    m_ready.wakeOne();
+  }
+
+  return !m_aborted;
+}
+
+/**
+ * Removes the next alien (in the original order) from the queue, waiting for it to arrive.
+ * @return True if an alien was removed; false if the queue was closed and has been drained,
+ * or if it was aborted.
+ */
+bool DialogueWriteQueue::pop(DialogueExportChunk& chunk)
+{
+  QMutexLocker locker(&m_mutex);
+
+  while (!m_aborted && !m_closed && !m_items.contains(m_next))
+  {
+    m_ready.wait(&m_mutex);
+  }
+
+  const bool status = !m_aborted && m_items.contains(m_next);
+  if (status)
+  {
+    chunk = m_items.take(m_next);
+    m_next++;
+    m_space.wakeAll();
+  }
+
+  return status;
+}
+
+/**
+ * Indicates that no more aliens will be added. The writer finishes once the queue is empty.
+ */
+void DialogueWriteQueue::close()
+{
+  QMutexLocker locker(&m_mutex);
+  m_closed = true;
+  m_ready.wakeAll();
+}
+
+/**
+ * Discards any queued aliens and releases the producers and the writer if they are waiting.
+ */
+void DialogueWriteQueue::abort()
+{
+  QMutexLocker locker(&m_mutex);
+  m_aborted = true;
+  m_items.clear();
+  m_ready.wakeAll();
+  m_space.wakeAll();
+}
+
+DialogueRaceTables::DialogueRaceTables()
+{
+
+}
+
+void DialogueRaceTables::clear()
+{
+  QMutexLocker locker(&m_mutex);
+  m_tables.clear();
+}
+
+/**
+ * Returns the contents of the specified race's conversation tables, reading them the first
+ * time they are needed. The files are read without holding the lock, so renderers that need
+ * different races do not wait on one another.
+ */
+ConvTableData DialogueRaceTables::get(ConversationText* convText, int raceId)
+{
+  {
+    QMutexLocker locker(&m_mutex);
+    QHash<int,ConvTableData>::const_iterator it = m_tables.constFind(raceId);
+    if (it != m_tables.constEnd())
+    {
+      return it.value();
+    }
+  }
+
+  ConvTableData data;
+  convText->getTableData(ConvTableType_Race, raceId, data);
+
+  QMutexLocker locker(&m_mutex);
+  if (!m_tables.contains(raceId))
+  {
+    m_tables.insert(raceId, data);
+  }
+
+  return m_tables.value(raceId);
+}
+
+/**
+ * Looks up the alien's response to every topic, and queues the responses rendered as both
+ * a JSON object and an HTML section. Topics that neither the alien nor its race has a
+ * response to are left out.
+ */
+void DialogueRenderer::operator()(const DialogueExportAlien& alien) const
+{
+  if (cancelled->loadAcquire())
+  {
+    return;
+  }
+
+  // read the alien's and its race's tables once, rather than once for each response
+  ConvTableData individualData;
+  convText->getTableData(ConvTableType_Individual, alien.id, individualData);
+  const ConvTableData raceData = raceTables->get(convText, alien.raceId);
+
+  QJsonArray jsonResponses;
+  QString html = QString("<h2 id=\"alien%1\">%2 (%1)</h2>\n<table>\n"
+                         "<tr><th>Topic</th><th>Thing</th><th>Table</th><th>Response</th><th>Commands</th></tr>\n")
+                   .arg(alien.id).arg(alien.name.toHtmlEscaped());
+
+  for (DialogueExportTopics::const_iterator topicIt = topics->constBegin(); topicIt != topics->constEnd(); ++topicIt)
+  {
+    for (QMap<int,QString>::const_iterator thingIt = topicIt.value().constBegin(); thingIt != topicIt.value().constEnd(); ++thingIt)
+    {
+      QVector<QPair<GTxtCmd,int> > commands;
+      ConvTableType tableType = ConvTableType_Invalid;
+      const QString line =
+        convText->getConversationText(alien.id, alien.raceId, topicIt.key(), thingIt.key(),
+                                      individualData, raceData, commands, tableType);
+
+      if (tableType != ConvTableType_Invalid)
+      {
+        const QString tableName = (tableType == ConvTableType_Race) ? "race" : "individual";
+        QJsonArray jsonCommands;
+        QStringList htmlCommands;
+
+        typedef QPair<GTxtCmd,int> CommandPair;
+        foreach (const CommandPair& cmd, commands)
+        {
+          QJsonObject jsonCommand;
+          jsonCommand.insert("command", static_cast<int>(cmd.first));
+          jsonCommand.insert("name", g_gameTextCommandName.value(cmd.first));
+          jsonCommand.insert("param", cmd.second);
+          jsonCommands.append(jsonCommand);
+          htmlCommands.append(QString("%1 (%2)").arg(g_gameTextCommandName.value(cmd.first).toHtmlEscaped(),
+                                                     QString::number(cmd.second)));
+        }
+
+        QJsonObject jsonResponse;
+        jsonResponse.insert("topic", DialogueExporter::topicName(topicIt.key()));
+        jsonResponse.insert("thingId", thingIt.key());
+        jsonResponse.insert("thing", thingIt.value());
+        jsonResponse.insert("table", tableName);
+        jsonResponse.insert("html", line);
+        jsonResponse.insert("commands", jsonCommands);
+        jsonResponses.append(jsonResponse);
+
+        // the multi-argument arg() substitutes every placeholder in one pass, so any "%1" that
+        // appears in the game text itself is left alone
+        const QString thing = thingIt.value().isEmpty() ? QString() :
+                              QString("%1 (%2)").arg(thingIt.value().toHtmlEscaped(), QString::number(thingIt.key()));
+        html += QString("<tr><td>%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td></tr>\n")
+                  .arg(DialogueExporter::topicName(topicIt.key()), thing, tableName, line, htmlCommands.join("<br>"));
+      }
+    }
+  }
+  html += "</table>\n";
+
+  QJsonObject jsonAlien;
+  jsonAlien.insert("id", alien.id);
+  jsonAlien.insert("name", alien.name);
+  jsonAlien.insert("race", s_raceNames.value(static_cast<AlienRace>(alien.raceId)));
+  jsonAlien.insert("responses", jsonResponses);
+
+  DialogueExportChunk chunk;
+  chunk.json = QJsonDocument(jsonAlien).toJson(QJsonDocument::Indented);
+  chunk.html = html.toUtf8();
+  queue->push(alien.index, chunk);
+}
+
+DialogueExporter::DialogueExporter(ConversationText& convText, QObject* parent) :
+  QObject(parent),
+  m_convText(&convText),
+  m_queue(DIALOGUE_EXPORT_WINDOW),
+  m_cancelled(0),
+  m_rendering(false),
+  m_writing(false),
+  m_success(false),
+  m_written(0)
+{
+  m_writerPool.setMaxThreadCount(1);
+  connect(&m_renderWatcher, &QFutureWatcher<void>::finished, this, &DialogueExporter::onRenderingFinished);
+}
+
+DialogueExporter::~DialogueExporter()
+{
+  cancel();
+  waitForFinished();
+}
+
+/**
+ * Starts exporting the dialogue of the provided aliens to the provided JSON and HTML files.
+ * The progress() signal is emitted as each alien is written, and finished() is emitted once
+ * both files have been completed or the export has been cancelled.
+ * @return True if the export was started; false if one is already running or there is
+ * nothing to export.
+ */
+bool DialogueExporter::start(const QList<DialogueExportAlien>& aliens, const DialogueExportTopics& topics,
+                             const QString& jsonPath, const QString& htmlPath)
+{
+  if (isRunning() || aliens.isEmpty())
+  {
+    return false;
+  }
+
+  m_aliens = aliens;
+  m_topics = topics;
+  m_jsonPath = jsonPath;
+  m_htmlPath = htmlPath;
+  m_written = 0;
+  m_success = false;
+  m_cancelled.storeRelease(0);
+  m_queue.reset();
+  m_raceTables.clear();
+  m_rendering = true;
+  m_writing = true;
+
+  QtConcurrent::run(&m_writerPool, this, &DialogueExporter::writeFiles);
+
+  DialogueRenderer renderer;
+  renderer.convText = m_convText;
+  renderer.raceTables = &m_raceTables;
+  renderer.topics = &m_topics;
+  renderer.queue = &m_queue;
+  renderer.cancelled = &m_cancelled;
+  m_renderWatcher.setFuture(QtConcurrent::map(m_aliens, renderer));
+
+  return true;
+}
+
+/**
+ * Stops the export. Aliens that are still being rendered are discarded, and the files are
+ * left incomplete.
+ */
+void DialogueExporter::cancel()
+{
+  if (isRunning())
+  {
+    m_cancelled.storeRelease(1);
+    m_renderWatcher.cancel();
+    m_queue.abort();
+  }
+}
+
+/**
+ * Blocks until all of the worker threads have stopped. The finished() signal is still
+ * delivered afterward through the event loop.
+ */
+void DialogueExporter::waitForFinished()
+{
+  m_renderWatcher.waitForFinished();
+  m_writerPool.waitForDone();
+}
+
+bool DialogueExporter::isRunning() const
+{
+  return m_rendering || m_writing;
+}
+
+QString DialogueExporter::topicName(ConvTopicCategory topic)
+{
+  QString name;
+
+  switch (topic)
+  {
+  case ConvTopicCategory_GreetingInitial:    name = "Greeting (first)";      break;
+  case ConvTopicCategory_GreetingSubsequent: name = "Greeting (subsequent)"; break;
+  case ConvTopicCategory_AskAboutPerson:     name = "Ask about person";      break;
+  case ConvTopicCategory_AskAboutLocation:   name = "Ask about place";       break;
+  case ConvTopicCategory_AskAboutObject:     name = "Ask about object";      break;
+  case ConvTopicCategory_AskAboutRace:       name = "Ask about race";        break;
+  case ConvTopicCategory_DisplayObject:      name = "Display object";        break;
+  case ConvTopicCategory_GiveObject:         name = "Give object";           break;
+  case ConvTopicCategory_GiveFact:           name = "Give fact";             break;
+  case ConvTopicCategory_SeesObject:         name = "Sees object";           break;
+  }
+
+  return name;
+}
+
+/**
+ * Writes the aliens from the queue to both files in order, until the queue is closed and
+ * empty, or aborted. This is run on the writer thread, and reports each alien back to the
+ * exporter's thread. The files are opened here so that the GUI thread never waits on disk.
+ */
+void DialogueExporter::writeFiles()
+{
+  bool status = false;
+  QFile jsonFile(m_jsonPath);
+  QFile htmlFile(m_htmlPath);
+
+  if (QDir().mkpath(QFileInfo(m_jsonPath).absolutePath()) &&
+      QDir().mkpath(QFileInfo(m_htmlPath).absolutePath()) &&
+      jsonFile.open(QIODevice::WriteOnly) &&
+      htmlFile.open(QIODevice::WriteOnly))
+  {
+    status = (jsonFile.write("[\n") >= 0);
+
+    QString toc;
+    foreach (const DialogueExportAlien& alien, m_aliens)
+    {
+      toc += QString("<li><a href=\"#alien%1\">%2</a></li>\n").arg(alien.id).arg(alien.name.toHtmlEscaped());
+    }
+    status = status &&
+             (htmlFile.write(QString("<!DOCTYPE html>\n<html>\n<head>\n<meta charset=\"utf-8\">\n"
+                                     "<title>Dialogue</title>\n<style>\n"
+                                     "table { border-collapse: collapse; }\n"
+                                     "td, th { border: 1px solid #999; padding: 2px 6px; vertical-align: top; text-align: left; }\n"
+                                     "</style>\n</head>\n<body>\n<h1>Dialogue</h1>\n<ul>\n%1</ul>\n").arg(toc).toUtf8()) >= 0);
+
+    DialogueExportChunk chunk;
+    int count = 0;
+    while (status && m_queue.pop(chunk))
+    {
+      status = (jsonFile.write(count > 0 ? ",\n" : "") >= 0) &&
+               (jsonFile.write(chunk.json) == chunk.json.size()) &&
+               (htmlFile.write(chunk.html) == chunk.html.size());
+      count++;
+      QMetaObject::invokeMethod(this, "onAlienWritten", Qt::QueuedConnection);
+    }
+
+    status = status &&
+             (count == m_aliens.count()) &&
+             (jsonFile.write("\n]\n") >= 0) &&
+             (htmlFile.write("</body>\n</html>\n") >= 0);
+  }
+
+  if (!status)
+  {
+    // release any renderers that are waiting for room in the queue
+    m_queue.abort();
+  }
+
+  QMetaObject::invokeMethod(this, "onWriterFinished", Qt::QueuedConnection, Q_ARG(bool, status));
+}
+
+/**
+ * Lets the writer finish once every alien has been rendered and queued.
+ */
+void DialogueExporter::onRenderingFinished()
+{
+  m_rendering = false;
+  m_queue.close();
+  checkFinished();
+}
+
+void DialogueExporter::onAlienWritten()
+{
+  m_written++;
+  emit progress(m_written, m_aliens.count());
+}
+
+void DialogueExporter::onWriterFinished(bool success)
+{
+  m_writing = false;
+  m_success = success;
+  checkFinished();
+}
+
+/**
+ * Announces the end of the export once both the rendering and the writer have finished.
+ * Either may finish first when the export is cancelled or a file cannot be written.
+ */
+void DialogueExporter::checkFinished()
+{
+  if (!m_rendering && !m_writing)
+  {
+    m_raceTables.clear();
+    emit finished(m_success, m_cancelled.loadAcquire() != 0);
+  }
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QList>
+#include <QMap>
+#include <QHash>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QThreadPool>
+#include <QFutureWatcher>
+#include "conversationtext.h"
+
+#define DIALOGUE_EXPORT_WINDOW 16
+
+/**
+ * Identifies a single alien whose dialogue is to be exported, and its position in the
+ * exported files.
+ */
+struct DialogueExportAlien
+{
+  int index;
+  int id;
+  int raceId;
+  QString name;
+};
+
+/**
+ * The thing IDs (and their names) for which each conversation topic category is exported,
+ * gathered from the data tables before the export starts.
+ */
+typedef QMap<ConvTopicCategory,QMap<int,QString> > DialogueExportTopics;
+
+/**
+ * The exported dialogue of a single alien, as a JSON object and as an HTML section.
+ */
+struct DialogueExportChunk
+{
+  QByteArray json;
+  QByteArray html;
+};
+
+/**
+ * Queue of exported aliens waiting to be written to disk, which hands them to the writer
+ * in their original order. Producers block while their alien is too far ahead of the
+ * next one to be written, so the amount of rendered text held in memory is bounded.
+ */
+class DialogueWriteQueue
+{
+public:
+  DialogueWriteQueue(int window);
+  void reset();
+  bool push(int index, const DialogueExportChunk& chunk);
+  bool pop(DialogueExportChunk& chunk);
+  void close();
+  void abort();
+
+private:
+  int m_window;
+  int m_next;
+  QMap<int,DialogueExportChunk> m_items;
+  bool m_closed;
+  bool m_aborted;
+  QMutex m_mutex;
+  QWaitCondition m_ready;
+  QWaitCondition m_space;
+};
+
+/**
+ * Contents of each race's conversation tables, shared by all of the renderers so that each
+ * race's tables are only read once per export.
+ */
+class DialogueRaceTables
+{
+public:
+  DialogueRaceTables();
+  void clear();
+  ConvTableData get(ConversationText* convText, int raceId);
+
+private:
+  QHash<int,ConvTableData> m_tables;
+  QMutex m_mutex;
+};
+
+/**
+ * Function object that is run on the worker threads to render the complete dialogue of a
+ * single alien and hand it to the write queue.
+ */
+struct DialogueRenderer
+{
+  ConversationText* convText;
+  DialogueRaceTables* raceTables;
+  const DialogueExportTopics* topics;
+  DialogueWriteQueue* queue;
+  QAtomicInt* cancelled;
+
+  void operator()(const DialogueExportAlien& alien) const;
+};
+
+/**
+ * Exports the response of every alien to every topic, with the race's generic responses
+ * filling in for topics that the alien has no response of its own to, as a JSON file and
+ * a browsable HTML file. Aliens are rendered in parallel on the global thread pool, while
+ * a dedicated thread streams them to both files in order.
+ */
+class DialogueExporter : public QObject
+{
+  Q_OBJECT
+
+public:
+  DialogueExporter(ConversationText& convText, QObject* parent = nullptr);
+  ~DialogueExporter();
+
+  bool start(const QList<DialogueExportAlien>& aliens, const DialogueExportTopics& topics,
+             const QString& jsonPath, const QString& htmlPath);
+  void cancel();
+  void waitForFinished();
+  bool isRunning() const;
+
+  static QString topicName(ConvTopicCategory topic);
+
+signals:
+  void progress(int completed, int total);
+  void finished(bool success, bool cancelled);
+
+private slots:
+  void onAlienWritten();
+  void onWriterFinished(bool success);
+  void onRenderingFinished();
+
+private:
+  ConversationText* m_convText;
+  QList<DialogueExportAlien> m_aliens;
+  DialogueExportTopics m_topics;
+  QString m_jsonPath;
+  QString m_htmlPath;
+  DialogueWriteQueue m_queue;
+  DialogueRaceTables m_raceTables;
+  QAtomicInt m_cancelled;
+  QThreadPool m_writerPool;
+  QFutureWatcher<void> m_renderWatcher;
+  bool m_rendering;
+  bool m_writing;
+  bool m_success;
+  int m_written;
+
+  void writeFiles();
+  void checkFinished();
+};
@@ -0,0 +1,306 @@
+#include <string.h>
+#include <limits.h>
+#include <QtGlobal>
+#include "dpcmdecoder.h"
+
+#define DPCM_SUBTABLE_COUNT 15
+
+/**
+ * Table of delta PCM subtables. Each subtable is one row of 16 values, where the first value is unused.
+ * These values are derived from an exponential transfer function.
+ */
+const int8_t DpcmDecoder::s_deltaTable[DPCM_SUBTABLE_COUNT * 16] =
+{
+  0, -7,    -6,    -5,    -4,    -3,    -2,    -1,    0, 1,    2,    3,    4,    5,    6,    7,
+  0, -0x0A, -8,    -6,    -5,    -3,    -2,    -1,    0, 1,    2,    3,    5,    6,    8,    0x0A,
+  0, -0x10, -0x0D, -0x0A, -8,    -6,    -4,    -2,    0, 2,    4,    6,    8,    0x0A, 0x0D, 0x10,
+  0, -0x17, -0x13, -0x0F, -0x0B, -8,    -5,    -2,    0, 2,    5,    8,    0x0B, 0x0F, 0x13, 0x17,
+  0, -0x1E, -0x18, -0x13, -0x0F, -0x0A, -7,    -3,    0, 3,    7,    0x0A, 0x0F, 0x13, 0x18, 0x1E,
+  0, -0x26, -0x1F, -0x18, -0x12, -0x0D, -8,    -4,    0, 4,    8,    0x0D, 0x12, 0x18, 0x1F, 0x26,
+  0, -0x2E, -0x25, -0x1D, -0x16, -0x10, -0x0A, -5,    0, 5,    0x0A, 0x10, 0x16, 0x1D, 0x25, 0x2E,
+  0, -0x36, -0x2C, -0x23, -0x1A, -0x13, -0x0C, -6,    0, 6,    0x0C, 0x13, 0x1A, 0x23, 0x2C, 0x36,
+  0, -0x3F, -0x33, -0x28, -0x1F, -0x16, -0x0E, -7,    0, 7,    0x0E, 0x16, 0x1F, 0x28, 0x33, 0x3F,
+  0, -0x49, -0x3B, -0x2F, -0x23, -0x19, -0x10, -8,    0, 7,    0x10, 0x19, 0x23, 0x2E, 0x3A, 0x48,
+  0, -0x53, -0x43, -0x35, -0x28, -0x1D, -0x12, -9,    0, 9,    0x12, 0x1C, 0x28, 0x35, 0x43, 0x52,
+  0, -0x5D, -0x4B, -0x3C, -0x2D, -0x20, -0x14, -0x0A, 0, 0x0A, 0x14, 0x20, 0x2D, 0x3B, 0x4B, 0x5C,
+  0, -0x68, -0x54, -0x43, -0x33, -0x24, -0x17, -0x0B, 0, 0x0B, 0x17, 0x24, 0x32, 0x42, 0x54, 0x67,
+  0, -0x74, -0x5E, -0x4A, -0x38, -0x28, -0x19, -0x0C, 0, 0x0C, 0x19, 0x28, 0x38, 0x4A, 0x5D, 0x73,
+  0, -0x80, -0x68, -0x52, -0x3E, -0x2C, -0x1C, -0x0D, 0, 0x0D, 0x1C, 0x2C, 0x3E, 0x51, 0x67, 0x7F
+};
+
+namespace
+{
+  /**
+   * For each subtable and each encoded byte whose nibbles are both nonzero (and therefore
+   * both plain samples), holds the offset from the previous output value to the first output
+   * sample in the low byte, and the offset to the second output sample in the high byte.
+   */
+  struct DpcmPairTable
+  {
+    uint16_t offsets[DPCM_SUBTABLE_COUNT][256];
+
+    explicit DpcmPairTable(const int8_t* deltaTable)
+    {
+      memset(offsets, 0, sizeof(offsets));
+      for (int subtable = 0; subtable < DPCM_SUBTABLE_COUNT; subtable++)
+      {
+        for (int byte = 0; byte < 256; byte++)
+        {
+          const uint8_t first = static_cast<uint8_t>(deltaTable[(subtable * 16) + (byte >> 4)]);
+          const uint8_t second = static_cast<uint8_t>(first + deltaTable[(subtable * 16) + (byte & 0x0F)]);
+          offsets[subtable][byte] = static_cast<uint16_t>(first | (second << 8));
+        }
+      }
+    }
+  };
+
+  /**
+   * Returns true if neither nibble in the provided pair is zero, so that both are plain samples.
+   */
+  inline bool isSamplePair(uint8_t nibblePair)
+  {
+    return ((nibblePair & 0xF0) != 0) && ((nibblePair & 0x0F) != 0);
+  }
+
+  /**
+   * Writes the two samples described by an entry from the byte pair table, and updates
+   * the last output value.
+   */
+  inline void writeSamplePair(uint16_t offsets, uint8_t& lastValue, uint8_t* output)
+  {
+    output[0] = static_cast<uint8_t>(lastValue + (offsets & 0xFF));
+    lastValue = static_cast<uint8_t>(lastValue + (offsets >> 8));
+    output[1] = lastValue;
+  }
+}
+
+/**
+ * Prepares to decode the provided DPCM data incrementally. The data is not copied,
+ * so it must remain valid for as long as the decoder is in use.
+ */
+DpcmDecoder::DpcmDecoder(const uint8_t* encoded, int length) :
+  m_encoded(encoded),
+  m_length(length)
+{
+  reset();
+}
+
+/**
+ * Returns the decoder to the start of its encoded data.
+ */
+void DpcmDecoder::reset()
+{
+  m_inpos = 0;
+  m_upperNibble = true;
+  m_state = State::Sample;
+  m_subtable = 0;
+  m_repeatCount = 0;
+  m_repeatRemaining = 0;
+  m_lastValue = 0x80;
+}
+
+/**
+ * Decodes up to the requested number of samples, continuing from where the previous
+ * call stopped.
+ * @return The number of samples written, which is only less than the requested
+ * number when the end of the encoded data is reached.
+ */
+int DpcmDecoder::decodeChunk(uint8_t* decoded, int maxSamples)
+{
+  return run<true>(decoded, maxSamples);
+}
+
+/**
+ * Returns true once all of the encoded data has been decoded.
+ */
+bool DpcmDecoder::atEnd() const
+{
+  return (m_inpos >= m_length) && (m_repeatRemaining == 0);
+}
+
+/**
+ * Returns the number of 8-bit PCM samples that will be produced by decoding the
+ * provided DPCM data.
+ */
+int DpcmDecoder::decodedLength(const uint8_t* encoded, int length)
+{
+  DpcmDecoder decoder(encoded, length);
+  return decoder.run<false>(nullptr, INT_MAX);
+}
+
+/**
+ * Decodes the provided DPCM data into 8-bit unsigned PCM. The output buffer must have
+ * room for the number of samples reported by decodedLength().
+ * @return The number of samples written.
+ */
+int DpcmDecoder::decode(const uint8_t* encoded, int length, uint8_t* decoded)
+{
+  DpcmDecoder decoder(encoded, length);
+  return decoder.run<true>(decoded, INT_MAX);
+}
+
+/**
+ * Runs the DPCM nibble state machine over the encoded data, producing at most the
+ * requested number of samples. A zero nibble introduces a command: the following
+ * nibble either selects a new delta subtable or, if it is 0xF, starts a repeat of
+ * the last output value with an 8-bit count in the next two nibbles (where zero
+ * means 0x100). Any other nibble is a delta from the last output value.
+ *
+ * Outside of a command, the next two nibbles (whether or not they are in the same byte) are
+ * handled together while neither is zero, producing both samples with a single lookup in
+ * the byte pair table. When WriteOutput is false, only the number of samples is counted.
+ */
+template<bool WriteOutput>
+int DpcmDecoder::run(uint8_t* decoded, int maxSamples)
+{
+  static const DpcmPairTable pairTable(s_deltaTable);
+
+  const uint8_t* const encoded = m_encoded;
+  const int length = m_length;
+  State state = m_state;
+  bool upperNibble = m_upperNibble;
+  int inpos = m_inpos;
+  int outpos = 0;
+  uint8_t lastValue = m_lastValue;
+
+  // finish any repeat that did not fit in the output on the previous call
+  if (m_repeatRemaining > 0)
+  {
+    const int repeatLength = qMin(m_repeatRemaining, maxSamples);
+    if (WriteOutput)
+    {
+      memset(decoded, lastValue, repeatLength);
+    }
+    outpos += repeatLength;
+    m_repeatRemaining -= repeatLength;
+  }
+
+  const uint16_t* currentPairs = pairTable.offsets[m_subtable];
+  const int8_t* currentDeltas = s_deltaTable + (0x10 * m_subtable);
+
+  while ((inpos < length) && (outpos < maxSamples))
+  {
+    if (state == State::Sample)
+    {
+      // Consume pairs of sample nibbles for as long as neither is a command. When the
+      // decoder is midway through a byte, each pair straddles two consecutive bytes.
+      const int pairLimit = maxSamples - 1;
+      if (upperNibble)
+      {
+        while ((inpos < length) && (outpos < pairLimit) && isSamplePair(encoded[inpos]))
+        {
+          if (WriteOutput)
+          {
+            writeSamplePair(currentPairs[encoded[inpos]], lastValue, decoded + outpos);
+          }
+          outpos += 2;
+          inpos++;
+        }
+      }
+      else
+      {
+        while ((inpos < (length - 1)) && (outpos < pairLimit))
+        {
+          const uint8_t nibblePair = static_cast<uint8_t>((encoded[inpos] << 4) | (encoded[inpos + 1] >> 4));
+          if (!isSamplePair(nibblePair))
+          {
+            break;
+          }
+
+          if (WriteOutput)
+          {
+            writeSamplePair(currentPairs[nibblePair], lastValue, decoded + outpos);
+          }
+          outpos += 2;
+          inpos++;
+        }
+      }
+
+      if ((inpos >= length) || (outpos >= maxSamples))
+      {
+        break;
+      }
+    }
+
+    const uint8_t encodedByte = encoded[inpos];
+    uint8_t nibble;
+    if (upperNibble)
+    {
+      nibble = encodedByte >> 4;
+      upperNibble = false;
+    }
+    else
+    {
+      nibble = encodedByte & 0x0F;
+      upperNibble = true;
+      inpos++;
+    }
+
+    switch (state)
+    {
+    case State::Sample:
+      if (nibble == 0)
+      {
+        state = State::Command;
+      }
+      else
+      {
+        if (WriteOutput)
+        {
+          lastValue = static_cast<uint8_t>(lastValue + currentDeltas[nibble]);
+          decoded[outpos] = lastValue;
+        }
+        outpos++;
+      }
+      break;
+
+    case State::Command:
+      if (nibble < 0xF)
+      {
+        // this nibble selects the delta subtable used for the samples that follow
+        m_subtable = nibble;
+        currentPairs = pairTable.offsets[nibble];
+        currentDeltas = s_deltaTable + (0x10 * nibble);
+        state = State::Sample;
+      }
+      else
+      {
+        state = State::RepeatCountHigh;
+      }
+      break;
+
+    case State::RepeatCountHigh:
+      m_repeatCount = (nibble << 4);
+      state = State::RepeatCountLow;
+      break;
+
+    case State::RepeatCountLow:
+      m_repeatCount |= nibble;
+
+      // the repeat count value of 0 is reserved to indicate 0x100
+      if (m_repeatCount == 0)
+      {
+        m_repeatCount = 0x100;
+      }
+
+      {
+        const int repeatLength = qMin(m_repeatCount, maxSamples - outpos);
+        if (WriteOutput)
+        {
+          memset(decoded + outpos, lastValue, repeatLength);
+        }
+        outpos += repeatLength;
+        m_repeatRemaining = m_repeatCount - repeatLength;
+      }
+      state = State::Sample;
+      break;
+    }
+  }
+
+  m_state = state;
+  m_upperNibble = upperNibble;
+  m_inpos = inpos;
+  m_lastValue = lastValue;
+
+  return outpos;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * Decodes the 4-bit DPCM format used for the game's sound effects and speech
+ * into 8-bit unsigned PCM. A whole sound can be decoded in two passes: the first
+ * finds the exact length of the output, so that the second can write into a
+ * buffer of that size without any reallocation. Alternatively, an instance of
+ * this class decodes a sound incrementally, in chunks of any size.
+ */
+class DpcmDecoder
+{
+public:
+  DpcmDecoder(const uint8_t* encoded = nullptr, int length = 0);
+  void reset();
+  int decodeChunk(uint8_t* decoded, int maxSamples);
+  bool atEnd() const;
+
+  static int decodedLength(const uint8_t* encoded, int length);
+  static int decode(const uint8_t* encoded, int length, uint8_t* decoded);
+
+private:
+  //! States of the nibble decoder between the normal delta samples and the command sequences
+  enum class State
+  {
+    Sample,
+    Command,
+    RepeatCountHigh,
+    RepeatCountLow
+  };
+
+  static const int8_t s_deltaTable[];
+
+  const uint8_t* m_encoded;
+  int m_length;
+  int m_inpos;
+  bool m_upperNibble;
+  State m_state;
+  int m_subtable;
+  int m_repeatCount;
+  int m_repeatRemaining;
+  uint8_t m_lastValue;
+
+  template<bool WriteOutput>
+  int run(uint8_t* decoded, int maxSamples);
+};
+
@@ -0,0 +1,130 @@
+#include <limits.h>
+#include "dpcmstreamdevice.h"
+
+DpcmStreamDevice::DpcmStreamDevice(QObject* parent) :
+  QIODevice(parent),
+  m_encoded(nullptr),
+  m_encodedLength(0),
+  m_size(0),
+  m_decodedCount(0)
+{
+
+}
+
+/**
+ * Selects the sound that will be decoded by this device. The device keeps a copy of the
+ * container (which shares its data with the original), so the encoded data remains valid
+ * for as long as the device does. Any open stream is closed.
+ * @return True if the sound ID exists in the container; false otherwise.
+ */
+bool DpcmStreamDevice::setSound(const NnvContainer& container, int soundId)
+{
+  if (isOpen())
+  {
+    close();
+  }
+
+  m_container = container;
+  m_encoded = nullptr;
+  m_encodedLength = 0;
+
+  const bool status = m_container.soundData(soundId, m_encoded, m_encodedLength);
+  if (!status)
+  {
+    m_container = NnvContainer();
+    m_encoded = nullptr;
+    m_encodedLength = 0;
+  }
+
+  m_decoder = DpcmDecoder(m_encoded, m_encodedLength);
+  m_size = -1;
+  m_decodedCount = 0;
+
+  return status;
+}
+
+/**
+ * Opens the device for reading from the start of the sound. Only read-only access
+ * is supported.
+ */
+bool DpcmStreamDevice::open(OpenMode mode)
+{
+  bool status = false;
+
+  if (!(mode & QIODevice::WriteOnly))
+  {
+    m_decoder.reset();
+    m_decodedCount = 0;
+    status = QIODevice::open(mode | QIODevice::Unbuffered);
+  }
+
+  return status;
+}
+
+/**
+ * The decoder can only move forward through the data, so the device is sequential.
+ */
+bool DpcmStreamDevice::isSequential() const
+{
+  return true;
+}
+
+/**
+ * Returns the total size of the decoded sound in bytes. This is found with a counting
+ * pass over the encoded data the first time it is requested.
+ */
+qint64 DpcmStreamDevice::size() const
+{
+  if (m_size < 0)
+  {
+    m_size = DpcmDecoder::decodedLength(m_encoded, m_encodedLength);
+  }
+
+  return m_size;
+}
+
+/**
+ * Returns the number of decoded bytes that have not yet been read.
+ */
+qint64 DpcmStreamDevice::bytesAvailable() const
+{
+  return (size() - m_decodedCount) + QIODevice::bytesAvailable();
+}
+
+/**
+ * Returns true once the entire sound has been decoded and read.
+ */
+bool DpcmStreamDevice::atEnd() const
+{
+  return !isOpen() || m_decoder.atEnd();
+}
+
+/**
+ * Decodes as many bytes as requested (or as remain in the sound) directly into the
+ * caller's buffer.
+ * @return The number of bytes decoded, or -1 once the end of the sound has been reached.
+ */
+qint64 DpcmStreamDevice::readData(char* data, qint64 maxSize)
+{
+  if (m_decoder.atEnd())
+  {
+    return (maxSize > 0) ? -1 : 0;
+  }
+
+  const int request = static_cast<int>(qMin(maxSize, static_cast<qint64>(INT_MAX)));
+  const int decoded = m_decoder.decodeChunk(reinterpret_cast<uint8_t*>(data), request);
+  m_decodedCount += decoded;
+
+  return decoded;
+}
+
+/**
+ * Writing is not supported.
+ */
+qint64 DpcmStreamDevice::writeData(const char* data, qint64 maxSize)
+{
+  Q_UNUSED(data)
+  Q_UNUSED(maxSize)
+  return -1;
+}
+
@@ -0,0 +1,37 @@
+#pragma once
+#include <QIODevice>
+#include "nnvcontainer.h"
+#include "dpcmdecoder.h"
+
+/**
+ * Read-only device that decodes a single DPCM sound from an NNV container as its
+ * data is read, so that playback or export can begin without first decoding the
+ * entire sound into memory. The output is 8-bit unsigned PCM.
+ */
+class DpcmStreamDevice : public QIODevice
+{
+  Q_OBJECT
+
+public:
+  explicit DpcmStreamDevice(QObject* parent = nullptr);
+  bool setSound(const NnvContainer& container, int soundId);
+
+  bool open(OpenMode mode) override;
+  bool isSequential() const override;
+  qint64 size() const override;
+  qint64 bytesAvailable() const override;
+  bool atEnd() const override;
+
+protected:
+  qint64 readData(char* data, qint64 maxSize) override;
+  qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+  NnvContainer m_container;
+  DpcmDecoder m_decoder;
+  const uint8_t* m_encoded;
+  int m_encodedLength;
+  mutable qint64 m_size;
+  qint64 m_decodedCount;
+};
+
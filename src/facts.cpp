@@ -17,7 +17,7 @@ void Facts::clear()
  * Gets a container of data structures that each holds information about one of the
  * learnable facts from the game universe.
  */
-QMap<int,Fact> Facts::getList()
+const DenseIdTable<Fact>& Facts::getList()
 {
   if (m_factList.isEmpty())
   {
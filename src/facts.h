@@ -3,6 +3,7 @@
 #include <QMap>
 #include "enums.h"
 #include "dattable.h"
+#include "denseidtable.h"
 #include "datlibrary.h"
 
 struct Fact
@@ -22,11 +23,26 @@ typedef struct __attribute__((packed)) FactTableEntry
 
 static_assert(sizeof(FactTableEntry) == 16, "FactTableEntry packing does not match game data");
 
+constexpr FieldDescriptor s_factTableFields[] =
+{
+  TABLE_GAMETEXT_FIELD(FactTableEntry, textOffset),
+  TABLE_FIELD(FactTableEntry, receptivity),
+  TABLE_FIELD(FactTableEntry, bitfield),
+  TABLE_UNKNOWN_FIELD(FactTableEntry, unused)
+};
+
+template <>
+struct TableSchema<FactTableEntry>
+{
+  static constexpr const FieldDescriptor* fields() { return s_factTableFields; }
+  static constexpr int fieldCount() { return sizeof(s_factTableFields) / sizeof(FieldDescriptor); }
+};
+
 class Facts : public DatTable<FactTableEntry>
 {
 public:
   Facts(DatLibrary& lib);
-  QMap<int,Fact> getList();
+  const DenseIdTable<Fact>& getList();
   Fact getFact(int id) const;
   QMap<AlienRace,int> getReceptivity(int id);
   void clear();
@@ -35,6 +51,6 @@ protected:
   bool populateList();
 
 private:
-  QMap<int,Fact> m_factList;
+  DenseIdTable<Fact> m_factList;
 };
 
@@ -81,39 +81,73 @@ bool FullscreenImages::getImage(DatFileType dat, QString lbmFilename, QImage& im
 }
 
 /**
- * Gets the palette data for the specified LBM image. This function assumes that the palette
- * required for the image is stored in the same DAT archive. It first attempts to use the
- * same base filename as the LBM and appending the ".pal" extension; if this fails, it will
- * then attempt to look up the palette filename for the LBM in this class's static dictionary.
- * @return Palette filename is a valid palette is found; otherwise an empty string
+ * Determines the palette filename for every LBM image in the game's DAT containers. This
+ * function assumes that the palette required for each image is stored in the same DAT archive.
+ * A palette with the same base filename as the LBM and a ".pal" extension is used if one
+ * exists; otherwise, the palette filename is looked up in this class's static dictionary.
+ * Only the DAT indices are searched, so no palette data is read here. This must be called
+ * after the data files are opened and before any palette is requested with getPalette().
  */
-QString FullscreenImages::getPalette(DatFileType dat, QString lbmFilename, QVector<QRgb>& palData) const
+void FullscreenImages::resolvePaletteNames()
 {
-  QString palFilename;
-
-  // position in string of the filename's extension (including the dot)
-  const int lbmExtPos = lbmFilename.length() - 4;
+  m_lbmPalettes.clear();
 
-  // if the provided filename ends with ".LBM" (or ".lbm") as expected,
-  // then first try to use a palette with the same filename base but with a .pal extension
-  if ((lbmFilename.length() >= 5) && // minimum length of an 8.3 filename
-      (lbmFilename.mid(lbmExtPos, 4).toLower() == s_lbmExtension))
+  for (int datIdx = 0; datIdx < static_cast<int>(DatFileType::NumFiles); datIdx++)
   {
-    QString testFilename = lbmFilename;
-    testFilename.replace(lbmExtPos, 4, s_palExtension);
-    if (m_pal->paletteByName(dat, testFilename, palData))
+    const DatFileType datType = static_cast<DatFileType>(datIdx);
+    const QStringList palsInDat = m_lib->getFilenamesByExtension(datType, s_palExtension);
+    const QStringList lbmsInDat = m_lib->getFilenamesByExtension(datType, s_lbmExtension);
+
+    foreach (QString lbmFilename, lbmsInDat)
     {
-      palFilename = testFilename;
+      // position in string of the filename's extension (including the dot)
+      const int lbmExtPos = lbmFilename.length() - 4;
+      QString palFilename;
+
+      if ((lbmFilename.length() >= 5) && // minimum length of an 8.3 filename
+          (lbmFilename.mid(lbmExtPos, 4).toLower() == s_lbmExtension))
+      {
+        QString testFilename = lbmFilename;
+        testFilename.replace(lbmExtPos, 4, s_palExtension);
+        if (palsInDat.contains(testFilename))
+        {
+          palFilename = testFilename;
+        }
+      }
+
+      if (palFilename.isEmpty() && s_lbmToPal.contains(lbmFilename) && palsInDat.contains(s_lbmToPal[lbmFilename]))
+      {
+        palFilename = s_lbmToPal[lbmFilename];
+      }
+
+      if (!palFilename.isEmpty())
+      {
+        m_lbmPalettes.insert(qMakePair(datIdx, lbmFilename), palFilename);
+      }
     }
   }
+}
 
-  // otherwise, fall back to the the dictionary of LBM/PAL pairings
-  if (palFilename.isEmpty() && s_lbmToPal.contains(lbmFilename))
+/**
+ * Clears the LBM-to-palette associations for the closed data files.
+ */
+void FullscreenImages::clear()
+{
+  m_lbmPalettes.clear();
+}
+
+/**
+ * Gets the palette data for the specified LBM image, using the palette filename that
+ * was determined by resolvePaletteNames().
+ * @return Palette filename is a valid palette is found; otherwise an empty string
+ */
+QString FullscreenImages::getPalette(DatFileType dat, QString lbmFilename, QVector<QRgb>& palData) const
+{
+  QString palFilename = m_lbmPalettes.value(qMakePair(static_cast<int>(dat), lbmFilename));
+
+  if (!palFilename.isEmpty() && !m_pal->paletteByName(dat, palFilename, palData))
   {
-    if (m_pal->paletteByName(dat, s_lbmToPal[lbmFilename], palData))
-    {
-      palFilename = s_lbmToPal[lbmFilename];
-    }
+    palFilename.clear();
   }
 
   return palFilename;
@@ -5,6 +5,8 @@
 #include <QStringList>
 #include <QString>
 #include <QImage>
+#include <QHash>
+#include <QPair>
 #include "datlibrary.h"
 #include "palette.h"
 
@@ -15,6 +17,8 @@ public:
   QMap<DatFileType, QStringList> getAllLbmList();
   bool getImage(DatFileType dat, QString lbmFilename, QImage& img);
   QString getPalette(DatFileType dat, QString lbmFilename, QVector<QRgb>& palData) const;
+  void resolvePaletteNames();
+  void clear();
 
 private:
   DatLibrary* m_lib;
@@ -22,6 +26,7 @@ private:
   static const QMap<QString,QString> s_lbmToPal;
   static const QString s_lbmExtension;
   static const QString s_palExtension;
+  QHash<QPair<int,QString>,QString> m_lbmPalettes;
 };
 
 #endif // FULLSCREENIMAGES_H
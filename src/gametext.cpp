@@ -1,6 +1,8 @@
 #include "gametext.h"
 #include <QString>
 #include <QUrl>
+#include <QReadLocker>
+#include <QWriteLocker>
 
 #define EMBEDDED_CMD_REFERENCE_STR "<font color=\"#da412a\">[%1]</font>"
 #define LINK_STYLE "style=\"color:#eaa92a;\""
@@ -15,16 +17,32 @@ GameText::GameText(DatLibrary& lib) :
 }
 
 /**
- * Returns a string that may be substituted for a metatext command. The metatext commands
- * are one of three types:
+ * Discards the metatext tables and all of the parsed strings, so that they will be
+ * read again from the data files when they are next needed.
+ */
+void GameText::clear()
+{
+  QWriteLocker locker(&m_lock);
+  m_metaTab.clear();
+  m_metaTextTab.clear();
+  m_arena.clear();
+  m_parsedStrings.clear();
+  m_metaHtml.clear();
+  m_metaPlain.clear();
+}
+
+/**
+ * Finds the text that may be substituted for a metatext command, and caches both its
+ * HTML and plain text forms. The caller must hold the write lock. The metatext commands are one of three types:
  * - Conversational synonym. Used to add variety to the alien dialog.
  * - Translated phrases. Used to (partially) translate the Shaasa alien language.
  * - Losten gateway code. Used to create (or recall) one of the randomly generated codes
  *   for the Losten planetary gateway.
  */
-QString GameText::getMetaString(int metaTabIndex)
+void GameText::resolveMetaText(int metaTabIndex)
 {
-  QString metaStr;
+  QString metaHtml;
+  QString metaPlain;
   bool status = true;
 
   if (m_metaTab.isEmpty())
@@ -37,10 +55,10 @@ QString GameText::getMetaString(int metaTabIndex)
     status = m_lib->getFileByName(DatFileType::CONVERSE, "METATXT.TAB", m_metaTextTab);
   }
 
-  if (status)
+  const int metaTabOffset = metaTabIndex * METATAB_RECORDSIZE_BYTES;
+  if (status && (metaTabOffset >= 0) && ((metaTabOffset + METATAB_RECORDSIZE_BYTES) <= m_metaTab.size()))
   {
     const uint8_t* metaData = reinterpret_cast<const uint8_t*>(m_metaTab.data());
-    const int metaTabOffset   = metaTabIndex * METATAB_RECORDSIZE_BYTES;
     const int numberOfOptions = metaData[metaTabOffset + 0];
     const int type            = metaData[metaTabOffset + 1];
     const int metaTextIndex   = metaData[metaTabOffset + 2] + (0x100 * metaData[metaTabOffset + 3]);
@@ -54,142 +72,419 @@ QString GameText::getMetaString(int metaTabIndex)
       for (int optionIndex = 0; optionIndex < numberOfOptions; optionIndex++)
       {
         const int metaTextOffset = (metaTextIndex + optionIndex) * METATEXT_RECORDSIZE_BYTES;
-        const int gametextOffset = metaTextData[metaTextOffset] + (0x100 * metaTextData[metaTextOffset + 1]);
-        synonyms.append(m_lib->getGameText(gametextOffset));
+        if ((metaTextOffset + METATEXT_RECORDSIZE_BYTES) <= m_metaTextTab.size())
+        {
+          const int gametextOffset = metaTextData[metaTextOffset] + (0x100 * metaTextData[metaTextOffset + 1]);
+          synonyms.append(m_lib->getGameText(gametextOffset));
+        }
       }
 
       if (synonyms.size() > 0)
       {
         // build a URL for the anchor that is just a pipe-separated list of the synonyms
-        metaStr = QString("<a %1 href=\"").arg(LINK_STYLE);
+        metaHtml = QString("<a %1 href=\"").arg(LINK_STYLE);
         foreach (QString synonym, synonyms)
         {
-          metaStr += synonym + "|";
+          metaHtml += synonym + "|";
         }
-        metaStr += "\">" + synonyms[0] + "</a>";
+        metaHtml += "\">" + synonyms[0] + "</a>";
+        metaPlain = synonyms[0];
       }
     }
     else if (type == METATAB_TYPE_LOSTENGATEWAY)
     {
-      metaStr = QString("<Losten gateway code #%1>").arg(metaTextIndex + 1).toHtmlEscaped();
+      metaPlain = QString("<Losten gateway code #%1>").arg(metaTextIndex + 1);
+      metaHtml = metaPlain.toHtmlEscaped();
     }
   }
 
-  return metaStr;
+  m_metaHtml.insert(metaTabIndex, metaHtml);
+  m_metaPlain.insert(metaTabIndex, metaPlain);
 }
 
 /**
- * Walks through the provided ASCII character string one byte at a time, consuming the special command
- * bytes and their parameters, and producing the text that gets generated in their place (if any).
+ * Returns the number of parameter bytes that follow the provided command byte, without
+ * counting any that would lie at or past maxlen. The GrantKnowledgePlace command uses a
+ * second byte when bit 7 of the first is set.
  */
-QString GameText::readString(const char* data, QVector<QPair<GTxtCmd,int> >& commands, bool showEmbeddedCommands, int maxlen)
+int GameText::commandParamLength(const char* data, int pos, int maxlen, GTxtCmd cmd)
+{
+  int length = g_gameTextParamCount.value(cmd, 0);
+
+  if ((cmd == GTxtCmd_GrantKnowledgePlace) && (pos < maxlen) && (static_cast<uint8_t>(data[pos]) & 0x80))
+  {
+    length++;
+  }
+
+  return qMax(0, qMin(length, maxlen - pos));
+}
+
+/**
+ * Returns the number of bytes in the provided string data, including the parameters of
+ * any embedded commands (which may contain zero bytes) but not the terminator.
+ */
+int GameText::encodedLength(const char* data, int maxlen)
 {
-  QString clean;
   int pos = 0;
-  commands.clear();
 
-  while ((data[pos] != 0) && (pos < maxlen))
+  while ((pos < maxlen) && (data[pos] != 0))
   {
-    // all normally printable characters are passed through to the output directly
     if (data[pos] >= 0x20)
     {
-      clean += QString(data[pos]).toHtmlEscaped();
       pos++;
     }
     else
     {
       const GTxtCmd cmd = static_cast<GTxtCmd>(data[pos]);
       pos++;
+      pos += commandParamLength(data, pos, maxlen, cmd);
+    }
+  }
 
-      if (cmd == GTxtCmd_InsertPlayerName)
-      {
-        clean.append(QString("<Player's name>").toHtmlEscaped());
-      }
-      else if (cmd == GTxtCmd_InsertPlayerShip)
-      {
-        clean.append(QString("<Player's ship>").toHtmlEscaped());
-      }
-      else if (cmd == GTxtCmd_GAMESTR)
+  return pos;
+}
+
+/**
+ * Returns the parsed form of the provided string data. Strings are identified by their
+ * content, so each distinct string is only parsed once regardless of where it was read.
+ * A new string is parsed into a scratch arena without holding the lock, and only copied
+ * into the shared arena under the write lock, so threads parsing different strings do
+ * not wait on one another.
+ */
+GameTextString GameText::parseCached(const char* data, int maxlen)
+{
+  const int length = encodedLength(data, maxlen);
+  const QByteArray key = QByteArray::fromRawData(data, length);
+
+  {
+    QReadLocker locker(&m_lock);
+    QHash<QByteArray,GameTextString>::const_iterator it = m_parsedStrings.constFind(key);
+    if (it != m_parsedStrings.constEnd())
+    {
+      return it.value();
+    }
+  }
+
+  GameTextArena scratch;
+  const GameTextString parsed = parse(scratch, data, length);
+
+  QWriteLocker locker(&m_lock);
+  QHash<QByteArray,GameTextString>::const_iterator it = m_parsedStrings.constFind(key);
+  if (it == m_parsedStrings.constEnd())
+  {
+    it = m_parsedStrings.insert(QByteArray(data, length), m_arena.copyString(scratch, parsed));
+  }
+
+  return it.value();
+}
+
+/**
+ * Resolves any metatext referenced by the provided string that has not yet been resolved.
+ * Each metatext record is only resolved once, so the write lock is rarely needed.
+ */
+void GameText::resolveMetaTextOf(const GameTextString& str)
+{
+  if (str.metaTextCount == 0)
+  {
+    return;
+  }
+
+  QVector<int> unresolved;
+  {
+    QReadLocker locker(&m_lock);
+    const GameTextToken* tokens = m_arena.tokens(str);
+    for (int i = 0; i < str.tokenCount; i++)
+    {
+      if ((tokens[i].type == GameTextTokenType::MetaText) && !m_metaHtml.contains(tokens[i].param))
       {
-        clean.append(QString("<GAMESTR>").toHtmlEscaped());
+        unresolved.append(tokens[i].param);
       }
-      else if (cmd == GTxtCmd_METAMOVE)
+    }
+  }
+
+  if (!unresolved.isEmpty())
+  {
+    QWriteLocker locker(&m_lock);
+    foreach (int metaTabIndex, unresolved)
+    {
+      if (!m_metaHtml.contains(metaTabIndex))
       {
-        clean.append(QString("<METAMOVE>").toHtmlEscaped());
+        resolveMetaText(metaTabIndex);
       }
-      else if (cmd == GTxtCmd_MetaText)
+    }
+  }
+}
+
+/**
+ * Walks through the provided ASCII character string, consuming the special command bytes and
+ * their parameters, and adds the resulting token stream to the provided arena. Printable characters are
+ * gathered into spans, substitutions are added as text, and metatext references and commands
+ * that modify game state are kept as tokens to be resolved when the string is rendered.
+ */
+GameTextString GameText::parse(GameTextArena& arena, const char* data, int length)
+{
+  int pos = 0;
+  int spanStart = 0;
+
+  arena.beginString();
+
+  while (pos < length)
+  {
+    // all normally printable characters are passed through to the output directly
+    if (data[pos] >= 0x20)
+    {
+      pos++;
+      continue;
+    }
+
+    if (pos > spanStart)
+    {
+      arena.appendText(data + spanStart, pos - spanStart);
+    }
+
+    const GTxtCmd cmd = static_cast<GTxtCmd>(data[pos]);
+    pos++;
+
+    // a command whose parameters are cut off by the end of the string is dropped
+    const int paramLength = commandParamLength(data, pos, length, cmd);
+    if (paramLength < g_gameTextParamCount.value(cmd, 0))
+    {
+      spanStart = length;
+      break;
+    }
+
+    if (cmd == GTxtCmd_InsertPlayerName)
+    {
+      arena.appendText(QString("<Player's name>"));
+    }
+    else if (cmd == GTxtCmd_InsertPlayerShip)
+    {
+      arena.appendText(QString("<Player's ship>"));
+    }
+    else if (cmd == GTxtCmd_GAMESTR)
+    {
+      arena.appendText(QString("<GAMESTR>"));
+    }
+    else if (cmd == GTxtCmd_METAMOVE)
+    {
+      arena.appendText(QString("<METAMOVE>"));
+    }
+    else if (cmd == GTxtCmd_MetaText)
+    {
+      const uint16_t metaTabIdx = (static_cast<uint8_t>(data[pos]) + (0x100 * static_cast<uint8_t>(data[pos+1]))) - 1;
+      arena.appendMetaText(metaTabIdx);
+    }
+    else if (cmd == GTxtCmd_InsertCurrentLocation)
+    {
+      arena.appendText(QString("<current location>"));
+    }
+    else if ((cmd == GTxtCmd_AddItem) ||
+             ((cmd >= GTxtCmd_ChangeAlienTemperament) && (cmd <= GTxtCmd_ModifyMissionTable)))
+    {
+      // the command is one of several that modify game state, so let's capture it along
+      // with its parameters to pass back to the caller in a list
+      int param = 0;
+
+      // the GrantKnowledgePlace command is special because it can use either one or two
+      // parameter bytes, determined during parsing by the content of the first byte
+      if (cmd == GTxtCmd_GrantKnowledgePlace)
       {
-        uint16_t metaTabIdx = (static_cast<uint8_t>(data[pos]) + (0x100 * static_cast<uint8_t>(data[pos+1]))) - 1;
-        const QString metaStr = getMetaString(metaTabIdx);
-        clean.append(metaStr);
+        param = data[pos];
+
+        // if bit 7 is set in the first parameter byte to GrantKnowledgePlace, we need
+        // to combine it with the following byte to form a 16-bit place ID
+        if ((param & 0x80) && ((pos + 1) < length))
+        {
+          param &= 0x7F;
+          param |= (static_cast<uint16_t>(data[pos + 1]) << 7);
+        }
       }
-      else if (cmd == GTxtCmd_InsertCurrentLocation)
+      else if (g_gameTextParamCount.value(cmd) == 1)
       {
-        clean.append(QString("<current location>").toHtmlEscaped());
+        param = static_cast<uint8_t>(data[pos]);
       }
-      else if ((cmd == GTxtCmd_AddItem) ||
-               ((cmd >= GTxtCmd_ChangeAlienTemperament) && (cmd <= GTxtCmd_ModifyMissionTable)))
+      else if (g_gameTextParamCount.value(cmd) == 2)
       {
-        // the command is one of several that modify game state, so let's capture it along
-        // with its parameters to pass back to the caller in a list
+        // interpret bytes as little-endian 16-bit word
+        param = (static_cast<uint8_t>(data[pos]) + (0x100 * static_cast<uint8_t>(data[pos+1])));
 
-        int param = 0;
-        if (g_gameTextParamCount.contains(cmd))
-        {
-          // the GrantKnowledgePlace command is special because it can use either one or two
-          // parameter bytes, determined during parsing by the content of the first byte
-          if (cmd == GTxtCmd_GrantKnowledgePlace)
-          {
-            param = data[pos];
-
-            // if bit 7 is set in the first parameter byte to GrantKnowledgePlace, we need
-            // to consume one additional byte and combine them to form a 16-bit place ID
-            if (param & 0x80)
-            {
-              // advance the input pointer once more since we just determined that an
-              // additional parameter byte is required
-              pos++;
-              if (pos < maxlen)
-              {
-                param &= 0x7F;
-                param |= (static_cast<uint16_t>(data[pos]) << 7);
-              }
-            }
-          }
-          else if (g_gameTextParamCount[cmd] == 1)
-          {
-            param = static_cast<uint8_t>(data[pos]);
-          }
-          else if (g_gameTextParamCount[cmd] == 2)
-          {
-            // interpret bytes as little-endian 16-bit word
-            param = (static_cast<uint8_t>(data[pos]) + (0x100 * static_cast<uint8_t>(data[pos+1])));
-
-            // Note: the ModifyEncountRelate command actually takes two single-byte parameters.
-            // Since this is the only command with parameters in this format, we're combining them
-            // into a single 16-bit word for the sake of consistency with the other commands.
-          }
-
-          commands.append(QPair<GTxtCmd,int>(cmd, param));
-
-          if (showEmbeddedCommands)
-          {
-            clean += QString(EMBEDDED_CMD_REFERENCE_STR).arg(commands.count());
-          }
-        }
+        // Note: the ModifyEncountRelate command actually takes two single-byte parameters.
+        // Since this is the only command with parameters in this format, we're combining them
+        // into a single 16-bit word for the sake of consistency with the other commands.
       }
-      else
+
+      arena.appendCommand(static_cast<uint8_t>(cmd), param);
+    }
+    else
+    {
+      // all other command values (bytes < 0x20) are unused, and cause the game's text engine to
+      // insert the string "<HUH?>"
+      arena.appendText(QString("<HUH?>"));
+    }
+
+    // advance the pointer by the number of parameter bytes used by this command
+    pos += paramLength;
+    spanStart = pos;
+  }
+
+  if (length > spanStart)
+  {
+    arena.appendText(data + spanStart, length - spanStart);
+  }
+
+  return arena.endString();
+}
+
+/**
+ * Renders a parsed string as HTML, with metatext as links listing its alternatives and
+ * (optionally) numbered markers where the embedded commands occur. The output is sized
+ * once from the precomputed span lengths and then filled in a single pass. The caller
+ * must hold the read lock, and must have resolved the string's metatext.
+ */
+QString GameText::html(const GameTextString& str, bool showEmbeddedCommands)
+{
+  const GameTextToken* tokens = m_arena.tokens(str);
+  int length = str.htmlLength;
+
+  for (int i = 0; i < str.tokenCount; i++)
+  {
+    if (tokens[i].type == GameTextTokenType::MetaText)
+    {
+      length += m_metaHtml.value(tokens[i].param).size();
+    }
+  }
+
+  if (showEmbeddedCommands)
+  {
+    length += str.commandCount * static_cast<int>(sizeof(EMBEDDED_CMD_REFERENCE_STR));
+  }
+
+  QString out;
+  out.reserve(length);
+  int commandNumber = 0;
+
+  for (int i = 0; i < str.tokenCount; i++)
+  {
+    const GameTextToken& token = tokens[i];
+    if (token.type == GameTextTokenType::Text)
+    {
+      out.append(m_arena.htmlText(token), token.htmlLength);
+    }
+    else if (token.type == GameTextTokenType::MetaText)
+    {
+      out.append(m_metaHtml.value(token.param));
+    }
+    else
+    {
+      commandNumber++;
+      if (showEmbeddedCommands)
       {
-        // all other command values (bytes < 0x20) are unused, and cause the game's text engine to
-        // insert the string "<HUH?>"
-        clean.append(QString("<HUH?>").toHtmlEscaped());
+        out.append(QString(EMBEDDED_CMD_REFERENCE_STR).arg(commandNumber));
       }
+    }
+  }
 
-      // advance the pointer by the number of parameter bytes used by this command
-      pos += g_gameTextParamCount[cmd];
+  return out;
+}
+
+/**
+ * Renders a parsed string as plain text, with the first alternative for each metatext
+ * and no indication of the embedded commands. The caller must hold the read lock, and
+ * must have resolved the string's metatext.
+ */
+QString GameText::plainText(const GameTextString& str)
+{
+  const GameTextToken* tokens = m_arena.tokens(str);
+  int length = str.plainLength;
+
+  for (int i = 0; i < str.tokenCount; i++)
+  {
+    if (tokens[i].type == GameTextTokenType::MetaText)
+    {
+      length += m_metaPlain.value(tokens[i].param).size();
+    }
+  }
+
+  QString out;
+  out.reserve(length);
+
+  for (int i = 0; i < str.tokenCount; i++)
+  {
+    const GameTextToken& token = tokens[i];
+    if (token.type == GameTextTokenType::Text)
+    {
+      out.append(m_arena.plainText(token), token.plainLength);
+    }
+    else if (token.type == GameTextTokenType::MetaText)
+    {
+      out.append(m_metaPlain.value(token.param));
+    }
+  }
+
+  return out;
+}
+
+/**
+ * Returns the embedded commands of a parsed string, with their parameters, in the order
+ * in which they occur. The caller must hold the read lock.
+ */
+QVector<QPair<GTxtCmd,int> > GameText::commandList(const GameTextString& str)
+{
+  const GameTextToken* tokens = m_arena.tokens(str);
+  QVector<QPair<GTxtCmd,int> > commands;
+  commands.reserve(str.commandCount);
+
+  for (int i = 0; i < str.tokenCount; i++)
+  {
+    if (tokens[i].type == GameTextTokenType::Command)
+    {
+      commands.append(QPair<GTxtCmd,int>(static_cast<GTxtCmd>(tokens[i].command), tokens[i].param));
     }
   }
 
-  return clean;
+  return commands;
+}
+
+/**
+ * Parses the provided string data (or finds it among the strings that have already been
+ * parsed), and returns a handle to its token stream. The handle remains valid until
+ * clear() is called.
+ */
+GameTextString GameText::parseString(const char* data, int maxlen)
+{
+  return parseCached(data, maxlen);
+}
+
+QString GameText::renderHtml(const GameTextString& str, bool showEmbeddedCommands)
+{
+  resolveMetaTextOf(str);
+  QReadLocker locker(&m_lock);
+  return html(str, showEmbeddedCommands);
+}
+
+QString GameText::renderPlainText(const GameTextString& str)
+{
+  resolveMetaTextOf(str);
+  QReadLocker locker(&m_lock);
+  return plainText(str);
+}
+
+QVector<QPair<GTxtCmd,int> > GameText::renderCommands(const GameTextString& str)
+{
+  QReadLocker locker(&m_lock);
+  return commandList(str);
 }
 
+/**
+ * Produces the HTML form of the provided string data, with the commands that modify
+ * game state removed and returned separately in the provided list.
+ */
+QString GameText::readString(const char* data, QVector<QPair<GTxtCmd,int> >& commands, bool showEmbeddedCommands, int maxlen)
+{
+  const GameTextString str = parseCached(data, maxlen);
+  resolveMetaTextOf(str);
+
+  QReadLocker locker(&m_lock);
+  commands = commandList(str);
+  return html(str, showEmbeddedCommands);
+}
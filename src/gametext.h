@@ -3,8 +3,11 @@
 
 #include <QString>
 #include <QMap>
+#include <QHash>
 #include <QByteArray>
+#include <QReadWriteLock>
 #include "datlibrary.h"
+#include "gametextarena.h"
 
 #define METATAB_RECORDSIZE_BYTES   4
 #define METATAB_TYPE_SYNONYM       0
@@ -110,7 +113,11 @@ static const QMap<GTxtCmd,QString> g_gameTextCommandName =
 /**
  * Reads mission, conversation, and object text from a data file. This text
  * may have embedded command sequences that control the game environment, and
- * this class will process them appropriately.
+ * this class will process them appropriately. Each distinct string is parsed
+ * only once into a token stream, which can then be rendered as HTML, as plain
+ * text, or as a list of its embedded commands. Strings may be parsed and rendered
+ * from any thread: parsing happens in a scratch arena, and the lock only guards the
+ * shared arena and lookup tables, so renders run concurrently with one another.
  */
 class GameText
 {
@@ -122,12 +129,31 @@ public:
   QString readString(const char* data, QVector<QPair<GTxtCmd,int> >& commands,
                      bool showEmbeddedCommands = false, int maxlen = 0x1000);
 
+  GameTextString parseString(const char* data, int maxlen = 0x1000);
+  QString renderHtml(const GameTextString& str, bool showEmbeddedCommands = false);
+  QString renderPlainText(const GameTextString& str);
+  QVector<QPair<GTxtCmd,int> > renderCommands(const GameTextString& str);
+
 private:
   DatLibrary* m_lib;
   QByteArray m_metaTab;
   QByteArray m_metaTextTab;
+  GameTextArena m_arena;
+  QHash<QByteArray,GameTextString> m_parsedStrings;
+  QHash<int,QString> m_metaHtml;
+  QHash<int,QString> m_metaPlain;
+  QReadWriteLock m_lock;
+
+  void resolveMetaText(int metaTabIndex);
+  void resolveMetaTextOf(const GameTextString& str);
+  GameTextString parseCached(const char* data, int maxlen);
+  static GameTextString parse(GameTextArena& arena, const char* data, int length);
+  QString html(const GameTextString& str, bool showEmbeddedCommands);
+  QString plainText(const GameTextString& str);
+  QVector<QPair<GTxtCmd,int> > commandList(const GameTextString& str);
 
-  QString getMetaString(int metaTabIndex);
+  static int encodedLength(const char* data, int maxlen);
+  static int commandParamLength(const char* data, int pos, int maxlen, GTxtCmd cmd);
 };
 
 #endif // GAMETEXT_H
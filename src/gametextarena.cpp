@@ -0,0 +1,203 @@
+#include "gametextarena.h"
+
+GameTextArena::GameTextArena()
+{
+  clear();
+}
+
+/**
+ * Discards every string in the arena. Any handles previously returned by endString()
+ * are no longer valid.
+ */
+void GameTextArena::clear()
+{
+  m_tokens.clear();
+  m_plainPool.clear();
+  m_htmlPool.clear();
+  m_current = GameTextString();
+  m_current.firstToken = 0;
+  m_current.tokenCount = 0;
+}
+
+/**
+ * Starts a new string. Tokens appended until the next call to endString() belong to it.
+ */
+void GameTextArena::beginString()
+{
+  m_current.firstToken = m_tokens.count();
+  m_current.tokenCount = 0;
+  m_current.plainLength = 0;
+  m_current.htmlLength = 0;
+  m_current.metaTextCount = 0;
+  m_current.commandCount = 0;
+}
+
+/**
+ * Returns the text token at the end of the current string, adding a new one if the
+ * string is empty or ends with a token of another type. Consecutive text is therefore
+ * always merged into a single span.
+ */
+GameTextToken& GameTextArena::currentTextToken()
+{
+  if ((m_current.tokenCount == 0) || (m_tokens.last().type != GameTextTokenType::Text))
+  {
+    GameTextToken token;
+    token.type = GameTextTokenType::Text;
+    token.command = 0;
+    token.param = 0;
+    token.plainOffset = m_plainPool.size();
+    token.plainLength = 0;
+    token.htmlOffset = m_htmlPool.size();
+    token.htmlLength = 0;
+    m_tokens.append(token);
+    m_current.tokenCount++;
+  }
+
+  return m_tokens.last();
+}
+
+/**
+ * Appends printable Latin-1 text to the current string. The HTML copy of the text has
+ * the same characters escaped as QString::toHtmlEscaped().
+ */
+void GameTextArena::appendText(const char* latin1, int length)
+{
+  GameTextToken& token = currentTextToken();
+  const int htmlStart = m_htmlPool.size();
+
+  m_plainPool.append(QLatin1String(latin1, length));
+  for (int i = 0; i < length; i++)
+  {
+    switch (latin1[i])
+    {
+    case '<':
+      m_htmlPool.append(QLatin1String("&lt;"));
+      break;
+    case '>':
+      m_htmlPool.append(QLatin1String("&gt;"));
+      break;
+    case '&':
+      m_htmlPool.append(QLatin1String("&amp;"));
+      break;
+    case '"':
+      m_htmlPool.append(QLatin1String("&quot;"));
+      break;
+    default:
+      m_htmlPool.append(QLatin1Char(latin1[i]));
+      break;
+    }
+  }
+
+  token.plainLength += length;
+  token.htmlLength += m_htmlPool.size() - htmlStart;
+  m_current.plainLength += length;
+  m_current.htmlLength += m_htmlPool.size() - htmlStart;
+}
+
+/**
+ * Appends substitution text (such as a placeholder for the player's name) to the
+ * current string.
+ */
+void GameTextArena::appendText(const QString& text)
+{
+  const QByteArray latin1 = text.toLatin1();
+  appendText(latin1.constData(), latin1.size());
+}
+
+/**
+ * Appends a reference to a metatext record, which is resolved when the string is rendered.
+ */
+void GameTextArena::appendMetaText(int metaTabIndex)
+{
+  GameTextToken token;
+  token.type = GameTextTokenType::MetaText;
+  token.command = 0;
+  token.param = metaTabIndex;
+  token.plainOffset = 0;
+  token.plainLength = 0;
+  token.htmlOffset = 0;
+  token.htmlLength = 0;
+  m_tokens.append(token);
+  m_current.tokenCount++;
+  m_current.metaTextCount++;
+}
+
+/**
+ * Appends an embedded command that modifies the game state, along with its parameter.
+ */
+void GameTextArena::appendCommand(uint8_t command, int param)
+{
+  GameTextToken token;
+  token.type = GameTextTokenType::Command;
+  token.command = command;
+  token.param = param;
+  token.plainOffset = 0;
+  token.plainLength = 0;
+  token.htmlOffset = 0;
+  token.htmlLength = 0;
+  m_tokens.append(token);
+  m_current.tokenCount++;
+  m_current.commandCount++;
+}
+
+/**
+ * Finishes the current string.
+ * @return Handle to the string, which remains valid until the arena is cleared.
+ */
+GameTextString GameTextArena::endString()
+{
+  return m_current;
+}
+
+/**
+ * Copies a string from another arena into this one, so that strings can be parsed into
+ * a private arena and then added to a shared one in a single step.
+ * @return Handle to the copy, which remains valid until this arena is cleared.
+ */
+GameTextString GameTextArena::copyString(const GameTextArena& source, const GameTextString& str)
+{
+  const GameTextToken* srcTokens = source.tokens(str);
+  GameTextString copy = str;
+  copy.firstToken = m_tokens.count();
+
+  m_tokens.reserve(m_tokens.count() + str.tokenCount);
+  for (int i = 0; i < str.tokenCount; i++)
+  {
+    GameTextToken token = srcTokens[i];
+    if (token.type == GameTextTokenType::Text)
+    {
+      token.plainOffset = m_plainPool.size();
+      token.htmlOffset = m_htmlPool.size();
+      m_plainPool.append(source.plainText(srcTokens[i]), token.plainLength);
+      m_htmlPool.append(source.htmlText(srcTokens[i]), token.htmlLength);
+    }
+    m_tokens.append(token);
+  }
+
+  return copy;
+}
+
+/**
+ * Returns a pointer to the first of the provided string's tokens.
+ */
+const GameTextToken* GameTextArena::tokens(const GameTextString& str) const
+{
+  return m_tokens.constData() + str.firstToken;
+}
+
+/**
+ * Returns a pointer to the plain characters of a text token.
+ */
+const QChar* GameTextArena::plainText(const GameTextToken& token) const
+{
+  return m_plainPool.constData() + token.plainOffset;
+}
+
+/**
+ * Returns a pointer to the HTML-escaped characters of a text token.
+ */
+const QChar* GameTextArena::htmlText(const GameTextToken& token) const
+{
+  return m_htmlPool.constData() + token.htmlOffset;
+}
+
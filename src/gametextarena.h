@@ -0,0 +1,77 @@
+#pragma once
+#include <stdint.h>
+#include <QString>
+#include <QVector>
+
+enum class GameTextTokenType : uint8_t
+{
+  Text,
+  MetaText,
+  Command
+};
+
+/**
+ * A single element of a parsed game text string. Text tokens refer to a span in each of
+ * the arena's two character pools (one plain and one HTML-escaped). Metatext tokens hold
+ * the index of a META.TAB record in their parameter, and command tokens hold the command
+ * byte and its parameter value.
+ */
+struct GameTextToken
+{
+  GameTextTokenType type;
+  uint8_t command;
+  int param;
+  int plainOffset;
+  int plainLength;
+  int htmlOffset;
+  int htmlLength;
+};
+
+/**
+ * Handle to a parsed string in a GameTextArena, along with the precomputed lengths of its
+ * text spans so that renderers can reserve their output before appending to it.
+ */
+struct GameTextString
+{
+  int firstToken;
+  int tokenCount;
+  int plainLength;
+  int htmlLength;
+  int metaTextCount;
+  int commandCount;
+};
+
+/**
+ * Pooled storage for parsed game text strings. The tokens for every string are kept in
+ * one shared array, and the characters of every text span in two shared character pools,
+ * so that parsing a string adds to a few contiguous buffers rather than allocating for
+ * each piece of it. Strings are built with beginString(), the append functions, and
+ * endString().
+ */
+class GameTextArena
+{
+public:
+  GameTextArena();
+  void clear();
+
+  void beginString();
+  void appendText(const char* latin1, int length);
+  void appendText(const QString& text);
+  void appendMetaText(int metaTabIndex);
+  void appendCommand(uint8_t command, int param);
+  GameTextString endString();
+  GameTextString copyString(const GameTextArena& source, const GameTextString& str);
+
+  const GameTextToken* tokens(const GameTextString& str) const;
+  const QChar* plainText(const GameTextToken& token) const;
+  const QChar* htmlText(const GameTextToken& token) const;
+
+private:
+  QVector<GameTextToken> m_tokens;
+  QString m_plainPool;
+  QString m_htmlPool;
+  GameTextString m_current;
+
+  GameTextToken& currentTextToken();
+};
+
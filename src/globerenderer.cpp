@@ -0,0 +1,153 @@
+#include <QtMath>
+#include <string.h>
+#include "globerenderer.h"
+
+GlobeRenderer::GlobeRenderer() :
+  m_texWidth(0),
+  m_texHeight(0)
+{
+  memset(m_colors, 0, sizeof(m_colors));
+}
+
+/**
+ * Sets the surface texture that is wrapped around the globe, along with the palette from
+ * its color table. The projection table is only rebuilt if the texture size has changed.
+ * @return True when the texture is a usable indexed image; false otherwise.
+ */
+bool GlobeRenderer::setTexture(const QImage& texture)
+{
+  bool status = false;
+
+  if (!texture.isNull() && (texture.format() == QImage::Format_Indexed8))
+  {
+    const int width = texture.width();
+    const int height = texture.height();
+    const bool sizeChanged = (width != m_texWidth) || (height != m_texHeight);
+
+    // Each row of the texture is stored twice in succession so that the texel for any
+    // rotation can be found without wrapping the longitude back into range.
+    m_texels.resize(width * height * 2);
+    for (int y = 0; y < height; y++)
+    {
+      const uint8_t* const srcRow = texture.constScanLine(y);
+      uint8_t* const dstRow = m_texels.data() + (y * width * 2);
+      memcpy(dstRow, srcRow, width);
+      memcpy(dstRow + width, srcRow, width);
+    }
+
+    m_texWidth = width;
+    m_texHeight = height;
+    if (sizeChanged)
+    {
+      buildLookupTable();
+    }
+
+    setPalette(texture.colorTable());
+    status = true;
+  }
+
+  return status;
+}
+
+/**
+ * Sets the palette used to expand the texel indices into colors.
+ */
+void GlobeRenderer::setPalette(const QVector<QRgb>& palette)
+{
+  for (int idx = 0; idx < 256; idx++)
+  {
+    m_colors[idx] = (idx < palette.size()) ? palette[idx] : qRgb(0, 0, 0);
+  }
+}
+
+/**
+ * Returns the width of the current texture, which is the number of distinct
+ * rotation steps for a full turn of the globe.
+ */
+int GlobeRenderer::textureWidth() const
+{
+  return m_texWidth;
+}
+
+/**
+ * Computes the texel offset for each screen pixel that falls on the globe. The visible
+ * hemisphere spans half of the texture's width, and the texture's rows run from the
+ * north pole to the south pole. Offsets are relative to the doubled texture rows, at
+ * zero rotation; the rotation (in texels) is simply added when rendering.
+ */
+void GlobeRenderer::buildLookupTable()
+{
+  const double radius = GLOBE_DIAMETER / 2.0;
+
+  m_spans.clear();
+  m_lut.clear();
+
+  for (int y = 0; y < GLOBE_DIAMETER; y++)
+  {
+    const double ny = ((y + 0.5) - radius) / radius;
+    GlobeSpan span = { y, -1, m_lut.size(), 0 };
+
+    for (int x = 0; x < GLOBE_DIAMETER; x++)
+    {
+      const double nx = ((x + 0.5) - radius) / radius;
+      const double r2 = (nx * nx) + (ny * ny);
+
+      if (r2 <= 1.0)
+      {
+        const double nz = sqrt(1.0 - r2);
+        const double lat = asin(ny);         // -pi/2 (north) to pi/2 (south)
+        const double lon = atan2(nx, nz);    // -pi/2 to pi/2 across the visible face
+
+        const int texRow = qBound(0, static_cast<int>(((lat / M_PI) + 0.5) * m_texHeight), m_texHeight - 1);
+        const int texCol = qBound(0, static_cast<int>(((lon / (2.0 * M_PI)) + 0.25) * m_texWidth), m_texWidth - 1);
+
+        if (span.xStart < 0)
+        {
+          span.xStart = x;
+        }
+        span.length++;
+        m_lut.append((texRow * m_texWidth * 2) + texCol);
+      }
+    }
+
+    if (span.length > 0)
+    {
+      m_spans.append(span);
+    }
+  }
+}
+
+/**
+ * Draws the globe at the given rotation (in texels, where the texture width is a
+ * full turn) into the provided frame, which is created as a transparent 32-bit
+ * image if it is not already of the correct size and format. Pixels outside of
+ * the globe are never written, so the same frame can be reused for every call.
+ */
+void GlobeRenderer::render(int rotation, QImage& frame) const
+{
+  if ((frame.width() != GLOBE_DIAMETER) || (frame.height() != GLOBE_DIAMETER) ||
+      (frame.format() != QImage::Format_ARGB32))
+  {
+    frame = QImage(GLOBE_DIAMETER, GLOBE_DIAMETER, QImage::Format_ARGB32);
+    frame.fill(Qt::transparent);
+  }
+
+  if (m_texWidth > 0)
+  {
+    rotation = ((rotation % m_texWidth) + m_texWidth) % m_texWidth;
+    const uint8_t* const texels = m_texels.constData() + rotation;
+    const int32_t* const lut = m_lut.constData();
+
+    foreach (const GlobeSpan& span, m_spans)
+    {
+      QRgb* const out = reinterpret_cast<QRgb*>(frame.scanLine(span.y)) + span.xStart;
+      const int32_t* const spanLut = lut + span.lutStart;
+
+      for (int idx = 0; idx < span.length; idx++)
+      {
+        out[idx] = m_colors[texels[spanLut[idx]]];
+      }
+    }
+  }
+}
+
@@ -0,0 +1,44 @@
+#pragma once
+#include <stdint.h>
+#include <QImage>
+#include <QVector>
+#include <QRgb>
+
+#define GLOBE_DIAMETER 256
+
+/**
+ * Renders a planet surface texture (as decoded from a .PLN file) onto a sphere
+ * in orthographic projection. The mapping from each screen pixel to its texel is
+ * computed once per texture size, so that drawing a frame at any rotation is only
+ * a table lookup for each pixel followed by palette expansion.
+ */
+class GlobeRenderer
+{
+public:
+  GlobeRenderer();
+
+  bool setTexture(const QImage& texture);
+  void setPalette(const QVector<QRgb>& palette);
+  int textureWidth() const;
+  void render(int rotation, QImage& frame) const;
+
+private:
+  //! Horizontal run of screen pixels on a single row that fall on the globe
+  struct GlobeSpan
+  {
+    int y;
+    int xStart;
+    int lutStart;
+    int length;
+  };
+
+  int m_texWidth;
+  int m_texHeight;
+  QVector<uint8_t> m_texels;
+  QVector<GlobeSpan> m_spans;
+  QVector<int32_t> m_lut;
+  QRgb m_colors[256];
+
+  void buildLookupTable();
+};
+
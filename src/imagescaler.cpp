@@ -0,0 +1,311 @@
+#include <string.h>
+#include <QVector>
+#include <QPair>
+#include <QtConcurrent>
+#include "imagescaler.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//! Number of rows of the source image handled by each worker task
+#define IMAGESCALER_ROWS_PER_BAND 16
+
+//! Images with fewer pixels than this are scaled on the calling thread
+#define IMAGESCALER_MIN_THREADED_PIXELS (64 * 64)
+
+/**
+ * Upscales the provided image by an integer factor (between 1 and IMAGESCALER_MAX_FACTOR)
+ * using the requested scaler. The PixelArt scaler uses Scale2x for a factor of two, Scale3x
+ * for a factor of three, and two passes of Scale2x for a factor of four.
+ * @return The upscaled image, or a null image if the provided image was null or the
+ * factor is out of range.
+ */
+QImage ImageScaler::upscale(const QImage& image, int factor, ScalerType type)
+{
+  QImage scaled;
+
+  if (!image.isNull() && (factor >= 1) && (factor <= IMAGESCALER_MAX_FACTOR))
+  {
+    if (factor == 1)
+    {
+      scaled = image;
+    }
+    else if (image.format() == QImage::Format_Indexed8)
+    {
+      scaled = upscaleIndexed(image, factor, type);
+    }
+    else
+    {
+      // all of the images decoded from the game data are indexed, so this is
+      // only a fallback for images that have already been converted
+      scaled = image.scaled(image.width() * factor, image.height() * factor,
+                            Qt::IgnoreAspectRatio, Qt::FastTransformation);
+    }
+  }
+
+  return scaled;
+}
+
+/**
+ * Upscales an 8-bit indexed image, working on the rows of the source in parallel.
+ */
+QImage ImageScaler::upscaleIndexed(const QImage& image, int factor, ScalerType type)
+{
+  if ((type == ScalerType::PixelArt) && (factor == 4))
+  {
+    return upscaleIndexed(upscaleIndexed(image, 2, type), 2, type);
+  }
+
+  const int width = image.width();
+  const int height = image.height();
+  QImage scaled(width * factor, height * factor, QImage::Format_Indexed8);
+  scaled.setColorTable(image.colorTable());
+
+  const uint8_t* const src = image.constBits();
+  const int srcStride = image.bytesPerLine();
+  uint8_t* const dst = scaled.bits();
+  const int dstStride = scaled.bytesPerLine();
+
+  forEachRowBand(width, height, [&](int rowStart, int rowEnd)
+  {
+    if (type == ScalerType::Nearest)
+    {
+      nearestRows(src, srcStride, width, height, dst, dstStride, factor, rowStart, rowEnd);
+    }
+    else if (factor == 2)
+    {
+      scale2xRows(src, srcStride, width, height, dst, dstStride, rowStart, rowEnd);
+    }
+    else
+    {
+      scale3xRows(src, srcStride, width, height, dst, dstStride, rowStart, rowEnd);
+    }
+  });
+
+  return scaled;
+}
+
+/**
+ * Splits the rows of a source image into bands and calls the provided function for
+ * each band on the global thread pool. Small images are processed in a single band
+ * on the calling thread, since the overhead of dispatching work would dominate.
+ */
+void ImageScaler::forEachRowBand(int width, int height, const std::function<void(int,int)>& func)
+{
+  if ((width * height) < IMAGESCALER_MIN_THREADED_PIXELS)
+  {
+    func(0, height);
+  }
+  else
+  {
+    QVector<QPair<int,int> > bands;
+    for (int rowStart = 0; rowStart < height; rowStart += IMAGESCALER_ROWS_PER_BAND)
+    {
+      bands.append(qMakePair(rowStart, qMin(rowStart + IMAGESCALER_ROWS_PER_BAND, height)));
+    }
+
+    QtConcurrent::blockingMap(bands, [&func](const QPair<int,int>& band)
+    {
+      func(band.first, band.second);
+    });
+  }
+}
+
+/**
+ * Replicates each source pixel into a square block of factor x factor destination pixels,
+ * for the source rows in the range [rowStart, rowEnd). Each destination row is expanded
+ * once horizontally and then copied to the remaining rows of its block.
+ */
+void ImageScaler::nearestRows(const uint8_t* src, int srcStride, int width, int height,
+                              uint8_t* dst, int dstStride, int factor, int rowStart, int rowEnd)
+{
+  Q_UNUSED(height)
+
+  for (int y = rowStart; y < rowEnd; y++)
+  {
+    const uint8_t* const srcRow = src + (y * srcStride);
+    uint8_t* const dstRow = dst + (y * factor * dstStride);
+    int x = 0;
+
+#ifdef __SSE2__
+    if (factor == 2)
+    {
+      for (; (x + 16) <= width; x += 16)
+      {
+        const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcRow + x));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dstRow + (x * 2)), _mm_unpacklo_epi8(px, px));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dstRow + (x * 2) + 16), _mm_unpackhi_epi8(px, px));
+      }
+    }
+    else if (factor == 4)
+    {
+      for (; (x + 16) <= width; x += 16)
+      {
+        const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcRow + x));
+        const __m128i lo = _mm_unpacklo_epi8(px, px);
+        const __m128i hi = _mm_unpackhi_epi8(px, px);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dstRow + (x * 4)), _mm_unpacklo_epi8(lo, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dstRow + (x * 4) + 16), _mm_unpackhi_epi8(lo, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dstRow + (x * 4) + 32), _mm_unpacklo_epi8(hi, hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dstRow + (x * 4) + 48), _mm_unpackhi_epi8(hi, hi));
+      }
+    }
+#endif
+
+    for (; x < width; x++)
+    {
+      memset(dstRow + (x * factor), srcRow[x], factor);
+    }
+
+    for (int rep = 1; rep < factor; rep++)
+    {
+      memcpy(dstRow + (rep * dstStride), dstRow, width * factor);
+    }
+  }
+}
+
+/**
+ * Applies the Scale2x algorithm to the source rows in the range [rowStart, rowEnd).
+ * Using the names of the neighbouring pixels around the center pixel E:
+ *    A B C
+ *    D E F
+ *    G H I
+ * E is replaced by the 2x2 block E0 E1 / E2 E3, where each corner takes the color
+ * of the adjacent neighbours when they match (and the opposite neighbours do not),
+ * which smooths diagonal edges without introducing any new colors.
+ * Pixels outside the image are treated as copies of the nearest edge pixel.
+ */
+void ImageScaler::scale2xRows(const uint8_t* src, int srcStride, int width, int height,
+                              uint8_t* dst, int dstStride, int rowStart, int rowEnd)
+{
+  for (int y = rowStart; y < rowEnd; y++)
+  {
+    const uint8_t* const cur = src + (y * srcStride);
+    const uint8_t* const above = src + (qMax(y - 1, 0) * srcStride);
+    const uint8_t* const below = src + (qMin(y + 1, height - 1) * srcStride);
+    uint8_t* const dst0 = dst + (y * 2 * dstStride);
+    uint8_t* const dst1 = dst0 + dstStride;
+    int x = 0;
+
+    while (x < width)
+    {
+#ifdef __SSE2__
+      // the vector path needs the pixels on either side of the 16 being processed,
+      // so the first and last columns are always handled by the scalar code
+      if ((x > 0) && ((x + 17) <= width))
+      {
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(above + x));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + x - 1));
+        const __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + x));
+        const __m128i f = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + x + 1));
+        const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(below + x));
+
+        const __m128i eqDB = _mm_cmpeq_epi8(d, b);
+        const __m128i eqBF = _mm_cmpeq_epi8(b, f);
+        const __m128i eqDH = _mm_cmpeq_epi8(d, h);
+        const __m128i eqHF = _mm_cmpeq_epi8(h, f);
+
+        const __m128i c0 = _mm_andnot_si128(_mm_or_si128(eqBF, eqDH), eqDB);
+        const __m128i c1 = _mm_andnot_si128(_mm_or_si128(eqDB, eqHF), eqBF);
+        const __m128i c2 = _mm_andnot_si128(_mm_or_si128(eqDB, eqHF), eqDH);
+        const __m128i c3 = _mm_andnot_si128(_mm_or_si128(eqDH, eqBF), eqHF);
+
+        const __m128i e0 = _mm_or_si128(_mm_and_si128(c0, d), _mm_andnot_si128(c0, e));
+        const __m128i e1 = _mm_or_si128(_mm_and_si128(c1, f), _mm_andnot_si128(c1, e));
+        const __m128i e2 = _mm_or_si128(_mm_and_si128(c2, d), _mm_andnot_si128(c2, e));
+        const __m128i e3 = _mm_or_si128(_mm_and_si128(c3, f), _mm_andnot_si128(c3, e));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst0 + (x * 2)), _mm_unpacklo_epi8(e0, e1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst0 + (x * 2) + 16), _mm_unpackhi_epi8(e0, e1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst1 + (x * 2)), _mm_unpacklo_epi8(e2, e3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst1 + (x * 2) + 16), _mm_unpackhi_epi8(e2, e3));
+        x += 16;
+        continue;
+      }
+#endif
+
+      const uint8_t b = above[x];
+      const uint8_t d = cur[qMax(x - 1, 0)];
+      const uint8_t e = cur[x];
+      const uint8_t f = cur[qMin(x + 1, width - 1)];
+      const uint8_t h = below[x];
+
+      if ((b != h) && (d != f))
+      {
+        dst0[x * 2]     = (d == b) ? d : e;
+        dst0[x * 2 + 1] = (b == f) ? f : e;
+        dst1[x * 2]     = (d == h) ? d : e;
+        dst1[x * 2 + 1] = (h == f) ? f : e;
+      }
+      else
+      {
+        dst0[x * 2]     = e;
+        dst0[x * 2 + 1] = e;
+        dst1[x * 2]     = e;
+        dst1[x * 2 + 1] = e;
+      }
+      x++;
+    }
+  }
+}
+
+/**
+ * Applies the Scale3x algorithm to the source rows in the range [rowStart, rowEnd).
+ * Each pixel E (with neighbours named as for Scale2x) is replaced by a 3x3 block:
+ *    E0 E1 E2
+ *    E3 E4 E5
+ *    E6 E7 E8
+ * Pixels outside the image are treated as copies of the nearest edge pixel.
+ */
+void ImageScaler::scale3xRows(const uint8_t* src, int srcStride, int width, int height,
+                              uint8_t* dst, int dstStride, int rowStart, int rowEnd)
+{
+  for (int y = rowStart; y < rowEnd; y++)
+  {
+    const uint8_t* const cur = src + (y * srcStride);
+    const uint8_t* const above = src + (qMax(y - 1, 0) * srcStride);
+    const uint8_t* const below = src + (qMin(y + 1, height - 1) * srcStride);
+    uint8_t* const dst0 = dst + (y * 3 * dstStride);
+    uint8_t* const dst1 = dst0 + dstStride;
+    uint8_t* const dst2 = dst1 + dstStride;
+
+    for (int x = 0; x < width; x++)
+    {
+      const int left = qMax(x - 1, 0);
+      const int right = qMin(x + 1, width - 1);
+      const uint8_t a = above[left];
+      const uint8_t b = above[x];
+      const uint8_t c = above[right];
+      const uint8_t d = cur[left];
+      const uint8_t e = cur[x];
+      const uint8_t f = cur[right];
+      const uint8_t g = below[left];
+      const uint8_t h = below[x];
+      const uint8_t i = below[right];
+      uint8_t* const out0 = dst0 + (x * 3);
+      uint8_t* const out1 = dst1 + (x * 3);
+      uint8_t* const out2 = dst2 + (x * 3);
+
+      if ((b != h) && (d != f))
+      {
+        out0[0] = (d == b) ? d : e;
+        out0[1] = (((d == b) && (e != c)) || ((b == f) && (e != a))) ? b : e;
+        out0[2] = (b == f) ? f : e;
+        out1[0] = (((d == b) && (e != g)) || ((d == h) && (e != a))) ? d : e;
+        out1[1] = e;
+        out1[2] = (((b == f) && (e != i)) || ((h == f) && (e != c))) ? f : e;
+        out2[0] = (d == h) ? d : e;
+        out2[1] = (((d == h) && (e != i)) || ((h == f) && (e != g))) ? h : e;
+        out2[2] = (h == f) ? f : e;
+      }
+      else
+      {
+        memset(out0, e, 3);
+        memset(out1, e, 3);
+        memset(out2, e, 3);
+      }
+    }
+  }
+}
+
@@ -0,0 +1,37 @@
+#pragma once
+#include <stdint.h>
+#include <functional>
+#include <QImage>
+
+#define IMAGESCALER_MAX_FACTOR 4
+
+enum class ScalerType
+{
+  Nearest,
+  PixelArt
+};
+
+/**
+ * Upscales the decoded game images by integer factors, either by simple pixel
+ * replication or with the Scale2x/Scale3x (EPX family) edge-aware pixel art
+ * scalers. Indexed images are scaled by operating directly on the palette
+ * indices, so the result shares the palette of the source image.
+ */
+class ImageScaler
+{
+public:
+  static QImage upscale(const QImage& image, int factor, ScalerType type);
+
+private:
+  ImageScaler();
+
+  static void nearestRows(const uint8_t* src, int srcStride, int width, int height,
+                          uint8_t* dst, int dstStride, int factor, int rowStart, int rowEnd);
+  static void scale2xRows(const uint8_t* src, int srcStride, int width, int height,
+                          uint8_t* dst, int dstStride, int rowStart, int rowEnd);
+  static void scale3xRows(const uint8_t* src, int srcStride, int width, int height,
+                          uint8_t* dst, int dstStride, int rowStart, int rowEnd);
+  static void forEachRowBand(int width, int height, const std::function<void(int,int)>& func);
+  static QImage upscaleIndexed(const QImage& image, int factor, ScalerType type);
+};
+
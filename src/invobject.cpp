@@ -65,9 +65,9 @@ bool InvObject::populateList()
 }
 
 /**
- * Gets a map of object IDs to structs containing data about those objects.
+ * Gets the table of structs containing data about the objects, indexed by object ID.
  */
-QMap<int,InventoryObj> InvObject::getList()
+const DenseIdTable<InventoryObj>& InvObject::getList()
 {
   if (m_objList.isEmpty())
   {
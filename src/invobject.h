@@ -3,6 +3,7 @@
 #include <QImage>
 #include <stdint.h>
 #include "dattable.h"
+#include "denseidtable.h"
 #include "gametext.h"
 #include "enums.h"
 #include "palette.h"
@@ -73,12 +74,33 @@ typedef struct __attribute__((packed)) ObjectTableEntry
 
 static_assert(sizeof(ObjectTableEntry) == 24, "ObjectTableEntry packing does not match game data");
 
+constexpr FieldDescriptor s_objectTableFields[] =
+{
+  TABLE_GAMETEXT_FIELD(ObjectTableEntry, nameOffset),
+  TABLE_UNKNOWN_FIELD(ObjectTableEntry, unknown_a),
+  TABLE_UNKNOWN_FIELD(ObjectTableEntry, unknown_b),
+  TABLE_FIELD(ObjectTableEntry, isTradeable),
+  TABLE_UNKNOWN_FIELD(ObjectTableEntry, unknown_c),
+  TABLE_FIELD(ObjectTableEntry, type),
+  TABLE_FIELD(ObjectTableEntry, subtype),
+  TABLE_FIELD(ObjectTableEntry, flags),
+  TABLE_FIELD(ObjectTableEntry, valueByRace),
+  TABLE_UNKNOWN_FIELD(ObjectTableEntry, unknown_d)
+};
+
+template <>
+struct TableSchema<ObjectTableEntry>
+{
+  static constexpr const FieldDescriptor* fields() { return s_objectTableFields; }
+  static constexpr int fieldCount() { return sizeof(s_objectTableFields) / sizeof(FieldDescriptor); }
+};
+
 class InvObject : public DatTable<ObjectTableEntry>
 {
 public:
   InvObject(DatLibrary& lib, Palette& pal, GameText& gtext);
   bool getImage(int id, QImage& img);
-  QMap<int,InventoryObj> getList();
+  const DenseIdTable<InventoryObj>& getList();
   InventoryObjType getObjectType(int id);
   QString getObjectText(int id);
   QString getName(int id);
@@ -91,6 +113,6 @@ protected:
 private:
   Palette* m_pal;
   GameText* m_gtext;
-  QMap<int,InventoryObj> m_objList;
+  DenseIdTable<InventoryObj> m_objList;
 };
 
@@ -10,7 +10,6 @@
 #include <QTreeWidgetItem>
 #include <QMap>
 #include <QAudioDeviceInfo>
-#include <QBuffer>
 #include <QTime>
 #include <QToolTip>
 #include <QCursor>
@@ -19,6 +18,11 @@
 #include <QBrush>
 #include <QMessageBox>
 #include <QDir>
+#include <QActionGroup>
+#include <QInputDialog>
+#include <QGraphicsPixmapItem>
+#include <QHeaderView>
+#include <QSet>
 #include "enums.h"
 #include "tablenumberitem.h"
 
@@ -26,6 +30,26 @@
 #define SURFACE_TEXTURE_PAL_LABEL_PREFIX "Surface texture palette: "
 #define ALIEN_PAL_LABEL_PREFIX "Alien palette: "
 
+#define OBJECT_VIEW_SCALE     3
+#define PLANET_VIEW_SCALE     2
+#define ALIEN_VIEW_SCALE      3
+#define FULLSCREEN_VIEW_SCALE 2
+#define STAMP_VIEW_SCALE      2
+
+//! The data table files that can be shown in the raw table viewer, and the schema of each
+static const QMap<QString,RawTable (*)(const QByteArray&)> s_rawTableReaders =
+{
+  {"ALIEN.TAB",   &RawTable::fromData<AlienTableEntry>},
+  {"FACT.TAB",    &RawTable::fromData<FactTableEntry>},
+  {"MISSION.TAB", &RawTable::fromData<MissionTableEntry>},
+  {"OBJECT.TAB",  &RawTable::fromData<ObjectTableEntry>},
+  {"PCLASS.TAB",  &RawTable::fromData<PClassTableEntry>},
+  {"PLACE.TAB",   &RawTable::fromData<PlaceTableEntry>},
+  {"SCLASS.TAB",  &RawTable::fromData<ShipClassTableEntry>},
+  {"SHIP.TAB",    &RawTable::fromData<ShipTableEntry>},
+  {"STCLASS.TAB", &RawTable::fromData<StClassTableEntry>}
+};
+
 MainWindow::MainWindow(QString gameDir, QWidget *parent) :
   QMainWindow(parent),
   ui(new Ui::MainWindow),
@@ -45,25 +69,63 @@ MainWindow::MainWindow(QString gameDir, QWidget *parent) :
   m_stamps(m_lib, m_palette),
   m_convText(m_lib, m_aliens, m_gametext),
   m_missions(m_lib, m_gametext),
+  m_thumbnails(m_fullscreenImages, m_stamps, m_invObject),
+  m_stampLoader(m_stamps),
+  m_soundAnalyzer(m_audio),
+  m_wavExporter(m_audio),
+  m_dedup(m_lib, m_stamps, m_fullscreenImages),
+  m_textSearch(m_lib, m_gametext, m_convText),
+  m_cmdXref(m_lib, m_gametext, m_convText),
+  m_reachability(m_convText),
+  m_dialogueExporter(m_convText),
   m_currentNNVSoundCount(0),
   m_currentNNVSoundId(-1),
   m_currentNNVFilename(""),
   m_currentSoundDat(DatFileType::Invalid),
   m_audioOutput(nullptr),
-  m_currentConvTopic(ConvTopicCategory_GreetingInitial)
+  m_playbackResampler(nullptr),
+  m_wavExportProgress(nullptr),
+  m_dedupProgress(nullptr),
+  m_reachProgress(nullptr),
+  m_dialogueExportProgress(nullptr),
+  m_currentConvTopic(ConvTopicCategory_GreetingInitial),
+  m_scalerType(ScalerType::Nearest),
+  m_displayPalCombo(nullptr),
+  m_palCycleCheckbox(nullptr),
+  m_palCycleFirstSpinBox(nullptr),
+  m_palCycleLastSpinBox(nullptr),
+  m_palCycleStep(0),
+  m_globeRotation(0),
+  m_thumbsCompleted(0),
+  m_thumbsValid(false),
+  m_shipModel(m_shipClasses, m_aliens, m_places)
 {
   setWindowIcon(QIcon(ICON_PATH));
   ui->setupUi(this);
   putResourceLabelsInArray();
 
-  ui->m_objectImageView->scale(3, 3);
-  ui->m_planetView->scale(2, 2);
-  ui->m_alienView->scale(3, 3);
-  ui->m_fullscreenView->scale(2, 2);
-  ui->m_stampView->scale(2, 2);
-
   setupAudio();
   setupTimer();
+  setupThumbnailView();
+  setupImageScaling();
+  setupPaletteToolBar();
+  setupCommandXrefPanels();
+  setupRawTableViewer();
+  setupRecordTables();
+  m_globeTimer.setInterval(16);
+  connect(&m_globeTimer, &QTimer::timeout, this, &MainWindow::onGlobeTimer);
+  connect(&m_stampLoader, &StampRollLoader::imageReady, this, &MainWindow::onStampImageReady);
+  connect(&m_soundAnalyzer, &SoundAnalyzer::analysisReady, this, &MainWindow::onSoundAnalysisReady);
+  connect(ui->m_soundWaveform, &WaveformWidget::soundActivated, this, &MainWindow::onWaveformSoundActivated);
+  connect(&m_wavExporter, &BatchWavExporter::progress, this, &MainWindow::onWavExportProgress);
+  connect(&m_wavExporter, &BatchWavExporter::finished, this, &MainWindow::onWavExportFinished);
+  connect(&m_dedup, &DedupAnalyzer::progress, this, &MainWindow::onDedupProgress);
+  connect(&m_dedup, &DedupAnalyzer::finished, this, &MainWindow::onDedupFinished);
+  connect(&m_textSearch, &TextSearchIndexer::finished, this, &MainWindow::onTextSearchIndexFinished);
+  connect(&m_cmdXref, &CommandXref::finished, this, &MainWindow::onCommandXrefFinished);
+  connect(&m_reachability, &ReachabilityExplorer::finished, this, &MainWindow::onReachabilityFinished);
+  connect(&m_dialogueExporter, &DialogueExporter::progress, this, &MainWindow::onDialogueExportProgress);
+  connect(&m_dialogueExporter, &DialogueExporter::finished, this, &MainWindow::onDialogueExportFinished);
   clearAllResourceLabels();
   connectGLViewerSliders();
 
@@ -75,6 +137,8 @@ MainWindow::MainWindow(QString gameDir, QWidget *parent) :
 
 MainWindow::~MainWindow()
 {
+  m_thumbnails.cancel();
+  m_stampLoader.cancel();
   delete m_audioOutput;
   delete m_aboutBox;
   delete ui;
@@ -86,6 +150,27 @@ void MainWindow::setupTimer()
   connect(&m_timer, SIGNAL(timeout()), this, SLOT(onTimer()));
 }
 
+void MainWindow::setupThumbnailView()
+{
+  ui->m_thumbView->setModel(&m_thumbModel);
+  ui->m_thumbView->setIconSize(QSize(THUMBNAIL_SIZE, THUMBNAIL_SIZE));
+  ui->m_thumbView->setGridSize(QSize(THUMBNAIL_SIZE + 40, THUMBNAIL_SIZE + 40));
+  connect(&m_thumbnails, &ThumbnailGenerator::thumbnailReady, this, &MainWindow::onThumbnailReady);
+  connect(&m_thumbnails, &ThumbnailGenerator::finished, this, &MainWindow::onThumbnailsFinished);
+}
+
+/**
+ * Groups the image scaling menu options so that only one may be selected at a time.
+ * The image views are not zoomed with their own transforms, since QGraphicsView
+ * would scale the pixmaps with filtering; the images are upscaled before display.
+ */
+void MainWindow::setupImageScaling()
+{
+  QActionGroup* scalerGroup = new QActionGroup(this);
+  scalerGroup->addAction(ui->actionScaleNearest);
+  scalerGroup->addAction(ui->actionScalePixelArt);
+}
+
 void MainWindow::connectGLViewerSliders()
 {
   connect(ui->m_3dSliderX, &QSlider::valueChanged, ui->m_3dModelViewer, &GLShipViewerWidget::setXRotation);
@@ -160,6 +245,50 @@ void MainWindow::clearPlaceLabels()
  */
 void MainWindow::clearData()
 {
+  // worker threads may still be decoding thumbnails from the old data
+  m_thumbnails.cancel();
+  m_thumbModel.clear();
+  m_thumbsValid = false;
+  ui->m_thumbStatusLabel->clear();
+  m_stampLoader.cancel();
+  m_textSearch.cancel();
+  m_cmdXref.cancel();
+  m_reachability.cancel();
+  m_dialogueExporter.cancel();
+  m_dialogueExporter.waitForFinished();
+  m_soundAnalyzer.clear();
+  m_wavExporter.cancel();
+  m_wavExporter.waitForFinished();
+  m_dedup.cancel();
+  ui->m_factXrefPanel->clear();
+  ui->m_placeXrefPanel->clear();
+  ui->m_objXrefPanel->clear();
+  ui->m_missionXrefPanel->clear();
+  m_searchHits.clear();
+  ui->m_searchResultTable->setRowCount(0);
+  ui->m_searchStatusLabel->clear();
+  m_rawTable = RawTable();
+  ui->m_rawTableView->clear();
+  ui->m_rawTableView->setRowCount(0);
+  ui->m_rawTableView->setColumnCount(0);
+  ui->m_rawTableExportButton->setEnabled(false);
+
+  m_placeModel.clear();
+  m_objModel.clear();
+  m_alienModel.clear();
+  m_shipModel.clear();
+  m_factModel.clear();
+
+  // resetting a model drops its selection without signalling a change of the current row,
+  // so the details of the previously selected records are cleared here
+  onPlaceRowChanged(QModelIndex());
+  onObjectRowChanged(QModelIndex());
+  onAlienRowChanged(QModelIndex());
+  onShipRowChanged(QModelIndex());
+  onFactRowChanged(QModelIndex());
+  m_convTopicModel.clear();
+  clearDialogLineAndCommandList();
+
   m_lib.closeData();
   m_invObject.clear();
   m_places.clear();
@@ -171,9 +300,20 @@ void MainWindow::clearData()
   m_inventory.clear();
   m_facts.clear();
   m_missions.clear();
+  m_gametext.clear();
+  m_convText.clear();
+  m_fullscreenImages.clear();
+  ui->m_soundWaveform->clear();
+  m_audio.clear();
 
   m_alienFrames.clear();
   m_stampImages.clear();
+  m_objImage = QImage();
+  m_planetSurfaceImage = QImage();
+  m_fullscreenImage = QImage();
+  m_scaledImages.clear();
+  m_globeTimer.stop();
+  populateDisplayPaletteList();
 
   m_fullscreenScene.clear();
   m_objScene.clear();
@@ -191,6 +331,7 @@ void MainWindow::openNewData(const QString gameDir)
   ui->statusBar->showMessage(QString("Using directory: %1").arg(gameDir));
 
   m_lib.openData(gameDir);
+  m_fullscreenImages.resolvePaletteNames();
   populatePlaceWidgets();
   populateObjectWidgets();
   populateAlienWidgets();
@@ -203,19 +344,35 @@ void MainWindow::openNewData(const QString gameDir)
   populateMissionWidgets();
   populate3dModelWidgets();
   populatePaletteWidgets();
+  populateRawTableWidgets();
+  startTextIndexing();
+
+  if (ui->m_tabs->currentWidget() == ui->m_tabThumbnails)
+  {
+    populateThumbnails();
+  }
 }
 
 /**
- * Sets up audio output to match the PCM sound format used by the game.
+ * Sets up audio output for the game's sounds. Because many output devices either refuse the
+ * game's native 7042 Hz 8-bit format or resample it poorly, 16-bit output at one of the
+ * common rates is preferred, with the sounds resampled as they are played. The native format
+ * is only used when none of those is supported. This also fills the list of sample rates
+ * offered for .WAV export.
  */
 void MainWindow::setupAudio()
 {
-  m_audioFormat.setSampleRate(7042);
+  const int outputRates[] = { 48000, 44100, 22050 };
+
+  ui->m_soundWavRateCombo->addItem(QString("%1 Hz, 8-bit (original)").arg(NNV_SAMPLE_RATE), NNV_SAMPLE_RATE);
+  for (int rate : outputRates)
+  {
+    ui->m_soundWavRateCombo->addItem(QString("%1 Hz, 16-bit").arg(rate), rate);
+  }
+
   m_audioFormat.setChannelCount(1);
-  m_audioFormat.setSampleSize(8);
   m_audioFormat.setCodec("audio/pcm");
   m_audioFormat.setByteOrder(QAudioFormat::LittleEndian);
-  m_audioFormat.setSampleType(QAudioFormat::UnSignedInt);
 
   QAudioDeviceInfo info(QAudioDeviceInfo::defaultOutputDevice());
 
@@ -225,7 +382,30 @@ void MainWindow::setupAudio()
   }
   else
   {
-    if (info.isFormatSupported(m_audioFormat))
+    bool formatFound = false;
+
+    m_audioFormat.setSampleSize(16);
+    m_audioFormat.setSampleType(QAudioFormat::SignedInt);
+    for (int rate : outputRates)
+    {
+      m_audioFormat.setSampleRate(rate);
+      if (info.isFormatSupported(m_audioFormat))
+      {
+        m_playbackResampler = new ResamplingDevice(NNV_SAMPLE_RATE, rate, this);
+        formatFound = true;
+        break;
+      }
+    }
+
+    if (!formatFound)
+    {
+      m_audioFormat.setSampleRate(NNV_SAMPLE_RATE);
+      m_audioFormat.setSampleSize(8);
+      m_audioFormat.setSampleType(QAudioFormat::UnSignedInt);
+      formatFound = info.isFormatSupported(m_audioFormat);
+    }
+
+    if (formatFound)
     {
       m_audioOutput = new QAudioOutput(m_audioFormat, this);
       connect(m_audioOutput, SIGNAL(stateChanged(QAudio::State)), this, SLOT(onAudioStateChanged(QAudio::State)));
@@ -234,7 +414,7 @@ void MainWindow::setupAudio()
     else
     {
       ui->m_soundWarningLabel->setText(
-        "Default audio device does not support required output format. Sound output is disabled.");
+        "Default audio device does not support any usable output format. Sound output is disabled.");
     }
   }
 }
@@ -313,18 +493,8 @@ void MainWindow::onCloseDataFiles()
  */
 void MainWindow::populatePlaceWidgets()
 {
-  QMap<int,Place> places = m_places.getPlaceList();
-  ui->m_placeTable->setRowCount(0);
-
-  foreach (Place p, places.values())
-  {
-    const int rowcount = ui->m_placeTable->rowCount();
-    ui->m_placeTable->insertRow(rowcount);
-    ui->m_placeTable->setItem(rowcount, 0, new TableNumberItem(QString("%1").arg(p.id)));
-    ui->m_placeTable->setItem(rowcount, 1, new QTableWidgetItem(p.name));
-  }
+  m_placeModel.setTable(m_places.getPlaceList());
   ui->m_placeTable->resizeColumnsToContents();
-  ui->m_placeTable->resizeRowsToContents();
 }
 
 /*
@@ -332,23 +502,8 @@ void MainWindow::populatePlaceWidgets()
  */
 void MainWindow::populateObjectWidgets()
 {
-  QMap<int,InventoryObj> objs = m_invObject.getList();
-  ui->m_objTable->setRowCount(0);
-
-  foreach (InventoryObj obj, objs.values())
-  {
-    const int rowcount = ui->m_objTable->rowCount();
-
-    ui->m_objTable->insertRow(rowcount);
-    ui->m_objTable->setItem(rowcount, 0, new TableNumberItem(QString("%1").arg(obj.id)));
-    ui->m_objTable->setItem(rowcount, 1, new QTableWidgetItem(obj.name));
-    for (int r = 0; r < static_cast<int>(AlienRace::NumRaces); r++)
-    {
-      ui->m_objTable->setItem(rowcount, 2 + r, new TableNumberItem(QString("%1").arg(obj.valueByRace[r])));
-    }
-  }
+  m_objModel.setTable(m_invObject.getList());
   ui->m_objTable->resizeColumnsToContents();
-  ui->m_objTable->resizeRowsToContents();
 }
 
 /*
@@ -356,21 +511,8 @@ void MainWindow::populateObjectWidgets()
  */
 void MainWindow::populateAlienWidgets()
 {
-  QMap<int,Alien> aliens = m_aliens.getList();
-  ui->m_alienTable->setRowCount(0);
-
-  foreach (Alien a, aliens.values())
-  {
-    const int rowcount = ui->m_alienTable->rowCount();
-    ui->m_alienTable->insertRow(rowcount);
-    ui->m_alienTable->setItem(rowcount, 0, new TableNumberItem(QString("%1").arg(a.id)));
-    ui->m_alienTable->setItem(rowcount, 1, new QTableWidgetItem(a.name));
-
-    const QString racename = s_raceNames.contains(a.race) ? s_raceNames[a.race] : "(invalid/unknown)";
-    ui->m_alienTable->setItem(rowcount, 2, new QTableWidgetItem(racename));
-  }
+  m_alienModel.setTable(m_aliens.getList());
   ui->m_alienTable->resizeColumnsToContents();
-  ui->m_alienTable->resizeRowsToContents();
 }
 
 /*
@@ -378,21 +520,8 @@ void MainWindow::populateAlienWidgets()
  */
 void MainWindow::populateShipWidgets()
 {
-  QMap<int,Ship> ships = m_ships.getList();
-  ui->m_shipTable->setRowCount(0);
-
-  foreach (Ship s, ships.values())
-  {
-    const int rowcount = ui->m_shipTable->rowCount();
-    ui->m_shipTable->insertRow(rowcount);
-    ui->m_shipTable->setItem(rowcount, 0, new TableNumberItem(QString("%1").arg(s.id)));
-    ui->m_shipTable->setItem(rowcount, 1, new QTableWidgetItem(s.name));
-    ui->m_shipTable->setItem(rowcount, 2, new QTableWidgetItem(m_shipClasses.getName(s.shipclass)));
-    ui->m_shipTable->setItem(rowcount, 3, new QTableWidgetItem(m_aliens.getName(s.pilot)));
-    ui->m_shipTable->setItem(rowcount, 4, new QTableWidgetItem(m_places.getName(s.location)));
-  }
+  m_shipModel.setTable(m_ships.getList());
   ui->m_shipTable->resizeColumnsToContents();
-  ui->m_shipTable->resizeRowsToContents();
 }
 
 /*
@@ -400,22 +529,8 @@ void MainWindow::populateShipWidgets()
  */
 void MainWindow::populateFactWidgets()
 {
-  QMap<int,Fact> facts = m_facts.getList();
-  ui->m_factTable->setRowCount(0);
-
-  foreach (Fact f, facts.values())
-  {
-    const int rowcount = ui->m_factTable->rowCount();
-    ui->m_factTable->insertRow(rowcount);
-    ui->m_factTable->setItem(rowcount, 0, new TableNumberItem(QString("%1").arg(f.id)));
-    for (int raceId = 0; raceId < static_cast<int>(AlienRace::NumRaces); raceId++)
-    {
-      AlienRace race = static_cast<AlienRace>(raceId);
-      ui->m_factTable->setItem(rowcount, 1 + raceId, new TableNumberItem(QString("%1").arg(f.receptivity[race])));
-    }
-  }
+  m_factModel.setTable(m_facts.getList());
   ui->m_factTable->resizeColumnsToContents();
-  ui->m_factTable->resizeRowsToContents();
 }
 
 /*
@@ -508,25 +623,13 @@ void MainWindow::populateStampWidgets()
 
 /**
  * Populates the only conversation text widget that must always contains some data,
- * which is the primary list of aliens.
+ * which is the primary list of aliens. This shares the model of the alien tab's table,
+ * so it only has to be sized once that model has been filled.
  */
 void MainWindow::populateConversationWidgets()
 {
-  QMap<int,Alien> aliens = m_aliens.getList();
-  ui->m_convAlienTable->setRowCount(0);
-
-  foreach (Alien a, aliens.values())
-  {
-    const int rowcount = ui->m_convAlienTable->rowCount();
-    ui->m_convAlienTable->insertRow(rowcount);
-    ui->m_convAlienTable->setItem(rowcount, 0, new TableNumberItem(QString("%1").arg(a.id)));
-    ui->m_convAlienTable->setItem(rowcount, 1, new QTableWidgetItem(a.name));
-
-    getConversationLinesForCurrentTopic();
-  }
-
+  getConversationLinesForCurrentTopic();
   ui->m_convAlienTable->resizeColumnsToContents();
-  ui->m_convAlienTable->resizeRowsToContents();
 }
 
 /**
@@ -614,24 +717,104 @@ void MainWindow::populatePaletteWidgets()
 
   ui->m_paletteTree->expandAll();
   ui->m_paletteTree->resizeColumnToContents(0);
+
+  populateDisplayPaletteList();
+}
+
+/**
+ * Populates the raw table viewer with the entries of the selected data table file. Each
+ * element of each field gets its own column. Fields that refer to GAMETEXT.TXT show the
+ * referenced text, and fields whose purpose is unknown are shown in hex.
+ */
+void MainWindow::populateRawTableWidgets()
+{
+  ui->m_rawTableView->clear();
+  ui->m_rawTableView->setRowCount(0);
+  ui->m_rawTableView->setColumnCount(0);
+  m_rawTable = RawTable();
+
+  const QString filename = ui->m_rawTableCombo->currentText();
+  QByteArray data;
+  if (s_rawTableReaders.contains(filename) && m_lib.getFileByName(DatFileType::CONVERSE, filename, data))
+  {
+    m_rawTable = s_rawTableReaders[filename](data);
+    const bool unknownOnly = ui->m_rawTableUnknownCheckbox->isChecked();
+
+    // each column shows one element of one field; the name fields are kept when showing
+    // only the unknown fields so that the entries can still be told apart
+    QVector<QPair<int,int> > columns;
+    QStringList headers("Index");
+    QStringList headerTips("Entry index");
+    for (int fieldIndex = 0; fieldIndex < m_rawTable.fieldCount(); fieldIndex++)
+    {
+      const FieldDescriptor& f = m_rawTable.field(fieldIndex);
+      if (!unknownOnly || f.isUnknown || f.isGameText)
+      {
+        for (int element = 0; element < f.count; element++)
+        {
+          columns.append(qMakePair(fieldIndex, element));
+          headers.append((f.count == 1) ? QString(f.name) : QString("%1[%2]").arg(f.name).arg(element));
+          headerTips.append(QString("Offset 0x%1, %2-bit %3").arg(f.offset + (element * f.width), 2, 16, QChar('0'))
+                            .arg(f.width * 8).arg(f.isSigned ? "signed" : "unsigned"));
+        }
+      }
+    }
+
+    ui->m_rawTableView->setColumnCount(headers.count());
+    for (int col = 0; col < headers.count(); col++)
+    {
+      QTableWidgetItem* headerItem = new QTableWidgetItem(headers.at(col));
+      headerItem->setToolTip(headerTips.at(col));
+      ui->m_rawTableView->setHorizontalHeaderItem(col, headerItem);
+    }
+
+    ui->m_rawTableView->setRowCount(m_rawTable.entryCount());
+    for (int entry = 0; entry < m_rawTable.entryCount(); entry++)
+    {
+      ui->m_rawTableView->setItem(entry, 0, new TableNumberItem(QString::number(entry)));
+
+      for (int col = 0; col < columns.count(); col++)
+      {
+        const FieldDescriptor& f = m_rawTable.field(columns.at(col).first);
+        const qint64 val = m_rawTable.value(entry, columns.at(col).first, columns.at(col).second);
+        QTableWidgetItem* item = nullptr;
+
+        if (f.isGameText)
+        {
+          item = new QTableWidgetItem((val != 0xFFFF) ? m_lib.getGameText(static_cast<int>(val)) : QString());
+          item->setToolTip(QString("GAMETEXT.TXT offset 0x%1").arg(val, 4, 16, QChar('0')));
+        }
+        else if (f.isUnknown)
+        {
+          item = new QTableWidgetItem(QString("%1").arg(val, f.width * 2, 16, QChar('0')).toUpper());
+          item->setToolTip(QString::number(val));
+        }
+        else
+        {
+          item = new TableNumberItem(QString::number(val));
+        }
+        ui->m_rawTableView->setItem(entry, col + 1, item);
+      }
+    }
+
+    ui->m_rawTableView->resizeColumnsToContents();
+    ui->m_rawTableView->resizeRowsToContents();
+  }
+
+  ui->m_rawTableExportButton->setEnabled(m_rawTable.entryCount() > 0);
 }
 
 /**
  * Responds to a ship being selected in the ship table by populating
  * the neighboring table to show that ship's inventory.
  */
-void MainWindow::on_m_shipTable_currentCellChanged(int currentRow, int currentColumn, int previousRow, int previousColumn)
+void MainWindow::onShipRowChanged(const QModelIndex& current)
 {
-  Q_UNUSED(currentColumn)
-  Q_UNUSED(previousRow)
-  Q_UNUSED(previousColumn)
-
   ui->m_shipInventoryTable->setRowCount(0);
-  const QTableWidgetItem* const selectedItem = ui->m_shipTable->item(currentRow, 0);
+  const int shipid = recordIdAt(current);
 
-  if (selectedItem)
+  if (shipid >= 0)
   {
-    const int shipid = selectedItem->text().toInt();
     QMap<int,int> inventory = m_inventory.getInventory(shipid);
 
     foreach(int obj, inventory.keys())
@@ -656,26 +839,21 @@ void MainWindow::on_m_shipTable_currentCellChanged(int currentRow, int currentCo
  * Responds to an object being selected in the object table by loading and
  * display its .STP image, and associated object text, and other parameters.
  */
-void MainWindow::on_m_objTable_currentCellChanged(int currentRow, int currentColumn, int previousRow, int previousColumn)
+void MainWindow::onObjectRowChanged(const QModelIndex& current)
 {
-  Q_UNUSED(currentColumn)
-  Q_UNUSED(previousRow)
-  Q_UNUSED(previousColumn)
-
   m_objScene.clear();
+  m_objImage = QImage();
   ui->m_objectText->setPlainText("");
+  ui->m_objXrefPanel->clear();
 
-  const QTableWidgetItem* const selectedItem = ui->m_objTable->item(currentRow, 0);
+  const int id = recordIdAt(current);
 
-  if (selectedItem)
+  if (id >= 0)
   {
-    const int id = selectedItem->text().toInt();
-    QImage img;
 
-    if (m_invObject.getImage(id, img))
+    if (m_invObject.getImage(id, m_objImage))
     {
-      m_objScene.addPixmap(QPixmap::fromImage(img));
-      ui->m_objectImageView->setScene(&m_objScene);
+      showImage(m_objScene, ui->m_objectImageView, m_objImage, OBJECT_VIEW_SCALE);
     }
 
     const InventoryObjType type = m_invObject.getObjectType(id);
@@ -697,26 +875,24 @@ void MainWindow::on_m_objTable_currentCellChanged(int currentRow, int currentCol
       ui->m_objectUniqueLabel->setText("Unique: No");
     }
     ui->m_objectText->setHtml(m_invObject.getObjectText(id));
+    showCommandXrefs(ui->m_objXrefPanel, id);
   }
 }
 
 /**
  * Responds to a row being selected in the fact table by loading and displaying the text for that fact.
  */
-void MainWindow::on_m_factTable_currentCellChanged(int currentRow, int currentColumn, int previousRow, int previousColumn)
+void MainWindow::onFactRowChanged(const QModelIndex& current)
 {
-  Q_UNUSED(currentColumn)
-  Q_UNUSED(previousRow)
-  Q_UNUSED(previousColumn)
-
   ui->m_factText->clear();
+  ui->m_factXrefPanel->clear();
 
-  const QTableWidgetItem* const selectedItem = ui->m_factTable->item(currentRow, 0);
-  if (selectedItem)
+  const int id = recordIdAt(current);
+  if (id >= 0)
   {
-    const int id = selectedItem->text().toInt();
     const Fact f = m_facts.getFact(id);
     ui->m_factText->setPlainText(f.text);
+    showCommandXrefs(ui->m_factXrefPanel, id);
   }
 }
 
@@ -724,22 +900,21 @@ void MainWindow::on_m_factTable_currentCellChanged(int currentRow, int currentCo
  * Responds to a row being selected in the place table by loading and displaying all of its parameters,
  * including class name, temperature, and resources.
  */
-void MainWindow::on_m_placeTable_currentCellChanged(int currentRow, int currentColumn, int previousRow, int previousColumn)
+void MainWindow::onPlaceRowChanged(const QModelIndex& current)
 {
-  Q_UNUSED(currentColumn)
-  Q_UNUSED(previousRow)
-  Q_UNUSED(previousColumn)
-
   clearAllResourceLabels();
   clearPlaceLabels();
+  m_globeTimer.stop();
   m_planetSurfaceScene.clear();
+  m_planetSurfaceImage = QImage();
+  ui->m_placeXrefPanel->clear();
 
-  const QTableWidgetItem* const selectedItem = ui->m_placeTable->item(currentRow, 0);
+  const int id = recordIdAt(current);
 
-  if (selectedItem)
+  if (id >= 0)
   {
     bool status = true;
-    const int id = selectedItem->text().toInt();
+    showCommandXrefs(ui->m_placeXrefPanel, id);
 
     Place p;
     if (m_places.getPlace(id, p))
@@ -754,8 +929,8 @@ void MainWindow::on_m_placeTable_currentCellChanged(int currentRow, int currentC
           const QImage surfaceImg = m_places.getPlaceSurfaceImage(id, status, palFilename);
           if (status)
           {
-            m_planetSurfaceScene.addPixmap(QPixmap::fromImage(surfaceImg));
-            ui->m_planetView->setScene(&m_planetSurfaceScene);
+            m_planetSurfaceImage = surfaceImg;
+            showPlanetSurface();
             ui->m_planetTexturePalLabel->setText(QString(SURFACE_TEXTURE_PAL_LABEL_PREFIX) + palFilename);
           }
         }
@@ -800,21 +975,15 @@ void MainWindow::on_m_placeTable_currentCellChanged(int currentRow, int currentC
 /**
  * Responds to a row being selected in the alien table by loading its animation frames.
  */
-void MainWindow::on_m_alienTable_currentCellChanged(int currentRow, int currentColumn, int previousRow, int previousColumn)
+void MainWindow::onAlienRowChanged(const QModelIndex& current)
 {
-  Q_UNUSED(currentColumn)
-  Q_UNUSED(previousRow)
-  Q_UNUSED(previousColumn)
-
   m_alienFrames.clear();
-  m_aliens.clear();
   ui->m_alienPaletteLabel->setText(ALIEN_PAL_LABEL_PREFIX);
 
-  const QTableWidgetItem* const selectedItem = ui->m_alienTable->item(currentRow, 0);
+  const int id = recordIdAt(current);
 
-  if (selectedItem)
+  if (id >= 0)
   {
-    const int id = selectedItem->text().toInt();
 
     Alien a;
     if (m_aliens.getAlien(id, a))
@@ -856,8 +1025,7 @@ void MainWindow::loadAlienFrame(int frameId)
   m_alienScene.clear();
   if (m_alienFrames.values().count() > frameId)
   {
-    m_alienScene.addPixmap(QPixmap::fromImage(m_alienFrames.values().at(frameId)));
-    ui->m_alienView->setScene(&m_alienScene);
+    showImage(m_alienScene, ui->m_alienView, m_alienFrames.values().at(frameId), ALIEN_VIEW_SCALE);
   }
 }
 
@@ -881,12 +1049,15 @@ void MainWindow::on_m_soundTree_currentItemChanged(QTreeWidgetItem* current, QTr
       {
         m_currentNNVSoundId = 0;
         setSoundIDLabel(m_currentNNVFilename, m_currentNNVSoundId);
+        ui->m_soundWaveform->clear();
+        m_soundAnalyzer.request(m_currentSoundDat, m_currentNNVFilename);
       }
     }
     else
     {
       m_currentNNVSoundId = -1;
       setSoundIDLabel(m_currentNNVFilename, m_currentNNVSoundId);
+      ui->m_soundWaveform->clear();
     }
   }
   else
@@ -910,39 +1081,46 @@ void MainWindow::on_m_soundPrevButton_clicked()
     m_currentNNVSoundId--;
     setSoundIDLabel(m_currentNNVFilename, m_currentNNVSoundId);
     setSoundButtonStates();
+    ui->m_soundWaveform->showSound(m_currentNNVSoundId);
   }
 }
 
 /**
- * Loads the currently selected sound into a buffer, and start playing it.
+ * Opens a decoding stream for the currently selected sound and starts playing it. The
+ * sound is decoded as the audio output pulls data, so playback begins immediately.
  */
 void MainWindow::on_m_soundPlayButton_clicked()
 {
   if (m_currentNNVSoundId >= 0)
   {
-    m_audioPcmData.clear();
-    if (m_audio.readSound(m_currentSoundDat, m_currentNNVFilename, m_currentNNVSoundId, m_audioPcmData))
+    m_audioOutput->stop();
+    if (m_audio.openSoundStream(m_currentSoundDat, m_currentNNVFilename, m_currentNNVSoundId, m_soundStream))
     {
-      if (m_audioBuffer.isOpen())
+      if (m_playbackResampler)
       {
-        m_audioBuffer.close();
+        if (m_playbackResampler->setSource(&m_soundStream) && m_playbackResampler->open(QIODevice::ReadOnly))
+        {
+          m_audioOutput->start(m_playbackResampler);
+        }
+      }
+      else
+      {
+        m_audioOutput->start(&m_soundStream);
       }
-      m_audioBuffer.setData(m_audioPcmData);
-      m_audioBuffer.open(QIODevice::ReadOnly);
-      m_audioOutput->start(&m_audioBuffer);
     }
   }
 }
 
 /**
- * Prompts for a target filename and saves the selected audio as a .WAV file.
+ * Prompts for a target filename and saves the selected audio as a .WAV file, at the
+ * sample rate selected for export.
  */
 void MainWindow::on_m_soundMakeWav_clicked()
 {
   if (m_currentNNVSoundId >= 0)
   {
-    m_audioPcmData.clear();
-    if (m_audio.readSound(m_currentSoundDat, m_currentNNVFilename, m_currentNNVSoundId, m_audioPcmData))
+    DpcmStreamDevice wavStream;
+    if (m_audio.openSoundStream(m_currentSoundDat, m_currentNNVFilename, m_currentNNVSoundId, wavStream))
     {
       const int dotPosition = m_currentNNVFilename.indexOf('.');
       const QString baseFilename = (dotPosition > 0) ? m_currentNNVFilename.mid(0, dotPosition) : m_currentNNVFilename;
@@ -959,7 +1137,24 @@ void MainWindow::on_m_soundMakeWav_clicked()
         {
           saveName += ".wav";
         }
-        m_audio.writeWavFile(saveName, m_audioPcmData);
+        const int wavRate = ui->m_soundWavRateCombo->currentData().toInt();
+        bool status = false;
+        if (wavRate == NNV_SAMPLE_RATE)
+        {
+          status = m_audio.writeWavFile(saveName, wavStream);
+        }
+        else
+        {
+          ResamplingDevice resampled(NNV_SAMPLE_RATE, wavRate);
+          status = resampled.setSource(&wavStream) &&
+                   resampled.open(QIODevice::ReadOnly) &&
+                   m_audio.writeWavFile(saveName, resampled, wavRate, 16);
+        }
+
+        if (!status)
+        {
+          QMessageBox::warning(this, "Error", QString("Failed to write output file %1.").arg(saveName));
+        }
       }
     }
     else
@@ -989,6 +1184,7 @@ void MainWindow::on_m_soundNextButton_clicked()
     m_currentNNVSoundId++;
     setSoundIDLabel(m_currentNNVFilename, m_currentNNVSoundId);
     setSoundButtonStates();
+    ui->m_soundWaveform->showSound(m_currentNNVSoundId);
   }
 }
 
@@ -1039,6 +1235,7 @@ void MainWindow::setSoundButtonStates()
   }
 
   ui->m_soundMakeWav->setEnabled(m_currentNNVSoundId >= 0);
+  ui->m_soundWavRateCombo->setEnabled(m_currentNNVSoundId >= 0);
 }
 
 /**
@@ -1061,746 +1258,2398 @@ void MainWindow::setSoundIDLabel(QString nnvName, int soundId)
 }
 
 /**
- * Loads and displays one of the fullscreen LBM images.
+ * Displays a finished sound container analysis in the waveform view, provided that
+ * the container is still the one selected.
  */
-void MainWindow::on_m_fullscreenTree_currentItemChanged(QTreeWidgetItem* current, QTreeWidgetItem* previous)
+void MainWindow::onSoundAnalysisReady(SoundBankAnalysisPtr analysis)
 {
-  Q_UNUSED(previous)
-  m_fullscreenScene.clear();
+  if ((analysis->dat == m_currentSoundDat) && (analysis->nnvName == m_currentNNVFilename))
+  {
+    ui->m_soundWaveform->setAnalysis(analysis);
+    ui->m_soundWaveform->showSound(m_currentNNVSoundId);
+  }
+}
 
-  if (current)
+/**
+ * Selects the sound that was double-clicked in the waveform view.
+ */
+void MainWindow::onWaveformSoundActivated(int soundIndex)
+{
+  if ((soundIndex >= 0) && (soundIndex < m_currentNNVSoundCount))
   {
-    const QString lbmFilename = current->text(0);
-    if (current->parent())
-    {
-      const QString datFilename = current->parent()->text(0);
-      const DatFileType dat = DatLibrary::s_datFileNames.key(datFilename);
+    m_currentNNVSoundId = soundIndex;
+    setSoundIDLabel(m_currentNNVFilename, m_currentNNVSoundId);
+    setSoundButtonStates();
+  }
+}
 
-      QVector<QRgb> tempPal;
-      const QString paletteFilename = m_fullscreenImages.getPalette(dat, lbmFilename, tempPal);
-      ui->m_fullscreenPaletteName->setText(QString("Displaying with palette: ") + paletteFilename);
+/**
+ * Adds an export job for each sound in the specified NNV container. The files are named
+ * in the same way as single exported sounds, and are placed in the provided directory.
+ */
+void MainWindow::appendSoundBankJobs(QList<BatchWavJob>& jobs, DatFileType dat, QString nnvName, QString outputDir)
+{
+  const int dotPosition = nnvName.indexOf('.');
+  const QString baseFilename = (dotPosition > 0) ? nnvName.mid(0, dotPosition) : nnvName;
+  const int soundCount = m_audio.getNumberOfSoundsInNNV(dat, nnvName);
 
-      QImage fsLbm;
-      if (m_fullscreenImages.getImage(dat, lbmFilename, fsLbm))
-      {
-        m_fullscreenScene.addPixmap(QPixmap::fromImage(fsLbm));
-      }
+  for (int soundId = 0; soundId < soundCount; soundId++)
+  {
+    BatchWavJob job;
+    job.dat = dat;
+    job.nnvName = nnvName;
+    job.soundId = soundId;
+    job.outputPath = QString("%1/%2-%3.wav").arg(outputDir).arg(baseFilename).arg(soundId).toLower();
+    jobs.append(job);
+  }
+}
+
+/**
+ * Starts a batch export at the sample rate selected for .WAV export, and shows a
+ * progress dialog that allows it to be cancelled.
+ */
+void MainWindow::startWavExport(const QList<BatchWavJob>& jobs)
+{
+  if (jobs.isEmpty())
+  {
+    QMessageBox::information(this, "Export sounds", "There are no sounds to export.");
+  }
+  else if (m_wavExporter.start(jobs, ui->m_soundWavRateCombo->currentData().toInt()))
+  {
+    if (!m_wavExportProgress)
+    {
+      m_wavExportProgress = new QProgressDialog(this);
+      m_wavExportProgress->setWindowTitle("Export sounds");
+      m_wavExportProgress->setWindowModality(Qt::WindowModal);
+      m_wavExportProgress->setAutoReset(false);
+      m_wavExportProgress->setAutoClose(false);
+      connect(m_wavExportProgress, &QProgressDialog::canceled, &m_wavExporter, &BatchWavExporter::cancel);
     }
-    ui->m_fullscreenView->setScene(&m_fullscreenScene);
+
+    m_wavExportProgress->setLabelText(QString("Writing %1 .WAV files...").arg(jobs.count()));
+    m_wavExportProgress->setRange(0, jobs.count());
+    m_wavExportProgress->setValue(0);
+    m_wavExportProgress->show();
   }
 }
 
 /**
- * Responds to an item being selected in the tree of stamp/roll images.
+ * Prompts for an output directory and exports every sound in the selected NNV container.
  */
-void MainWindow::on_m_stampTree_currentItemChanged(QTreeWidgetItem* current, QTreeWidgetItem* previous)
+void MainWindow::on_actionExport_sound_bank_triggered()
 {
-  Q_UNUSED(previous)
-  m_stampScene.clear();
-  m_stampImages.clear();
+  if (m_currentNNVFilename.isEmpty() || (m_currentSoundDat == DatFileType::Invalid))
+  {
+    QMessageBox::information(this, "Export sounds", "Select a sound container on the Sounds tab first.");
+  }
+  else if (!m_wavExporter.isRunning())
+  {
+    const QString outputDir = QFileDialog::getExistingDirectory(this, "Select output directory for .WAV files", QDir::currentPath());
+    if (!outputDir.isEmpty())
+    {
+      QList<BatchWavJob> jobs;
+      appendSoundBankJobs(jobs, m_currentSoundDat, m_currentNNVFilename, outputDir);
+      startWavExport(jobs);
+    }
+  }
+}
 
-  if (current)
+/**
+ * Prompts for an output directory and exports every sound in every NNV container. The
+ * sounds from each DAT file are placed in a subdirectory named after it.
+ */
+void MainWindow::on_actionExport_all_sound_banks_triggered()
+{
+  if (!m_wavExporter.isRunning())
   {
-    const QString stampFilename = current->text(0);
-    if (current->parent())
+    const QString outputDir = QFileDialog::getExistingDirectory(this, "Select output directory for .WAV files", QDir::currentPath());
+    if (!outputDir.isEmpty())
     {
-      const QString datFilename = current->parent()->text(0);
-      const DatFileType dat = DatLibrary::s_datFileNames.key(datFilename);
+      QList<BatchWavJob> jobs;
+      const QMap<DatFileType,QStringList> nnvList = m_audio.getAllSoundList();
 
-      if (m_stamps.getStamp(dat, stampFilename, m_stampImages))
+      foreach (DatFileType dat, nnvList.keys())
       {
-        ui->m_stampRollSlider->setEnabled(m_stampImages.count() > 0);
-        ui->m_stampRollSlider->setValue(0);
-        if (m_stampImages.count() > 0)
-        {
-          ui->m_stampRollSlider->setMaximum(m_stampImages.count() - 1);
-          displayStamp(0);
-        }
-        else
+        const QString datFilename = DatLibrary::s_datFileNames.value(dat);
+        const int dotPosition = datFilename.indexOf('.');
+        const QString datDir = QString("%1/%2").arg(outputDir)
+                                               .arg(((dotPosition > 0) ? datFilename.mid(0, dotPosition) : datFilename).toLower());
+
+        foreach (QString nnvName, nnvList.value(dat))
         {
-          ui->m_stampRollSlider->setMaximum(0);
+          appendSoundBankJobs(jobs, dat, nnvName, datDir);
         }
       }
+
+      startWavExport(jobs);
     }
   }
 }
 
-/**
- * Responds to a row being selected in the alien table of the conversation text tab.
- */
-void MainWindow::on_m_convAlienTable_currentCellChanged(int currentRow, int currentColumn, int previousRow, int previousColumn)
+void MainWindow::onWavExportProgress(int completed, int total)
 {
-  Q_UNUSED(currentRow)
-  Q_UNUSED(currentColumn)
-  Q_UNUSED(previousRow)
-  Q_UNUSED(previousColumn)
-
-  clearDialogLineAndCommandList();
-
-  // We're going to repopulate the list of conversation topics for the currently selected alien and topic
-  // category. Before we do, save the ID of the last topic selected by the user so that we can auto-select
-  // it in the newly repopulated table *if* that topic is one of interest for the newly selected alien.
-  const int currentTopicRow = ui->m_convTopicTable->currentRow();
-  const QTableWidgetItem* const selectedTopicItem = ui->m_convTopicTable->item(currentTopicRow, 0);
-  const int lastSelectedTopicId = (selectedTopicItem) ? (selectedTopicItem->text().toInt()) : -1;
+  Q_UNUSED(total)
 
-  populateConversationTopicTable(lastSelectedTopicId);
+  if (m_wavExportProgress)
+  {
+    m_wavExportProgress->setValue(completed);
+  }
 }
 
 /**
- * Switches the current conversation topic to "initial greeting".
+ * Closes the export progress dialog and reports any files that could not be written.
  */
-void MainWindow::on_m_convTopicButtonGreeting0_clicked()
+void MainWindow::onWavExportFinished(int written, int failed, bool cancelled)
 {
-  m_currentConvTopic = ConvTopicCategory_GreetingInitial;
-  populateConversationTopicTable();
+  if (m_wavExportProgress)
+  {
+    m_wavExportProgress->reset();
+    m_wavExportProgress->hide();
+  }
+
+  if (cancelled)
+  {
+    QMessageBox::information(this, "Export sounds", QString("Export cancelled after writing %1 .WAV files.").arg(written));
+  }
+  else if (failed > 0)
+  {
+    QMessageBox::warning(this, "Export sounds", QString("Wrote %1 .WAV files; %2 sounds could not be exported.").arg(written).arg(failed));
+  }
 }
 
 /**
- * Switches the current conversation topic to "subsequent greeting".
+ * Exports the complete dialogue of every alien to JSON and HTML files in a directory
+ * selected by the user.
  */
-void MainWindow::on_m_convTopicButtonGreeting1_clicked()
+void MainWindow::on_actionExport_all_dialogue_triggered()
 {
-  m_currentConvTopic = ConvTopicCategory_GreetingSubsequent;
-  populateConversationTopicTable();
+  if (!m_dialogueExporter.isRunning())
+  {
+    QList<DialogueExportAlien> aliens;
+    for (const Alien& a : m_aliens.getList())
+    {
+      DialogueExportAlien alien;
+      alien.index = aliens.count();
+      alien.id = a.id;
+      alien.raceId = static_cast<int>(a.race);
+      alien.name = a.name;
+      aliens.append(alien);
+    }
+
+    if (aliens.isEmpty())
+    {
+      QMessageBox::information(this, "Export dialogue", "There is no game data loaded.");
+      return;
+    }
+
+    const QString outputDir = QFileDialog::getExistingDirectory(this, "Select output directory for dialogue", QDir::currentPath());
+    if (!outputDir.isEmpty())
+    {
+      DialogueExportTopics topics;
+      topics[ConvTopicCategory_GreetingInitial].insert(0, QString());
+      topics[ConvTopicCategory_GreetingSubsequent].insert(0, QString());
+
+      foreach (const DialogueExportAlien& alien, aliens)
+      {
+        topics[ConvTopicCategory_AskAboutPerson].insert(alien.id, alien.name);
+      }
+      for (const Place& p : m_places.getPlaceList())
+      {
+        topics[ConvTopicCategory_AskAboutLocation].insert(p.id, p.name);
+      }
+      for (const InventoryObj& obj : m_invObject.getList())
+      {
+        topics[ConvTopicCategory_AskAboutObject].insert(obj.id, obj.name);
+        topics[ConvTopicCategory_DisplayObject].insert(obj.id, obj.name);
+        topics[ConvTopicCategory_GiveObject].insert(obj.id, obj.name);
+        topics[ConvTopicCategory_SeesObject].insert(obj.id, obj.name);
+      }
+      for (int race = 0; race < static_cast<int>(AlienRace::NumRaces); race++)
+      {
+        topics[ConvTopicCategory_AskAboutRace].insert(race, s_raceNames.value(static_cast<AlienRace>(race)));
+      }
+      for (const Fact& f : m_facts.getList())
+      {
+        topics[ConvTopicCategory_GiveFact].insert(f.id, f.text);
+      }
+
+      if (m_dialogueExporter.start(aliens, topics, outputDir + "/dialogue.json", outputDir + "/dialogue.html"))
+      {
+        if (!m_dialogueExportProgress)
+        {
+          m_dialogueExportProgress = new QProgressDialog(this);
+          m_dialogueExportProgress->setWindowTitle("Export dialogue");
+          m_dialogueExportProgress->setLabelText("Exporting dialogue...");
+          m_dialogueExportProgress->setWindowModality(Qt::WindowModal);
+          m_dialogueExportProgress->setAutoReset(false);
+          m_dialogueExportProgress->setAutoClose(false);
+          connect(m_dialogueExportProgress, &QProgressDialog::canceled, &m_dialogueExporter, &DialogueExporter::cancel);
+        }
+
+        m_dialogueExportProgress->setRange(0, aliens.count());
+        m_dialogueExportProgress->setValue(0);
+        m_dialogueExportProgress->show();
+      }
+    }
+  }
 }
 
-/**
- * Switches the current conversation topic to "ask about person".
- */
-void MainWindow::on_m_convTopicButtonPerson_clicked()
+void MainWindow::onDialogueExportProgress(int completed, int total)
 {
-  m_currentConvTopic = ConvTopicCategory_AskAboutPerson;
-  populateConversationTopicTable();
+  Q_UNUSED(total)
+
+  if (m_dialogueExportProgress)
+  {
+    m_dialogueExportProgress->setValue(completed);
+  }
 }
 
 /**
- * Switches the current conversation topic to "ask about location".
+ * Closes the export progress dialog and reports whether the files could be written.
  */
-void MainWindow::on_m_convTopicButtonPlace_clicked()
+void MainWindow::onDialogueExportFinished(bool success, bool cancelled)
 {
-  m_currentConvTopic = ConvTopicCategory_AskAboutLocation;
-  populateConversationTopicTable();
+  if (m_dialogueExportProgress)
+  {
+    m_dialogueExportProgress->reset();
+    m_dialogueExportProgress->hide();
+  }
+
+  if (cancelled)
+  {
+    QMessageBox::information(this, "Export dialogue", "Export cancelled; the dialogue files are incomplete.");
+  }
+  else if (!success)
+  {
+    QMessageBox::warning(this, "Export dialogue", "The dialogue files could not be written.");
+  }
 }
 
 /**
- * Switches the current conversation topic to "ask about object".
+ * Writes every parsed data table into a single columnar snapshot file that external
+ * tools can read without parsing the game's DAT files.
  */
-void MainWindow::on_m_convTopicButtonObject_clicked()
+void MainWindow::on_actionExport_table_snapshot_triggered()
 {
-  m_currentConvTopic = ConvTopicCategory_AskAboutObject;
-  populateConversationTopicTable();
-}
+  if (m_places.getPlaceList().isEmpty())
+  {
+    QMessageBox::information(this, "Export table snapshot", "There is no game data loaded.");
+    return;
+  }
 
-/**
- * Switches the current conversation topic to "ask about race".
- */
-void MainWindow::on_m_convTopicButtonRace_clicked()
-{
-  m_currentConvTopic = ConvTopicCategory_AskAboutRace;
-  populateConversationTopicTable();
+  const QString filename = QFileDialog::getSaveFileName(this, "Export table snapshot", "nomad-tables.nres",
+                                                        "Table snapshots (*.nres)");
+  if (!filename.isEmpty())
+  {
+    TableSnapshot snapshot;
+    snapshot.addPlaces(m_places);
+    snapshot.addPlaceClasses(m_pclasses);
+    snapshot.addAliens(m_aliens);
+    snapshot.addObjects(m_invObject);
+    snapshot.addFacts(m_facts);
+    snapshot.addShips(m_ships, m_inventory);
+    snapshot.addShipClasses(m_shipClasses);
+    snapshot.addMissions(m_missions);
+
+    if (!snapshot.write(filename))
+    {
+      QMessageBox::warning(this, "Export table snapshot", QString("Failed to write %1.").arg(filename));
+    }
+  }
 }
 
 /**
- * Switches the current conversation topic to "display object".
+ * Starts hashing all of the game data in the background to find duplicated content.
  */
-void MainWindow::on_m_convTopicButtonDispObj_clicked()
+void MainWindow::on_actionFind_duplicate_data_triggered()
 {
-  m_currentConvTopic = ConvTopicCategory_DisplayObject;
-  populateConversationTopicTable();
+  if (!m_dedup.isRunning())
+  {
+    const int entryCount = m_dedup.start();
+    if (entryCount == 0)
+    {
+      QMessageBox::information(this, "Find duplicate data", "There is no game data loaded.");
+    }
+    else
+    {
+      if (!m_dedupProgress)
+      {
+        m_dedupProgress = new QProgressDialog(this);
+        m_dedupProgress->setWindowTitle("Find duplicate data");
+        m_dedupProgress->setLabelText("Hashing game data...");
+        m_dedupProgress->setWindowModality(Qt::WindowModal);
+        m_dedupProgress->setAutoReset(false);
+        m_dedupProgress->setAutoClose(false);
+        connect(m_dedupProgress, &QProgressDialog::canceled, &m_dedup, &DedupAnalyzer::cancel);
+      }
+
+      m_dedupProgress->setRange(0, entryCount);
+      m_dedupProgress->setValue(0);
+      m_dedupProgress->show();
+    }
+  }
 }
 
-/**
- * Switches the current conversation topic to "give object".
- */
-void MainWindow::on_m_convTopicButtonGiveObj_clicked()
+void MainWindow::onDedupProgress(int completed, int total)
 {
-  m_currentConvTopic = ConvTopicCategory_GiveObject;
-  populateConversationTopicTable();
+  Q_UNUSED(total)
+
+  if (m_dedupProgress)
+  {
+    m_dedupProgress->setValue(completed);
+  }
 }
 
 /**
- * Switches the current conversation topic to "give fact".
+ * Closes the progress dialog and displays the duplication report.
  */
-void MainWindow::on_m_convTopicButtonGiveFact_clicked()
+void MainWindow::onDedupFinished(bool cancelled)
 {
-  m_currentConvTopic = ConvTopicCategory_GiveFact;
-  populateConversationTopicTable();
+  if (m_dedupProgress)
+  {
+    m_dedupProgress->reset();
+    m_dedupProgress->hide();
+  }
+
+  if (!cancelled)
+  {
+    const QString report = m_dedup.index().report();
+    QMessageBox box(QMessageBox::Information, "Find duplicate data", report.section("\n\n", 0, 0), QMessageBox::Ok, this);
+    box.setDetailedText(report);
+    box.exec();
+  }
 }
 
 /**
- * Switches the current conversation topic to "sees item".
+ * Starts exploring the conversations in the background to find the content that the
+ * player can reach through them.
  */
-void MainWindow::on_m_convTopicButtonSeesItem_clicked()
+void MainWindow::on_actionFind_unreachable_content_triggered()
 {
-  m_currentConvTopic = ConvTopicCategory_SeesObject;
-  populateConversationTopicTable();
+  if (!m_reachability.isRunning())
+  {
+    const ReachabilitySeed seed = gatherReachabilitySeed();
+    if (seed.alienRaces.isEmpty())
+    {
+      QMessageBox::information(this, "Find unreachable content", "There is no game data loaded.");
+    }
+    else
+    {
+      if (!m_reachProgress)
+      {
+        m_reachProgress = new QProgressDialog(this);
+        m_reachProgress->setWindowTitle("Find unreachable content");
+        m_reachProgress->setLabelText("Exploring conversations...");
+        m_reachProgress->setWindowModality(Qt::WindowModal);
+        m_reachProgress->setAutoReset(false);
+        m_reachProgress->setAutoClose(false);
+        connect(m_reachProgress, &QProgressDialog::canceled, &m_reachability, &ReachabilityExplorer::cancel);
+      }
+
+      // the number of levels is not known in advance, so the dialog only shows activity
+      m_reachProgress->setRange(0, 0);
+      m_reachProgress->show();
+      m_reachability.start(seed);
+    }
+  }
 }
 
 /**
- * Responds to the "show only interesting topics" checkbox being checked or unchecked
- * by applying or removing a filter on the conversation topic list box.
+ * Closes the progress dialog and displays the reachability report.
  */
-void MainWindow::on_m_convFilterTopicsCheckbox_stateChanged(int arg1)
+void MainWindow::onReachabilityFinished(bool cancelled)
 {
-  Q_UNUSED(arg1)
-  populateConversationTopicTable();
+  if (m_reachProgress)
+  {
+    m_reachProgress->reset();
+    m_reachProgress->hide();
+  }
+
+  const ReachabilityResultPtr result = m_reachability.result();
+  if (!cancelled && result)
+  {
+    const QString report = result->report();
+    QMessageBox box(QMessageBox::Information, "Find unreachable content", report.section("\n\n", 0, 0), QMessageBox::Ok, this);
+    box.setDetailedText(report);
+    box.exec();
+  }
 }
 
 /**
- * Populates the list widget with the topics for the provided category. The topicList parameter provides
- * a comprehensive list of all possible topics in the category, but only a subset may actually be added
- * to the list, depending on whether an alien is selected or the show-only-interesting-dialogue checkbox
- * is checked.
+ * Gathers the starting conditions for a reachability exploration from the data tables.
+ * Every alien may be spoken to, but only the aliens that are present in the initial game
+ * state (piloting a ship or representing a place) are known from the start, along with
+ * their races; any others must be learned through conversation. Objects that are flagged
+ * as known by the player at the start are known from the start.
  */
-void MainWindow::populateTopicTableForCategory(ConvTopicCategory category, QMap<int, QString> topicList, int lastSelectedTopicId)
+ReachabilitySeed MainWindow::gatherReachabilitySeed()
 {
-  const int currentAlienRow = ui->m_convAlienTable->currentRow();
-  const QTableWidgetItem* const selectedAlienItem = ui->m_convAlienTable->item(currentAlienRow, 0);
-  const int alienId = (selectedAlienItem) ? (selectedAlienItem->text().toInt()) : 0;
+  ReachabilitySeed seed;
+  ReachItem item;
+  QSet<int> startingAliens;
+  QSet<int> startingRaces;
 
-  // we will show all topics for the selected topic category if either:
-  // (a) no alien is selected in the first list box, or
-  // (b) the user has deselected the checkbox that filters the list down to the interesting topics
-  const bool alwaysAddAllTopics = ((alienId == 0) || (ui->m_convFilterTopicsCheckbox->checkState() == Qt::Unchecked));
+  for (const Ship& s : m_ships.getList())
+  {
+    startingAliens.insert(s.pilot);
+  }
+  for (const Place& p : m_places.getPlaceList())
+  {
+    startingAliens.insert(p.representativeId);
+  }
 
-  foreach (int topicId, topicList.keys())
+  item.type = ReachItemType::Alien;
+  for (const Alien& a : m_aliens.getList())
   {
-    if (alwaysAddAllTopics || m_convText.doesInterestingDialogExist(alienId, category, topicId))
+    item.id = a.id;
+    seed.alienRaces.insert(a.id, static_cast<int>(a.race));
+    if (startingAliens.contains(a.id))
     {
-      const int rowcount = ui->m_convTopicTable->rowCount();
+      seed.knownItems.append(item);
+      startingRaces.insert(static_cast<int>(a.race));
+    }
+    seed.allItems.append(item);
+    seed.names.insert(item, a.name);
+  }
 
-      ui->m_convTopicTable->insertRow(rowcount);
-      ui->m_convTopicTable->setItem(rowcount, 0, new TableNumberItem(QString("%1").arg(topicId)));
-      ui->m_convTopicTable->setItem(rowcount, 1, new QTableWidgetItem(topicList[topicId]));
+  item.type = ReachItemType::Race;
+  for (int race = 0; race < static_cast<int>(AlienRace::NumRaces); race++)
+  {
+    item.id = race;
+    if (startingRaces.contains(race))
+    {
+      seed.knownItems.append(item);
     }
+    seed.allItems.append(item);
+    seed.names.insert(item, s_raceNames.value(static_cast<AlienRace>(race)));
   }
-  ui->m_convTopicTable->resizeColumnToContents(0);
-  ui->m_convTopicTable->resizeRowsToContents();
 
-  clearDialogLineAndCommandList();
+  item.type = ReachItemType::Fact;
+  for (const Fact& f : m_facts.getList())
+  {
+    item.id = f.id;
+    seed.allItems.append(item);
+    seed.names.insert(item, f.text.left(40));
+  }
 
-  // search through the rows to find one with the topic ID matching the previously selected topic ID;
-  // if such a row is found, select it
-  if (lastSelectedTopicId >= 0)
+  item.type = ReachItemType::Place;
+  for (const Place& p : m_places.getPlaceList())
   {
-    bool foundMatchingRow = false;
-    int rowId = 0;
-    const int rowCount = ui->m_convTopicTable->rowCount();
+    item.id = p.id;
+    seed.allItems.append(item);
+    seed.names.insert(item, p.name);
+  }
 
-    while (!foundMatchingRow && (rowId < rowCount))
+  for (const InventoryObj& obj : m_invObject.getList())
+  {
+    item.id = obj.id;
+    item.type = ReachItemType::Object;
+    if (obj.knownByPlayer)
     {
-      const QTableWidgetItem* const currentIdItem = ui->m_convTopicTable->item(rowId, 0);
-      if (currentIdItem && (currentIdItem->text().toInt() == lastSelectedTopicId))
-      {
-        foundMatchingRow = true;
-        ui->m_convTopicTable->selectRow(rowId);
-      }
-      rowId++;
+      seed.knownItems.append(item);
     }
+    seed.allItems.append(item);
+    seed.names.insert(item, obj.name);
+
+    item.type = ReachItemType::HeldObject;
+    seed.names.insert(item, obj.name);
   }
+
+  return seed;
 }
 
 /**
- * Populates the table of specific conversation topics, given the currently selected topic category.
- * Note that two categories -- Greeting/Initial and Greeting/Subsequent -- do not require the selection
- * of a specific topic, and they will not trigger the population of the table.
- *
- * If the parameter (the previously selected topic ID) is not negative, then automatically
- * select the row in the repopulated table with the same ID, if one exists.
+ * Starts building the text search index and the embedded command cross-reference on
+ * worker threads.
  */
-void MainWindow::populateConversationTopicTable(int lastSelectedTopicId)
+void MainWindow::startTextIndexing()
 {
-  ui->m_convTopicTable->setRowCount(0);
+  const TextSearchOwners owners = gatherTextOwners();
 
-  if (m_currentConvTopic == ConvTopicCategory_AskAboutPerson)
+  ui->m_searchStatusLabel->setText("Indexing game text...");
+  m_textSearch.start(owners);
+  m_cmdXref.start(owners);
+}
+
+/**
+ * Gathers the owners of the text strings from the data tables. GAMETEXT strings are
+ * attributed to the first table entry whose name or text they match.
+ */
+TextSearchOwners MainWindow::gatherTextOwners()
+{
+  TextSearchOwners owners;
+  TextSearchTarget target;
+  target.raceId = -1;
+  target.topic = ConvTopicCategory_GreetingInitial;
+  target.thingId = -1;
+
+  target.type = TextSearchTargetType::Fact;
+  for (const Fact& f : m_facts.getList())
   {
-    const QMap<int,Alien> aliens = m_aliens.getList();
-    QMap<int,QString> alienNames;
-    foreach (Alien a, aliens.values())
+    target.id = f.id;
+    if (!owners.gameTextOwners.contains(f.text))
     {
-      alienNames.insert(a.id, a.name);
+      owners.gameTextOwners.insert(f.text, target);
     }
-    populateTopicTableForCategory(m_currentConvTopic, alienNames, lastSelectedTopicId);
   }
-  else if (m_currentConvTopic == ConvTopicCategory_AskAboutLocation)
+
+  target.type = TextSearchTargetType::Place;
+  for (const Place& p : m_places.getPlaceList())
   {
-    const QMap<int,Place> places = m_places.getPlaceList();
-    QMap<int,QString> placeNames;
-    foreach (Place p, places.values())
+    target.id = p.id;
+    if (!owners.gameTextOwners.contains(p.name))
     {
-      placeNames.insert(p.id, p.name);
+      owners.gameTextOwners.insert(p.name, target);
     }
-    populateTopicTableForCategory(m_currentConvTopic, placeNames, lastSelectedTopicId);
   }
-  else if ((m_currentConvTopic == ConvTopicCategory_AskAboutObject) ||
-           (m_currentConvTopic == ConvTopicCategory_GiveObject)     ||
-           (m_currentConvTopic == ConvTopicCategory_DisplayObject)  ||
-           (m_currentConvTopic == ConvTopicCategory_SeesObject))
+
+  target.type = TextSearchTargetType::Alien;
+  for (const Alien& a : m_aliens.getList())
   {
-    const QMap<int,InventoryObj> objs = m_invObject.getList();
-    QMap<int,QString> objectNames;
-    foreach (InventoryObj obj, objs.values())
+    target.id = a.id;
+    if (!owners.gameTextOwners.contains(a.name))
     {
-      objectNames.insert(obj.id, obj.name);
+      owners.gameTextOwners.insert(a.name, target);
     }
-    populateTopicTableForCategory(m_currentConvTopic, objectNames, lastSelectedTopicId);
   }
-  else if (m_currentConvTopic == ConvTopicCategory_AskAboutRace)
+
+  target.type = TextSearchTargetType::Object;
+  for (const InventoryObj& obj : m_invObject.getList())
   {
-    QMap<int,QString> raceNames;
-    for (int raceId = 0; raceId < static_cast<int>(AlienRace::NumRaces); raceId++)
+    target.id = obj.id;
+    if (!owners.gameTextOwners.contains(obj.name))
     {
-      const AlienRace race = static_cast<AlienRace>(raceId);
-      raceNames.insert(raceId, s_raceNames[race]);
+      owners.gameTextOwners.insert(obj.name, target);
+    }
+    if ((obj.type == InventoryObjType::NormalWithText) && !owners.objectTextOwners.contains(obj.subtype))
+    {
+      owners.objectTextOwners.insert(obj.subtype, obj.id);
     }
-    populateTopicTableForCategory(m_currentConvTopic, raceNames, lastSelectedTopicId);
   }
-  else if (m_currentConvTopic == ConvTopicCategory_GiveFact)
+
+  target.type = TextSearchTargetType::Ship;
+  for (const Ship& ship : m_ships.getList())
   {
-    const QMap<int,Fact> facts = m_facts.getList();
-    QMap<int,QString> factText;
-    foreach (Fact f, facts.values())
+    target.id = ship.id;
+    if (!owners.gameTextOwners.contains(ship.name))
     {
-      factText.insert(f.id, f.text);
+      owners.gameTextOwners.insert(ship.name, target);
     }
-    populateTopicTableForCategory(m_currentConvTopic, factText, lastSelectedTopicId);
   }
-  else if ((m_currentConvTopic == ConvTopicCategory_GreetingInitial) ||
-           (m_currentConvTopic == ConvTopicCategory_GreetingSubsequent))
+
+  const DenseIdTable<Mission>& missions = m_missions.getList();
+  for (DenseIdTable<Mission>::const_iterator it = missions.constBegin(); it != missions.constEnd(); ++it)
   {
-    getConversationLinesForCurrentTopic();
+    owners.missionTextOwners.insert(it->startTextIndex, it.key());
+    owners.missionTextOwners.insert(it->completeTextIndex, it.key());
   }
+
+  return owners;
 }
 
 /**
- * Responds to the selection of a row in the conversation topic table.
+ * Reports the size of the newly built search index, and repeats the current search
+ * (if any) so that its results reflect the new data.
  */
-void MainWindow::on_m_convTopicTable_currentCellChanged(int currentRow, int currentColumn, int previousRow, int previousColumn)
+void MainWindow::onTextSearchIndexFinished(bool cancelled)
 {
-  Q_UNUSED(currentColumn)
-  Q_UNUSED(previousRow)
-  Q_UNUSED(previousColumn)
+  const TextSearchIndexPtr index = m_textSearch.index();
 
-  if (currentRow >= 0)
+  if (!cancelled && index)
   {
-    getConversationLinesForCurrentTopic();
+    ui->m_searchStatusLabel->setText(QString("Indexed %1 terms in %2 strings.")
+                                     .arg(index->termCount()).arg(index->documentCount()));
+    if (!ui->m_searchEdit->text().trimmed().isEmpty())
+    {
+      runTextSearch();
+    }
   }
 }
 
+void MainWindow::on_m_searchEdit_textChanged(const QString& text)
+{
+  Q_UNUSED(text)
+  runTextSearch();
+}
+
 /**
- * Loads any conversation text that is applicable to the currently selected alien and conversation topic.
+ * Searches the text index for the contents of the search box and fills the result table
+ * with the ranked hits.
  */
-void MainWindow::getConversationLinesForCurrentTopic()
+void MainWindow::runTextSearch()
 {
-  const int currentAlienRow = ui->m_convAlienTable->currentRow();
-  const int currentTopicRow = ui->m_convTopicTable->currentRow();
+  const TextSearchIndexPtr index = m_textSearch.index();
+  const QString query = ui->m_searchEdit->text();
 
-  const QTableWidgetItem* const selectedAlienItem = ui->m_convAlienTable->item(currentAlienRow, 0);
-  const QTableWidgetItem* const selectedTopicItem = ui->m_convTopicTable->item(currentTopicRow, 0);
+  ui->m_searchResultTable->setRowCount(0);
+  m_searchHits.clear();
 
-  const int alienId = (selectedAlienItem) ? (selectedAlienItem->text().toInt()) : 0;
-  const int thingId = (selectedTopicItem) ? (selectedTopicItem->text().toInt()) : 0;
+  if (!index || query.trimmed().isEmpty())
+  {
+    return;
+  }
 
-  // certain conversation topic categories do not require a topic ID greater than zero
-  const bool thingIdOfZeroAllowed = (m_currentConvTopic == ConvTopicCategory_AskAboutRace) ||
-                                    (m_currentConvTopic == ConvTopicCategory_GreetingInitial) ||
-                                    (m_currentConvTopic == ConvTopicCategory_GreetingSubsequent);
+  QElapsedTimer timer;
+  timer.start();
+  m_searchHits = index->search(query);
+  const qint64 searchMs = timer.elapsed();
 
-  if ((alienId > 0) && ((thingId > 0) || thingIdOfZeroAllowed))
+  ui->m_searchResultTable->setRowCount(m_searchHits.size());
+  for (int row = 0; row < m_searchHits.size(); row++)
   {
-    QVector<QPair<GTxtCmd,int> > embeddedCommands;
-    QString currentConvLine = m_convText.getConversationText(alienId, m_currentConvTopic, thingId, embeddedCommands);
+    const TextSearchHit& hit = m_searchHits[row];
+    const TextSearchDocument& doc = index->document(hit.document);
 
-    clearDialogLineAndCommandList();
-    ui->m_convDialogueLine->setHtml(currentConvLine);
+    // show the matched text with some context on either side
+    const int contextStart = qMax(0, hit.charOffset - 40);
+    QString excerpt = doc.text.mid(contextStart, (hit.charOffset - contextStart) + hit.length + 80).simplified();
+    if (contextStart > 0)
+    {
+      excerpt.prepend("...");
+    }
+    if ((hit.charOffset + hit.length + 80) < doc.text.size())
+    {
+      excerpt.append("...");
+    }
 
-    // populate the table to display the details of the commands embedded in this dialogue line
-    populateGameTextCommandList(ui->m_convCommandList, embeddedCommands);
+    QTableWidgetItem* sourceItem = new QTableWidgetItem(QString("%1 @ 0x%2").arg(doc.filename).arg(doc.offset, 0, 16));
+    sourceItem->setData(Qt::UserRole, row);
+    ui->m_searchResultTable->setItem(row, 0, sourceItem);
+    ui->m_searchResultTable->setItem(row, 1, new QTableWidgetItem(describeSearchTarget(doc.target)));
+    ui->m_searchResultTable->setItem(row, 2, new QTableWidgetItem(excerpt));
   }
+  ui->m_searchResultTable->resizeColumnToContents(0);
+  ui->m_searchResultTable->resizeColumnToContents(1);
+
+  ui->m_searchStatusLabel->setText(QString("%1 matches (%2 ms)").arg(m_searchHits.size()).arg(searchMs));
 }
 
 /**
- * Get the human-readable name for the person/place/thing/fact described by the combination of
- * command byte and parameter ID.
+ * Returns a short description of the thing that owns a piece of text.
  */
-QString MainWindow::getNameForGameTextCommandParameter(GTxtCmd cmd, int param)
+QString MainWindow::describeSearchTarget(const TextSearchTarget& target)
 {
-  QString name;
+  QString desc;
 
-  if ((cmd == GTxtCmd_AddItem) || (cmd == GTxtCmd_GrantKnowledgeObject))
+  if (target.type == TextSearchTargetType::Fact)
   {
-    name = m_invObject.getName(param);
+    desc = QString("Fact %1").arg(target.id);
   }
-  else if ((cmd == GTxtCmd_GrantKnowledgeAlien) || (cmd == GTxtCmd_AStateTableModifyB))
+  else if (target.type == TextSearchTargetType::Place)
   {
-    name = m_aliens.getName(param);
+    desc = QString("Place: %1").arg(m_places.getName(target.id));
   }
-  else if (cmd == GTxtCmd_GrantKnowledgeRace)
+  else if (target.type == TextSearchTargetType::Alien)
   {
-    const AlienRace race = static_cast<AlienRace>(param);
-    name = s_raceNames.contains(race) ? s_raceNames[race] : "(invalid)";
+    desc = QString("Alien: %1").arg(m_aliens.getName(target.id));
   }
-  else if ((cmd == GTxtCmd_GrantKnowledgePlace) || (cmd == GTxtCmd_StorePlaceIDInSetupTable))
+  else if (target.type == TextSearchTargetType::Object)
   {
-    name = m_places.getName(param);
+    desc = QString("Object: %1").arg(m_invObject.getName(target.id));
   }
-  else if (cmd == GTxtCmd_StoreShipIDInSetupTab)
+  else if (target.type == TextSearchTargetType::Ship)
   {
-    name = m_ships.getName(param);
+    desc = QString("Ship: %1").arg(m_ships.getName(target.id));
   }
-  else if (cmd == GTxtCmd_GrantKnowledgeFact)
+  else if (target.type == TextSearchTargetType::Mission)
   {
-    name = m_facts.getFact(param).text;
+    desc = QString("Mission %1").arg(target.id);
   }
-  else if (cmd == GTxtCmd_ModifyEncountRelate)
+  else if (target.type == TextSearchTargetType::Conversation)
   {
-    const uint8_t byteA = (param & 0xFF);
-    const uint8_t byteB = (param >> 8);
-    const AlienRace race = static_cast<AlienRace>(byteA);
-    const QString raceName = s_raceNames.contains(race) ? s_raceNames[race] : "(invalid)";
-    name = QString("%1: %2").arg(raceName).arg(byteB);
+    const AlienRace race = static_cast<AlienRace>(target.raceId);
+    desc = (target.id >= 0) ? m_aliens.getName(target.id) :
+                              QString("%1 (race)").arg(s_raceNames.value(race, "(invalid/unknown)"));
+
+    const QRadioButton* topicButton = convTopicButton(target.topic);
+    if ((target.thingId >= 0) && topicButton)
+    {
+      desc += QString(" / %1").arg(topicButton->text());
+      if ((target.topic != ConvTopicCategory_GreetingInitial) &&
+          (target.topic != ConvTopicCategory_GreetingSubsequent))
+      {
+        desc += QString(" %1").arg(target.thingId);
+      }
+    }
   }
 
-  return name;
+  return desc;
 }
 
 /**
- * Clears the box showing the current line of dialogue, and clears the table that
- * shows all the embedded commands in that dialogue.
+ * Responds to a search result being double-clicked by showing the thing that owns its text.
  */
-void MainWindow::clearDialogLineAndCommandList()
+void MainWindow::on_m_searchResultTable_cellDoubleClicked(int row, int column)
 {
-  ui->m_convDialogueLine->clear();
-  ui->m_convDialogueLine->clearHistory();
-  ui->m_convCommandList->setRowCount(0);
+  Q_UNUSED(column)
+
+  const TextSearchIndexPtr index = m_textSearch.index();
+  const QTableWidgetItem* const sourceItem = ui->m_searchResultTable->item(row, 0);
+
+  if (index && sourceItem)
+  {
+    const int hitIndex = sourceItem->data(Qt::UserRole).toInt();
+    if ((hitIndex >= 0) && (hitIndex < m_searchHits.size()))
+    {
+      jumpToSearchTarget(index->document(m_searchHits[hitIndex].document).target);
+    }
+  }
 }
 
 /**
- * Responds to one of the conversation text synonyms being clicked by displaying a tooltip with
- * the alternatives from which the game randomly selects. The list of synonyms is sent from the
- * QTextBrowser to this slot by encoding them in a URL.
+ * Switches to the tab that displays the provided search target and selects it. Lines of
+ * generic race dialogue are shown for the first alien of that race.
  */
-void MainWindow::on_m_convDialogueLine_anchorClicked(const QUrl& arg1)
+void MainWindow::jumpToSearchTarget(const TextSearchTarget& target)
 {
-  showAnchorTooltip(arg1);
+  if (target.type == TextSearchTargetType::Fact)
+  {
+    ui->m_tabs->setCurrentWidget(ui->m_tabFacts);
+    selectTableRowById(ui->m_factTable, target.id);
+  }
+  else if (target.type == TextSearchTargetType::Place)
+  {
+    ui->m_tabs->setCurrentWidget(ui->m_tabPlaces);
+    selectTableRowById(ui->m_placeTable, target.id);
+  }
+  else if (target.type == TextSearchTargetType::Alien)
+  {
+    ui->m_tabs->setCurrentWidget(ui->m_tabAliens);
+    selectTableRowById(ui->m_alienTable, target.id);
+  }
+  else if (target.type == TextSearchTargetType::Object)
+  {
+    ui->m_tabs->setCurrentWidget(ui->m_tabObjects);
+    selectTableRowById(ui->m_objTable, target.id);
+  }
+  else if (target.type == TextSearchTargetType::Ship)
+  {
+    ui->m_tabs->setCurrentWidget(ui->m_tabShips);
+    selectTableRowById(ui->m_shipTable, target.id);
+  }
+  else if (target.type == TextSearchTargetType::Mission)
+  {
+    ui->m_tabs->setCurrentWidget(ui->m_tabMissions);
+    ui->m_missionIdSpinBox->setValue(target.id);
+  }
+  else if (target.type == TextSearchTargetType::Conversation)
+  {
+    int alienId = target.id;
+    if (alienId < 0)
+    {
+      const DenseIdTable<Alien>& aliens = m_aliens.getList();
+      for (DenseIdTable<Alien>::const_iterator it = aliens.constBegin(); (alienId < 0) && (it != aliens.constEnd()); ++it)
+      {
+        if (static_cast<int>(it.value().race) == target.raceId)
+        {
+          alienId = it.key();
+        }
+      }
+    }
+
+    ui->m_tabs->setCurrentWidget(ui->m_convTab);
+
+    // the topic category is switched before the alien is selected, so that the topic
+    // table is only rebuilt for the new combination
+    QRadioButton* topicButton = convTopicButton(target.topic);
+    if ((target.thingId >= 0) && topicButton)
+    {
+      topicButton->setChecked(true);
+      m_currentConvTopic = target.topic;
+    }
+
+    if (selectTableRowById(ui->m_convAlienTable, alienId) && (target.thingId >= 0))
+    {
+      ui->m_convTopicFilterEdit->clear();
+      populateConversationTopicTable(target.thingId);
+    }
+  }
 }
 
 /**
- * Responds to the stamp roll slider being moved by displaying the stamp at the selected index.
+ * Selects the row in the provided record table that shows the record with the provided ID.
+ * If the row is hidden by the table's filter, the filter is cleared first.
+ * @return True if such a row was found; false otherwise.
  */
-void MainWindow::on_m_stampRollSlider_valueChanged(int value)
+bool MainWindow::selectTableRowById(QTableView* view, int id)
 {
-  displayStamp(value);
+  QAbstractItemModel* model = view->model();
+  QModelIndexList matches = model->match(model->index(0, 0), RECORD_ID_ROLE, id, 1, Qt::MatchExactly);
+
+  QLineEdit* filter = recordTableFilter(view);
+  if (matches.isEmpty() && filter && !filter->text().isEmpty())
+  {
+    filter->clear();
+    matches = model->match(model->index(0, 0), RECORD_ID_ROLE, id, 1, Qt::MatchExactly);
+  }
+
+  if (!matches.isEmpty())
+  {
+    view->setCurrentIndex(matches.first());
+    view->scrollTo(matches.first());
+  }
+
+  return !matches.isEmpty();
 }
 
 /**
- * Displays a single static image on the stamp/roll tab, based on the currently selected roll index.
+ * Connects each of the record tables to its model through a proxy that sorts and filters
+ * it, and connects the table's filter box to the proxy. The alien table of the conversation
+ * tab shares the alien tab's model, but not its sorting or filtering. Column sizing only
+ * measures the rows that are in view, so that it never walks a whole table.
  */
-void MainWindow::displayStamp(int rollIndex)
+void MainWindow::setupRecordTables()
 {
-  m_stampScene.clear();
-  if (m_stampImages.count() > rollIndex)
+  m_placeProxy.setSourceModel(&m_placeModel);
+  m_objProxy.setSourceModel(&m_objModel);
+  m_alienProxy.setSourceModel(&m_alienModel);
+  m_shipProxy.setSourceModel(&m_shipModel);
+  m_factProxy.setSourceModel(&m_factModel);
+  m_convAlienProxy.setSourceModel(&m_alienModel);
+  m_convTopicProxy.setSourceModel(&m_convTopicModel);
+
+  const QMap<QTableView*,QSortFilterProxyModel*> proxies =
   {
-    m_stampScene.addPixmap(QPixmap::fromImage(m_stampImages[rollIndex]));
-    ui->m_stampView->setScene(&m_stampScene);
+    { ui->m_placeTable,     &m_placeProxy },
+    { ui->m_objTable,       &m_objProxy },
+    { ui->m_alienTable,     &m_alienProxy },
+    { ui->m_shipTable,      &m_shipProxy },
+    { ui->m_factTable,      &m_factProxy },
+    { ui->m_convAlienTable, &m_convAlienProxy },
+    { ui->m_convTopicTable, &m_convTopicProxy }
+  };
+
+  foreach (QTableView* view, proxies.keys())
+  {
+    QSortFilterProxyModel* proxy = proxies[view];
+    proxy->setFilterKeyColumn(-1);
+    proxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
+    view->setModel(proxy);
+    view->sortByColumn(0, Qt::AscendingOrder);
+
+    // rows are never taller than a line of text, so a fixed height spares the view from
+    // measuring each one
+    view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    view->verticalHeader()->setDefaultSectionSize(view->verticalHeader()->minimumSectionSize());
+    view->horizontalHeader()->setResizeContentsPrecision(0);
+
+    connect(recordTableFilter(view), &QLineEdit::textChanged, proxy, &QSortFilterProxyModel::setFilterFixedString);
   }
+  ui->m_convAlienTable->setColumnHidden(AlienTableModel::s_raceColumn, true);
+
+  connect(ui->m_placeTable->selectionModel(), &QItemSelectionModel::currentRowChanged, this, &MainWindow::onPlaceRowChanged);
+  connect(ui->m_objTable->selectionModel(), &QItemSelectionModel::currentRowChanged, this, &MainWindow::onObjectRowChanged);
+  connect(ui->m_alienTable->selectionModel(), &QItemSelectionModel::currentRowChanged, this, &MainWindow::onAlienRowChanged);
+  connect(ui->m_shipTable->selectionModel(), &QItemSelectionModel::currentRowChanged, this, &MainWindow::onShipRowChanged);
+  connect(ui->m_factTable->selectionModel(), &QItemSelectionModel::currentRowChanged, this, &MainWindow::onFactRowChanged);
+  connect(ui->m_convAlienTable->selectionModel(), &QItemSelectionModel::currentRowChanged, this, &MainWindow::onConvAlienRowChanged);
+  connect(ui->m_convTopicTable->selectionModel(), &QItemSelectionModel::currentRowChanged, this, &MainWindow::onConvTopicRowChanged);
 }
 
 /**
- * Responds to a change in the currently selected mission ID by calling a routine to update
- * the mission information being displayed.
+ * Returns the filter box above the provided record table.
  */
-void MainWindow::on_m_missionIdSpinBox_valueChanged(int arg1)
+QLineEdit* MainWindow::recordTableFilter(QTableView* view)
 {
-  showInfoForMission(arg1);
+  const QMap<QTableView*,QLineEdit*> filters =
+  {
+    { ui->m_placeTable,     ui->m_placeFilterEdit },
+    { ui->m_objTable,       ui->m_objFilterEdit },
+    { ui->m_alienTable,     ui->m_alienFilterEdit },
+    { ui->m_shipTable,      ui->m_shipFilterEdit },
+    { ui->m_factTable,      ui->m_factFilterEdit },
+    { ui->m_convAlienTable, ui->m_convAlienFilterEdit },
+    { ui->m_convTopicTable, ui->m_convTopicFilterEdit }
+  };
+
+  return filters.value(view, nullptr);
 }
 
 /**
- * Populates the mission text widgets with information about the currently selected mission ID.
+ * Sets the embedded commands that each of the cross-reference panels looks for, and
+ * connects them so that double-clicking a reference shows the text that contains it.
  */
-void MainWindow::showInfoForMission(int id)
+void MainWindow::setupCommandXrefPanels()
 {
-  ui->m_missionStartText->clear();
-  ui->m_missionStartText->clearHistory();
-  ui->m_missionReqText->clear();
-  ui->m_missionReqText->clearHistory();
-  ui->m_missionEndText->clear();
-  ui->m_missionEndText->clearHistory();
-  ui->m_missionStartCommandList->setRowCount(0);
-  ui->m_missionEndCommandList->setRowCount(0);
+  ui->m_factXrefPanel->setCommands({ GTxtCmd_GrantKnowledgeFact });
+  ui->m_placeXrefPanel->setCommands({ GTxtCmd_GrantKnowledgePlace, GTxtCmd_StorePlaceIDInSetupTable });
+  ui->m_objXrefPanel->setCommands({ GTxtCmd_AddItem, GTxtCmd_GrantKnowledgeObject });
+  ui->m_missionXrefPanel->setCommands({ GTxtCmd_ModifyMissionTable });
 
-  QMap<int,Mission> missions = m_missions.getList();
-  if (missions.contains(id))
+  foreach (CommandXrefPanel* panel, QList<CommandXrefPanel*>({ ui->m_factXrefPanel, ui->m_placeXrefPanel,
+                                                               ui->m_objXrefPanel, ui->m_missionXrefPanel }))
   {
-    ui->m_missionStartText->setHtml(missions[id].startText);
-    ui->m_missionEndText->setHtml(missions[id].completeText);
-    populateGameTextCommandList(ui->m_missionStartCommandList, missions[id].startTextCommands);
-    populateGameTextCommandList(ui->m_missionEndCommandList,   missions[id].completeTextCommands);
-
-    if (missions[id].action == MissionActionType::None)
-    {
-      ui->m_missionReqText->setHtml("(No action required.)");
-    }
-    else if (missions[id].action == MissionActionType::DeliverItem)
-    {
-      const QString itemName = m_invObject.getName(missions[id].objectiveId);
-      ui->m_missionReqText->setHtml(QString("Deliver item: %1").arg(itemName));
-    }
-    else if (missions[id].action == MissionActionType::DestroyShip)
-    {
-      const QString shipName = m_ships.getName(missions[id].objectiveId);
-      ui->m_missionReqText->setHtml(QString("Destroy ship: %1").arg(shipName));
-    }
-    else
-    {
-      ui->m_missionReqText->setHtml(QString("Unknown action type %1, objective ID %2").arg(missions[id].missionActionRawVal).arg(missions[id].objectiveId));
-    }
+    connect(panel, &CommandXrefPanel::targetActivated, this, &MainWindow::jumpToSearchTarget);
   }
 }
 
 /**
- * Decodes the provided string into a list of game text alternate strings and displays
- * them in a tooltip at the current cursor position.
+ * Fills the provided cross-reference panel with every string whose embedded commands
+ * refer to the provided ID.
  */
-void MainWindow::showAnchorTooltip(const QUrl& url)
+void MainWindow::showCommandXrefs(CommandXrefPanel* panel, int id)
 {
-  const QString urlStr = url.toString(QUrl::DecodeReserved).replace("|", "\n").trimmed();
-  QToolTip::showText(QCursor::pos(), urlStr);
+  if (m_cmdXref.isRunning())
+  {
+    panel->setUnavailable("(still scanning...)");
+  }
+  else
+  {
+    QVector<CommandXrefEntry> entries;
+    QStringList locations;
+
+    foreach (GTxtCmd cmd, panel->commands())
+    {
+      entries += m_cmdXref.index().find(cmd, id);
+    }
+    foreach (const CommandXrefEntry& entry, entries)
+    {
+      locations.append(describeSearchTarget(entry.owner));
+    }
+
+    panel->setEntries(id, entries, locations);
+  }
 }
 
 /**
- * Populates cells in a three-column QTableWidget with the information contained in the supplied
- * list of gametext commands.
+ * Refreshes the cross-reference panels once the scan of the embedded commands is done.
  */
-void MainWindow::populateGameTextCommandList(QTableWidget* table, QVector<QPair<GTxtCmd,int> >& commands)
+void MainWindow::onCommandXrefFinished(bool cancelled)
 {
-  // populate the table to display the details of the commands embedded in this dialogue line
-  QPair<GTxtCmd,int> cmdPair;
-  foreach (cmdPair, commands)
+  if (!cancelled)
   {
-    const GTxtCmd command = cmdPair.first;
-    const int param = cmdPair.second;
-
-    const int rowcount = table->rowCount();
-
-    table->insertRow(rowcount);
-    table->setItem(rowcount, 0, new QTableWidgetItem(g_gameTextCommandName[command]));
-
-    // the command ModifyEncountRelate is a special case
-    // in that it takes two 8-bit parameters
-    if (command == GTxtCmd_ModifyEncountRelate)
-    {
-      const uint8_t byteA = (param & 0xFF);
-      const uint8_t byteB = (param >> 8);
-      const QString twoParamStr = QString("%1, %2").arg(byteA).arg(byteB);
-      table->setItem(rowcount, 1, new QTableWidgetItem(twoParamStr));
-    }
-    else
+    const QMap<CommandXrefPanel*,QTableView*> panels =
     {
-      table->setItem(rowcount, 1, new QTableWidgetItem(QString("%1").arg(param)));
-    }
+      { ui->m_factXrefPanel,  ui->m_factTable },
+      { ui->m_placeXrefPanel, ui->m_placeTable },
+      { ui->m_objXrefPanel,   ui->m_objTable }
+    };
 
-    const QString paramName = getNameForGameTextCommandParameter(command, param);
-    if (!paramName.isEmpty())
+    foreach (CommandXrefPanel* panel, panels.keys())
     {
-      table->setItem(rowcount, 2, new QTableWidgetItem(paramName));
+      const int id = recordIdAt(panels[panel]->currentIndex());
+      if (id >= 0)
+      {
+        showCommandXrefs(panel, id);
+      }
     }
-  }
 
-  table->resizeColumnToContents(0);
-  table->resizeColumnToContents(1);
-  table->resizeRowsToContents();
+    showCommandXrefs(ui->m_missionXrefPanel, ui->m_missionIdSpinBox->value());
+  }
 }
 
 /**
- * Displays tooltip with list of synonyms from metatext in mission start text.
+ * Returns the radio button that selects the provided conversation topic category.
  */
-void MainWindow::on_m_missionStartText_anchorClicked(const QUrl& arg1)
+QRadioButton* MainWindow::convTopicButton(ConvTopicCategory topic)
 {
-  showAnchorTooltip(arg1);
+  const QMap<ConvTopicCategory,QRadioButton*> buttons =
+  {
+    { ConvTopicCategory_GreetingInitial,    ui->m_convTopicButtonGreeting0 },
+    { ConvTopicCategory_GreetingSubsequent, ui->m_convTopicButtonGreeting1 },
+    { ConvTopicCategory_AskAboutPerson,     ui->m_convTopicButtonPerson },
+    { ConvTopicCategory_AskAboutLocation,   ui->m_convTopicButtonPlace },
+    { ConvTopicCategory_AskAboutObject,     ui->m_convTopicButtonObject },
+    { ConvTopicCategory_AskAboutRace,       ui->m_convTopicButtonRace },
+    { ConvTopicCategory_DisplayObject,      ui->m_convTopicButtonDispObj },
+    { ConvTopicCategory_GiveObject,         ui->m_convTopicButtonGiveObj },
+    { ConvTopicCategory_GiveFact,           ui->m_convTopicButtonGiveFact },
+    { ConvTopicCategory_SeesObject,         ui->m_convTopicButtonSeesItem }
+  };
+
+  return buttons.value(topic, nullptr);
 }
 
 /**
- * Displays tooltip with list of synonyms from metatext in mission end text.
+ * Loads and displays one of the fullscreen LBM images.
  */
-void MainWindow::on_m_missionEndText_anchorClicked(const QUrl& arg1)
+void MainWindow::on_m_fullscreenTree_currentItemChanged(QTreeWidgetItem* current, QTreeWidgetItem* previous)
 {
-  showAnchorTooltip(arg1);
+  Q_UNUSED(previous)
+  m_fullscreenScene.clear();
+  m_fullscreenImage = QImage();
+
+  if (current)
+  {
+    const QString lbmFilename = current->text(0);
+    if (current->parent())
+    {
+      const QString datFilename = current->parent()->text(0);
+      const DatFileType dat = DatLibrary::s_datFileNames.key(datFilename);
+
+      QVector<QRgb> tempPal;
+      const QString paletteFilename = m_fullscreenImages.getPalette(dat, lbmFilename, tempPal);
+      ui->m_fullscreenPaletteName->setText(QString("Displaying with palette: ") + paletteFilename);
+
+      if (m_fullscreenImages.getImage(dat, lbmFilename, m_fullscreenImage))
+      {
+        showImage(m_fullscreenScene, ui->m_fullscreenView, m_fullscreenImage, FULLSCREEN_VIEW_SCALE);
+      }
+    }
+    ui->m_fullscreenView->setScene(&m_fullscreenScene);
+  }
 }
 
 /**
- * Reponds to a 3D model filename being selected by loading the model's
- * data into the 3D viewer and displaying its informational text
- * in the associated box.
+ * Responds to an item being selected in the tree of stamp/roll images.
  */
-void MainWindow::on_m_3dModelTree_currentItemChanged(QTreeWidgetItem* current, QTreeWidgetItem* previous)
+void MainWindow::on_m_stampTree_currentItemChanged(QTreeWidgetItem* current, QTreeWidgetItem* previous)
 {
   Q_UNUSED(previous)
-
-  ui->m_3dModelViewer->clear();
-  ui->m_3dModelInfoText->clear();
-  reset3DView();
+  m_stampLoader.cancel();
+  m_stampScene.clear();
+  m_stampImages.clear();
 
   if (current)
   {
-    const QString binFilename = current->text(0);
+    const QString stampFilename = current->text(0);
     if (current->parent())
     {
       const QString datFilename = current->parent()->text(0);
       const DatFileType dat = DatLibrary::s_datFileNames.key(datFilename);
+      QImage firstImage;
+      int imageCount = 0;
 
-      QByteArray binData;
-      if (m_lib.getFileByName(dat, binFilename, binData))
+      // only the first image is decoded before this returns; any others in
+      // the roll are filled in by onStampImageReady() as they are finished
+      const bool status = m_stampLoader.load(dat, stampFilename, firstImage, imageCount);
+
+      ui->m_stampRollSlider->setEnabled(status);
+      ui->m_stampRollSlider->setValue(0);
+      if (status)
       {
-        QString modelInfo;
-        ui->m_3dModelViewer->loadData(binData, modelInfo);
-        ui->m_3dModelInfoText->setText(modelInfo);
+        for (int rollIndex = 0; rollIndex < imageCount; rollIndex++)
+        {
+          m_stampImages.append(QImage());
+        }
+        m_stampImages[0] = firstImage;
+
+        ui->m_stampRollSlider->setMaximum(imageCount - 1);
+        displayStamp(0);
       }
       else
       {
-        ui->m_3dModelInfoText->setHtml(QString("<b>Error:</b> Could not load '%1'").arg(binFilename));
+        ui->m_stampRollSlider->setMaximum(0);
       }
     }
   }
 }
 
 /**
- * Increment the rotation value for all of the 3D model axes whose rotation button is checked.
+ * Stores an image from the current stamp roll that was decoded in the background,
+ * and displays it if the roll slider is already waiting on it.
  */
-void MainWindow::onTimer()
+void MainWindow::onStampImageReady(int rollIndex, QImage image)
 {
-  if (ui->m_3dSpinXButton->isChecked())
-  {
-    ui->m_3dModelViewer->incrementXRotation();
-  }
-  if (ui->m_3dSpinYButton->isChecked())
-  {
-    ui->m_3dModelViewer->incrementYRotation();
-  }
-  if (ui->m_3dSpinZButton->isChecked())
+  if (rollIndex < m_stampImages.count())
   {
-    ui->m_3dModelViewer->incrementZRotation();
+    m_stampImages[rollIndex] = image;
+    if (ui->m_stampRollSlider->value() == rollIndex)
+    {
+      displayStamp(rollIndex);
+    }
   }
 }
 
 /**
- * Start the 3D model rotation timer if any of the rotation buttons are checked,
- * and stop the timer if none of them are checked.
+ * Responds to a row being selected in the alien table of the conversation text tab.
  */
-void MainWindow::timerControl()
+void MainWindow::onConvAlienRowChanged(const QModelIndex& current)
 {
-  if (ui->m_3dSpinXButton->isChecked() ||
-      ui->m_3dSpinYButton->isChecked() ||
-      ui->m_3dSpinZButton->isChecked())
-  {
-    m_timer.start();
-  }
-  else
-  {
-    m_timer.stop();
-  }
+  Q_UNUSED(current)
+
+  clearDialogLineAndCommandList();
+
+  // We're going to repopulate the list of conversation topics for the currently selected alien and topic
+  // category. Before we do, save the ID of the last topic selected by the user so that we can auto-select
+  // it in the newly repopulated table *if* that topic is one of interest for the newly selected alien.
+  const int lastSelectedTopicId = recordIdAt(ui->m_convTopicTable->currentIndex());
+
+  populateConversationTopicTable(lastSelectedTopicId);
 }
 
 /**
- * Calls a routine to start/stop the rotation timer depending on whether
- * any of the 3D rotation buttons are checked.
+ * Switches the current conversation topic to "initial greeting".
  */
-void MainWindow::on_m_3dSpinXButton_toggled(bool checked)
+void MainWindow::on_m_convTopicButtonGreeting0_clicked()
 {
-  Q_UNUSED(checked)
-  timerControl();
+  m_currentConvTopic = ConvTopicCategory_GreetingInitial;
+  populateConversationTopicTable();
 }
 
 /**
- * Calls a routine to start/stop the rotation timer depending on whether
- * any of the 3D rotation buttons are checked.
+ * Switches the current conversation topic to "subsequent greeting".
  */
-void MainWindow::on_m_3dSpinYButton_toggled(bool checked)
+void MainWindow::on_m_convTopicButtonGreeting1_clicked()
 {
-  Q_UNUSED(checked)
-  timerControl();
+  m_currentConvTopic = ConvTopicCategory_GreetingSubsequent;
+  populateConversationTopicTable();
 }
 
 /**
- * Calls a routine to start/stop the rotation timer depending on whether
- * any of the 3D rotation buttons are checked.
+ * Switches the current conversation topic to "ask about person".
  */
-void MainWindow::on_m_3dSpinZButton_toggled(bool checked)
+void MainWindow::on_m_convTopicButtonPerson_clicked()
 {
-  Q_UNUSED(checked)
-  timerControl();
+  m_currentConvTopic = ConvTopicCategory_AskAboutPerson;
+  populateConversationTopicTable();
 }
 
 /**
- * Responds to the "reset" button being clicked by calling a routine
- * that resets the view parameters.
+ * Switches the current conversation topic to "ask about location".
  */
-void MainWindow::on_m_3dResetButton_clicked()
+void MainWindow::on_m_convTopicButtonPlace_clicked()
 {
-  reset3DView();
+  m_currentConvTopic = ConvTopicCategory_AskAboutLocation;
+  populateConversationTopicTable();
 }
 
 /**
- * Reset the rotation and zoom of the 3D view to the original values.
+ * Switches the current conversation topic to "ask about object".
  */
-void MainWindow::reset3DView()
+void MainWindow::on_m_convTopicButtonObject_clicked()
 {
-  m_timer.stop();
-  ui->m_3dSpinXButton->setChecked(false);
-  ui->m_3dSpinYButton->setChecked(false);
-  ui->m_3dSpinZButton->setChecked(false);
-  ui->m_3dModelViewer->resetView();
+  m_currentConvTopic = ConvTopicCategory_AskAboutObject;
+  populateConversationTopicTable();
 }
 
 /**
- * Responds to a new palette filename being selected by loading and
- * displaying the palette data in the table widget.
+ * Switches the current conversation topic to "ask about race".
  */
-void MainWindow::on_m_paletteTree_currentItemChanged(QTreeWidgetItem* current, QTreeWidgetItem* previous)
+void MainWindow::on_m_convTopicButtonRace_clicked()
 {
-  Q_UNUSED(previous)
+  m_currentConvTopic = ConvTopicCategory_AskAboutRace;
+  populateConversationTopicTable();
+}
 
-  ui->m_paletteTable->clearContents();
+/**
+ * Switches the current conversation topic to "display object".
+ */
+void MainWindow::on_m_convTopicButtonDispObj_clicked()
+{
+  m_currentConvTopic = ConvTopicCategory_DisplayObject;
+  populateConversationTopicTable();
+}
 
-  if (current)
-  {
-    const QString palFilename = current->text(0);
-    if (current->parent())
-    {
-      const QString datFilename = current->parent()->text(0);
+/**
+ * Switches the current conversation topic to "give object".
+ */
+void MainWindow::on_m_convTopicButtonGiveObj_clicked()
+{
+  m_currentConvTopic = ConvTopicCategory_GiveObject;
+  populateConversationTopicTable();
+}
+
+/**
+ * Switches the current conversation topic to "give fact".
+ */
+void MainWindow::on_m_convTopicButtonGiveFact_clicked()
+{
+  m_currentConvTopic = ConvTopicCategory_GiveFact;
+  populateConversationTopicTable();
+}
+
+/**
+ * Switches the current conversation topic to "sees item".
+ */
+void MainWindow::on_m_convTopicButtonSeesItem_clicked()
+{
+  m_currentConvTopic = ConvTopicCategory_SeesObject;
+  populateConversationTopicTable();
+}
+
+/**
+ * Responds to the "show only interesting topics" checkbox being checked or unchecked
+ * by applying or removing a filter on the conversation topic list box.
+ */
+void MainWindow::on_m_convFilterTopicsCheckbox_stateChanged(int arg1)
+{
+  Q_UNUSED(arg1)
+  populateConversationTopicTable();
+}
+
+/**
+ * Populates the list widget with the topics for the provided category. The topicList parameter provides
+ * a comprehensive list of all possible topics in the category, but only a subset may actually be added
+ * to the list, depending on whether an alien is selected or the show-only-interesting-dialogue checkbox
+ * is checked.
+ */
+void MainWindow::populateTopicTableForCategory(ConvTopicCategory category, const QMap<int,QString>& topicList, int lastSelectedTopicId)
+{
+  const int selectedAlienId = recordIdAt(ui->m_convAlienTable->currentIndex());
+  const int alienId = (selectedAlienId >= 0) ? selectedAlienId : 0;
+
+  // we will show all topics for the selected topic category if either:
+  // (a) no alien is selected in the first list box, or
+  // (b) the user has deselected the checkbox that filters the list down to the interesting topics
+  const bool alwaysAddAllTopics = ((alienId == 0) || (ui->m_convFilterTopicsCheckbox->checkState() == Qt::Unchecked));
+
+  QVector<int> topicIds;
+  QStringList topicNames;
+
+  for (QMap<int,QString>::const_iterator it = topicList.constBegin(); it != topicList.constEnd(); ++it)
+  {
+    const int topicId = it.key();
+    if (alwaysAddAllTopics || m_convText.doesInterestingDialogExist(alienId, category, topicId))
+    {
+      topicIds.append(topicId);
+      topicNames.append(it.value());
+    }
+  }
+  m_convTopicModel.setTopics(topicIds, topicNames);
+  ui->m_convTopicTable->resizeColumnToContents(0);
+
+  clearDialogLineAndCommandList();
+
+  // if the previously selected topic is still listed (and not hidden by the filter), select it again
+  if (lastSelectedTopicId >= 0)
+  {
+    const QModelIndexList matches = m_convTopicProxy.match(m_convTopicProxy.index(0, 0), RECORD_ID_ROLE,
+                                                           lastSelectedTopicId, 1, Qt::MatchExactly);
+    if (!matches.isEmpty())
+    {
+      ui->m_convTopicTable->setCurrentIndex(matches.first());
+      ui->m_convTopicTable->scrollTo(matches.first());
+    }
+  }
+}
+
+/**
+ * Populates the table of specific conversation topics, given the currently selected topic category.
+ * Note that two categories -- Greeting/Initial and Greeting/Subsequent -- do not require the selection
+ * of a specific topic, and they will not trigger the population of the table.
+ *
+ * If the parameter (the previously selected topic ID) is not negative, then automatically
+ * select the row in the repopulated table with the same ID, if one exists.
+ */
+void MainWindow::populateConversationTopicTable(int lastSelectedTopicId)
+{
+  m_convTopicModel.clear();
+
+  if (m_currentConvTopic == ConvTopicCategory_AskAboutPerson)
+  {
+    QMap<int,QString> alienNames;
+    for (const Alien& a : m_aliens.getList())
+    {
+      alienNames.insert(a.id, a.name);
+    }
+    populateTopicTableForCategory(m_currentConvTopic, alienNames, lastSelectedTopicId);
+  }
+  else if (m_currentConvTopic == ConvTopicCategory_AskAboutLocation)
+  {
+    QMap<int,QString> placeNames;
+    for (const Place& p : m_places.getPlaceList())
+    {
+      placeNames.insert(p.id, p.name);
+    }
+    populateTopicTableForCategory(m_currentConvTopic, placeNames, lastSelectedTopicId);
+  }
+  else if ((m_currentConvTopic == ConvTopicCategory_AskAboutObject) ||
+           (m_currentConvTopic == ConvTopicCategory_GiveObject)     ||
+           (m_currentConvTopic == ConvTopicCategory_DisplayObject)  ||
+           (m_currentConvTopic == ConvTopicCategory_SeesObject))
+  {
+    QMap<int,QString> objectNames;
+    for (const InventoryObj& obj : m_invObject.getList())
+    {
+      objectNames.insert(obj.id, obj.name);
+    }
+    populateTopicTableForCategory(m_currentConvTopic, objectNames, lastSelectedTopicId);
+  }
+  else if (m_currentConvTopic == ConvTopicCategory_AskAboutRace)
+  {
+    QMap<int,QString> raceNames;
+    for (int raceId = 0; raceId < static_cast<int>(AlienRace::NumRaces); raceId++)
+    {
+      const AlienRace race = static_cast<AlienRace>(raceId);
+      raceNames.insert(raceId, s_raceNames[race]);
+    }
+    populateTopicTableForCategory(m_currentConvTopic, raceNames, lastSelectedTopicId);
+  }
+  else if (m_currentConvTopic == ConvTopicCategory_GiveFact)
+  {
+    QMap<int,QString> factText;
+    for (const Fact& f : m_facts.getList())
+    {
+      factText.insert(f.id, f.text);
+    }
+    populateTopicTableForCategory(m_currentConvTopic, factText, lastSelectedTopicId);
+  }
+  else if ((m_currentConvTopic == ConvTopicCategory_GreetingInitial) ||
+           (m_currentConvTopic == ConvTopicCategory_GreetingSubsequent))
+  {
+    getConversationLinesForCurrentTopic();
+  }
+}
+
+/**
+ * Responds to the selection of a row in the conversation topic table.
+ */
+void MainWindow::onConvTopicRowChanged(const QModelIndex& current)
+{
+  if (current.isValid())
+  {
+    getConversationLinesForCurrentTopic();
+  }
+}
+
+/**
+ * Loads any conversation text that is applicable to the currently selected alien and conversation topic.
+ */
+void MainWindow::getConversationLinesForCurrentTopic()
+{
+  const int selectedTopicId = recordIdAt(ui->m_convTopicTable->currentIndex());
+
+  const int selectedAlienId = recordIdAt(ui->m_convAlienTable->currentIndex());
+  const int alienId = (selectedAlienId >= 0) ? selectedAlienId : 0;
+  const int thingId = (selectedTopicId >= 0) ? selectedTopicId : 0;
+
+  // certain conversation topic categories do not require a topic ID greater than zero
+  const bool thingIdOfZeroAllowed = (m_currentConvTopic == ConvTopicCategory_AskAboutRace) ||
+                                    (m_currentConvTopic == ConvTopicCategory_GreetingInitial) ||
+                                    (m_currentConvTopic == ConvTopicCategory_GreetingSubsequent);
+
+  if ((alienId > 0) && ((thingId > 0) || thingIdOfZeroAllowed))
+  {
+    QVector<QPair<GTxtCmd,int> > embeddedCommands;
+    QString currentConvLine = m_convText.getConversationText(alienId, m_currentConvTopic, thingId, embeddedCommands);
+
+    clearDialogLineAndCommandList();
+    ui->m_convDialogueLine->setHtml(currentConvLine);
+
+    // populate the table to display the details of the commands embedded in this dialogue line
+    populateGameTextCommandList(ui->m_convCommandList, embeddedCommands);
+  }
+}
+
+/**
+ * Get the human-readable name for the person/place/thing/fact described by the combination of
+ * command byte and parameter ID.
+ */
+QString MainWindow::getNameForGameTextCommandParameter(GTxtCmd cmd, int param)
+{
+  QString name;
+
+  if ((cmd == GTxtCmd_AddItem) || (cmd == GTxtCmd_GrantKnowledgeObject))
+  {
+    name = m_invObject.getName(param);
+  }
+  else if ((cmd == GTxtCmd_GrantKnowledgeAlien) || (cmd == GTxtCmd_AStateTableModifyB))
+  {
+    name = m_aliens.getName(param);
+  }
+  else if (cmd == GTxtCmd_GrantKnowledgeRace)
+  {
+    const AlienRace race = static_cast<AlienRace>(param);
+    name = s_raceNames.contains(race) ? s_raceNames[race] : "(invalid)";
+  }
+  else if ((cmd == GTxtCmd_GrantKnowledgePlace) || (cmd == GTxtCmd_StorePlaceIDInSetupTable))
+  {
+    name = m_places.getName(param);
+  }
+  else if (cmd == GTxtCmd_StoreShipIDInSetupTab)
+  {
+    name = m_ships.getName(param);
+  }
+  else if (cmd == GTxtCmd_GrantKnowledgeFact)
+  {
+    name = m_facts.getFact(param).text;
+  }
+  else if (cmd == GTxtCmd_ModifyEncountRelate)
+  {
+    const uint8_t byteA = (param & 0xFF);
+    const uint8_t byteB = (param >> 8);
+    const AlienRace race = static_cast<AlienRace>(byteA);
+    const QString raceName = s_raceNames.contains(race) ? s_raceNames[race] : "(invalid)";
+    name = QString("%1: %2").arg(raceName).arg(byteB);
+  }
+
+  return name;
+}
+
+/**
+ * Clears the box showing the current line of dialogue, and clears the table that
+ * shows all the embedded commands in that dialogue.
+ */
+void MainWindow::clearDialogLineAndCommandList()
+{
+  ui->m_convDialogueLine->clear();
+  ui->m_convDialogueLine->clearHistory();
+  ui->m_convCommandList->setRowCount(0);
+}
+
+/**
+ * Responds to one of the conversation text synonyms being clicked by displaying a tooltip with
+ * the alternatives from which the game randomly selects. The list of synonyms is sent from the
+ * QTextBrowser to this slot by encoding them in a URL.
+ */
+void MainWindow::on_m_convDialogueLine_anchorClicked(const QUrl& arg1)
+{
+  showAnchorTooltip(arg1);
+}
+
+/**
+ * Responds to the stamp roll slider being moved by displaying the stamp at the selected index.
+ */
+void MainWindow::on_m_stampRollSlider_valueChanged(int value)
+{
+  displayStamp(value);
+}
+
+/**
+ * Displays a single static image on the stamp/roll tab, based on the currently selected roll index.
+ */
+void MainWindow::displayStamp(int rollIndex)
+{
+  m_stampScene.clear();
+  if ((m_stampImages.count() > rollIndex) && !m_stampImages[rollIndex].isNull())
+  {
+    showImage(m_stampScene, ui->m_stampView, m_stampImages[rollIndex], STAMP_VIEW_SCALE);
+  }
+}
+
+/**
+ * Responds to a change in the currently selected mission ID by calling a routine to update
+ * the mission information being displayed.
+ */
+void MainWindow::on_m_missionIdSpinBox_valueChanged(int arg1)
+{
+  showInfoForMission(arg1);
+}
+
+/**
+ * Populates the mission text widgets with information about the currently selected mission ID.
+ */
+void MainWindow::showInfoForMission(int id)
+{
+  ui->m_missionStartText->clear();
+  ui->m_missionStartText->clearHistory();
+  ui->m_missionReqText->clear();
+  ui->m_missionReqText->clearHistory();
+  ui->m_missionEndText->clear();
+  ui->m_missionEndText->clearHistory();
+  ui->m_missionStartCommandList->setRowCount(0);
+  ui->m_missionEndCommandList->setRowCount(0);
+  ui->m_missionXrefPanel->clear();
+
+  const DenseIdTable<Mission>& missions = m_missions.getList();
+  if (missions.contains(id))
+  {
+    showCommandXrefs(ui->m_missionXrefPanel, id);
+    ui->m_missionStartText->setHtml(missions[id].startText);
+    ui->m_missionEndText->setHtml(missions[id].completeText);
+    populateGameTextCommandList(ui->m_missionStartCommandList, missions[id].startTextCommands);
+    populateGameTextCommandList(ui->m_missionEndCommandList,   missions[id].completeTextCommands);
+
+    if (missions[id].action == MissionActionType::None)
+    {
+      ui->m_missionReqText->setHtml("(No action required.)");
+    }
+    else if (missions[id].action == MissionActionType::DeliverItem)
+    {
+      const QString itemName = m_invObject.getName(missions[id].objectiveId);
+      ui->m_missionReqText->setHtml(QString("Deliver item: %1").arg(itemName));
+    }
+    else if (missions[id].action == MissionActionType::DestroyShip)
+    {
+      const QString shipName = m_ships.getName(missions[id].objectiveId);
+      ui->m_missionReqText->setHtml(QString("Destroy ship: %1").arg(shipName));
+    }
+    else
+    {
+      ui->m_missionReqText->setHtml(QString("Unknown action type %1, objective ID %2").arg(missions[id].missionActionRawVal).arg(missions[id].objectiveId));
+    }
+
+    ui->m_missionReqText->append(describeMissionDependencies(id));
+  }
+}
+
+/**
+ * Returns HTML describing where the provided mission falls in the mission prerequisite
+ * graph, with links to the related missions.
+ */
+QString MainWindow::describeMissionDependencies(int id)
+{
+  const MissionGraph& graph = m_missions.getGraph();
+  QStringList chain;
+  QStringList unlocked;
+  QStringList allUnlocked;
+
+  foreach (int prereqId, graph.prerequisiteChain(id))
+  {
+    chain.append(QString("<a href=\"mission:%1\">%1</a>").arg(prereqId));
+  }
+  foreach (int unlockedId, graph.unlockedBy(id))
+  {
+    unlocked.append(QString("<a href=\"mission:%1\">%1</a>").arg(unlockedId));
+  }
+  foreach (int unlockedId, graph.allUnlockedBy(id))
+  {
+    allUnlocked.append(QString("<a href=\"mission:%1\">%1</a>").arg(unlockedId));
+  }
+
+  QString desc = QString("<p>Prerequisite missions: %1<br>").arg(chain.isEmpty() ? "(none)" : chain.join(" &rarr; "));
+  desc += QString("Completing this mission unlocks: %1").arg(unlocked.isEmpty() ? "(none)" : unlocked.join(", "));
+  if (allUnlocked.count() > unlocked.count())
+  {
+    desc += QString(" (and eventually %1)").arg(allUnlocked.mid(unlocked.count()).join(", "));
+  }
+
+  if (graph.isOnCycle(id))
+  {
+    desc += "<br>This mission is on a prerequisite cycle and can never be unlocked.";
+  }
+  else if (graph.orderPosition(id) < 0)
+  {
+    desc += "<br>This mission depends on a prerequisite cycle and can never be unlocked.";
+  }
+  else
+  {
+    desc += QString("<br>Position in completion order: %1 of %2").arg(graph.orderPosition(id) + 1)
+                                                                  .arg(graph.completionOrder().count());
+  }
+  desc += "</p>";
+
+  return desc;
+}
+
+/**
+ * Decodes the provided string into a list of game text alternate strings and displays
+ * them in a tooltip at the current cursor position.
+ */
+void MainWindow::showAnchorTooltip(const QUrl& url)
+{
+  const QString urlStr = url.toString(QUrl::DecodeReserved).replace("|", "\n").trimmed();
+  QToolTip::showText(QCursor::pos(), urlStr);
+}
+
+/**
+ * Populates cells in a three-column QTableWidget with the information contained in the supplied
+ * list of gametext commands.
+ */
+void MainWindow::populateGameTextCommandList(QTableWidget* table, QVector<QPair<GTxtCmd,int> >& commands)
+{
+  // populate the table to display the details of the commands embedded in this dialogue line
+  QPair<GTxtCmd,int> cmdPair;
+  foreach (cmdPair, commands)
+  {
+    const GTxtCmd command = cmdPair.first;
+    const int param = cmdPair.second;
+
+    const int rowcount = table->rowCount();
+
+    table->insertRow(rowcount);
+    table->setItem(rowcount, 0, new QTableWidgetItem(g_gameTextCommandName[command]));
+
+    // the command ModifyEncountRelate is a special case
+    // in that it takes two 8-bit parameters
+    if (command == GTxtCmd_ModifyEncountRelate)
+    {
+      const uint8_t byteA = (param & 0xFF);
+      const uint8_t byteB = (param >> 8);
+      const QString twoParamStr = QString("%1, %2").arg(byteA).arg(byteB);
+      table->setItem(rowcount, 1, new QTableWidgetItem(twoParamStr));
+    }
+    else
+    {
+      table->setItem(rowcount, 1, new QTableWidgetItem(QString("%1").arg(param)));
+    }
+
+    const QString paramName = getNameForGameTextCommandParameter(command, param);
+    if (!paramName.isEmpty())
+    {
+      table->setItem(rowcount, 2, new QTableWidgetItem(paramName));
+    }
+  }
+
+  table->resizeColumnToContents(0);
+  table->resizeColumnToContents(1);
+  table->resizeRowsToContents();
+}
+
+/**
+ * Displays tooltip with list of synonyms from metatext in mission start text.
+ */
+void MainWindow::on_m_missionStartText_anchorClicked(const QUrl& arg1)
+{
+  showAnchorTooltip(arg1);
+}
+
+/**
+ * Displays tooltip with list of synonyms from metatext in mission end text.
+ */
+void MainWindow::on_m_missionEndText_anchorClicked(const QUrl& arg1)
+{
+  showAnchorTooltip(arg1);
+}
+
+/**
+ * Shows the mission whose link was clicked in the mission requirements.
+ */
+void MainWindow::on_m_missionReqText_anchorClicked(const QUrl& arg1)
+{
+  if (arg1.scheme() == "mission")
+  {
+    ui->m_missionIdSpinBox->setValue(arg1.path().toInt());
+  }
+}
+
+/**
+ * Reponds to a 3D model filename being selected by loading the model's
+ * data into the 3D viewer and displaying its informational text
+ * in the associated box.
+ */
+void MainWindow::on_m_3dModelTree_currentItemChanged(QTreeWidgetItem* current, QTreeWidgetItem* previous)
+{
+  Q_UNUSED(previous)
+
+  ui->m_3dModelViewer->clear();
+  ui->m_3dModelInfoText->clear();
+  reset3DView();
+
+  if (current)
+  {
+    const QString binFilename = current->text(0);
+    if (current->parent())
+    {
+      const QString datFilename = current->parent()->text(0);
+      const DatFileType dat = DatLibrary::s_datFileNames.key(datFilename);
+
+      QByteArray binData;
+      if (m_lib.getFileByName(dat, binFilename, binData))
+      {
+        QString modelInfo;
+        ui->m_3dModelViewer->loadData(binData, modelInfo);
+        ui->m_3dModelInfoText->setText(modelInfo);
+      }
+      else
+      {
+        ui->m_3dModelInfoText->setHtml(QString("<b>Error:</b> Could not load '%1'").arg(binFilename));
+      }
+    }
+  }
+}
+
+/**
+ * Increment the rotation value for all of the 3D model axes whose rotation button is checked.
+ */
+void MainWindow::onTimer()
+{
+  if (ui->m_3dSpinXButton->isChecked())
+  {
+    ui->m_3dModelViewer->incrementXRotation();
+  }
+  if (ui->m_3dSpinYButton->isChecked())
+  {
+    ui->m_3dModelViewer->incrementYRotation();
+  }
+  if (ui->m_3dSpinZButton->isChecked())
+  {
+    ui->m_3dModelViewer->incrementZRotation();
+  }
+}
+
+/**
+ * Start the 3D model rotation timer if any of the rotation buttons are checked,
+ * and stop the timer if none of them are checked.
+ */
+void MainWindow::timerControl()
+{
+  if (ui->m_3dSpinXButton->isChecked() ||
+      ui->m_3dSpinYButton->isChecked() ||
+      ui->m_3dSpinZButton->isChecked())
+  {
+    m_timer.start();
+  }
+  else
+  {
+    m_timer.stop();
+  }
+}
+
+/**
+ * Calls a routine to start/stop the rotation timer depending on whether
+ * any of the 3D rotation buttons are checked.
+ */
+void MainWindow::on_m_3dSpinXButton_toggled(bool checked)
+{
+  Q_UNUSED(checked)
+  timerControl();
+}
+
+/**
+ * Calls a routine to start/stop the rotation timer depending on whether
+ * any of the 3D rotation buttons are checked.
+ */
+void MainWindow::on_m_3dSpinYButton_toggled(bool checked)
+{
+  Q_UNUSED(checked)
+  timerControl();
+}
+
+/**
+ * Calls a routine to start/stop the rotation timer depending on whether
+ * any of the 3D rotation buttons are checked.
+ */
+void MainWindow::on_m_3dSpinZButton_toggled(bool checked)
+{
+  Q_UNUSED(checked)
+  timerControl();
+}
+
+/**
+ * Responds to the "reset" button being clicked by calling a routine
+ * that resets the view parameters.
+ */
+void MainWindow::on_m_3dResetButton_clicked()
+{
+  reset3DView();
+}
+
+/**
+ * Reset the rotation and zoom of the 3D view to the original values.
+ */
+void MainWindow::reset3DView()
+{
+  m_timer.stop();
+  ui->m_3dSpinXButton->setChecked(false);
+  ui->m_3dSpinYButton->setChecked(false);
+  ui->m_3dSpinZButton->setChecked(false);
+  ui->m_3dModelViewer->resetView();
+}
+
+/**
+ * Responds to a new palette filename being selected by loading and
+ * displaying the palette data in the table widget.
+ */
+void MainWindow::on_m_paletteTree_currentItemChanged(QTreeWidgetItem* current, QTreeWidgetItem* previous)
+{
+  Q_UNUSED(previous)
+
+  ui->m_paletteTable->clearContents();
+
+  if (current)
+  {
+    const QString palFilename = current->text(0);
+    if (current->parent())
+    {
+      const QString datFilename = current->parent()->text(0);
       const DatFileType dat = DatLibrary::s_datFileNames.key(datFilename);
 
-      QVector<QRgb> pal;
-      int startIndex = 0;
+      QVector<QRgb> pal;
+      int startIndex = 0;
+
+      if (m_palette.paletteByName(dat, palFilename, pal, &startIndex))
+      {
+        const int palSize = pal.size();
+
+        for (int palIdx = 0; palIdx < 256; palIdx++)
+        {
+          const int rowIdx = palIdx / 16;
+          const int colIdx = palIdx % 16;
+          QTableWidgetItem* cell = new QTableWidgetItem();
+
+          if ((palIdx < startIndex) || (palIdx >= (startIndex + palSize)))
+          {
+            // specially mark the cells that are outside of the palette data bounds
+            cell->setText("X");
+            cell->setTextAlignment(Qt::AlignCenter);
+            cell->setBackground(QBrush(qRgb(0,0,0)));
+          }
+          else
+          {
+            cell->setBackground(QBrush(pal[palIdx - startIndex]));
+          }
+
+          ui->m_paletteTable->setItem(rowIdx, colIdx, cell);
+        }
+        ui->m_paletteTable->resizeColumnsToContents();
+      }
+    }
+  }
+}
+
+
+/**
+ * Builds the list of images in the currently selected image set, adds a placeholder
+ * item for each to the thumbnail view, and starts decoding the images in the background.
+ */
+void MainWindow::populateThumbnails()
+{
+  m_thumbnails.cancel();
+  m_thumbModel.clear();
+  m_thumbsCompleted = 0;
+
+  const ThumbnailSource source = static_cast<ThumbnailSource>(ui->m_thumbSourceCombo->currentIndex());
+  QList<ThumbnailRequest> requests;
+  QStringList labels;
+
+  if (source == ThumbnailSource::InventoryImages)
+  {
+    for (const InventoryObj& obj : m_invObject.getList())
+    {
+      requests.append({ DatFileType::INVENT, QString(), obj.id });
+      labels.append(obj.name);
+    }
+  }
+  else
+  {
+    const QMap<DatFileType,QStringList> fileList = (source == ThumbnailSource::FullscreenImages) ?
+                                                   m_fullscreenImages.getAllLbmList() :
+                                                   m_stamps.getAllStampsList();
+    foreach (DatFileType dat, fileList.keys())
+    {
+      foreach (QString filename, fileList[dat])
+      {
+        requests.append({ dat, filename, -1 });
+        labels.append(filename);
+      }
+    }
+  }
+
+  QPixmap placeholder(THUMBNAIL_SIZE, THUMBNAIL_SIZE);
+  placeholder.fill(Qt::transparent);
+  const QIcon placeholderIcon(placeholder);
+
+  for (int idx = 0; idx < requests.size(); idx++)
+  {
+    QStandardItem* item = new QStandardItem(placeholderIcon, labels[idx]);
+    item->setData(static_cast<int>(requests[idx].dat), Qt::UserRole);
+    item->setData(requests[idx].filename, Qt::UserRole + 1);
+    item->setData(requests[idx].objectId, Qt::UserRole + 2);
+    item->setToolTip(QString("%1: %2").arg(DatLibrary::s_datFileNames[requests[idx].dat]).arg(labels[idx]));
+    m_thumbModel.appendRow(item);
+  }
+
+  m_thumbsValid = true;
+  if (requests.isEmpty())
+  {
+    ui->m_thumbStatusLabel->setText("No images available.");
+  }
+  else
+  {
+    ui->m_thumbStatusLabel->setText(QString("Generating %1 thumbnails...").arg(requests.size()));
+    m_thumbElapsed.start();
+    m_thumbnails.start(source, requests);
+  }
+}
+
+/**
+ * Replaces the placeholder icon of a thumbnail view item with its finished thumbnail.
+ */
+void MainWindow::onThumbnailReady(int index, QImage thumbnail)
+{
+  QStandardItem* item = m_thumbModel.item(index);
+  m_thumbsCompleted++;
+
+  if (item && !thumbnail.isNull())
+  {
+    item->setIcon(QIcon(QPixmap::fromImage(thumbnail)));
+  }
+}
+
+/**
+ * Reports the time taken to generate the set of thumbnails, or notes that
+ * generation was interrupted.
+ */
+void MainWindow::onThumbnailsFinished()
+{
+  if (m_thumbModel.rowCount() == 0)
+  {
+    // the view was cleared while the last set was being generated
+    return;
+  }
+
+  if (m_thumbsCompleted < m_thumbModel.rowCount())
+  {
+    // generation was cancelled before all of the thumbnails were finished
+    m_thumbsValid = false;
+    ui->m_thumbStatusLabel->setText(QString("Stopped after %1 of %2 thumbnails.")
+                                    .arg(m_thumbsCompleted).arg(m_thumbModel.rowCount()));
+  }
+  else
+  {
+    ui->m_thumbStatusLabel->setText(QString("Generated %1 thumbnails in %2 ms.")
+                                    .arg(m_thumbsCompleted).arg(m_thumbElapsed.elapsed()));
+  }
+}
+
+/**
+ * Starts generating thumbnails when the thumbnail tab is shown (unless a complete
+ * set is already displayed), and stops the generation when another tab is selected.
+ */
+void MainWindow::on_m_tabs_currentChanged(int index)
+{
+  Q_UNUSED(index)
 
-      if (m_palette.paletteByName(dat, palFilename, pal, &startIndex))
-      {
-        const int palSize = pal.size();
+  if (ui->m_tabs->currentWidget() == ui->m_tabThumbnails)
+  {
+    if (!m_thumbsValid)
+    {
+      populateThumbnails();
+    }
+  }
+  else
+  {
+    m_thumbnails.cancel();
+  }
+}
 
-        for (int palIdx = 0; palIdx < 256; palIdx++)
+/**
+ * Regenerates the thumbnails when a different image set is selected.
+ */
+void MainWindow::on_m_thumbSourceCombo_currentIndexChanged(int index)
+{
+  Q_UNUSED(index)
+
+  m_thumbsValid = false;
+  if (ui->m_tabs->currentWidget() == ui->m_tabThumbnails)
+  {
+    populateThumbnails();
+  }
+}
+
+/**
+ * Selects the item with the provided filename under the provided DAT's parent item in a tree widget.
+ */
+void MainWindow::selectTreeItem(QTreeWidget* tree, DatFileType dat, QString filename)
+{
+  const QString datFilename = DatLibrary::s_datFileNames[dat];
+
+  for (int parentIdx = 0; parentIdx < tree->topLevelItemCount(); parentIdx++)
+  {
+    QTreeWidgetItem* datTreeParent = tree->topLevelItem(parentIdx);
+    if (datTreeParent->text(0) == datFilename)
+    {
+      for (int childIdx = 0; childIdx < datTreeParent->childCount(); childIdx++)
+      {
+        if (datTreeParent->child(childIdx)->text(0) == filename)
         {
-          const int rowIdx = palIdx / 16;
-          const int colIdx = palIdx % 16;
-          QTableWidgetItem* cell = new QTableWidgetItem();
+          tree->setCurrentItem(datTreeParent->child(childIdx));
+          tree->scrollToItem(datTreeParent->child(childIdx));
+          return;
+        }
+      }
+    }
+  }
+}
 
-          if ((palIdx < startIndex) || (palIdx >= (startIndex + palSize)))
-          {
-            // specially mark the cells that are outside of the palette data bounds
-            cell->setText("X");
-            cell->setTextAlignment(Qt::AlignCenter);
-            cell->setBackground(QBrush(qRgb(0,0,0)));
-          }
-          else
-          {
-            cell->setBackground(QBrush(pal[palIdx - startIndex]));
-          }
+/**
+ * Switches to the tab that shows the full details of the image whose thumbnail was double-clicked.
+ */
+void MainWindow::on_m_thumbView_doubleClicked(const QModelIndex& index)
+{
+  const QStandardItem* item = m_thumbModel.itemFromIndex(index);
 
-          ui->m_paletteTable->setItem(rowIdx, colIdx, cell);
+  if (item)
+  {
+    const DatFileType dat = static_cast<DatFileType>(item->data(Qt::UserRole).toInt());
+    const QString filename = item->data(Qt::UserRole + 1).toString();
+    const int objectId = item->data(Qt::UserRole + 2).toInt();
+    const ThumbnailSource source = static_cast<ThumbnailSource>(ui->m_thumbSourceCombo->currentIndex());
+
+    if (source == ThumbnailSource::FullscreenImages)
+    {
+      selectTreeItem(ui->m_fullscreenTree, dat, filename);
+      ui->m_tabs->setCurrentWidget(ui->m_tabFullscreen);
+    }
+    else if (source == ThumbnailSource::StampImages)
+    {
+      selectTreeItem(ui->m_stampTree, dat, filename);
+      ui->m_tabs->setCurrentWidget(ui->m_tabStamps);
+    }
+    else
+    {
+      selectTableRowById(ui->m_objTable, objectId);
+      ui->m_tabs->setCurrentWidget(ui->m_tabObjects);
+    }
+  }
+}
+
+/**
+ * Replaces the contents of a graphics scene with the provided image, upscaled by
+ * the given factor with the currently selected scaler, and shows it in the view.
+ */
+void MainWindow::showImage(QGraphicsScene& scene, QGraphicsView* view, const QImage& img, int factor)
+{
+  scene.clear();
+  scene.setSceneRect(QRectF());
+  m_scaledImages.remove(&scene);
+
+  if (!img.isNull())
+  {
+    // keep the upscaled indices so that a change of palette only needs a new color table
+    const QImage scaled = ImageScaler::upscale(img, factor, m_scalerType);
+    m_scaledImages[&scene] = scaled;
+    scene.addPixmap(QPixmap::fromImage(withDisplayPalette(scaled)));
+    scene.setSceneRect(scene.itemsBoundingRect());
+  }
+  view->setScene(&scene);
+}
+
+/**
+ * Redraws each of the image views that are currently displaying an image, so that
+ * a change in the selected scaler takes effect immediately.
+ */
+void MainWindow::refreshImageViews()
+{
+  if (!m_objImage.isNull())
+  {
+    showImage(m_objScene, ui->m_objectImageView, m_objImage, OBJECT_VIEW_SCALE);
+  }
+  if (!m_planetSurfaceImage.isNull() && !m_globeTimer.isActive())
+  {
+    showImage(m_planetSurfaceScene, ui->m_planetView, m_planetSurfaceImage, PLANET_VIEW_SCALE);
+  }
+  if (!m_fullscreenImage.isNull())
+  {
+    showImage(m_fullscreenScene, ui->m_fullscreenView, m_fullscreenImage, FULLSCREEN_VIEW_SCALE);
+  }
+  if (ui->m_alienFrameSlider->isEnabled())
+  {
+    loadAlienFrame(ui->m_alienFrameSlider->value());
+  }
+  displayStamp(ui->m_stampRollSlider->value());
+}
+
+void MainWindow::on_actionScaleNearest_triggered()
+{
+  m_scalerType = ScalerType::Nearest;
+  refreshImageViews();
+}
+
+void MainWindow::on_actionScalePixelArt_triggered()
+{
+  m_scalerType = ScalerType::PixelArt;
+  refreshImageViews();
+}
+
+/**
+ * Returns the unscaled image that is displayed on the current tab, or a null image if
+ * the current tab does not display an image.
+ */
+QImage MainWindow::currentDisplayedImage()
+{
+  QImage img;
+  const QWidget* const tab = ui->m_tabs->currentWidget();
+
+  if (tab == ui->m_tabObjects)
+  {
+    img = m_objImage;
+  }
+  else if (tab == ui->m_tabPlaces)
+  {
+    img = m_planetSurfaceImage;
+  }
+  else if (tab == ui->m_tabAliens)
+  {
+    img = m_alienFrames.values().value(ui->m_alienFrameSlider->value());
+  }
+  else if (tab == ui->m_tabFullscreen)
+  {
+    img = m_fullscreenImage;
+  }
+  else if (tab == ui->m_tabStamps)
+  {
+    img = m_stampImages.value(ui->m_stampRollSlider->value());
+  }
+
+  return img;
+}
+
+/**
+ * Saves the image displayed on the current tab to a file, upscaled by a user-selected
+ * factor with the currently selected scaler.
+ */
+void MainWindow::on_actionExport_image_triggered()
+{
+  const QImage img = currentDisplayedImage();
+
+  if (img.isNull())
+  {
+    QMessageBox::information(this, "Export image", "There is no image displayed on the current tab.");
+  }
+  else
+  {
+    bool ok = false;
+    const int factor = QInputDialog::getInt(this, "Export image", "Scale factor:", IMAGESCALER_MAX_FACTOR,
+                                            1, IMAGESCALER_MAX_FACTOR, 1, &ok);
+    if (ok)
+    {
+      const QString filename = QFileDialog::getSaveFileName(this, "Export image", QDir::homePath(), "PNG images (*.png)");
+      if (!filename.isEmpty())
+      {
+        const QImage scaled = withDisplayPalette(ImageScaler::upscale(img, factor, m_scalerType));
+        if (!scaled.save(filename, "PNG"))
+        {
+          QMessageBox::warning(this, "Export image", QString("Failed to write %1.").arg(filename));
         }
-        ui->m_paletteTable->resizeColumnsToContents();
       }
     }
   }
 }
 
+/**
+ * Creates the widgets in the display palette toolbar, which allow any palette to be
+ * substituted for an image's own palette, and a range of colors to be cycled.
+ */
+void MainWindow::setupPaletteToolBar()
+{
+  m_displayPalCombo = new QComboBox(this);
+  m_displayPalCombo->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+  m_palCycleCheckbox = new QCheckBox("Cycle colors", this);
+  m_palCycleFirstSpinBox = new QSpinBox(this);
+  m_palCycleFirstSpinBox->setRange(0, 255);
+  m_palCycleFirstSpinBox->setValue(0);
+  m_palCycleLastSpinBox = new QSpinBox(this);
+  m_palCycleLastSpinBox->setRange(0, 255);
+  m_palCycleLastSpinBox->setValue(15);
+
+  ui->m_paletteToolBar->addWidget(new QLabel("Display palette: ", this));
+  ui->m_paletteToolBar->addWidget(m_displayPalCombo);
+  ui->m_paletteToolBar->addSeparator();
+  ui->m_paletteToolBar->addWidget(m_palCycleCheckbox);
+  ui->m_paletteToolBar->addWidget(new QLabel(" from index ", this));
+  ui->m_paletteToolBar->addWidget(m_palCycleFirstSpinBox);
+  ui->m_paletteToolBar->addWidget(new QLabel(" to ", this));
+  ui->m_paletteToolBar->addWidget(m_palCycleLastSpinBox);
+
+  m_palCycleTimer.setInterval(100);
+  connect(&m_palCycleTimer, &QTimer::timeout, this, &MainWindow::onPaletteCycleTimer);
+  connect(m_palCycleCheckbox, &QCheckBox::toggled, this, &MainWindow::onPaletteCycleToggled);
+  connect(m_displayPalCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+          this, &MainWindow::onDisplayPaletteChanged);
+
+  populateDisplayPaletteList();
+}
+
+/**
+ * Fills the display palette selector with every .PAL file in the game data,
+ * following the entry that selects each image's own palette.
+ */
+void MainWindow::populateDisplayPaletteList()
+{
+  m_displayPalCombo->blockSignals(true);
+  m_displayPalCombo->clear();
+  m_displayPalCombo->addItem("(Image's own palette)");
+
+  const QMap<DatFileType,QStringList> palList = m_palette.getAllPaletteList();
+  foreach (DatFileType dat, palList.keys())
+  {
+    foreach (QString palFilename, palList[dat])
+    {
+      m_displayPalCombo->addItem(QString("%1: %2").arg(m_lib.s_datFileNames[dat]).arg(palFilename));
+      const int itemIndex = m_displayPalCombo->count() - 1;
+      m_displayPalCombo->setItemData(itemIndex, static_cast<int>(dat), Qt::UserRole);
+      m_displayPalCombo->setItemData(itemIndex, palFilename, Qt::UserRole + 1);
+    }
+  }
+
+  m_displayPalCombo->blockSignals(false);
+  m_displayPal.clear();
+}
+
+/**
+ * Returns a copy of the provided indexed image that uses the selected display palette
+ * (or its own palette if none is selected), with any color cycling applied. The pixel
+ * data itself is not changed; only the color table is replaced.
+ */
+QImage MainWindow::withDisplayPalette(const QImage& img) const
+{
+  QImage displayed = img;
+
+  if ((img.format() == QImage::Format_Indexed8) && (!m_displayPal.isEmpty() || (m_palCycleStep != 0)))
+  {
+    displayed.setColorTable(displayColorTable(img.colorTable()));
+  }
+
+  return displayed;
+}
+
+/**
+ * Returns the color table that should be used to display an image with the provided
+ * color table, given the selected display palette and color cycling.
+ */
+QVector<QRgb> MainWindow::displayColorTable(const QVector<QRgb>& colors) const
+{
+  QVector<QRgb> displayColors = m_displayPal.isEmpty() ? colors : m_displayPal;
+  if (m_palCycleStep != 0)
+  {
+    displayColors = Palette::rotateRange(displayColors, m_palCycleFirstSpinBox->value(),
+                                         m_palCycleLastSpinBox->value(), m_palCycleStep);
+  }
+  return displayColors;
+}
+
+/**
+ * Returns the pixmap item that displays the image in a scene, or nullptr if the scene is empty.
+ */
+QGraphicsPixmapItem* MainWindow::scenePixmapItem(QGraphicsScene& scene) const
+{
+  QGraphicsPixmapItem* pixmapItem = nullptr;
+
+  foreach (QGraphicsItem* item, scene.items())
+  {
+    pixmapItem = qgraphicsitem_cast<QGraphicsPixmapItem*>(item);
+    if (pixmapItem)
+    {
+      break;
+    }
+  }
+
+  return pixmapItem;
+}
+
+/**
+ * Updates the color table of each displayed image without scaling or decoding it again.
+ */
+void MainWindow::applyDisplayPaletteToViews()
+{
+  foreach (QGraphicsScene* scene, m_scaledImages.keys())
+  {
+    QGraphicsPixmapItem* pixmapItem = scenePixmapItem(*scene);
+    if (pixmapItem)
+    {
+      pixmapItem->setPixmap(QPixmap::fromImage(withDisplayPalette(m_scaledImages[scene])));
+    }
+  }
+}
+
+/**
+ * Loads the newly selected display palette (as a full 256-color palette) and
+ * applies it to the displayed images.
+ */
+void MainWindow::onDisplayPaletteChanged(int index)
+{
+  m_displayPal.clear();
+
+  if (index > 0)
+  {
+    const DatFileType dat = static_cast<DatFileType>(m_displayPalCombo->itemData(index, Qt::UserRole).toInt());
+    const QString palFilename = m_displayPalCombo->itemData(index, Qt::UserRole + 1).toString();
+
+    if (!m_palette.paletteByName(dat, palFilename, m_displayPal))
+    {
+      m_displayPal.clear();
+    }
+  }
+
+  applyDisplayPaletteToViews();
+}
+
+void MainWindow::onPaletteCycleToggled(bool checked)
+{
+  m_palCycleStep = 0;
+  if (checked)
+  {
+    m_palCycleTimer.start();
+  }
+  else
+  {
+    m_palCycleTimer.stop();
+    applyDisplayPaletteToViews();
+  }
+}
+
+/**
+ * Advances the color cycling by one palette entry.
+ */
+void MainWindow::onPaletteCycleTimer()
+{
+  m_palCycleStep++;
+  applyDisplayPaletteToViews();
+}
+
+/**
+ * Displays the current planet surface texture, either as the flat texture or as
+ * a rotating globe, depending on the state of the globe checkbox.
+ */
+void MainWindow::showPlanetSurface()
+{
+  m_globeTimer.stop();
+
+  if (ui->m_planetGlobeCheckbox->isChecked() && m_globe.setTexture(m_planetSurfaceImage))
+  {
+    // the globe frames are drawn directly rather than through the scaled image cache
+    m_planetSurfaceScene.clear();
+    m_planetSurfaceScene.setSceneRect(QRectF());
+    m_scaledImages.remove(&m_planetSurfaceScene);
+
+    m_globeRotation = 0;
+    m_globe.render(m_globeRotation, m_globeFrame);
+    m_planetSurfaceScene.addPixmap(QPixmap::fromImage(m_globeFrame));
+    m_planetSurfaceScene.setSceneRect(m_planetSurfaceScene.itemsBoundingRect());
+    ui->m_planetView->setScene(&m_planetSurfaceScene);
+    m_globeTimer.start();
+  }
+  else
+  {
+    showImage(m_planetSurfaceScene, ui->m_planetView, m_planetSurfaceImage, PLANET_VIEW_SCALE);
+  }
+}
+
+void MainWindow::on_m_planetGlobeCheckbox_toggled(bool checked)
+{
+  Q_UNUSED(checked)
+
+  if (!m_planetSurfaceImage.isNull())
+  {
+    showPlanetSurface();
+  }
+}
+
+/**
+ * Draws the next frame of the rotating globe. Frames are skipped while the
+ * place tab is not visible.
+ */
+void MainWindow::onGlobeTimer()
+{
+  QGraphicsPixmapItem* pixmapItem = scenePixmapItem(m_planetSurfaceScene);
+
+  if (pixmapItem && (ui->m_tabs->currentWidget() == ui->m_tabPlaces))
+  {
+    m_globeRotation = (m_globeRotation + 1) % qMax(m_globe.textureWidth(), 1);
+    m_globe.setPalette(displayColorTable(m_planetSurfaceImage.colorTable()));
+    m_globe.render(m_globeRotation, m_globeFrame);
+    pixmapItem->setPixmap(QPixmap::fromImage(m_globeFrame));
+  }
+}
+
+void MainWindow::setupRawTableViewer()
+{
+  // the viewer is filled when data is opened, so don't react to the initial list being added
+  ui->m_rawTableCombo->blockSignals(true);
+  ui->m_rawTableCombo->addItems(s_rawTableReaders.keys());
+  ui->m_rawTableCombo->blockSignals(false);
+}
+
+void MainWindow::on_m_rawTableCombo_currentIndexChanged(int index)
+{
+  Q_UNUSED(index)
+  populateRawTableWidgets();
+}
+
+void MainWindow::on_m_rawTableUnknownCheckbox_toggled(bool checked)
+{
+  Q_UNUSED(checked)
+  populateRawTableWidgets();
+}
+
+/**
+ * Writes every entry of the table shown in the raw table viewer to a CSV file, with the
+ * raw value of each field element in its own column.
+ */
+void MainWindow::on_m_rawTableExportButton_clicked()
+{
+  const QString defaultName = QString("%1.csv").arg(QFileInfo(ui->m_rawTableCombo->currentText()).completeBaseName());
+  const QString filename = QFileDialog::getSaveFileName(this, "Export table", defaultName, "CSV files (*.csv)");
+
+  if (!filename.isEmpty())
+  {
+    QFile csvFile(filename);
+    if (!csvFile.open(QIODevice::WriteOnly) || (csvFile.write(m_rawTable.toCsv()) < 0))
+    {
+      QMessageBox::warning(this, "Export table", QString("Failed to write %1.").arg(filename));
+    }
+  }
+}
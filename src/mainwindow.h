@@ -6,14 +6,25 @@
 #include <QGraphicsScene>
 #include <QTreeWidgetItem>
 #include <QByteArray>
-#include <QBuffer>
 #include <QAudio>
 #include <QAudioFormat>
 #include <QAudioOutput>
 #include <QListWidgetItem>
 #include <QLabel>
 #include <QTableWidget>
+#include <QTableView>
+#include <QSortFilterProxyModel>
+#include <QLineEdit>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QStandardItemModel>
+#include <QModelIndex>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QRadioButton>
+#include <QSpinBox>
+#include <QGraphicsPixmapItem>
+#include <QProgressDialog>
 #include "aboutbox.h"
 #include "datlibrary.h"
 #include "gametext.h"
@@ -27,10 +38,27 @@
 #include "shipinventory.h"
 #include "facts.h"
 #include "audio.h"
+#include "dpcmstreamdevice.h"
+#include "resamplingdevice.h"
+#include "soundanalysis.h"
+#include "batchwavexporter.h"
+#include "dedupanalyzer.h"
+#include "textsearchindex.h"
+#include "commandxref.h"
+#include "commandxrefpanel.h"
+#include "reachabilityexplorer.h"
+#include "dialogueexporter.h"
+#include "tableschema.h"
+#include "recordtablemodel.h"
+#include "tablesnapshot.h"
 #include "fullscreenimages.h"
 #include "stampimages.h"
 #include "conversationtext.h"
 #include "missions.h"
+#include "thumbnailgenerator.h"
+#include "stamprollloader.h"
+#include "imagescaler.h"
+#include "globerenderer.h"
 
 namespace Ui {
 class MainWindow;
@@ -52,9 +80,9 @@ private slots:
   void onExit();
   void onCloseDataFiles();
   void onTimer();
-  void on_m_objTable_currentCellChanged(int currentRow, int currentColumn, int previousRow, int previousColumn);
-  void on_m_placeTable_currentCellChanged(int currentRow, int currentColumn, int previousRow, int previousColumn);
-  void on_m_alienTable_currentCellChanged(int currentRow, int currentColumn, int previousRow, int previousColumn);
+  void onObjectRowChanged(const QModelIndex& current);
+  void onPlaceRowChanged(const QModelIndex& current);
+  void onAlienRowChanged(const QModelIndex& current);
   void on_m_alienFrameSlider_valueChanged(int value);
   void on_m_soundTree_currentItemChanged(QTreeWidgetItem* current, QTreeWidgetItem* previous);
   void on_m_soundPrevButton_clicked();
@@ -62,15 +90,15 @@ private slots:
   void on_m_soundNextButton_clicked();
   void on_m_soundStopButton_clicked();
   void on_m_soundMakeWav_clicked();
-  void on_m_shipTable_currentCellChanged(int currentRow, int currentColumn, int previousRow, int previousColumn);
-  void on_m_factTable_currentCellChanged(int currentRow, int currentColumn, int previousRow, int previousColumn);
+  void onShipRowChanged(const QModelIndex& current);
+  void onFactRowChanged(const QModelIndex& current);
   void on_m_fullscreenTree_currentItemChanged(QTreeWidgetItem *current, QTreeWidgetItem *previous);
-  void on_m_convAlienTable_currentCellChanged(int currentRow, int currentColumn, int previousRow, int previousColumn);
+  void onConvAlienRowChanged(const QModelIndex& current);
+  void onConvTopicRowChanged(const QModelIndex& current);
   void on_m_convTopicButtonPerson_clicked();
   void on_m_convTopicButtonPlace_clicked();
   void on_m_convTopicButtonObject_clicked();
   void on_m_convTopicButtonRace_clicked();
-  void on_m_convTopicTable_currentCellChanged(int currentRow, int currentColumn, int previousRow, int previousColumn);
   void on_m_convTopicButtonGreeting0_clicked();
   void on_m_convTopicButtonGreeting1_clicked();
   void on_m_convTopicButtonDispObj_clicked();
@@ -85,6 +113,7 @@ private slots:
   void on_m_missionIdSpinBox_valueChanged(int arg1);
   void on_m_missionStartText_anchorClicked(const QUrl &arg1);
   void on_m_missionEndText_anchorClicked(const QUrl &arg1);
+  void on_m_missionReqText_anchorClicked(const QUrl &arg1);
   void on_m_3dModelTree_currentItemChanged(QTreeWidgetItem* current, QTreeWidgetItem* previous);
   void on_m_3dSpinXButton_toggled(bool checked);
   void on_m_3dSpinYButton_toggled(bool checked);
@@ -93,6 +122,43 @@ private slots:
   void reset3DView();
   void on_m_3dResetButton_clicked();
   void on_m_paletteTree_currentItemChanged(QTreeWidgetItem *current, QTreeWidgetItem *previous);
+  void on_m_tabs_currentChanged(int index);
+  void on_m_thumbSourceCombo_currentIndexChanged(int index);
+  void on_m_thumbView_doubleClicked(const QModelIndex& index);
+  void onThumbnailReady(int index, QImage thumbnail);
+  void onThumbnailsFinished();
+  void onStampImageReady(int rollIndex, QImage image);
+  void on_actionScaleNearest_triggered();
+  void on_actionScalePixelArt_triggered();
+  void on_actionExport_image_triggered();
+  void onDisplayPaletteChanged(int index);
+  void onPaletteCycleToggled(bool checked);
+  void onPaletteCycleTimer();
+  void on_m_planetGlobeCheckbox_toggled(bool checked);
+  void onGlobeTimer();
+  void onSoundAnalysisReady(SoundBankAnalysisPtr analysis);
+  void onWaveformSoundActivated(int soundIndex);
+  void on_actionExport_sound_bank_triggered();
+  void on_actionExport_all_sound_banks_triggered();
+  void onWavExportProgress(int completed, int total);
+  void onWavExportFinished(int written, int failed, bool cancelled);
+  void on_actionFind_duplicate_data_triggered();
+  void onDedupProgress(int completed, int total);
+  void onDedupFinished(bool cancelled);
+  void onTextSearchIndexFinished(bool cancelled);
+  void on_m_searchEdit_textChanged(const QString& text);
+  void on_m_searchResultTable_cellDoubleClicked(int row, int column);
+  void onCommandXrefFinished(bool cancelled);
+  void jumpToSearchTarget(const TextSearchTarget& target);
+  void on_actionFind_unreachable_content_triggered();
+  void onReachabilityFinished(bool cancelled);
+  void on_actionExport_all_dialogue_triggered();
+  void on_actionExport_table_snapshot_triggered();
+  void onDialogueExportProgress(int completed, int total);
+  void onDialogueExportFinished(bool success, bool cancelled);
+  void on_m_rawTableCombo_currentIndexChanged(int index);
+  void on_m_rawTableUnknownCheckbox_toggled(bool checked);
+  void on_m_rawTableExportButton_clicked();
 
 private:
   Ui::MainWindow *ui;
@@ -116,9 +182,36 @@ private:
   StampImages m_stamps;
   ConversationText m_convText;
   Missions m_missions;
+  ThumbnailGenerator m_thumbnails;
+  StampRollLoader m_stampLoader;
+  SoundAnalyzer m_soundAnalyzer;
+  BatchWavExporter m_wavExporter;
+  DedupAnalyzer m_dedup;
+  TextSearchIndexer m_textSearch;
+  CommandXref m_cmdXref;
+  ReachabilityExplorer m_reachability;
+  DialogueExporter m_dialogueExporter;
 
   QMap<int,QImage> m_alienFrames;
   QList<QImage> m_stampImages;
+  QImage m_objImage;
+  QImage m_planetSurfaceImage;
+  QImage m_fullscreenImage;
+  ScalerType m_scalerType;
+  QMap<QGraphicsScene*,QImage> m_scaledImages;
+
+  QComboBox* m_displayPalCombo;
+  QCheckBox* m_palCycleCheckbox;
+  QSpinBox* m_palCycleFirstSpinBox;
+  QSpinBox* m_palCycleLastSpinBox;
+  QVector<QRgb> m_displayPal;
+  QTimer m_palCycleTimer;
+  int m_palCycleStep;
+
+  GlobeRenderer m_globe;
+  QImage m_globeFrame;
+  QTimer m_globeTimer;
+  int m_globeRotation;
 
   QGraphicsScene m_objScene;
   QGraphicsScene m_planetSurfaceScene;
@@ -131,9 +224,13 @@ private:
   QString m_currentNNVFilename;
   DatFileType m_currentSoundDat;
   QAudioFormat m_audioFormat;
-  QByteArray m_audioPcmData;
   QAudioOutput* m_audioOutput;
-  QBuffer m_audioBuffer;
+  DpcmStreamDevice m_soundStream;
+  ResamplingDevice* m_playbackResampler;
+  QProgressDialog* m_wavExportProgress;
+  QProgressDialog* m_dedupProgress;
+  QProgressDialog* m_reachProgress;
+  QProgressDialog* m_dialogueExportProgress;
 
   ConvTopicCategory m_currentConvTopic;
   QString m_currentConvLine;
@@ -141,9 +238,43 @@ private:
   QMap<PlanetResourceType,QMap<int,QLabel*> > m_resourceLabels;
   QTimer m_timer;
 
+  QStandardItemModel m_thumbModel;
+  QElapsedTimer m_thumbElapsed;
+  int m_thumbsCompleted;
+  bool m_thumbsValid;
+
+  QVector<TextSearchHit> m_searchHits;
+  RawTable m_rawTable;
+
+  PlaceTableModel m_placeModel;
+  ObjectTableModel m_objModel;
+  AlienTableModel m_alienModel;
+  ShipTableModel m_shipModel;
+  FactTableModel m_factModel;
+  QSortFilterProxyModel m_placeProxy;
+  QSortFilterProxyModel m_objProxy;
+  QSortFilterProxyModel m_alienProxy;
+  QSortFilterProxyModel m_shipProxy;
+  QSortFilterProxyModel m_factProxy;
+  QSortFilterProxyModel m_convAlienProxy;
+  ConvTopicTableModel m_convTopicModel;
+  QSortFilterProxyModel m_convTopicProxy;
+
   void clearData();
   void openNewData(const QString gameDir);
   void connectGLViewerSliders();
+  void setupThumbnailView();
+  void setupImageScaling();
+  void showImage(QGraphicsScene& scene, QGraphicsView* view, const QImage& img, int factor);
+  void refreshImageViews();
+  void setupPaletteToolBar();
+  void populateDisplayPaletteList();
+  QImage withDisplayPalette(const QImage& img) const;
+  void applyDisplayPaletteToViews();
+  QVector<QRgb> displayColorTable(const QVector<QRgb>& colors) const;
+  QGraphicsPixmapItem* scenePixmapItem(QGraphicsScene& scene) const;
+  void showPlanetSurface();
+  QImage currentDisplayedImage();
   void setupAudio();
   void setupTimer();
   void populatePlaceWidgets();
@@ -158,9 +289,12 @@ private:
   void populateMissionWidgets();
   void populate3dModelWidgets();
   void populatePaletteWidgets();
+  void populateRawTableWidgets();
+  void populateThumbnails();
+  void selectTreeItem(QTreeWidget* tree, DatFileType dat, QString filename);
   void loadAlienFrame(int frameId);
   void populateConversationTopicTable(int lastSelectedTopicId = -1);
-  void populateTopicTableForCategory(ConvTopicCategory category, QMap<int,QString> topicList, int lastSelectedTopicId);
+  void populateTopicTableForCategory(ConvTopicCategory category, const QMap<int,QString>& topicList, int lastSelectedTopicId);
   void getConversationLinesForCurrentTopic();
   QString getNameForGameTextCommandParameter(GTxtCmd cmd, int param);
   void clearDialogLineAndCommandList();
@@ -169,11 +303,26 @@ private:
   void clearPlaceLabels();
   void setSoundButtonStates();
   void setSoundIDLabel(QString nnvName, int soundId);
+  void appendSoundBankJobs(QList<BatchWavJob>& jobs, DatFileType dat, QString nnvName, QString outputDir);
+  void startWavExport(const QList<BatchWavJob>& jobs);
   void setAudioStateLabel(QAudio::State state);
   void displayStamp(int rollIndex);
   void showInfoForMission(int id);
+  QString describeMissionDependencies(int id);
   void showAnchorTooltip(const QUrl& url);
   void populateGameTextCommandList(QTableWidget* table, QVector<QPair<GTxtCmd,int> >& commands);
+  void startTextIndexing();
+  TextSearchOwners gatherTextOwners();
+  void runTextSearch();
+  QString describeSearchTarget(const TextSearchTarget& target);
+  void setupCommandXrefPanels();
+  void setupRawTableViewer();
+  void setupRecordTables();
+  QLineEdit* recordTableFilter(QTableView* view);
+  void showCommandXrefs(CommandXrefPanel* panel, int id);
+  ReachabilitySeed gatherReachabilitySeed();
+  bool selectTableRowById(QTableView* view, int id);
+  QRadioButton* convTopicButton(ConvTopicCategory topic);
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <QQueue>
+#include <QSet>
+#include "missiongraph.h"
+
+MissionGraph::MissionGraph()
+{
+
+}
+
+/**
+ * Builds the graph from a map of each mission ID to the ID of its prerequisite mission (or
+ * -1 if it has none). A prerequisite that is not itself a mission is ignored. The missions
+ * are then sorted so that each one follows its prerequisite, and the missions that cannot
+ * be sorted because they depend on a cycle are found.
+ */
+void MissionGraph::build(const QMap<int,int>& prerequisites)
+{
+  clear();
+
+  for (QMap<int,int>::const_iterator it = prerequisites.constBegin(); it != prerequisites.constEnd(); ++it)
+  {
+    const bool hasPrereq = prerequisites.contains(it.value());
+    m_prerequisites.insert(it.key(), hasPrereq ? it.value() : -1);
+    if (hasPrereq)
+    {
+      m_dependents[it.value()].append(it.key());
+    }
+  }
+
+  // Kahn's algorithm: start with the missions that have no prerequisite, and release each
+  // mission once its prerequisite has been placed
+  QQueue<int> ready;
+  for (QMap<int,int>::const_iterator it = m_prerequisites.constBegin(); it != m_prerequisites.constEnd(); ++it)
+  {
+    if (it.value() < 0)
+    {
+      ready.enqueue(it.key());
+    }
+  }
+
+  while (!ready.isEmpty())
+  {
+    const int id = ready.dequeue();
+    m_orderPositions.insert(id, m_order.count());
+    m_order.append(id);
+
+    foreach (int dependent, m_dependents.value(id))
+    {
+      ready.enqueue(dependent);
+    }
+  }
+
+  // every mission that was not placed is either on a cycle or depends on one; following
+  // the prerequisites from such a mission must eventually revisit a mission on the cycle
+  QSet<int> onCycle;
+  foreach (int id, m_prerequisites.keys())
+  {
+    if (!m_orderPositions.contains(id))
+    {
+      m_blocked.append(id);
+
+      if (!onCycle.contains(id))
+      {
+        QList<int> visited;
+        int current = id;
+        while (!visited.contains(current) && !onCycle.contains(current))
+        {
+          visited.append(current);
+          current = m_prerequisites.value(current);
+        }
+
+        if (!onCycle.contains(current))
+        {
+          for (int index = visited.indexOf(current); index < visited.count(); index++)
+          {
+            onCycle.insert(visited.at(index));
+          }
+        }
+      }
+    }
+  }
+
+  m_cycleMissions = onCycle.values();
+  std::sort(m_cycleMissions.begin(), m_cycleMissions.end());
+}
+
+void MissionGraph::clear()
+{
+  m_prerequisites.clear();
+  m_dependents.clear();
+  m_order.clear();
+  m_orderPositions.clear();
+  m_blocked.clear();
+  m_cycleMissions.clear();
+}
+
+/**
+ * Returns the ID of the mission that must be completed to unlock the provided mission, or
+ * -1 if it has none.
+ */
+int MissionGraph::prerequisite(int id) const
+{
+  return m_prerequisites.value(id, -1);
+}
+
+/**
+ * Returns the missions that must be completed, in order, before the provided mission is
+ * unlocked. The chain stops early if it reaches a cycle.
+ */
+QList<int> MissionGraph::prerequisiteChain(int id) const
+{
+  QList<int> chain;
+  int current = prerequisite(id);
+
+  while ((current >= 0) && (current != id) && !chain.contains(current))
+  {
+    chain.prepend(current);
+    current = prerequisite(current);
+  }
+
+  return chain;
+}
+
+/**
+ * Returns the missions that are unlocked directly by completing the provided mission.
+ */
+QList<int> MissionGraph::unlockedBy(int id) const
+{
+  return m_dependents.value(id);
+}
+
+/**
+ * Returns every mission that is unlocked, directly or through other missions, by completing
+ * the provided mission, nearest first.
+ */
+QList<int> MissionGraph::allUnlockedBy(int id) const
+{
+  QList<int> unlocked;
+  QQueue<int> pending;
+  pending.enqueue(id);
+
+  while (!pending.isEmpty())
+  {
+    foreach (int dependent, m_dependents.value(pending.dequeue()))
+    {
+      if ((dependent != id) && !unlocked.contains(dependent))
+      {
+        unlocked.append(dependent);
+        pending.enqueue(dependent);
+      }
+    }
+  }
+
+  return unlocked;
+}
+
+/**
+ * Returns the missions in an order in which they can be completed, with each mission
+ * following its prerequisite.
+ */
+QList<int> MissionGraph::completionOrder() const
+{
+  return m_order;
+}
+
+/**
+ * Returns the position of the provided mission in the completion order, or -1 if it is
+ * not in the order.
+ */
+int MissionGraph::orderPosition(int id) const
+{
+  return m_orderPositions.value(id, -1);
+}
+
+/**
+ * Returns the missions that can never be unlocked because they are on a prerequisite
+ * cycle or depend on a mission that is.
+ */
+QList<int> MissionGraph::blockedMissions() const
+{
+  return m_blocked;
+}
+
+bool MissionGraph::isOnCycle(int id) const
+{
+  return m_cycleMissions.contains(id);
+}
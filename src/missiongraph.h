@@ -0,0 +1,34 @@
+#pragma once
+#include <QList>
+#include <QMap>
+
+/**
+ * Dependency graph of the missions, in which each mission is unlocked by completing its
+ * prerequisite mission (if it has one). Since a mission has at most one prerequisite, the
+ * graph is a forest unless the data contains a cycle; missions that are on a cycle, or
+ * that can only be unlocked through one, are left out of the completion order.
+ */
+class MissionGraph
+{
+public:
+  MissionGraph();
+  void build(const QMap<int,int>& prerequisites);
+  void clear();
+
+  int prerequisite(int id) const;
+  QList<int> prerequisiteChain(int id) const;
+  QList<int> unlockedBy(int id) const;
+  QList<int> allUnlockedBy(int id) const;
+  QList<int> completionOrder() const;
+  int orderPosition(int id) const;
+  QList<int> blockedMissions() const;
+  bool isOnCycle(int id) const;
+
+private:
+  QMap<int,int> m_prerequisites;
+  QMap<int,QList<int> > m_dependents;
+  QList<int> m_order;
+  QMap<int,int> m_orderPositions;
+  QList<int> m_blocked;
+  QList<int> m_cycleMissions;
+};
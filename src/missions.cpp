@@ -11,7 +11,7 @@ Missions::Missions(DatLibrary& lib, GameText& gametext) :
 /**
  * Gets the list of missions read from the data file, populating it first if necessary.
  */
-QMap<int,Mission> Missions::getList()
+const DenseIdTable<Mission>& Missions::getList()
 {
   if (m_missions.isEmpty())
   {
@@ -21,6 +21,29 @@ QMap<int,Mission> Missions::getList()
   return m_missions;
 }
 
+/**
+ * Gets the graph of mission prerequisites, populating the list of missions first if necessary.
+ */
+const MissionGraph& Missions::getGraph()
+{
+  if (m_missions.isEmpty())
+  {
+    populateList();
+  }
+
+  return m_graph;
+}
+
+/**
+ * Discards the mission data so that it will be read again from the next set of data files.
+ */
+void Missions::clear()
+{
+  DatTable<MissionTableEntry>::clear();
+  m_missions.clear();
+  m_graph.clear();
+}
+
 /**
  * Parses the MISSION.TAB data file to read information about Alliance mission postings.
  */
@@ -31,6 +54,17 @@ bool Missions::populateList()
   if (openFile(DatFileType::CONVERSE, "MISSION.TAB"))
   {
     status = true;
+
+    // the mission text files are read (and decompressed) once for all of the missions
+    QByteArray misTextIdxData;
+    QByteArray misTextStrData;
+    if (!m_lib->getFileByName(DatFileType::CONVERSE, "MISTEXT.IDX", misTextIdxData) ||
+        !m_lib->getFileByName(DatFileType::CONVERSE, "MISTEXT.TXT", misTextStrData))
+    {
+      misTextIdxData.clear();
+      misTextStrData.clear();
+    }
+
     int index = 0;
     MissionTableEntry* currentEntry = getEntry(index);
 
@@ -58,43 +92,52 @@ bool Missions::populateList()
           m.action = MissionActionType::Unknown;
         }
         m.missionActionRawVal = currentEntry->actionRequired;
-        m.startText    = getMissionText(qFromLittleEndian<quint16>(currentEntry->startTextIndex), m.startTextCommands);
-        m.completeText = getMissionText(qFromLittleEndian<quint16>(currentEntry->completeTextIndex), m.completeTextCommands);
+        m.startTextIndex = qFromLittleEndian<quint16>(currentEntry->startTextIndex);
+        m.completeTextIndex = qFromLittleEndian<quint16>(currentEntry->completeTextIndex);
+        m.startText    = getMissionText(m.startTextIndex, misTextIdxData, misTextStrData, m.startTextCommands);
+        m.completeText = getMissionText(m.completeTextIndex, misTextIdxData, misTextStrData, m.completeTextCommands);
         m.objectiveId  = currentEntry->objectiveId;
         m.objectiveLocation = currentEntry->placeId;
+        m.prereqMissionId = currentEntry->prereqMissionId;
 
         m_missions.insert(index, m);
       }
       index++;
       currentEntry = getEntry(index);
     }
+
+    QMap<int,int> prerequisites;
+    foreach (int id, m_missions.keys())
+    {
+      prerequisites.insert(id, (m_missions[id].prereqMissionId == MISSION_NO_PREREQ) ? -1 : m_missions[id].prereqMissionId);
+    }
+    m_graph.build(prerequisites);
   }
 
   return status;
 }
 
 /**
- * Returns the text associated with a missions at the provided index in the MISTEXT.IDX index file.
- * Populates the provided QVector with the list of game commands embedded in that text.
+ * Returns the text associated with a missions at the provided index in the MISTEXT.IDX index file,
+ * using the provided contents of MISTEXT.IDX and MISTEXT.TXT. Populates the provided QVector with
+ * the list of game commands embedded in that text.
  */
-QString Missions::getMissionText(uint16_t idxFileIndex, QVector<QPair<GTxtCmd,int> >& commands)
+QString Missions::getMissionText(uint16_t idxFileIndex, const QByteArray& misTextIdxData, const QByteArray& misTextStrData,
+                                 QVector<QPair<GTxtCmd,int> >& commands)
 {
-  QByteArray misTextIdxData;
-  QByteArray misTextStrData;
   QString txt;
+  const int idxOffset = (idxFileIndex + 1) * 4;
 
-  if (m_lib->getFileByName(DatFileType::CONVERSE, "MISTEXT.IDX", misTextIdxData) &&
-      m_lib->getFileByName(DatFileType::CONVERSE, "MISTEXT.TXT", misTextStrData))
+  if ((idxOffset + 4) <= misTextIdxData.size())
   {
-    const int idxOffset = (idxFileIndex + 1) * 4;
     int32_t txtOffset = 0;
 
-    memcpy(&txtOffset, misTextIdxData.data() + idxOffset, 4);
+    memcpy(&txtOffset, misTextIdxData.constData() + idxOffset, 4);
     txtOffset = qFromLittleEndian<qint32>(txtOffset);
 
-    if (txtOffset < misTextStrData.size())
+    if ((txtOffset >= 0) && (txtOffset < misTextStrData.size()))
     {
-      const char* rawdata = misTextStrData.data();
+      const char* rawdata = misTextStrData.constData();
       txt = m_gtext->readString(rawdata + txtOffset, commands);
     }
   }
@@ -4,8 +4,13 @@
 #include <QPair>
 #include <QMap>
 #include "dattable.h"
+#include "denseidtable.h"
 #include "datlibrary.h"
 #include "gametext.h"
+#include "missiongraph.h"
+
+//! Mission ID that a MISSION.TAB entry uses when it has no prerequisite mission
+#define MISSION_NO_PREREQ 0
 
 enum class MissionActionType
 {
@@ -21,6 +26,9 @@ struct Mission
   int missionActionRawVal;
   int objectiveId;
   int objectiveLocation;
+  int prereqMissionId;
+  int startTextIndex;
+  int completeTextIndex;
   QString startText;
   QString completeText;
   QVector<QPair<GTxtCmd,int> > startTextCommands;
@@ -42,19 +50,42 @@ typedef struct __attribute__((packed)) MissionTableEntry
 
 static_assert(sizeof(MissionTableEntry) == 24, "MissionTableEntry packing does not match game data");
 
+constexpr FieldDescriptor s_missionTableFields[] =
+{
+  TABLE_FIELD(MissionTableEntry, placeId),
+  TABLE_UNKNOWN_FIELD(MissionTableEntry, unknown_a),
+  TABLE_FIELD(MissionTableEntry, prereqMissionId),
+  TABLE_FIELD(MissionTableEntry, actionRequired),
+  TABLE_FIELD(MissionTableEntry, objectiveId),
+  TABLE_UNKNOWN_FIELD(MissionTableEntry, unknown_b),
+  TABLE_FIELD(MissionTableEntry, startTextIndex),
+  TABLE_FIELD(MissionTableEntry, completeTextIndex)
+};
+
+template <>
+struct TableSchema<MissionTableEntry>
+{
+  static constexpr const FieldDescriptor* fields() { return s_missionTableFields; }
+  static constexpr int fieldCount() { return sizeof(s_missionTableFields) / sizeof(FieldDescriptor); }
+};
+
 class Missions : public DatTable<MissionTableEntry>
 {
 public:
   Missions(DatLibrary& lib, GameText& gametext);
-  QMap<int,Mission> getList();
+  const DenseIdTable<Mission>& getList();
+  const MissionGraph& getGraph();
+  void clear();
 
 protected:
   bool populateList();
 
 private:
   GameText* m_gtext;
-  QMap<int,Mission> m_missions;
+  DenseIdTable<Mission> m_missions;
+  MissionGraph m_graph;
 
-  QString getMissionText(uint16_t idxFileIndex, QVector<QPair<GTxtCmd,int> >& commands);
+  QString getMissionText(uint16_t idxFileIndex, const QByteArray& misTextIdxData, const QByteArray& misTextStrData,
+                         QVector<QPair<GTxtCmd,int> >& commands);
 };
 
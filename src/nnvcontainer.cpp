@@ -0,0 +1,120 @@
+#include <string.h>
+#include <QtEndian>
+#include "nnvcontainer.h"
+
+NnvContainer::NnvContainer() :
+  m_valid(false)
+{
+}
+
+/**
+ * Reads the index at the start of the provided (decompressed) NNV file data and
+ * keeps a copy of the data for later access to the individual sounds.
+ * @return True if the data contained a sound count; false otherwise.
+ */
+bool NnvContainer::parse(const QByteArray& nnvData)
+{
+  m_data = nnvData;
+  m_entries.clear();
+  m_valid = !m_data.isEmpty();
+
+  if (m_valid)
+  {
+    const int count = static_cast<uint8_t>(m_data.at(0));
+    m_entries.reserve(count);
+
+    for (int soundId = 0; soundId < count; soundId++)
+    {
+      SoundEntry entry;
+      entry.offset = getStartLocation(m_data, soundId);
+      entry.length = getSoundDataLength(m_data, soundId);
+      m_entries.append(entry);
+    }
+  }
+
+  return m_valid;
+}
+
+/**
+ * Returns true if the container data was read successfully.
+ */
+bool NnvContainer::isValid() const
+{
+  return m_valid;
+}
+
+/**
+ * Returns the number of sounds listed in the container's index.
+ */
+int NnvContainer::soundCount() const
+{
+  return m_entries.size();
+}
+
+/**
+ * Provides the location and length of the encoded data for the sound with the given ID.
+ * The pointer refers to this container's data and is valid as long as the container
+ * (or any copy of it) exists.
+ * @return True if the index entry for the sound refers to data within the container; false otherwise.
+ */
+bool NnvContainer::soundData(int soundId, const uint8_t*& encoded, int& length) const
+{
+  bool status = false;
+
+  if ((soundId >= 0) && (soundId < m_entries.size()))
+  {
+    const SoundEntry& entry = m_entries[soundId];
+
+    if ((entry.offset >= 0) && (entry.length > 0) && (m_data.size() >= (entry.offset + entry.length)))
+    {
+      encoded = reinterpret_cast<const uint8_t*>(m_data.constData()) + entry.offset;
+      length = entry.length;
+      status = true;
+    }
+  }
+
+  return status;
+}
+
+/**
+ * Determines the start offset within the provided NNV data of the sound file with the given ID.
+ * @return The start offset of the specified sound file; or -1 if an error occurred (e.g. if the
+ * data was not large enough to contain a file with the specified ID.)
+ */
+int NnvContainer::getStartLocation(const QByteArray& nnvData, int soundId)
+{
+  int loc = -1;
+
+  // if the NNV file is at least big enough to contain the header fields for the requested sound ID
+  if (nnvData.size() >= 1 + (NNV_INDEX_SIZE * (soundId + 1)))
+  {
+    int32_t locationField;
+    memcpy (&locationField, nnvData.constData() + 1 + (NNV_INDEX_SIZE * soundId), sizeof(int32_t));
+    locationField = qFromLittleEndian<qint32>(locationField);
+    loc = locationField;
+  }
+
+  return loc;
+}
+
+/**
+ * Determines the length in bytes of the sound file with the given ID within the provided NNV data.
+ * @return The length in bytes of the specified sound file; or -1 if an error occurred (e.g. if the
+ * data was not large enough to contain a file with the specified ID.)
+ */
+int NnvContainer::getSoundDataLength(const QByteArray& nnvData, int soundId)
+{
+  int len = -1;
+
+  // if the NNV file is at least big enough to contain the header fields for the requested sound ID
+  if (nnvData.size() >= 1 + (NNV_INDEX_SIZE * (soundId + 1)))
+  {
+    int32_t lengthField;
+    memcpy (&lengthField, nnvData.constData() + 1 + (NNV_INDEX_SIZE * soundId) + 4, sizeof(int32_t));
+    lengthField = qFromLittleEndian<qint32>(lengthField);
+    len = lengthField;
+  }
+
+  return len;
+}
+
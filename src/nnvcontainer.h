@@ -0,0 +1,36 @@
+#pragma once
+#include <stdint.h>
+#include <QByteArray>
+#include <QVector>
+
+#define NNV_INDEX_SIZE 8
+
+/**
+ * Decompressed contents of an NNV sound container, along with the location of
+ * each DPCM-encoded sound within it. Copies share the same underlying data.
+ */
+class NnvContainer
+{
+public:
+  NnvContainer();
+  bool parse(const QByteArray& nnvData);
+  bool isValid() const;
+  int soundCount() const;
+  bool soundData(int soundId, const uint8_t*& encoded, int& length) const;
+
+private:
+  //! Location of a single encoded sound within the container data
+  struct SoundEntry
+  {
+    int offset;
+    int length;
+  };
+
+  bool m_valid;
+  QByteArray m_data;
+  QVector<SoundEntry> m_entries;
+
+  static int getStartLocation(const QByteArray& nnvData, int soundId);
+  static int getSoundDataLength(const QByteArray& nnvData, int soundId);
+};
+
@@ -49,12 +49,13 @@ Palette::Palette(DatLibrary& lib) :
 }
 
 /**
- * Clears the cached GAME.PAL data so that it will be loaded again from the data file
- * when it is next requested.
+ * Clears the cache of decoded palettes so that each will be loaded again from the
+ * data files when it is next requested.
  */
 void Palette::clear()
 {
-  m_gamePal.clear();
+  QMutexLocker locker(&m_cacheMutex);
+  m_cache.clear();
 }
 
 /**
@@ -156,23 +157,20 @@ void Palette::defaultVgaPalette(QVector<QRgb>& palette)
 
 /**
  * Loads the file "GAME.PAL" from the game's data files, overlays it on the default VGA palette,
- * and returns it in the provided vector.
+ * and returns it in the provided vector. This may be called from worker threads.
  * @return True when loading the palette data was successful, false otherwise
  */
 bool Palette::gamePalette(QVector<QRgb>& palette)
 {
-  bool status = true;
-  if (m_gamePal.size() == 0)
-  {
-    status = loadPalData(DatFileType::TEST, s_gamePalFilename, m_gamePal);
-  }
-  palette = m_gamePal;
-  return status;
+  return paletteByName(DatFileType::TEST, s_gamePalFilename, palette);
 }
 
 /**
- * Loads a palette file with the specified name (and from the specified DAT container),
- * overlays it on the default VGA palette, and returns it in the provided vector.
+ * Gets the palette with the specified name (from the specified DAT container). If a
+ * pointer to a startIndex location is given, only the palette colors actually contained
+ * in the file are returned; otherwise, the colors are overlayed on the default VGA palette.
+ * Each palette file is only read and decoded once, including those that fail to load, and
+ * the returned vectors share their data with the cache. This may be called from worker threads.
  * @return True when loading the palette data was successful, false otherwise
  */
 bool Palette::paletteByName(DatFileType datContainer,
@@ -180,7 +178,65 @@ bool Palette::paletteByName(DatFileType datContainer,
                             QVector<QRgb>& palette,
                             int* startIndex) const
 {
-  return loadPalData(datContainer, palFileName, palette, startIndex);
+  const QPair<int,QString> key(static_cast<int>(datContainer), palFileName);
+  CachedPalette entry;
+  bool found = false;
+
+  {
+    QMutexLocker locker(&m_cacheMutex);
+    QHash<QPair<int,QString>,CachedPalette>::const_iterator cached = m_cache.constFind(key);
+    if (cached != m_cache.constEnd())
+    {
+      entry = cached.value();
+      found = true;
+    }
+  }
+
+  // the file is read and decoded without holding the lock, so that palettes can be loaded
+  // on several threads at once; if two threads load the same palette, the first one is kept
+  if (!found)
+  {
+    entry.startIndex = 0;
+    entry.valid = loadPalData(datContainer, palFileName, entry.fileColors, &entry.startIndex);
+
+    if (entry.valid)
+    {
+      entry.fullPalette = s_defaultVgaPalette;
+      for (int colorIdx = 0; colorIdx < entry.fileColors.size(); colorIdx++)
+      {
+        const int palIdx = entry.startIndex + colorIdx;
+        if (palIdx < entry.fullPalette.size())
+        {
+          entry.fullPalette[palIdx] = entry.fileColors[colorIdx];
+        }
+      }
+    }
+
+    QMutexLocker locker(&m_cacheMutex);
+    if (m_cache.contains(key))
+    {
+      entry = m_cache.value(key);
+    }
+    else
+    {
+      m_cache.insert(key, entry);
+    }
+  }
+
+  if (entry.valid)
+  {
+    if (startIndex)
+    {
+      *startIndex = entry.startIndex;
+      palette = entry.fileColors;
+    }
+    else
+    {
+      palette = entry.fullPalette;
+    }
+  }
+
+  return entry.valid;
 }
 
 /**
@@ -200,3 +256,29 @@ QMap<DatFileType,QStringList> Palette::getAllPaletteList()
   return palContainerList;
 }
 
+
+/**
+ * Returns a copy of the provided palette with the colors in the inclusive range of
+ * indices [first, last] rotated upward by the given number of steps, in the same
+ * manner as the VGA palette cycling used for simple animation effects.
+ */
+QVector<QRgb> Palette::rotateRange(const QVector<QRgb>& palette, int first, int last, int steps)
+{
+  QVector<QRgb> rotated = palette;
+
+  first = qMax(first, 0);
+  last = qMin(last, palette.size() - 1);
+
+  if (last > first)
+  {
+    const int len = last - first + 1;
+    steps = ((steps % len) + len) % len;
+
+    for (int idx = 0; idx < len; idx++)
+    {
+      rotated[first + ((idx + steps) % len)] = palette[first + idx];
+    }
+  }
+
+  return rotated;
+}
@@ -2,6 +2,9 @@
 #include <QString>
 #include <QVector>
 #include <QRgb>
+#include <QMutex>
+#include <QHash>
+#include <QPair>
 #include "datlibrary.h"
 
 class Palette
@@ -18,11 +21,24 @@ public:
                      int* startIndex = nullptr) const;
   QMap<DatFileType,QStringList> getAllPaletteList();
 
+  static QVector<QRgb> rotateRange(const QVector<QRgb>& palette, int first, int last, int steps);
+
 private:
   static const QVector<QRgb> s_defaultVgaPalette;
   static const QString s_gamePalFilename;
   DatLibrary* m_lib;
-  QVector<QRgb> m_gamePal;
+
+  //! Decoded contents of a palette file, or a record that the file could not be loaded
+  struct CachedPalette
+  {
+    bool valid;
+    int startIndex;
+    QVector<QRgb> fileColors;
+    QVector<QRgb> fullPalette;
+  };
+
+  mutable QHash<QPair<int,QString>,CachedPalette> m_cache;
+  mutable QMutex m_cacheMutex;
 
   bool loadPalData(DatFileType datContainer,
                    QString palFileName,
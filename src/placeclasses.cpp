@@ -183,3 +183,30 @@ QString PlaceClasses::getStarClassName(int id)
   return name;
 }
 
+/**
+ * Gets a map of IDs to structs that each describe one of the planet classes,
+ * populating it first if necessary.
+ */
+QMap<int,PlanetClass> PlaceClasses::getPlanetClassList()
+{
+  if (m_planetClassList.isEmpty())
+  {
+    populatePlaceClassList();
+  }
+
+  return m_planetClassList;
+}
+
+/**
+ * Gets a map of IDs to structs that each describe one of the star classes,
+ * populating it first if necessary.
+ */
+QMap<int,StarClass> PlaceClasses::getStarClassList()
+{
+  if (m_starClassList.isEmpty())
+  {
+    populatePlaceClassList();
+  }
+
+  return m_starClassList;
+}
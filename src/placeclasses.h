@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include "datlibrary.h"
 #include "enums.h"
+#include "tableschema.h"
 
 struct PlanetClass
 {
@@ -43,6 +44,36 @@ typedef struct __attribute__((packed)) PClassTableEntry
 
 static_assert(sizeof(PClassTableEntry) == 48, "PClassTableEntry packing does not match game data");
 
+constexpr FieldDescriptor s_pclassTableFields[] =
+{
+  TABLE_GAMETEXT_FIELD(PClassTableEntry, nameOffset),
+  TABLE_UNKNOWN_FIELD(PClassTableEntry, unknown_a),
+  TABLE_FIELD(PClassTableEntry, temperature),
+  TABLE_UNKNOWN_FIELD(PClassTableEntry, unknown_b),
+  TABLE_FIELD(PClassTableEntry, inhabited),
+  TABLE_FIELD(PClassTableEntry, classType),
+  TABLE_FIELD(PClassTableEntry, foods),
+  TABLE_FIELD(PClassTableEntry, foodsAgriculture),
+  TABLE_FIELD(PClassTableEntry, ores),
+  TABLE_FIELD(PClassTableEntry, oresConcentration),
+  TABLE_FIELD(PClassTableEntry, ancientArtifacts),
+  TABLE_FIELD(PClassTableEntry, ancientArtifactsConcentration),
+  TABLE_FIELD(PClassTableEntry, gasses),
+  TABLE_FIELD(PClassTableEntry, gassesConcentration),
+  TABLE_FIELD(PClassTableEntry, animals),
+  TABLE_FIELD(PClassTableEntry, animalsConcentration),
+  TABLE_FIELD(PClassTableEntry, intelligenceItems),
+  TABLE_FIELD(PClassTableEntry, intelligenceItemsConcentration),
+  TABLE_UNKNOWN_FIELD(PClassTableEntry, unknown_c)
+};
+
+template <>
+struct TableSchema<PClassTableEntry>
+{
+  static constexpr const FieldDescriptor* fields() { return s_pclassTableFields; }
+  static constexpr int fieldCount() { return sizeof(s_pclassTableFields) / sizeof(FieldDescriptor); }
+};
+
 typedef struct __attribute__((packed)) StClassTableEntry
 {
   uint16_t nameOffset;
@@ -51,6 +82,19 @@ typedef struct __attribute__((packed)) StClassTableEntry
 
 static_assert(sizeof(StClassTableEntry) == 6, "StClassTableEntry packing does not match game data");
 
+constexpr FieldDescriptor s_stclassTableFields[] =
+{
+  TABLE_GAMETEXT_FIELD(StClassTableEntry, nameOffset),
+  TABLE_UNKNOWN_FIELD(StClassTableEntry, unknown)
+};
+
+template <>
+struct TableSchema<StClassTableEntry>
+{
+  static constexpr const FieldDescriptor* fields() { return s_stclassTableFields; }
+  static constexpr int fieldCount() { return sizeof(s_stclassTableFields) / sizeof(FieldDescriptor); }
+};
+
 /**
  * Reads and parses data table with place class information (for stars and planets).
  * This class stores information about planet names, resources, temperature, and
@@ -63,6 +107,8 @@ public:
   bool pclassData(int id, PlanetClass& pclass);
   void clear();
   QString getStarClassName(int id);
+  QMap<int,PlanetClass> getPlanetClassList();
+  QMap<int,StarClass> getStarClassList();
 
 private:
   DatLibrary* m_lib;
@@ -140,10 +140,10 @@ bool Places::populateList()
 }
 
 /**
- * Gets a map of IDs to struct, where each one contains data about one of the
- * places in the game.
+ * Gets the table of structs, indexed by ID, where each one contains data about one
+ * of the places in the game.
  */
-QMap<int,Place> Places::getPlaceList()
+const DenseIdTable<Place>& Places::getPlaceList()
 {
   if (m_placeList.isEmpty())
   {
@@ -6,6 +6,7 @@
 #include "enums.h"
 #include "datlibrary.h"
 #include "dattable.h"
+#include "denseidtable.h"
 #include "palette.h"
 #include "placeclasses.h"
 
@@ -35,6 +36,26 @@ typedef struct __attribute__((packed)) PlaceTableEntry
 
 static_assert(sizeof(PlaceTableEntry) == 16, "PlaceTableEntry packing does not match game data");
 
+constexpr FieldDescriptor s_placeTableFields[] =
+{
+  TABLE_GAMETEXT_FIELD(PlaceTableEntry, nameOffset),
+  TABLE_FIELD(PlaceTableEntry, flags),
+  TABLE_FIELD(PlaceTableEntry, pclass),
+  TABLE_FIELD(PlaceTableEntry, isPlanet),
+  TABLE_FIELD(PlaceTableEntry, parentStarId),
+  TABLE_UNKNOWN_FIELD(PlaceTableEntry, unknown_a),
+  TABLE_FIELD(PlaceTableEntry, planetRepId),
+  TABLE_FIELD(PlaceTableEntry, race),
+  TABLE_UNKNOWN_FIELD(PlaceTableEntry, unknown_b)
+};
+
+template <>
+struct TableSchema<PlaceTableEntry>
+{
+  static constexpr const FieldDescriptor* fields() { return s_placeTableFields; }
+  static constexpr int fieldCount() { return sizeof(s_placeTableFields) / sizeof(FieldDescriptor); }
+};
+
 /**
  * Reads data about places (stars and planets) from data files, and also provides images of the
  * surface textures used when planets are rendered in game.
@@ -45,7 +66,7 @@ public:
   Places(DatLibrary& lib, Palette& pal, PlaceClasses& pclasses);
 
   void clear();
-  QMap<int,Place> getPlaceList();
+  const DenseIdTable<Place>& getPlaceList();
   bool getPlace(int id, Place& p);
   QImage getPlaceSurfaceImage(int id, bool& status, QString& palFilename);
   QString getName(int id);
@@ -56,7 +77,7 @@ protected:
 private:
   Palette* m_pal;
   PlaceClasses* m_placeClasses;
-  QMap<int,Place> m_placeList;
+  DenseIdTable<Place> m_placeList;
 
   static const uint8_t s_planetTextureMapping[622];
 };
@@ -0,0 +1,493 @@
+#include <QtConcurrent>
+#include <QStringList>
+#include "reachabilityexplorer.h"
+
+namespace
+{
+  ReachItem makeItem(ReachItemType type, int id)
+  {
+    ReachItem item;
+    item.type = type;
+    item.id = id;
+    return item;
+  }
+
+  /**
+   * Finds the item that the player needs in order to raise the provided topic.
+   * @return True if the topic needs an item; false if it is a greeting (or is not understood).
+   */
+  bool topicPrerequisite(ConvTopicCategory topic, int thingId, ReachItem& item)
+  {
+    bool status = true;
+
+    switch (topic)
+    {
+    case ConvTopicCategory_AskAboutPerson:
+      item = makeItem(ReachItemType::Alien, thingId);
+      break;
+    case ConvTopicCategory_AskAboutLocation:
+      item = makeItem(ReachItemType::Place, thingId);
+      break;
+    case ConvTopicCategory_AskAboutObject:
+      item = makeItem(ReachItemType::Object, thingId);
+      break;
+    case ConvTopicCategory_AskAboutRace:
+      item = makeItem(ReachItemType::Race, thingId);
+      break;
+    case ConvTopicCategory_DisplayObject:
+    case ConvTopicCategory_GiveObject:
+    case ConvTopicCategory_SeesObject:
+      item = makeItem(ReachItemType::HeldObject, thingId);
+      break;
+    case ConvTopicCategory_GiveFact:
+      item = makeItem(ReachItemType::Fact, thingId);
+      break;
+    default:
+      status = false;
+      break;
+    }
+
+    return status;
+  }
+
+  /**
+   * Returns the items granted by the provided embedded command. An object that is added to
+   * the player's inventory also becomes known.
+   */
+  QVector<ReachItem> commandGrants(GTxtCmd cmd, int param)
+  {
+    QVector<ReachItem> items;
+
+    switch (cmd)
+    {
+    case GTxtCmd_GrantKnowledgeFact:
+      items.append(makeItem(ReachItemType::Fact, param));
+      break;
+    case GTxtCmd_GrantKnowledgePlace:
+      items.append(makeItem(ReachItemType::Place, param));
+      break;
+    case GTxtCmd_GrantKnowledgeAlien:
+      items.append(makeItem(ReachItemType::Alien, param));
+      break;
+    case GTxtCmd_GrantKnowledgeObject:
+      items.append(makeItem(ReachItemType::Object, param));
+      break;
+    case GTxtCmd_GrantKnowledgeRace:
+      items.append(makeItem(ReachItemType::Race, param));
+      break;
+    case GTxtCmd_AddItem:
+      items.append(makeItem(ReachItemType::HeldObject, param));
+      items.append(makeItem(ReachItemType::Object, param));
+      break;
+    default:
+      break;
+    }
+
+    return items;
+  }
+}
+
+/**
+ * Reads every response of the specified alien, and groups the responses that grant any
+ * items by the item needed to raise their topics.
+ */
+ReachAlienEdges ReachEdgeReader::operator()(int alienId) const
+{
+  ReachAlienEdges edges;
+  edges.alienId = alienId;
+
+  if (cancelRequested->load() == 0)
+  {
+    foreach (const ConvResponse& response, convText->getAllResponses(alienId, alienRaces.value(alienId, -1)))
+    {
+      bool grantsItems = false;
+      for (int cmdIndex = 0; !grantsItems && (cmdIndex < response.commands.size()); cmdIndex++)
+      {
+        grantsItems = !commandGrants(response.commands.at(cmdIndex).first, response.commands.at(cmdIndex).second).isEmpty();
+      }
+
+      if (grantsItems)
+      {
+        ReachItem prerequisite;
+        if (topicPrerequisite(response.topic, response.thingId, prerequisite))
+        {
+          edges.byPrerequisite[prerequisite].append(edges.responses.size());
+        }
+        else
+        {
+          edges.greetings.append(edges.responses.size());
+        }
+        edges.responses.append(response);
+      }
+    }
+  }
+
+  return edges;
+}
+
+/**
+ * Returns a step for every item granted by the alien in response to the topics opened up by
+ * the frontier. The greetings are only expanded in the first level, since they need no item.
+ */
+QVector<ReachStep> ReachLevelExpander::operator()(const ReachAlienEdges& edges) const
+{
+  QVector<ReachStep> steps;
+
+  if (level == 1)
+  {
+    foreach (int responseIndex, edges.greetings)
+    {
+      addGrants(steps, edges, responseIndex, false, ReachItem());
+    }
+  }
+
+  foreach (const ReachItem& item, frontier)
+  {
+    foreach (int responseIndex, edges.byPrerequisite.value(item))
+    {
+      addGrants(steps, edges, responseIndex, true, item);
+    }
+  }
+
+  return steps;
+}
+
+void ReachLevelExpander::addGrants(QVector<ReachStep>& steps, const ReachAlienEdges& edges, int responseIndex,
+                                   bool hasPrerequisite, const ReachItem& prerequisite) const
+{
+  const ConvResponse& response = edges.responses.at(responseIndex);
+
+  typedef QPair<GTxtCmd,int> CommandPair;
+  foreach (const CommandPair& cmd, response.commands)
+  {
+    foreach (const ReachItem& item, commandGrants(cmd.first, cmd.second))
+    {
+      ReachStep step;
+      step.item = item;
+      step.level = level;
+      step.alienId = edges.alienId;
+      step.topic = response.topic;
+      step.thingId = response.thingId;
+      step.tableType = response.tableType;
+      step.tableId = response.tableId;
+      step.tlkxIndex = response.tlkxIndex;
+      step.hasPrerequisite = hasPrerequisite;
+      step.prerequisite = prerequisite;
+      steps.append(step);
+    }
+  }
+}
+
+ReachabilityResult::ReachabilityResult(const ReachabilitySeed& seed) :
+  m_seed(seed)
+{
+
+}
+
+/**
+ * Records the step that unlocks an item, unless the item has already been unlocked.
+ * @return True if the item had not already been unlocked; false otherwise.
+ */
+bool ReachabilityResult::addStep(const ReachStep& step)
+{
+  bool status = false;
+
+  if (!m_lookup.contains(step.item))
+  {
+    m_lookup.insert(step.item, m_steps.size());
+    m_steps.append(step);
+    status = true;
+  }
+
+  return status;
+}
+
+bool ReachabilityResult::isReachable(const ReachItem& item) const
+{
+  return m_lookup.contains(item);
+}
+
+/**
+ * Returns the number of conversations in the longest of the shortest paths to any item.
+ */
+int ReachabilityResult::levelCount() const
+{
+  return m_steps.isEmpty() ? 0 : m_steps.last().level;
+}
+
+/**
+ * Returns the shortest chain of conversations that unlocks the provided item, starting
+ * with the item that the player has at the start of the game. The list is empty if the
+ * item cannot be reached.
+ */
+QVector<ReachStep> ReachabilityResult::path(const ReachItem& item) const
+{
+  QVector<ReachStep> steps;
+  int stepIndex = m_lookup.value(item, -1);
+
+  while (stepIndex >= 0)
+  {
+    const ReachStep& step = m_steps.at(stepIndex);
+    steps.prepend(step);
+    stepIndex = step.hasPrerequisite ? m_lookup.value(step.prerequisite, -1) : -1;
+  }
+
+  return steps;
+}
+
+/**
+ * Returns the items (from the full set provided with the seed) that cannot be reached.
+ */
+QList<ReachItem> ReachabilityResult::unreachable() const
+{
+  QList<ReachItem> items;
+
+  foreach (const ReachItem& item, m_seed.allItems)
+  {
+    if (!m_lookup.contains(item))
+    {
+      items.append(item);
+    }
+  }
+
+  return items;
+}
+
+QString ReachabilityResult::itemName(const ReachItem& item) const
+{
+  const QString name = m_seed.names.value(item);
+  return name.isEmpty() ? QString("%1 %2").arg(typeName(item.type)).arg(item.id) :
+                          QString("%1 %2 (%3)").arg(typeName(item.type)).arg(item.id).arg(name);
+}
+
+QString ReachabilityResult::describeStep(const ReachStep& step) const
+{
+  QString desc;
+
+  if (step.level == 0)
+  {
+    desc = QString("start: %1").arg(itemName(step.item));
+  }
+  else
+  {
+    const QString alienName = m_seed.names.value(makeItem(ReachItemType::Alien, step.alienId));
+    desc = QString("%1: talk to %2, %3").arg(step.level)
+                                        .arg(alienName.isEmpty() ? QString::number(step.alienId) : alienName)
+                                        .arg(topicName(step.topic));
+    if (step.hasPrerequisite)
+    {
+      desc += QString(" %1").arg(itemName(step.prerequisite));
+    }
+    desc += QString(" -> %1 [%2 %3, line %4]").arg(itemName(step.item))
+                                              .arg((step.tableType == ConvTableType_Race) ? "TLKXR" : "TLKXC")
+                                              .arg(step.tableId)
+                                              .arg(step.tlkxIndex);
+  }
+
+  return desc;
+}
+
+/**
+ * Returns a report listing the items of each type that cannot be reached, followed by the
+ * shortest unlocking path of every item that can be reached through conversation.
+ */
+QString ReachabilityResult::report() const
+{
+  QString text;
+  const QList<ReachItem> missing = unreachable();
+  const ReachItemType types[] = { ReachItemType::Fact, ReachItemType::Place, ReachItemType::Object,
+                                  ReachItemType::Alien, ReachItemType::Race };
+
+  for (ReachItemType type : types)
+  {
+    int total = 0;
+    int missingCount = 0;
+    foreach (const ReachItem& item, m_seed.allItems)
+    {
+      if (item.type == type)
+      {
+        total++;
+        missingCount += m_lookup.contains(item) ? 0 : 1;
+      }
+    }
+    text += QString("%1: %2 of %3 reachable through conversation\n").arg(typeName(type)).arg(total - missingCount).arg(total);
+  }
+  text += QString("Longest unlocking chain: %1 conversations\n").arg(levelCount());
+
+  text += "\nUnreachable:\n";
+  foreach (const ReachItem& item, missing)
+  {
+    text += QString("  %1\n").arg(itemName(item));
+  }
+
+  text += "\nUnlocking paths:\n";
+  foreach (const ReachStep& step, m_steps)
+  {
+    if (step.level > 0)
+    {
+      text += QString("%1\n").arg(itemName(step.item));
+      foreach (const ReachStep& pathStep, path(step.item))
+      {
+        text += QString("  %1\n").arg(describeStep(pathStep));
+      }
+    }
+  }
+
+  return text;
+}
+
+QString ReachabilityResult::typeName(ReachItemType type)
+{
+  QString name;
+
+  switch (type)
+  {
+  case ReachItemType::Alien:      name = "Alien";       break;
+  case ReachItemType::Race:       name = "Race";        break;
+  case ReachItemType::Fact:       name = "Fact";        break;
+  case ReachItemType::Place:      name = "Place";       break;
+  case ReachItemType::Object:     name = "Object";      break;
+  case ReachItemType::HeldObject: name = "Held object"; break;
+  }
+
+  return name;
+}
+
+QString ReachabilityResult::topicName(ConvTopicCategory topic)
+{
+  QString name;
+
+  switch (topic)
+  {
+  case ConvTopicCategory_GreetingInitial:    name = "first greeting";       break;
+  case ConvTopicCategory_GreetingSubsequent: name = "later greeting";       break;
+  case ConvTopicCategory_AskAboutPerson:     name = "ask about";            break;
+  case ConvTopicCategory_AskAboutLocation:   name = "ask about";            break;
+  case ConvTopicCategory_AskAboutObject:     name = "ask about";            break;
+  case ConvTopicCategory_AskAboutRace:       name = "ask about";            break;
+  case ConvTopicCategory_DisplayObject:      name = "show";                 break;
+  case ConvTopicCategory_GiveObject:         name = "give";                 break;
+  case ConvTopicCategory_GiveFact:           name = "tell";                 break;
+  case ConvTopicCategory_SeesObject:         name = "let them see";         break;
+  }
+
+  return name;
+}
+
+ReachabilityExplorer::ReachabilityExplorer(ConversationText& convText, QObject* parent) :
+  QObject(parent),
+  m_convText(&convText)
+{
+  connect(&m_watcher, &QFutureWatcher<ReachabilityResultPtr>::finished, this, &ReachabilityExplorer::onFinished);
+}
+
+ReachabilityExplorer::~ReachabilityExplorer()
+{
+  cancel();
+}
+
+/**
+ * Discards the current result and starts a new exploration on a worker thread. The
+ * finished() signal is emitted when the new result is available from result().
+ */
+void ReachabilityExplorer::start(const ReachabilitySeed& seed)
+{
+  cancel();
+  m_result.clear();
+  m_cancelRequested.store(0);
+  m_watcher.setFuture(QtConcurrent::run(this, &ReachabilityExplorer::explore, seed));
+}
+
+/**
+ * Stops the exploration in progress (if any) and waits for the worker threads to finish.
+ */
+void ReachabilityExplorer::cancel()
+{
+  if (m_watcher.isRunning())
+  {
+    m_cancelRequested.store(1);
+    m_watcher.waitForFinished();
+  }
+}
+
+bool ReachabilityExplorer::isRunning() const
+{
+  return m_watcher.isRunning();
+}
+
+/**
+ * Returns the most recently completed result, or a null pointer if there is none.
+ */
+ReachabilityResultPtr ReachabilityExplorer::result() const
+{
+  return m_result;
+}
+
+void ReachabilityExplorer::onFinished()
+{
+  m_result = m_watcher.result();
+  emit finished(m_result.isNull());
+}
+
+/**
+ * Runs the breadth-first closure. Each level is expanded for all of the aliens in parallel,
+ * and the steps found are then merged in order of alien ID, so that the result does not
+ * depend on thread scheduling. This runs on a worker thread, and only uses the conversation
+ * text parser, which may be used from any thread.
+ * @return The completed result, or a null pointer if the exploration was cancelled.
+ */
+ReachabilityResultPtr ReachabilityExplorer::explore(ReachabilitySeed seed)
+{
+  QSharedPointer<ReachabilityResult> result(new ReachabilityResult(seed));
+  QVector<ReachItem> frontier;
+
+  foreach (const ReachItem& item, seed.knownItems)
+  {
+    ReachStep step;
+    step.item = item;
+    step.level = 0;
+    step.alienId = -1;
+    step.topic = ConvTopicCategory_GreetingInitial;
+    step.thingId = -1;
+    step.tableType = ConvTableType_Invalid;
+    step.tableId = -1;
+    step.tlkxIndex = -1;
+    step.hasPrerequisite = false;
+    step.prerequisite = ReachItem();
+    if (result->addStep(step))
+    {
+      frontier.append(item);
+    }
+  }
+
+  ReachEdgeReader reader;
+  reader.convText = m_convText;
+  reader.alienRaces = seed.alienRaces;
+  reader.cancelRequested = &m_cancelRequested;
+  const QList<ReachAlienEdges> edges =
+    QtConcurrent::blockingMapped<QList<ReachAlienEdges> >(seed.alienRaces.keys(), reader);
+
+  int level = 1;
+  while (((level == 1) || !frontier.isEmpty()) && (m_cancelRequested.load() == 0))
+  {
+    ReachLevelExpander expander;
+    expander.frontier = frontier;
+    expander.level = level;
+    frontier.clear();
+
+    foreach (const QVector<ReachStep>& steps, QtConcurrent::blockingMapped<QList<QVector<ReachStep> > >(edges, expander))
+    {
+      foreach (const ReachStep& step, steps)
+      {
+        if (result->addStep(step))
+        {
+          frontier.append(step.item);
+        }
+      }
+    }
+
+    level++;
+  }
+
+  return (m_cancelRequested.load() == 0) ? result : ReachabilityResultPtr();
+}
@@ -0,0 +1,181 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QFutureWatcher>
+#include "gametext.h"
+#include "conversationtext.h"
+
+enum class ReachItemType
+{
+  Alien,
+  Race,
+  Fact,
+  Place,
+  Object,
+  HeldObject
+};
+
+/**
+ * A piece of knowledge (or an inventory object) that the player may have. Having an item
+ * makes it possible to raise the conversation topics about it.
+ */
+struct ReachItem
+{
+  ReachItemType type;
+  int id;
+};
+
+inline bool operator==(const ReachItem& a, const ReachItem& b)
+{
+  return (a.type == b.type) && (a.id == b.id);
+}
+
+inline uint qHash(const ReachItem& item, uint seed = 0)
+{
+  return qHash((static_cast<int>(item.type) << 24) ^ item.id, seed);
+}
+
+/**
+ * The conversation in which an item is first unlocked: the alien spoken to, the topic that
+ * was raised (which requires the prerequisite item, unless the topic is a greeting), and the
+ * line of dialogue that grants the item. Items that the player has at the start of the game
+ * are at level 0 and have no conversation.
+ */
+struct ReachStep
+{
+  ReachItem item;
+  int level;
+  int alienId;
+  ConvTopicCategory topic;
+  int thingId;
+  ConvTableType tableType;
+  int tableId;
+  int tlkxIndex;
+  bool hasPrerequisite;
+  ReachItem prerequisite;
+};
+
+/**
+ * The starting conditions for an exploration, gathered from the data tables before it
+ * starts: the aliens that can be spoken to (with the race of each), the items that the
+ * player has at the start, and the full set of items (with their names) against which
+ * unreachable content is reported.
+ */
+struct ReachabilitySeed
+{
+  QMap<int,int> alienRaces;
+  QList<ReachItem> knownItems;
+  QList<ReachItem> allItems;
+  QHash<ReachItem,QString> names;
+};
+
+/**
+ * Every response that a single alien can give, grouped by the item needed to raise the
+ * topic that leads to it. Greetings need no item.
+ */
+struct ReachAlienEdges
+{
+  int alienId;
+  QVector<ConvResponse> responses;
+  QVector<int> greetings;
+  QHash<ReachItem,QVector<int> > byPrerequisite;
+};
+
+/**
+ * Function object that is run on the worker threads to read the responses of a single alien.
+ */
+struct ReachEdgeReader
+{
+  typedef ReachAlienEdges result_type;
+
+  ConversationText* convText;
+  QMap<int,int> alienRaces;
+  const QAtomicInt* cancelRequested;
+
+  ReachAlienEdges operator()(int alienId) const;
+};
+
+/**
+ * Function object that is run on the worker threads to find every item granted by a single
+ * alien in response to the topics opened up by the items found in the previous level.
+ */
+struct ReachLevelExpander
+{
+  typedef QVector<ReachStep> result_type;
+
+  QVector<ReachItem> frontier;
+  int level;
+
+  QVector<ReachStep> operator()(const ReachAlienEdges& edges) const;
+  void addGrants(QVector<ReachStep>& steps, const ReachAlienEdges& edges, int responseIndex,
+                 bool hasPrerequisite, const ReachItem& prerequisite) const;
+};
+
+/**
+ * Results of an exploration: the step that first unlocks each reachable item, from which
+ * the shortest chain of conversations leading to any item can be found.
+ */
+class ReachabilityResult
+{
+public:
+  ReachabilityResult(const ReachabilitySeed& seed);
+  bool addStep(const ReachStep& step);
+  bool isReachable(const ReachItem& item) const;
+  int levelCount() const;
+  QVector<ReachStep> path(const ReachItem& item) const;
+  QList<ReachItem> unreachable() const;
+  QString itemName(const ReachItem& item) const;
+  QString describeStep(const ReachStep& step) const;
+  QString report() const;
+
+  static QString typeName(ReachItemType type);
+  static QString topicName(ConvTopicCategory topic);
+
+private:
+  ReachabilitySeed m_seed;
+  QVector<ReachStep> m_steps;
+  QHash<ReachItem,int> m_lookup;
+};
+
+typedef QSharedPointer<const ReachabilityResult> ReachabilityResultPtr;
+
+/**
+ * Finds the items that can be reached through conversation. Starting from the items that
+ * the player has at the start of the game, a breadth-first closure treats each line of
+ * dialogue that grants knowledge or an object as an edge from the item needed to raise its
+ * topic to the items it grants. The responses of the aliens are read, and each level of the
+ * search is expanded, in parallel across aliens on the global thread pool.
+ */
+class ReachabilityExplorer : public QObject
+{
+  Q_OBJECT
+
+public:
+  ReachabilityExplorer(ConversationText& convText, QObject* parent = nullptr);
+  ~ReachabilityExplorer();
+
+  void start(const ReachabilitySeed& seed);
+  void cancel();
+  bool isRunning() const;
+  ReachabilityResultPtr result() const;
+
+signals:
+  void finished(bool cancelled);
+
+private slots:
+  void onFinished();
+
+private:
+  ConversationText* m_convText;
+  QAtomicInt m_cancelRequested;
+  QFutureWatcher<ReachabilityResultPtr> m_watcher;
+  ReachabilityResultPtr m_result;
+
+  ReachabilityResultPtr explore(ReachabilitySeed seed);
+};
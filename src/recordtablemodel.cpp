@@ -0,0 +1,214 @@
+#include "recordtablemodel.h"
+#include "enums.h"
+
+/**
+ * Returns the names of the races, in order of race ID, for use as column headers.
+ */
+static QStringList raceNameHeaders()
+{
+  QStringList names;
+  for (int raceId = 0; raceId < static_cast<int>(AlienRace::NumRaces); raceId++)
+  {
+    names.append(s_raceNames.value(static_cast<AlienRace>(raceId)));
+  }
+  return names;
+}
+
+PlaceTableModel::PlaceTableModel(QObject* parent) :
+  RecordTableModel<Place>(QStringList({ "ID", "Name" }), parent)
+{
+
+}
+
+QVariant PlaceTableModel::recordData(const Place& record, int column) const
+{
+  return (column == 0) ? QVariant(record.id) : QVariant(record.name);
+}
+
+ObjectTableModel::ObjectTableModel(QObject* parent) :
+  RecordTableModel<InventoryObj>(QStringList({ "ID", "Name" }) + raceNameHeaders(), parent)
+{
+
+}
+
+/**
+ * Gives the ID and name of the object, followed by its value to each race.
+ */
+QVariant ObjectTableModel::recordData(const InventoryObj& record, int column) const
+{
+  QVariant value;
+
+  if (column == 0)
+  {
+    value = record.id;
+  }
+  else if (column == 1)
+  {
+    value = record.name;
+  }
+  else if ((column - 2) < static_cast<int>(AlienRace::NumRaces))
+  {
+    value = record.valueByRace[column - 2];
+  }
+
+  return value;
+}
+
+AlienTableModel::AlienTableModel(QObject* parent) :
+  RecordTableModel<Alien>(QStringList({ "ID", "Name", "Race" }), parent)
+{
+
+}
+
+QVariant AlienTableModel::recordData(const Alien& record, int column) const
+{
+  QVariant value;
+
+  if (column == 0)
+  {
+    value = record.id;
+  }
+  else if (column == 1)
+  {
+    value = record.name;
+  }
+  else if (column == s_raceColumn)
+  {
+    value = s_raceNames.contains(record.race) ? s_raceNames[record.race] : "(invalid/unknown)";
+  }
+
+  return value;
+}
+
+ShipTableModel::ShipTableModel(ShipClasses& shipClasses, Aliens& aliens, Places& places, QObject* parent) :
+  RecordTableModel<Ship>(QStringList({ "ID", "Name", "Class", "Pilot", "Location" }), parent),
+  m_shipClasses(&shipClasses),
+  m_aliens(&aliens),
+  m_places(&places)
+{
+
+}
+
+QVariant ShipTableModel::recordData(const Ship& record, int column) const
+{
+  QVariant value;
+
+  if (column == 0)
+  {
+    value = record.id;
+  }
+  else if (column == 1)
+  {
+    value = record.name;
+  }
+  else if (column == 2)
+  {
+    value = m_shipClasses->getName(record.shipclass);
+  }
+  else if (column == 3)
+  {
+    value = m_aliens->getName(record.pilot);
+  }
+  else if (column == 4)
+  {
+    value = m_places->getName(record.location);
+  }
+
+  return value;
+}
+
+FactTableModel::FactTableModel(QObject* parent) :
+  RecordTableModel<Fact>(QStringList("ID") + raceNameHeaders(), parent)
+{
+
+}
+
+/**
+ * Gives the ID of the fact, followed by the receptivity of each race to it.
+ */
+QVariant FactTableModel::recordData(const Fact& record, int column) const
+{
+  QVariant value;
+
+  if (column == 0)
+  {
+    value = record.id;
+  }
+  else if ((column - 1) < static_cast<int>(AlienRace::NumRaces))
+  {
+    value = record.receptivity.value(static_cast<AlienRace>(column - 1));
+  }
+
+  return value;
+}
+
+ConvTopicTableModel::ConvTopicTableModel(QObject* parent) :
+  QAbstractTableModel(parent)
+{
+
+}
+
+/**
+ * Replaces the listed topics. The two lists must be the same length, with the name of
+ * each topic at the same position as its ID.
+ */
+void ConvTopicTableModel::setTopics(const QVector<int>& ids, const QStringList& names)
+{
+  beginResetModel();
+  m_ids = ids;
+  m_names = names;
+  endResetModel();
+}
+
+void ConvTopicTableModel::clear()
+{
+  beginResetModel();
+  m_ids.clear();
+  m_names.clear();
+  endResetModel();
+}
+
+int ConvTopicTableModel::rowCount(const QModelIndex& parent) const
+{
+  return parent.isValid() ? 0 : m_ids.count();
+}
+
+int ConvTopicTableModel::columnCount(const QModelIndex& parent) const
+{
+  return parent.isValid() ? 0 : 2;
+}
+
+QVariant ConvTopicTableModel::data(const QModelIndex& index, int role) const
+{
+  QVariant value;
+
+  if (index.isValid() && (index.row() < m_ids.count()))
+  {
+    if ((role == RECORD_ID_ROLE) || ((role == Qt::DisplayRole) && (index.column() == 0)))
+    {
+      value = m_ids.at(index.row());
+    }
+    else if (role == Qt::DisplayRole)
+    {
+      value = m_names.value(index.row());
+    }
+  }
+
+  return value;
+}
+
+QVariant ConvTopicTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  QVariant value;
+
+  if ((orientation == Qt::Horizontal) && (role == Qt::DisplayRole) && (section >= 0) && (section < 2))
+  {
+    value = QString((section == 0) ? "ID" : "Name");
+  }
+  else
+  {
+    value = QAbstractTableModel::headerData(section, orientation, role);
+  }
+
+  return value;
+}
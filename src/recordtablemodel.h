@@ -0,0 +1,202 @@
+#pragma once
+#include <QAbstractTableModel>
+#include <QModelIndex>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+#include "denseidtable.h"
+#include "aliens.h"
+#include "facts.h"
+#include "invobject.h"
+#include "places.h"
+#include "ships.h"
+#include "shipclasses.h"
+
+//! Item data role through which every cell of a record table model gives the ID of its record
+#define RECORD_ID_ROLE Qt::UserRole
+
+/**
+ * Base for the table models that present one of the parsed data tables, with one row per
+ * record. The model only keeps the ID of the record on each row; the contents of a cell are
+ * read from the table when the view asks for them, so only the rows that are actually
+ * displayed are ever formatted. Numeric columns are given as numbers so that a sorting
+ * proxy orders them numerically.
+ */
+template <typename T>
+class RecordTableModel : public QAbstractTableModel
+{
+public:
+  RecordTableModel(const QStringList& headers, QObject* parent = nullptr) :
+    QAbstractTableModel(parent),
+    m_headers(headers),
+    m_table(nullptr)
+  {
+
+  }
+
+  /**
+   * Presents the records in the provided table, which must outlive the model or be
+   * removed from it with clear() before it is destroyed or changed.
+   */
+  void setTable(const DenseIdTable<T>& table)
+  {
+    beginResetModel();
+    m_table = &table;
+    m_ids = table.keys().toVector();
+    endResetModel();
+  }
+
+  void clear()
+  {
+    beginResetModel();
+    m_table = nullptr;
+    m_ids.clear();
+    endResetModel();
+  }
+
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override
+  {
+    return parent.isValid() ? 0 : m_ids.count();
+  }
+
+  int columnCount(const QModelIndex& parent = QModelIndex()) const override
+  {
+    return parent.isValid() ? 0 : m_headers.count();
+  }
+
+  QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override
+  {
+    QVariant value;
+
+    if (m_table && index.isValid() && (index.row() < m_ids.count()))
+    {
+      const int id = m_ids.at(index.row());
+      if (role == RECORD_ID_ROLE)
+      {
+        value = id;
+      }
+      else if (role == Qt::DisplayRole)
+      {
+        const T* record = m_table->find(id);
+        if (record)
+        {
+          value = recordData(*record, index.column());
+        }
+      }
+    }
+
+    return value;
+  }
+
+  QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override
+  {
+    QVariant value;
+
+    if ((orientation == Qt::Horizontal) && (role == Qt::DisplayRole) && (section >= 0) && (section < m_headers.count()))
+    {
+      value = m_headers.at(section);
+    }
+    else
+    {
+      value = QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    return value;
+  }
+
+protected:
+  virtual QVariant recordData(const T& record, int column) const = 0;
+
+private:
+  QStringList m_headers;
+  const DenseIdTable<T>* m_table;
+  QVector<int> m_ids;
+};
+
+/**
+ * Returns the ID of the record shown on the row of the provided index in a record table
+ * model (or a proxy of one), or -1 if the index is not valid.
+ */
+inline int recordIdAt(const QModelIndex& index)
+{
+  return index.isValid() ? index.data(RECORD_ID_ROLE).toInt() : -1;
+}
+
+class PlaceTableModel : public RecordTableModel<Place>
+{
+public:
+  PlaceTableModel(QObject* parent = nullptr);
+
+protected:
+  QVariant recordData(const Place& record, int column) const override;
+};
+
+class ObjectTableModel : public RecordTableModel<InventoryObj>
+{
+public:
+  ObjectTableModel(QObject* parent = nullptr);
+
+protected:
+  QVariant recordData(const InventoryObj& record, int column) const override;
+};
+
+class AlienTableModel : public RecordTableModel<Alien>
+{
+public:
+  AlienTableModel(QObject* parent = nullptr);
+  static const int s_raceColumn = 2;
+
+protected:
+  QVariant recordData(const Alien& record, int column) const override;
+};
+
+/**
+ * Model of the ship table. The names of each ship's class, pilot, and location are looked
+ * up from their own tables as the rows are displayed.
+ */
+class ShipTableModel : public RecordTableModel<Ship>
+{
+public:
+  ShipTableModel(ShipClasses& shipClasses, Aliens& aliens, Places& places, QObject* parent = nullptr);
+
+protected:
+  QVariant recordData(const Ship& record, int column) const override;
+
+private:
+  ShipClasses* m_shipClasses;
+  Aliens* m_aliens;
+  Places* m_places;
+};
+
+class FactTableModel : public RecordTableModel<Fact>
+{
+public:
+  FactTableModel(QObject* parent = nullptr);
+
+protected:
+  QVariant recordData(const Fact& record, int column) const override;
+};
+
+/**
+ * Model of the conversation topic table, which lists the people, places, objects, races,
+ * or facts that can be the subject of the selected topic category. Unlike the other record
+ * tables, its rows are drawn from whichever table the category refers to, so the model
+ * keeps the ID and name of each topic. Each row gives its topic ID through RECORD_ID_ROLE.
+ */
+class ConvTopicTableModel : public QAbstractTableModel
+{
+public:
+  ConvTopicTableModel(QObject* parent = nullptr);
+
+  void setTopics(const QVector<int>& ids, const QStringList& names);
+  void clear();
+
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+  QVector<int> m_ids;
+  QStringList m_names;
+};
@@ -0,0 +1,298 @@
+#include <math.h>
+#include <string.h>
+#include <QHash>
+#include <QPair>
+#include <QMutex>
+#include <QMutexLocker>
+#include "resampler.h"
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#define RESAMPLER_KAISER_BETA 8.0
+#define RESAMPLER_PASSBAND 0.91
+
+/**
+ * Prepares a resampler for the provided input and output rates. The filter bank for
+ * the reduced ratio of the two rates is only built when the first output sample is
+ * computed, and is then shared by every resampler that uses the same ratio.
+ */
+PolyphaseResampler::PolyphaseResampler(int inputRate, int outputRate) :
+  m_inputRate(inputRate),
+  m_outputRate(outputRate)
+{
+  int a = inputRate;
+  int b = outputRate;
+  while (b != 0)
+  {
+    const int remainder = a % b;
+    a = b;
+    b = remainder;
+  }
+
+  m_upFactor = outputRate / a;
+  m_downFactor = inputRate / a;
+  m_taps = filterTaps(m_upFactor, m_downFactor);
+  reset();
+}
+
+/**
+ * Discards all buffered input so that a new sound can be started.
+ */
+void PolyphaseResampler::reset()
+{
+  // the history starts with enough silence for the filters centered on the first input samples
+  const int leadIn = (m_taps / 2) - 1;
+  m_history.fill(0.0f, leadIn);
+  m_historyStart = -leadIn;
+  m_inputCount = 0;
+  m_outputCount = 0;
+  m_baseIndex = 0;
+  m_phase = 0;
+  m_finished = false;
+}
+
+int PolyphaseResampler::inputRate() const
+{
+  return m_inputRate;
+}
+
+int PolyphaseResampler::outputRate() const
+{
+  return m_outputRate;
+}
+
+/**
+ * Returns the number of output samples that will be produced from the provided
+ * number of input samples.
+ */
+qint64 PolyphaseResampler::outputLength(qint64 inputLength) const
+{
+  const qint64 up = m_upFactor;
+  const qint64 down = m_downFactor;
+  return ((inputLength * up) + down - 1) / down;
+}
+
+/**
+ * Appends 8-bit unsigned input samples to the resampler's history.
+ */
+void PolyphaseResampler::write(const uint8_t* input, int count)
+{
+  const int oldSize = m_history.size();
+  m_history.resize(oldSize + count);
+  float* const dest = m_history.data() + oldSize;
+
+  for (int i = 0; i < count; i++)
+  {
+    dest[i] = static_cast<float>((input[i] - 0x80) * 0x100);
+  }
+
+  m_inputCount += count;
+}
+
+/**
+ * Indicates that all of the input has been written. The remaining output samples,
+ * which depend on input past the end of the sound, are then computed as if that
+ * input were silent.
+ */
+void PolyphaseResampler::finish()
+{
+  if (!m_finished)
+  {
+    m_history.resize(m_history.size() + (m_taps / 2) + 1);
+    m_finished = true;
+  }
+}
+
+/**
+ * Computes as many output samples as the buffered input allows, up to the provided limit.
+ * @return The number of samples written to the output buffer.
+ */
+int PolyphaseResampler::read(int16_t* output, int maxOutput)
+{
+  if (!m_filters)
+  {
+    m_filters = filterBank(m_upFactor, m_downFactor);
+  }
+
+  const ResamplerFilterBank& filters = *m_filters;
+  const int taps = filters.taps;
+  const int leadIn = (taps / 2) - 1;
+  const qint64 totalOutput = m_finished ? outputLength(m_inputCount) : -1;
+  const qint64 historyEnd = m_historyStart + m_history.size();
+  const int baseStep = filters.downFactor / filters.upFactor;
+  const int phaseStep = filters.downFactor % filters.upFactor;
+  int count = 0;
+
+  while ((count < maxOutput) &&
+         ((totalOutput < 0) || (m_outputCount < totalOutput)) &&
+         ((m_baseIndex - leadIn + taps) <= historyEnd))
+  {
+    const float* const samples = m_history.constData() + (m_baseIndex - leadIn - m_historyStart);
+    const int filterIndex = ((m_phase * filters.phases) + (filters.upFactor / 2)) / filters.upFactor;
+    const float value = dotProduct(samples, filters.phase(filterIndex), taps);
+    output[count++] = static_cast<int16_t>(qBound(-32768.0f, floorf(value + 0.5f), 32767.0f));
+    m_outputCount++;
+
+    m_baseIndex += baseStep;
+    m_phase += phaseStep;
+    if (m_phase >= filters.upFactor)
+    {
+      m_phase -= filters.upFactor;
+      m_baseIndex++;
+    }
+  }
+
+  // drop the history that no future output sample can reach
+  const int consumed = static_cast<int>(qMin(m_baseIndex - leadIn - m_historyStart, static_cast<qint64>(m_history.size())));
+  if (consumed > 0)
+  {
+    m_history.remove(0, consumed);
+    m_historyStart += consumed;
+  }
+
+  return count;
+}
+
+/**
+ * Returns true once the input has been finished and every output sample has been read.
+ */
+bool PolyphaseResampler::atEnd() const
+{
+  return m_finished && (m_outputCount >= outputLength(m_inputCount));
+}
+
+/**
+ * Returns the cutoff of the filters for the provided reduced conversion ratio, as a
+ * fraction of the input Nyquist frequency. When reducing the rate, the cutoff drops and
+ * the filters are widened to match.
+ */
+double PolyphaseResampler::filterCutoff(int upFactor, int downFactor)
+{
+  return RESAMPLER_PASSBAND * qMin(1.0, static_cast<double>(upFactor) / downFactor);
+}
+
+/**
+ * Returns the number of taps in each filter for the provided reduced conversion ratio,
+ * rounded up to a multiple of four for dotProduct().
+ */
+int PolyphaseResampler::filterTaps(int upFactor, int downFactor)
+{
+  const int halfWidth = static_cast<int>(ceil(RESAMPLER_ZERO_CROSSINGS / filterCutoff(upFactor, downFactor)));
+  return (((halfWidth * 2) + 3) / 4) * 4;
+}
+
+/**
+ * Returns the filter bank for the provided reduced conversion ratio, building it if
+ * it has not already been built. Each filter is a Kaiser-windowed sinc with its
+ * cutoff just below the Nyquist frequency of the lower of the two rates, normalized
+ * for unity gain at DC. The game's 7042 Hz rate shares few factors with the common
+ * output rates, so the number of phases is capped; at RESAMPLER_MAX_PHASES, the timing
+ * error from using the nearest phase is well below the noise floor of the 8-bit input.
+ */
+QSharedPointer<const ResamplerFilterBank> PolyphaseResampler::filterBank(int upFactor, int downFactor)
+{
+  static QHash<QPair<int,int>,QSharedPointer<const ResamplerFilterBank>> s_filterBanks;
+  static QMutex s_filterBankMutex;
+
+  const QPair<int,int> key(upFactor, downFactor);
+  QMutexLocker locker(&s_filterBankMutex);
+
+  if (!s_filterBanks.contains(key))
+  {
+    const double cutoff = filterCutoff(upFactor, downFactor);
+
+    ResamplerFilterBank* bank = new ResamplerFilterBank;
+    bank->upFactor = upFactor;
+    bank->downFactor = downFactor;
+    bank->phases = qMin(upFactor, RESAMPLER_MAX_PHASES);
+    bank->taps = filterTaps(upFactor, downFactor);
+    bank->coefficients.resize((bank->phases + 1) * bank->taps);
+
+    // the extra filter is for the nearest phase being the start of the next input sample
+    const int leadIn = (bank->taps / 2) - 1;
+    for (int phase = 0; phase <= bank->phases; phase++)
+    {
+      const double fraction = static_cast<double>(phase) / bank->phases;
+      float* const coefficients = bank->coefficients.data() + (phase * bank->taps);
+      double sum = 0.0;
+
+      for (int tap = 0; tap < bank->taps; tap++)
+      {
+        const double x = (tap - leadIn) - fraction;
+        const double sinc = (x == 0.0) ? 1.0 : (sin(M_PI * cutoff * x) / (M_PI * cutoff * x));
+        const double value = sinc * kaiserWindow(x / (bank->taps / 2), RESAMPLER_KAISER_BETA);
+        coefficients[tap] = static_cast<float>(value);
+        sum += value;
+      }
+
+      for (int tap = 0; tap < bank->taps; tap++)
+      {
+        coefficients[tap] = static_cast<float>(coefficients[tap] / sum);
+      }
+    }
+
+    s_filterBanks.insert(key, QSharedPointer<const ResamplerFilterBank>(bank));
+  }
+
+  return s_filterBanks.value(key);
+}
+
+/**
+ * Returns the sum of the products of the provided samples and filter coefficients.
+ * The count must be a multiple of four.
+ */
+float PolyphaseResampler::dotProduct(const float* samples, const float* coefficients, int count)
+{
+#ifdef __SSE__
+  __m128 sum = _mm_setzero_ps();
+  for (int i = 0; i < count; i += 4)
+  {
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(samples + i), _mm_loadu_ps(coefficients + i)));
+  }
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x55));
+  return _mm_cvtss_f32(sum);
+#else
+  float sum = 0.0f;
+  for (int i = 0; i < count; i++)
+  {
+    sum += samples[i] * coefficients[i];
+  }
+  return sum;
+#endif
+}
+
+/**
+ * Evaluates the Kaiser window at the provided position, where -1 and 1 are its edges.
+ */
+double PolyphaseResampler::kaiserWindow(double x, double beta)
+{
+  double result = 0.0;
+
+  if ((x > -1.0) && (x < 1.0))
+  {
+    result = besselI0(beta * sqrt(1.0 - (x * x))) / besselI0(beta);
+  }
+
+  return result;
+}
+
+/**
+ * Evaluates the zeroth-order modified Bessel function of the first kind with its
+ * power series, which converges quickly for the arguments used by the window.
+ */
+double PolyphaseResampler::besselI0(double x)
+{
+  double sum = 1.0;
+  double term = 1.0;
+
+  for (int k = 1; k < 25; k++)
+  {
+    term *= ((x / 2.0) / k) * ((x / 2.0) / k);
+    sum += term;
+  }
+
+  return sum;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <stdint.h>
+#include <QVector>
+#include <QSharedPointer>
+
+#define RESAMPLER_ZERO_CROSSINGS 12
+#define RESAMPLER_MAX_PHASES 1024
+
+/**
+ * Set of precomputed windowed-sinc filters for one rational conversion ratio. There is
+ * one filter (or phase) for each of a fixed set of evenly-spaced fractional positions
+ * between two input samples, plus one for the position of the following sample, and
+ * every filter has the same number of taps. When the ratio has more fractional positions
+ * than RESAMPLER_MAX_PHASES, each output sample uses the filter for the nearest one.
+ */
+struct ResamplerFilterBank
+{
+  int upFactor;
+  int downFactor;
+  int phases;
+  int taps;
+  QVector<float> coefficients;
+
+  const float* phase(int index) const { return coefficients.constData() + (index * taps); }
+};
+
+/**
+ * Converts 8-bit unsigned PCM at one sample rate to 16-bit signed PCM at another with
+ * a polyphase FIR filter. Input is supplied with write() and converted samples are
+ * collected with read(), so that sounds of any length can be processed in chunks.
+ */
+class PolyphaseResampler
+{
+public:
+  PolyphaseResampler(int inputRate, int outputRate);
+  void reset();
+  int inputRate() const;
+  int outputRate() const;
+  qint64 outputLength(qint64 inputLength) const;
+
+  void write(const uint8_t* input, int count);
+  void finish();
+  int read(int16_t* output, int maxOutput);
+  bool atEnd() const;
+
+private:
+  int m_inputRate;
+  int m_outputRate;
+  int m_upFactor;
+  int m_downFactor;
+  int m_taps;
+  QSharedPointer<const ResamplerFilterBank> m_filters;
+
+  QVector<float> m_history;
+  qint64 m_historyStart;
+  qint64 m_inputCount;
+  qint64 m_outputCount;
+  qint64 m_baseIndex;
+  int m_phase;
+  bool m_finished;
+
+  static QSharedPointer<const ResamplerFilterBank> filterBank(int upFactor, int downFactor);
+  static double filterCutoff(int upFactor, int downFactor);
+  static int filterTaps(int upFactor, int downFactor);
+  static float dotProduct(const float* samples, const float* coefficients, int count);
+  static double kaiserWindow(double x, double beta);
+  static double besselI0(double x);
+};
+
@@ -0,0 +1,139 @@
+#include <QtEndian>
+#include <limits.h>
+#include "resamplingdevice.h"
+
+#define RESAMPLING_SOURCE_CHUNK_SIZE 1024
+
+ResamplingDevice::ResamplingDevice(int inputRate, int outputRate, QObject* parent) :
+  QIODevice(parent),
+  m_source(nullptr),
+  m_resampler(inputRate, outputRate),
+  m_bytesRead(0)
+{
+  m_sourceChunk.resize(RESAMPLING_SOURCE_CHUNK_SIZE);
+}
+
+/**
+ * Selects the device from which the 8-bit input samples are read. The source should
+ * already be open, and any open stream on this device is closed.
+ * @return True if the source is open for reading; false otherwise.
+ */
+bool ResamplingDevice::setSource(QIODevice* source)
+{
+  if (isOpen())
+  {
+    close();
+  }
+
+  m_source = source;
+  return (m_source != nullptr) && m_source->isReadable();
+}
+
+int ResamplingDevice::outputRate() const
+{
+  return m_resampler.outputRate();
+}
+
+/**
+ * Opens the device for reading from the current position of the source. Only
+ * read-only access is supported.
+ */
+bool ResamplingDevice::open(OpenMode mode)
+{
+  bool status = false;
+
+  if (m_source && !(mode & QIODevice::WriteOnly))
+  {
+    m_resampler.reset();
+    m_bytesRead = 0;
+    status = QIODevice::open(mode | QIODevice::Unbuffered);
+  }
+
+  return status;
+}
+
+bool ResamplingDevice::isSequential() const
+{
+  return true;
+}
+
+/**
+ * Returns the total size of the resampled output in bytes, provided that the
+ * source reports its own size.
+ */
+qint64 ResamplingDevice::size() const
+{
+  return m_source ? (m_resampler.outputLength(m_source->size()) * sizeof(int16_t)) : 0;
+}
+
+/**
+ * Returns the number of resampled bytes that have not yet been read.
+ */
+qint64 ResamplingDevice::bytesAvailable() const
+{
+  return (size() - m_bytesRead) + QIODevice::bytesAvailable();
+}
+
+/**
+ * Returns true once the source has been exhausted and all of the resampled output
+ * has been read.
+ */
+bool ResamplingDevice::atEnd() const
+{
+  return !isOpen() || m_resampler.atEnd();
+}
+
+/**
+ * Resamples enough of the source data to fill the caller's buffer (or to finish the
+ * sound), reading from the source in small chunks as the resampler needs more input.
+ * @return The number of bytes written, or -1 once the end of the sound has been reached.
+ */
+qint64 ResamplingDevice::readData(char* data, qint64 maxSize)
+{
+  if (m_resampler.atEnd())
+  {
+    return (maxSize > 0) ? -1 : 0;
+  }
+
+  const int maxSamples = static_cast<int>(qMin(maxSize / static_cast<qint64>(sizeof(int16_t)), static_cast<qint64>(INT_MAX)));
+  int16_t* const output = reinterpret_cast<int16_t*>(data);
+  int count = 0;
+
+  while ((count < maxSamples) && !m_resampler.atEnd())
+  {
+    const int produced = m_resampler.read(output + count, maxSamples - count);
+    count += produced;
+
+    if (produced == 0)
+    {
+      const qint64 sourceBytes = m_source->read(reinterpret_cast<char*>(m_sourceChunk.data()), m_sourceChunk.size());
+      if (sourceBytes > 0)
+      {
+        m_resampler.write(m_sourceChunk.constData(), static_cast<int>(sourceBytes));
+      }
+      else
+      {
+        m_resampler.finish();
+      }
+    }
+  }
+
+  for (int i = 0; i < count; i++)
+  {
+    output[i] = qToLittleEndian(output[i]);
+  }
+
+  m_bytesRead += count * static_cast<qint64>(sizeof(int16_t));
+  return count * static_cast<qint64>(sizeof(int16_t));
+}
+
+/**
+ * Writing is not supported.
+ */
+qint64 ResamplingDevice::writeData(const char* data, qint64 maxSize)
+{
+  Q_UNUSED(data)
+  Q_UNUSED(maxSize)
+  return -1;
+}
+
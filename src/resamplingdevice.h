@@ -0,0 +1,36 @@
+#pragma once
+#include <QIODevice>
+#include <QVector>
+#include "resampler.h"
+
+/**
+ * Read-only device that pulls 8-bit unsigned PCM from a source device and
+ * provides it as 16-bit signed little-endian PCM at a different sample rate.
+ * The source device must remain valid for as long as this device is open.
+ */
+class ResamplingDevice : public QIODevice
+{
+  Q_OBJECT
+
+public:
+  ResamplingDevice(int inputRate, int outputRate, QObject* parent = nullptr);
+  bool setSource(QIODevice* source);
+  int outputRate() const;
+
+  bool open(OpenMode mode) override;
+  bool isSequential() const override;
+  qint64 size() const override;
+  qint64 bytesAvailable() const override;
+  bool atEnd() const override;
+
+protected:
+  qint64 readData(char* data, qint64 maxSize) override;
+  qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+  QIODevice* m_source;
+  PolyphaseResampler m_resampler;
+  QVector<uint8_t> m_sourceChunk;
+  qint64 m_bytesRead;
+};
+
@@ -23,6 +23,26 @@ typedef struct __attribute__((packed)) ShipClassTableEntry
 
 static_assert(sizeof(ShipClassTableEntry) == 12, "ShipClassTableEntry packing does not match game data");
 
+constexpr FieldDescriptor s_shipClassTableFields[] =
+{
+  TABLE_GAMETEXT_FIELD(ShipClassTableEntry, nameOffset),
+  TABLE_FIELD(ShipClassTableEntry, missileStartQty),
+  TABLE_FIELD(ShipClassTableEntry, missileType),
+  TABLE_FIELD(ShipClassTableEntry, missileLoadType),
+  TABLE_FIELD(ShipClassTableEntry, shieldType),
+  TABLE_FIELD(ShipClassTableEntry, scannerType),
+  TABLE_FIELD(ShipClassTableEntry, engineType),
+  TABLE_FIELD(ShipClassTableEntry, startingStrengthA),
+  TABLE_FIELD(ShipClassTableEntry, startingStrengthB)
+};
+
+template <>
+struct TableSchema<ShipClassTableEntry>
+{
+  static constexpr const FieldDescriptor* fields() { return s_shipClassTableFields; }
+  static constexpr int fieldCount() { return sizeof(s_shipClassTableFields) / sizeof(FieldDescriptor); }
+};
+
 /**
  * Reads and parses the table containing ship class data.
  */
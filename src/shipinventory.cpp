@@ -33,6 +33,20 @@ QMap<int,int> ShipInventory::getInventory(int shipId)
   return invent;
 }
 
+/**
+ * Gets the starting inventory of every ship, as a map of ship IDs to maps of
+ * object IDs and object quantities.
+ */
+QMap<int, QMap<int,int> > ShipInventory::getAllInventories()
+{
+  if (m_inventories.keys().isEmpty())
+  {
+    populateInventoryData();
+  }
+
+  return m_inventories;
+}
+
 /**
  * Reads INVENT.TAB and parses its records to build a local store of the game's
  * ship inventory data.
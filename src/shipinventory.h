@@ -18,6 +18,7 @@ class ShipInventory
 public:
   ShipInventory(DatLibrary& lib);
   QMap<int,int> getInventory(int shipId);
+  QMap<int, QMap<int,int> > getAllInventories();
   void clear();
 
 private:
@@ -8,10 +8,10 @@ Ships::Ships(DatLibrary& lib) :
 }
 
 /**
- * Gets a map of ship IDs to ship data structs, representing
+ * Gets the table of ship data structs, indexed by ship ID, representing
  * all ships in the game.
  */
-QMap<int,Ship> Ships::getList()
+const DenseIdTable<Ship>& Ships::getList()
 {
   if (m_shipList.isEmpty())
   {
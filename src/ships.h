@@ -2,6 +2,7 @@
 #include <QString>
 #include <QMap>
 #include "dattable.h"
+#include "denseidtable.h"
 
 struct Ship
 {
@@ -50,6 +51,42 @@ typedef struct __attribute__((packed)) ShipTableEntry
 
 static_assert(sizeof(ShipTableEntry) == 70, "ShipTableEntry packing does not match game data");
 
+constexpr FieldDescriptor s_shipTableFields[] =
+{
+  TABLE_GAMETEXT_FIELD(ShipTableEntry, nameOffset),
+  TABLE_FIELD(ShipTableEntry, pilot),
+  TABLE_FIELD(ShipTableEntry, shipclass),
+  TABLE_UNKNOWN_FIELD(ShipTableEntry, unknown_a),
+  TABLE_FIELD(ShipTableEntry, location),
+  TABLE_FIELD(ShipTableEntry, engagedShipPtr),
+  TABLE_FIELD(ShipTableEntry, weaponType),
+  TABLE_FIELD(ShipTableEntry, weaponSystemDamage),
+  TABLE_FIELD(ShipTableEntry, missileLoaderType),
+  TABLE_UNKNOWN_FIELD(ShipTableEntry, unknown_b),
+  TABLE_FIELD(ShipTableEntry, missileLoadDowncounter),
+  TABLE_FIELD(ShipTableEntry, currentlyLoadedMissileType),
+  TABLE_FIELD(ShipTableEntry, missileLockDowncounter),
+  TABLE_UNKNOWN_FIELD(ShipTableEntry, unknown_c),
+  TABLE_FIELD(ShipTableEntry, shieldRelatedA),
+  TABLE_FIELD(ShipTableEntry, shieldSystemDamage),
+  TABLE_FIELD(ShipTableEntry, shieldRelatedB),
+  TABLE_UNKNOWN_FIELD(ShipTableEntry, unknown_d),
+  TABLE_FIELD(ShipTableEntry, scannerSystemDamage),
+  TABLE_FIELD(ShipTableEntry, scannerType),
+  TABLE_UNKNOWN_FIELD(ShipTableEntry, unknown_e),
+  TABLE_FIELD(ShipTableEntry, engineSystemDamage),
+  TABLE_FIELD(ShipTableEntry, engineType),
+  TABLE_FIELD(ShipTableEntry, jammerSystemDamage),
+  TABLE_FIELD(ShipTableEntry, jammerType)
+};
+
+template <>
+struct TableSchema<ShipTableEntry>
+{
+  static constexpr const FieldDescriptor* fields() { return s_shipTableFields; }
+  static constexpr int fieldCount() { return sizeof(s_shipTableFields) / sizeof(FieldDescriptor); }
+};
+
 /**
  * Reads and parses the game's ship table (SHIP.TAB).
  */
@@ -57,13 +94,13 @@ class Ships : public DatTable<ShipTableEntry>
 {
 public:
   Ships(DatLibrary& lib);
-  QMap<int,Ship> getList();
+  const DenseIdTable<Ship>& getList();
   QString getName(int id);
 
 protected:
   bool populateList();
 
 private:
-  QMap<int,Ship> m_shipList;
+  DenseIdTable<Ship> m_shipList;
 };
 
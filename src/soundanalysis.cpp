@@ -0,0 +1,386 @@
+#include <math.h>
+#include <algorithm>
+#include <QtConcurrent>
+#include "soundanalysis.h"
+
+#define SPECTROGRAM_FLOOR_DB -80.0f
+
+WaveformPyramid::WaveformPyramid()
+{
+
+}
+
+/**
+ * Builds the pyramid levels for the provided PCM data. The data itself is kept
+ * (sharing its buffer with the caller) for ranges too small for the first level.
+ */
+void WaveformPyramid::build(const QByteArray& pcm)
+{
+  m_pcm = pcm;
+  m_levels.clear();
+
+  const uint8_t* const samples = reinterpret_cast<const uint8_t*>(m_pcm.constData());
+  const int sampleCount = m_pcm.size();
+
+  if (sampleCount > WAVEFORM_BASE_BLOCK_SIZE)
+  {
+    Level base;
+    base.blockSize = WAVEFORM_BASE_BLOCK_SIZE;
+    const int blockCount = (sampleCount + WAVEFORM_BASE_BLOCK_SIZE - 1) / WAVEFORM_BASE_BLOCK_SIZE;
+    base.minValues.resize(blockCount);
+    base.maxValues.resize(blockCount);
+
+    for (int block = 0; block < blockCount; block++)
+    {
+      const int start = block * WAVEFORM_BASE_BLOCK_SIZE;
+      const int end = qMin(start + WAVEFORM_BASE_BLOCK_SIZE, sampleCount);
+      const std::pair<const uint8_t*, const uint8_t*> extremes = std::minmax_element(samples + start, samples + end);
+      base.minValues[block] = *extremes.first;
+      base.maxValues[block] = *extremes.second;
+    }
+    m_levels.append(base);
+
+    // each further level combines a fixed number of blocks from the level below it
+    while (m_levels.last().minValues.count() > WAVEFORM_LEVEL_FACTOR)
+    {
+      const Level& below = m_levels.last();
+      Level level;
+      level.blockSize = below.blockSize * WAVEFORM_LEVEL_FACTOR;
+      const int belowCount = below.minValues.count();
+      const int count = (belowCount + WAVEFORM_LEVEL_FACTOR - 1) / WAVEFORM_LEVEL_FACTOR;
+      level.minValues.resize(count);
+      level.maxValues.resize(count);
+
+      for (int block = 0; block < count; block++)
+      {
+        const int start = block * WAVEFORM_LEVEL_FACTOR;
+        const int end = qMin(start + WAVEFORM_LEVEL_FACTOR, belowCount);
+        level.minValues[block] = *std::min_element(below.minValues.constData() + start, below.minValues.constData() + end);
+        level.maxValues[block] = *std::max_element(below.maxValues.constData() + start, below.maxValues.constData() + end);
+      }
+      m_levels.append(level);
+    }
+  }
+}
+
+int WaveformPyramid::sampleCount() const
+{
+  return m_pcm.size();
+}
+
+/**
+ * Finds the minimum and maximum sample values in the range [start, end). The range is
+ * covered by the largest aligned blocks that fit within it, so only the samples at its
+ * ragged edges are visited individually. An empty range yields the center value.
+ */
+void WaveformPyramid::range(int start, int end, uint8_t& minValue, uint8_t& maxValue) const
+{
+  const uint8_t* const samples = reinterpret_cast<const uint8_t*>(m_pcm.constData());
+  start = qMax(start, 0);
+  end = qMin(end, m_pcm.size());
+
+  if (start >= end)
+  {
+    minValue = 0x80;
+    maxValue = 0x80;
+    return;
+  }
+
+  minValue = 0xFF;
+  maxValue = 0x00;
+  int pos = start;
+
+  while (pos < end)
+  {
+    int levelIndex = m_levels.count() - 1;
+    while ((levelIndex >= 0) &&
+           (((pos % m_levels.at(levelIndex).blockSize) != 0) || ((pos + m_levels.at(levelIndex).blockSize) > end)))
+    {
+      levelIndex--;
+    }
+
+    if (levelIndex >= 0)
+    {
+      const Level& level = m_levels.at(levelIndex);
+      const int block = pos / level.blockSize;
+      minValue = qMin(minValue, level.minValues.at(block));
+      maxValue = qMax(maxValue, level.maxValues.at(block));
+      pos += level.blockSize;
+    }
+    else
+    {
+      minValue = qMin(minValue, samples[pos]);
+      maxValue = qMax(maxValue, samples[pos]);
+      pos++;
+    }
+  }
+}
+
+SoundAnalyzer::SoundAnalyzer(Audio& audio, QObject* parent) :
+  QObject(parent),
+  m_audio(&audio),
+  m_pending(false),
+  m_cancelled(0)
+{
+  connect(&m_watcher, &QFutureWatcher<SoundBankAnalysisPtr>::finished, this, &SoundAnalyzer::onAnalysisFinished);
+}
+
+SoundAnalyzer::~SoundAnalyzer()
+{
+  m_cancelled.storeRelease(1);
+  m_watcher.waitForFinished();
+}
+
+/**
+ * Requests the analysis of the specified NNV container. If it has already been analyzed,
+ * the analysisReady() signal is emitted immediately; otherwise it is emitted once the
+ * analysis has finished on the worker thread. If another container is still being
+ * analyzed, only the most recent request is started after it.
+ */
+void SoundAnalyzer::request(DatFileType dat, QString nnvName)
+{
+  const QPair<int,QString> key(static_cast<int>(dat), nnvName);
+
+  if (m_cache.contains(key))
+  {
+    m_pending = false;
+    emit analysisReady(m_cache.value(key));
+  }
+  else if (m_watcher.isRunning())
+  {
+    m_pending = (key != m_runningKey);
+    m_pendingKey = key;
+  }
+  else
+  {
+    start(key);
+  }
+}
+
+/**
+ * Returns the cached analysis of the specified NNV container, or a null pointer if
+ * it has not yet been analyzed.
+ */
+SoundBankAnalysisPtr SoundAnalyzer::cached(DatFileType dat, QString nnvName) const
+{
+  return m_cache.value(QPair<int,QString>(static_cast<int>(dat), nnvName));
+}
+
+/**
+ * Cancels any analysis in progress and waits for it to stop, so that the worker no
+ * longer reads from the DAT library, then discards all of the cached results.
+ */
+void SoundAnalyzer::clear()
+{
+  m_pending = false;
+  m_cancelled.storeRelease(1);
+  m_watcher.waitForFinished();
+  m_cache.clear();
+}
+
+void SoundAnalyzer::start(const QPair<int,QString>& key)
+{
+  m_runningKey = key;
+  m_cancelled.storeRelease(0);
+  m_watcher.setFuture(QtConcurrent::run(&SoundAnalyzer::analyze, m_audio, static_cast<DatFileType>(key.first),
+                                        key.second, &m_cancelled));
+}
+
+/**
+ * Caches a finished analysis and announces it, then starts the most recent request
+ * that arrived while it was running.
+ */
+void SoundAnalyzer::onAnalysisFinished()
+{
+  // the result of a cancelled analysis may have been read from data that has since been closed
+  if (m_cancelled.loadAcquire())
+  {
+    return;
+  }
+
+  const SoundBankAnalysisPtr analysis = m_watcher.result();
+  if (analysis)
+  {
+    m_cache.insert(m_runningKey, analysis);
+    emit analysisReady(analysis);
+  }
+
+  if (m_pending)
+  {
+    m_pending = false;
+    request(static_cast<DatFileType>(m_pendingKey.first), m_pendingKey.second);
+  }
+}
+
+/**
+ * Decodes every sound in the specified NNV container, and builds the waveform pyramid
+ * and spectrogram for the combined PCM data. This is safe to run on a worker thread.
+ * The cancellation flag is checked between sounds.
+ * @return The analysis, or a null pointer if the container could not be read or the
+ *  analysis was cancelled.
+ */
+SoundBankAnalysisPtr SoundAnalyzer::analyze(Audio* audio, DatFileType dat, QString nnvName, const QAtomicInt* cancelled)
+{
+  const int soundCount = audio->getNumberOfSoundsInNNV(dat, nnvName);
+  if (soundCount <= 0)
+  {
+    return SoundBankAnalysisPtr();
+  }
+
+  QSharedPointer<SoundBankAnalysis> analysis(new SoundBankAnalysis);
+  analysis->dat = dat;
+  analysis->nnvName = nnvName;
+
+  for (int soundId = 0; soundId < soundCount; soundId++)
+  {
+    if (cancelled->loadAcquire())
+    {
+      return SoundBankAnalysisPtr();
+    }
+
+    QByteArray soundPcm;
+    analysis->soundStarts.append(analysis->pcm.size());
+    if (audio->readSound(dat, nnvName, soundId, soundPcm))
+    {
+      analysis->pcm.append(soundPcm);
+    }
+  }
+  analysis->soundStarts.append(analysis->pcm.size());
+
+  analysis->waveform.build(analysis->pcm);
+  analysis->spectrogram = makeSpectrogram(analysis->pcm, analysis->soundStarts);
+
+  return analysis;
+}
+
+/**
+ * Computes a spectrogram of the provided PCM data with a Hann-windowed FFT. Each column
+ * of the image is one frame, advancing by a fixed number of samples, and each row is one
+ * frequency bin, with the highest frequency at the top. A frame only includes samples
+ * from the sound that contains its center, so that neighbouring sounds do not bleed
+ * into one another. Pixel values are magnitudes on a decibel scale.
+ */
+QImage SoundAnalyzer::makeSpectrogram(const QByteArray& pcm, const QVector<int>& soundStarts)
+{
+  const int frameCount = (pcm.size() + SPECTROGRAM_HOP_SIZE - 1) / SPECTROGRAM_HOP_SIZE;
+  const int binCount = SPECTROGRAM_FFT_SIZE / 2;
+  if ((frameCount == 0) || (soundStarts.count() < 2))
+  {
+    return QImage();
+  }
+
+  QImage img(frameCount, binCount, QImage::Format_Indexed8);
+  // black through purple, red and orange to white
+  static const QRgb stops[] = { qRgb(0, 0, 0), qRgb(48, 0, 128), qRgb(192, 0, 64), qRgb(255, 160, 0), qRgb(255, 255, 255) };
+  QVector<QRgb> colors(256);
+  for (int i = 0; i < 256; i++)
+  {
+    const QRgb from = stops[i / 64];
+    const QRgb to = stops[(i / 64) + 1];
+    const int t = i % 64;
+    colors[i] = qRgb(qRed(from) + (((qRed(to) - qRed(from)) * t) / 64),
+                     qGreen(from) + (((qGreen(to) - qGreen(from)) * t) / 64),
+                     qBlue(from) + (((qBlue(to) - qBlue(from)) * t) / 64));
+  }
+  img.setColorTable(colors);
+
+  float window[SPECTROGRAM_FFT_SIZE];
+  float windowSum = 0.0f;
+  for (int i = 0; i < SPECTROGRAM_FFT_SIZE; i++)
+  {
+    window[i] = 0.5f - (0.5f * cosf((2.0f * static_cast<float>(M_PI) * i) / SPECTROGRAM_FFT_SIZE));
+    windowSum += window[i];
+  }
+
+  const uint8_t* const samples = reinterpret_cast<const uint8_t*>(pcm.constData());
+  float real[SPECTROGRAM_FFT_SIZE];
+  float imag[SPECTROGRAM_FFT_SIZE];
+  int soundIndex = 0;
+
+  for (int frame = 0; frame < frameCount; frame++)
+  {
+    const int center = (frame * SPECTROGRAM_HOP_SIZE) + (SPECTROGRAM_HOP_SIZE / 2);
+    while ((soundIndex < (soundStarts.count() - 2)) && (center >= soundStarts.at(soundIndex + 1)))
+    {
+      soundIndex++;
+    }
+    const int soundStart = soundStarts.at(soundIndex);
+    const int soundEnd = soundStarts.at(soundIndex + 1);
+    const int windowStart = center - (SPECTROGRAM_FFT_SIZE / 2);
+
+    for (int i = 0; i < SPECTROGRAM_FFT_SIZE; i++)
+    {
+      const int pos = windowStart + i;
+      const float sample = ((pos >= soundStart) && (pos < soundEnd)) ? ((samples[pos] - 0x80) / 128.0f) : 0.0f;
+      real[i] = sample * window[i];
+      imag[i] = 0.0f;
+    }
+
+    fft(real, imag, SPECTROGRAM_FFT_SIZE);
+
+    for (int bin = 0; bin < binCount; bin++)
+    {
+      const float magnitude = (2.0f * sqrtf((real[bin] * real[bin]) + (imag[bin] * imag[bin]))) / windowSum;
+      const float db = 20.0f * log10f(magnitude + 1e-9f);
+      const int level = qBound(0, static_cast<int>(255.0f * (1.0f - (db / SPECTROGRAM_FLOOR_DB))), 255);
+      img.scanLine(binCount - 1 - bin)[frame] = static_cast<uchar>(level);
+    }
+  }
+
+  return img;
+}
+
+/**
+ * Computes the discrete Fourier transform of the provided complex data in place, with
+ * an iterative radix-2 algorithm. The size must be a power of two.
+ */
+void SoundAnalyzer::fft(float* real, float* imag, int size)
+{
+  // reorder the input by bit-reversed index
+  for (int i = 1, j = 0; i < size; i++)
+  {
+    int bit = size >> 1;
+    for (; j & bit; bit >>= 1)
+    {
+      j ^= bit;
+    }
+    j ^= bit;
+
+    if (i < j)
+    {
+      std::swap(real[i], real[j]);
+      std::swap(imag[i], imag[j]);
+    }
+  }
+
+  for (int length = 2; length <= size; length <<= 1)
+  {
+    const float angle = (-2.0f * static_cast<float>(M_PI)) / length;
+    const float stepReal = cosf(angle);
+    const float stepImag = sinf(angle);
+
+    for (int start = 0; start < size; start += length)
+    {
+      float twiddleReal = 1.0f;
+      float twiddleImag = 0.0f;
+
+      for (int k = 0; k < (length / 2); k++)
+      {
+        const int even = start + k;
+        const int odd = even + (length / 2);
+        const float oddReal = (real[odd] * twiddleReal) - (imag[odd] * twiddleImag);
+        const float oddImag = (real[odd] * twiddleImag) + (imag[odd] * twiddleReal);
+
+        real[odd] = real[even] - oddReal;
+        imag[odd] = imag[even] - oddImag;
+        real[even] += oddReal;
+        imag[even] += oddImag;
+
+        const float nextReal = (twiddleReal * stepReal) - (twiddleImag * stepImag);
+        twiddleImag = (twiddleReal * stepImag) + (twiddleImag * stepReal);
+        twiddleReal = nextReal;
+      }
+    }
+  }
+}
+
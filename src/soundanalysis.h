@@ -0,0 +1,105 @@
+#pragma once
+#include <stdint.h>
+#include <QObject>
+#include <QByteArray>
+#include <QVector>
+#include <QImage>
+#include <QString>
+#include <QHash>
+#include <QPair>
+#include <QSharedPointer>
+#include <QFutureWatcher>
+#include <QAtomicInt>
+#include "datlibrary.h"
+#include "audio.h"
+
+#define WAVEFORM_BASE_BLOCK_SIZE 16
+#define WAVEFORM_LEVEL_FACTOR 4
+#define SPECTROGRAM_FFT_SIZE 256
+#define SPECTROGRAM_HOP_SIZE 32
+
+/**
+ * Level-of-detail summary of 8-bit unsigned PCM data. Each level holds the minimum and
+ * maximum sample value in consecutive blocks of the data, with the blocks growing by a
+ * constant factor from one level to the next, so that any range of the data can be
+ * summarized by visiting only a handful of blocks.
+ */
+class WaveformPyramid
+{
+public:
+  WaveformPyramid();
+  void build(const QByteArray& pcm);
+  int sampleCount() const;
+  void range(int start, int end, uint8_t& minValue, uint8_t& maxValue) const;
+
+private:
+  //! Minimum and maximum values for each block of one level of the pyramid
+  struct Level
+  {
+    int blockSize;
+    QVector<uint8_t> minValues;
+    QVector<uint8_t> maxValues;
+  };
+
+  QByteArray m_pcm;
+  QVector<Level> m_levels;
+};
+
+/**
+ * Decoded PCM data for every sound in an NNV container, laid end to end, along with
+ * the waveform pyramid and spectrogram computed from it.
+ */
+struct SoundBankAnalysis
+{
+  DatFileType dat;
+  QString nnvName;
+  QByteArray pcm;
+  QVector<int> soundStarts;
+  WaveformPyramid waveform;
+  QImage spectrogram;
+
+  int soundCount() const { return soundStarts.count() - 1; }
+};
+
+typedef QSharedPointer<const SoundBankAnalysis> SoundBankAnalysisPtr;
+
+/**
+ * Decodes whole NNV containers and computes their visualization data on a worker
+ * thread. Each container is only analyzed once; the results are cached until the
+ * cache is cleared. Requests and results are handled on the thread that owns the
+ * analyzer, so the cache needs no locking.
+ */
+class SoundAnalyzer : public QObject
+{
+  Q_OBJECT
+
+public:
+  SoundAnalyzer(Audio& audio, QObject* parent = nullptr);
+  ~SoundAnalyzer();
+
+  void request(DatFileType dat, QString nnvName);
+  SoundBankAnalysisPtr cached(DatFileType dat, QString nnvName) const;
+  void clear();
+
+  static SoundBankAnalysisPtr analyze(Audio* audio, DatFileType dat, QString nnvName, const QAtomicInt* cancelled);
+  static QImage makeSpectrogram(const QByteArray& pcm, const QVector<int>& soundStarts);
+
+signals:
+  void analysisReady(SoundBankAnalysisPtr analysis);
+
+private slots:
+  void onAnalysisFinished();
+
+private:
+  Audio* m_audio;
+  QHash<QPair<int,QString>,SoundBankAnalysisPtr> m_cache;
+  QFutureWatcher<SoundBankAnalysisPtr> m_watcher;
+  QPair<int,QString> m_runningKey;
+  QPair<int,QString> m_pendingKey;
+  bool m_pending;
+  QAtomicInt m_cancelled;
+
+  void start(const QPair<int,QString>& key);
+  static void fft(float* real, float* imag, int size);
+};
+
@@ -6,6 +6,7 @@
 #include <QtEndian>
 #include <QVector>
 #include <QRgb>
+#include <QtConcurrent>
 #include "stampimages.h"
 #include "imageconverter.h"
 
@@ -64,71 +65,111 @@ QMap<DatFileType,QStringList> StampImages::getAllStampsList()
 }
 
 /**
- * Gets a list of QImages, each one representing an .stp image from the named file.
- * This function can process both .stp and .rol files, with the latter containing
- * multiple images.
+ * Reads the named .stp or .rol file and its palette, and splits the data into
+ * the individual stamps that it contains. A .stp file contains a single stamp.
+ * @return True when the file and its palette were read successfully; false otherwise.
  */
-bool StampImages::getStamp(DatFileType dat, QString filename, QList<QImage>& images)
+bool StampImages::getStampFile(DatFileType dat, QString filename, StampFile& file)
 {
   bool status = false;
-  QList<QImage> imagesLocal;
 
   if (filename.length() > 4)
   {
     const bool isRoll = (filename.right(4).toLower() == QString(ROLL_EXTENSION));
-    QByteArray data;
 
-    if (m_lib->getFileByName(dat, filename, data))
+    if (m_lib->getFileByName(dat, filename, file.data))
     {
-      QVector<QRgb> palData;
       if (s_stpToPal.contains(filename))
       {
-        status = m_pal->paletteByName(dat, s_stpToPal[filename], palData);
+        status = m_pal->paletteByName(dat, s_stpToPal[filename], file.palette);
       }
       else
       {
-        status = m_pal->gamePalette(palData);
+        status = m_pal->gamePalette(file.palette);
       }
 
       if (status)
       {
         if (isRoll)
         {
-          QList<QByteArray> stpDataFromRoll = getStpDataFromRoll(data);
-          foreach (QByteArray singleStp, stpDataFromRoll)
-          {
-            QImage stpImage;
-            if (ImageConverter::stpToImage(singleStp, palData, stpImage))
-            {
-              imagesLocal.append(stpImage);
-              status = true;
-            }
-          }
+          file.stamps = getStpDataFromRoll(file.data);
         }
         else
         {
-          QImage stpImage;
-          if (ImageConverter::stpToImage(data, palData, stpImage))
-          {
-            imagesLocal.append(stpImage);
-            status = true;
-          }
+          file.stamps = QList<QByteArray>() << file.data;
         }
       }
     }
   }
 
+  return status;
+}
+
+/**
+ * Gets a list of QImages, each one representing an .stp image from the named file.
+ * This function can process both .stp and .rol files, with the latter containing
+ * multiple images. The images in a roll are decoded in parallel.
+ */
+bool StampImages::getStamp(DatFileType dat, QString filename, QList<QImage>& images)
+{
+  StampFile file;
+  const bool status = getStampFile(dat, filename, file);
+
   if (status)
   {
-    images = imagesLocal;
+    StampDecoder decoder;
+    decoder.palette = file.palette;
+
+    const QList<QImage> decoded = (file.stamps.count() > 1) ?
+                                  QtConcurrent::blockingMapped(file.stamps, decoder) :
+                                  QList<QImage>() << decoder(file.stamps.value(0));
+    images.clear();
+    foreach (QImage stpImage, decoded)
+    {
+      if (!stpImage.isNull())
+      {
+        images.append(stpImage);
+      }
+    }
   }
 
   return status;
 }
 
 /**
- * Returns a list of byte arrays, each one containing the complete data for one of the
- * .stp images contained within the provided .rol file data.
+ * Decodes only the first image in the named .stp or .rol file.
+ * @return True when the image was decoded successfully; false otherwise.
+ */
+bool StampImages::getFirstStamp(DatFileType dat, QString filename, QImage& image)
+{
+  StampFile file;
+  bool status = getStampFile(dat, filename, file) && !file.stamps.isEmpty();
+
+  if (status)
+  {
+    StampDecoder decoder;
+    decoder.palette = file.palette;
+    image = decoder(file.stamps.first());
+    status = !image.isNull();
+  }
+
+  return status;
+}
+
+QImage StampDecoder::operator()(const QByteArray& stpData) const
+{
+  QImage stpImage;
+  if (!ImageConverter::stpToImage(stpData, palette, stpImage))
+  {
+    stpImage = QImage();
+  }
+  return stpImage;
+}
+
+/**
+ * Returns a list of byte arrays, each one being a view of the data for one of the
+ * .stp images contained within the provided .rol file data. No data is copied, so
+ * the views are only valid while the provided roll data is unmodified and alive.
  */
 QList<QByteArray> StampImages::getStpDataFromRoll(const QByteArray& roll)
 {
@@ -144,10 +185,9 @@ QList<QByteArray> StampImages::getStpDataFromRoll(const QByteArray& roll)
     const int byteCount = isLast ? (rolSize - startOffset) : (stpStartOffsets[stpIndex + 1] - startOffset);
 
     // only continue if the roll is at least big enough to contain data for this STP
-    if (rolSize >= (startOffset + byteCount))
+    if ((startOffset >= 0) && (byteCount > 0) && (rolSize >= (startOffset + byteCount)))
     {
-      QByteArray singleStp(roll.data() + startOffset, byteCount);
-      stpData.append(singleStp);
+      stpData.append(QByteArray::fromRawData(roll.constData() + startOffset, byteCount));
     }
   }
 
@@ -6,12 +6,40 @@
 #include <QVector>
 #include <QRgb>
 #include <QByteArray>
+#include <QImage>
+#include <QList>
 #include "datlibrary.h"
 #include "palette.h"
 
 #define STAMP_EXTENSION ".stp"
 #define ROLL_EXTENSION  ".rol"
 
+/**
+ * Contents of a single .stp or .rol file. The data for each individual stamp is
+ * a read-only view into the decompressed file data, so the views are only valid
+ * for as long as a copy of that data is held.
+ */
+struct StampFile
+{
+  QByteArray data;
+  QList<QByteArray> stamps;
+  QVector<QRgb> palette;
+};
+
+/**
+ * Function object that decodes the data for a single stamp, used to decode
+ * the images in a roll in parallel. A null image is returned if the data
+ * could not be decoded.
+ */
+struct StampDecoder
+{
+  typedef QImage result_type;
+
+  QVector<QRgb> palette;
+
+  QImage operator()(const QByteArray& stpData) const;
+};
+
 /**
  * Reads and decodes stamp (.stp) and stamp roll (.rol) image files (other
  * than those for the inventory objects, which are separately handled by
@@ -23,6 +51,8 @@ public:
   StampImages(DatLibrary& lib, Palette& pal);
   QMap<DatFileType,QStringList> getAllStampsList();
   bool getStamp(DatFileType dat, QString filename, QList<QImage>& images);
+  bool getFirstStamp(DatFileType dat, QString filename, QImage& image);
+  bool getStampFile(DatFileType dat, QString filename, StampFile& file);
 
 private:
   DatLibrary* m_lib;
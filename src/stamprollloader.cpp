@@ -0,0 +1,85 @@
+#include <QtConcurrent>
+#include "stamprollloader.h"
+
+StampRollLoader::StampRollLoader(StampImages& stamps, QObject* parent) :
+  QObject(parent),
+  m_stamps(&stamps)
+{
+  connect(&m_watcher, &QFutureWatcher<QImage>::resultReadyAt, this, &StampRollLoader::onResultReadyAt);
+  connect(&m_watcher, &QFutureWatcher<QImage>::finished, this, &StampRollLoader::finished);
+}
+
+StampRollLoader::~StampRollLoader()
+{
+  cancel();
+}
+
+/**
+ * Cancels the decoding of any previously loaded roll, reads the named .stp or .rol
+ * file, and decodes its first image. If the file contains further images, their
+ * decoding is started in the background and the imageReady() signal is emitted
+ * (in no particular order) as each one is completed.
+ * @return True when the file was read and its first image was decoded; false otherwise.
+ */
+bool StampRollLoader::load(DatFileType dat, QString filename, QImage& firstImage, int& imageCount)
+{
+  cancel();
+  m_file = StampFile();
+  m_remaining.clear();
+
+  bool status = m_stamps->getStampFile(dat, filename, m_file) && !m_file.stamps.isEmpty();
+
+  if (status)
+  {
+    StampDecoder decoder;
+    decoder.palette = m_file.palette;
+
+    firstImage = decoder(m_file.stamps.first());
+    imageCount = m_file.stamps.count();
+    status = !firstImage.isNull();
+
+    if (status && (imageCount > 1))
+    {
+      // the stamp data are views into m_file.data, which is kept unmodified until the
+      // decoding is either finished or cancelled
+      m_remaining = m_file.stamps.mid(1);
+      m_watcher.setFuture(QtConcurrent::mapped(m_remaining, decoder));
+    }
+  }
+
+  return status;
+}
+
+/**
+ * Stops the decoding of any images that have not yet been started, and waits for
+ * those that are currently being decoded.
+ */
+void StampRollLoader::cancel()
+{
+  if (m_watcher.isRunning())
+  {
+    m_watcher.cancel();
+    m_watcher.waitForFinished();
+  }
+}
+
+/**
+ * Returns true if images from the roll are still being decoded.
+ */
+bool StampRollLoader::isRunning() const
+{
+  return m_watcher.isRunning();
+}
+
+/**
+ * Forwards a decoded image along with its index in the roll. The first image
+ * in the roll was not part of the background work, so the index is offset by one.
+ */
+void StampRollLoader::onResultReadyAt(int index)
+{
+  if (!m_watcher.isCanceled() && m_watcher.future().isResultReadyAt(index))
+  {
+    emit imageReady(index + 1, m_watcher.resultAt(index));
+  }
+}
+
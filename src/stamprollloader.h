@@ -0,0 +1,40 @@
+#pragma once
+#include <QObject>
+#include <QImage>
+#include <QList>
+#include <QString>
+#include <QFutureWatcher>
+#include "datlibrary.h"
+#include "stampimages.h"
+
+/**
+ * Loads a stamp roll (.rol) so that its first image is available immediately,
+ * while the remaining images are decoded in parallel on the global thread pool.
+ * Each of the remaining images is announced with a signal as it is finished.
+ */
+class StampRollLoader : public QObject
+{
+  Q_OBJECT
+
+public:
+  StampRollLoader(StampImages& stamps, QObject* parent = nullptr);
+  ~StampRollLoader();
+
+  bool load(DatFileType dat, QString filename, QImage& firstImage, int& imageCount);
+  void cancel();
+  bool isRunning() const;
+
+signals:
+  void imageReady(int rollIndex, QImage image);
+  void finished();
+
+private slots:
+  void onResultReadyAt(int index);
+
+private:
+  StampImages* m_stamps;
+  StampFile m_file;
+  QList<QByteArray> m_remaining;
+  QFutureWatcher<QImage> m_watcher;
+};
+
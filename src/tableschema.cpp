@@ -0,0 +1,113 @@
+#include <QtEndian>
+#include <QStringList>
+#include "tableschema.h"
+
+RawTable::RawTable() :
+  m_fields(nullptr),
+  m_fieldCount(0),
+  m_entrySize(0)
+{
+
+}
+
+RawTable::RawTable(const QByteArray& data, int entrySize, const FieldDescriptor* fields, int fieldCount) :
+  m_data(data),
+  m_fields(fields),
+  m_fieldCount(fieldCount),
+  m_entrySize(entrySize)
+{
+
+}
+
+/**
+ * Returns the number of complete entries in the table. A partial entry at the end of
+ * the file is ignored.
+ */
+int RawTable::entryCount() const
+{
+  return (m_entrySize > 0) ? (m_data.size() / m_entrySize) : 0;
+}
+
+int RawTable::fieldCount() const
+{
+  return m_fieldCount;
+}
+
+const FieldDescriptor& RawTable::field(int fieldIndex) const
+{
+  return m_fields[fieldIndex];
+}
+
+/**
+ * Reads one element of a field from the provided entry, sign-extending it if the field
+ * is signed. Returns 0 if the entry, field, or element is out of range.
+ */
+qint64 RawTable::value(int entry, int fieldIndex, int element) const
+{
+  qint64 val = 0;
+
+  if ((entry >= 0) && (entry < entryCount()) &&
+      (fieldIndex >= 0) && (fieldIndex < m_fieldCount) &&
+      (element >= 0) && (element < m_fields[fieldIndex].count))
+  {
+    const FieldDescriptor& f = m_fields[fieldIndex];
+    const uchar* ptr = reinterpret_cast<const uchar*>(m_data.constData()) +
+                       (entry * m_entrySize) + f.offset + (element * f.width);
+
+    if (f.width == 1)
+    {
+      val = f.isSigned ? static_cast<qint8>(*ptr) : *ptr;
+    }
+    else if (f.width == 2)
+    {
+      val = f.isSigned ? qFromLittleEndian<qint16>(ptr) : qFromLittleEndian<quint16>(ptr);
+    }
+    else if (f.width == 4)
+    {
+      val = f.isSigned ? qFromLittleEndian<qint32>(ptr) : qFromLittleEndian<quint32>(ptr);
+    }
+  }
+
+  return val;
+}
+
+/**
+ * Dumps every entry in the table as comma-separated values, with a header row naming the
+ * fields. Array fields are given one column per element.
+ */
+QByteArray RawTable::toCsv() const
+{
+  QStringList header("index");
+  for (int fieldIndex = 0; fieldIndex < m_fieldCount; fieldIndex++)
+  {
+    const FieldDescriptor& f = m_fields[fieldIndex];
+    if (f.count == 1)
+    {
+      header.append(f.name);
+    }
+    else
+    {
+      for (int element = 0; element < f.count; element++)
+      {
+        header.append(QString("%1[%2]").arg(f.name).arg(element));
+      }
+    }
+  }
+
+  QByteArray csv = header.join(',').toLatin1() + "\n";
+
+  for (int entry = 0; entry < entryCount(); entry++)
+  {
+    QStringList row(QString::number(entry));
+    for (int fieldIndex = 0; fieldIndex < m_fieldCount; fieldIndex++)
+    {
+      for (int element = 0; element < m_fields[fieldIndex].count; element++)
+      {
+        row.append(QString::number(value(entry, fieldIndex, element)));
+      }
+    }
+    csv += row.join(',').toLatin1() + "\n";
+  }
+
+  return csv;
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+#include <QByteArray>
+
+/**
+ * Describes one field of a packed data table entry: where it is, how wide each element is,
+ * how many elements it has (for arrays), whether it is signed, and whether its value is an
+ * offset into GAMETEXT.TXT. Fields whose purpose is not yet known are also marked, so that
+ * they can be picked out when looking at the raw data.
+ */
+struct FieldDescriptor
+{
+  const char* name;
+  int offset;
+  int width;
+  int count;
+  bool isSigned;
+  bool isGameText;
+  bool isUnknown;
+};
+
+//! Element type of a table entry field, with any array extent removed
+#define TABLE_FIELD_TYPE(StructType, member) std::remove_all_extents<decltype(StructType::member)>::type
+
+#define TABLE_FIELD_DESCRIPTOR(StructType, member, isGameText, isUnknown) \
+  { #member, \
+    static_cast<int>(offsetof(StructType, member)), \
+    static_cast<int>(sizeof(TABLE_FIELD_TYPE(StructType, member))), \
+    static_cast<int>(sizeof(StructType::member) / sizeof(TABLE_FIELD_TYPE(StructType, member))), \
+    std::is_signed<TABLE_FIELD_TYPE(StructType, member)>::value, \
+    isGameText, \
+    isUnknown }
+
+#define TABLE_FIELD(StructType, member)          TABLE_FIELD_DESCRIPTOR(StructType, member, false, false)
+#define TABLE_GAMETEXT_FIELD(StructType, member) TABLE_FIELD_DESCRIPTOR(StructType, member, true,  false)
+#define TABLE_UNKNOWN_FIELD(StructType, member)  TABLE_FIELD_DESCRIPTOR(StructType, member, false, true)
+
+/**
+ * Schema of a data table entry struct. This is specialized next to each struct, providing
+ * constexpr fields() and fieldCount() functions that describe every field in order.
+ */
+template <typename StructType>
+struct TableSchema;
+
+/**
+ * Checks that a list of field descriptors covers a struct of the provided size exactly,
+ * with each field starting where the previous one ended.
+ */
+constexpr bool tableFieldsCover(const FieldDescriptor* fields, int count, int structSize, int offset = 0)
+{
+  return (count == 0) ? (offset == structSize) :
+         ((fields[0].offset == offset) &&
+          tableFieldsCover(fields + 1, count - 1, structSize, offset + (fields[0].width * fields[0].count)));
+}
+
+template <typename StructType>
+constexpr bool tableSchemaMatches()
+{
+  return tableFieldsCover(TableSchema<StructType>::fields(), TableSchema<StructType>::fieldCount(),
+                          static_cast<int>(sizeof(StructType)));
+}
+
+/**
+ * Read-only view of the entries in a data table file, with the fields of each entry
+ * decoded according to a schema. The view shares the file data rather than copying it,
+ * and reads each field in place as a little-endian value, regardless of the host's
+ * byte order.
+ */
+class RawTable
+{
+public:
+  RawTable();
+  RawTable(const QByteArray& data, int entrySize, const FieldDescriptor* fields, int fieldCount);
+
+  template <typename StructType>
+  static RawTable fromData(const QByteArray& data)
+  {
+    static_assert(tableSchemaMatches<StructType>(), "Data table entry struct has no matching schema");
+    return RawTable(data, sizeof(StructType), TableSchema<StructType>::fields(), TableSchema<StructType>::fieldCount());
+  }
+
+  int entryCount() const;
+  int fieldCount() const;
+  const FieldDescriptor& field(int fieldIndex) const;
+  qint64 value(int entry, int fieldIndex, int element = 0) const;
+  QByteArray toCsv() const;
+
+private:
+  QByteArray m_data;
+  const FieldDescriptor* m_fields;
+  int m_fieldCount;
+  int m_entrySize;
+};
@@ -0,0 +1,360 @@
+#include <QFile>
+#include <QtEndian>
+#include "tablesnapshot.h"
+#include "enums.h"
+
+TableSnapshot::TableSnapshot()
+{
+  // offset 0 in the string pool is reserved for the empty string
+  m_stringPool.append('\0');
+  m_stringOffsets.insert(QString(), 0);
+}
+
+void TableSnapshot::addPlaces(Places& places)
+{
+  Table& table = addTable("places");
+  addColumn(table, "id", TableSnapshotColumn_Int32);
+  addColumn(table, "name", TableSnapshotColumn_String);
+  addColumn(table, "isPlanet", TableSnapshotColumn_Int32);
+  addColumn(table, "classId", TableSnapshotColumn_Int32);
+  addColumn(table, "race", TableSnapshotColumn_Int32);
+  addColumn(table, "representativeId", TableSnapshotColumn_Int32);
+  addColumn(table, "parentStarId", TableSnapshotColumn_Int32);
+
+  for (const Place& p : places.getPlaceList())
+  {
+    appendRow(table, { p.id, internString(p.name), p.isPlanet ? 1 : 0, p.classId,
+                       static_cast<int>(p.race), p.representativeId, p.parentStarId });
+  }
+}
+
+/**
+ * Adds the planet classes, their resources (one row per resource slot that is in use),
+ * and the star classes.
+ */
+void TableSnapshot::addPlaceClasses(PlaceClasses& pclasses)
+{
+  const QMap<int,PlanetClass> planetClasses = pclasses.getPlanetClassList();
+
+  Table& classTable = addTable("planetClasses");
+  addColumn(classTable, "id", TableSnapshotColumn_Int32);
+  addColumn(classTable, "name", TableSnapshotColumn_String);
+  addColumn(classTable, "temperature", TableSnapshotColumn_Int32);
+  addColumn(classTable, "temperatureRange", TableSnapshotColumn_String);
+
+  foreach (int id, planetClasses.keys())
+  {
+    const PlanetClass& pclass = planetClasses[id];
+    appendRow(classTable, { id, internString(pclass.name), pclass.temperature, internString(pclass.temperatureRange) });
+  }
+
+  Table& resourceTable = addTable("planetClassResources");
+  addColumn(resourceTable, "classId", TableSnapshotColumn_Int32);
+  addColumn(resourceTable, "resourceType", TableSnapshotColumn_Int32);
+  addColumn(resourceTable, "objectId", TableSnapshotColumn_Int32);
+  addColumn(resourceTable, "value", TableSnapshotColumn_Int32);
+
+  foreach (int id, planetClasses.keys())
+  {
+    const QMap<PlanetResourceType, QMap<int,int> >& resources = planetClasses[id].resources;
+    foreach (PlanetResourceType type, resources.keys())
+    {
+      foreach (int objectId, resources[type].keys())
+      {
+        appendRow(resourceTable, { id, static_cast<int>(type), objectId, resources[type][objectId] });
+      }
+    }
+  }
+
+  const QMap<int,StarClass> starClasses = pclasses.getStarClassList();
+
+  Table& starTable = addTable("starClasses");
+  addColumn(starTable, "id", TableSnapshotColumn_Int32);
+  addColumn(starTable, "name", TableSnapshotColumn_String);
+
+  foreach (int id, starClasses.keys())
+  {
+    appendRow(starTable, { id, internString(starClasses[id].name) });
+  }
+}
+
+void TableSnapshot::addAliens(Aliens& aliens)
+{
+  Table& table = addTable("aliens");
+  addColumn(table, "id", TableSnapshotColumn_Int32);
+  addColumn(table, "name", TableSnapshotColumn_String);
+  addColumn(table, "race", TableSnapshotColumn_Int32);
+
+  for (const Alien& a : aliens.getList())
+  {
+    appendRow(table, { a.id, internString(a.name), static_cast<int>(a.race) });
+  }
+}
+
+/**
+ * Adds the inventory objects, with one column for the value of each object to each race.
+ */
+void TableSnapshot::addObjects(InvObject& objects)
+{
+  Table& table = addTable("objects");
+  addColumn(table, "id", TableSnapshotColumn_Int32);
+  addColumn(table, "name", TableSnapshotColumn_String);
+  addColumn(table, "type", TableSnapshotColumn_Int32);
+  addColumn(table, "subtype", TableSnapshotColumn_Int32);
+  addColumn(table, "tradeable", TableSnapshotColumn_Int32);
+  addColumn(table, "unique", TableSnapshotColumn_Int32);
+  for (int race = 0; race < static_cast<int>(AlienRace::NumRaces); race++)
+  {
+    addColumn(table, QByteArray("valueByRace_") + QByteArray::number(race), TableSnapshotColumn_Int32);
+  }
+
+  for (const InventoryObj& obj : objects.getList())
+  {
+    QVector<qint32> row = { obj.id, internString(obj.name), static_cast<int>(obj.type), obj.subtype,
+                            obj.tradeable ? 1 : 0, obj.unique ? 1 : 0 };
+    for (int race = 0; race < static_cast<int>(AlienRace::NumRaces); race++)
+    {
+      row.append(obj.valueByRace[race]);
+    }
+    appendRow(table, row);
+  }
+}
+
+/**
+ * Adds the facts, with one column for the receptivity of each race to each fact.
+ */
+void TableSnapshot::addFacts(Facts& facts)
+{
+  Table& table = addTable("facts");
+  addColumn(table, "id", TableSnapshotColumn_Int32);
+  addColumn(table, "text", TableSnapshotColumn_String);
+  for (int race = 0; race < static_cast<int>(AlienRace::NumRaces); race++)
+  {
+    addColumn(table, QByteArray("receptivity_") + QByteArray::number(race), TableSnapshotColumn_Int32);
+  }
+
+  for (const Fact& f : facts.getList())
+  {
+    QVector<qint32> row = { f.id, internString(f.text) };
+    for (int race = 0; race < static_cast<int>(AlienRace::NumRaces); race++)
+    {
+      row.append(f.receptivity.value(static_cast<AlienRace>(race)));
+    }
+    appendRow(table, row);
+  }
+}
+
+/**
+ * Adds the ships, and their starting inventories as a separate table with one row per
+ * ship and object.
+ */
+void TableSnapshot::addShips(Ships& ships, ShipInventory& inventory)
+{
+  Table& shipTable = addTable("ships");
+  addColumn(shipTable, "id", TableSnapshotColumn_Int32);
+  addColumn(shipTable, "name", TableSnapshotColumn_String);
+  addColumn(shipTable, "shipClass", TableSnapshotColumn_Int32);
+  addColumn(shipTable, "pilot", TableSnapshotColumn_Int32);
+  addColumn(shipTable, "location", TableSnapshotColumn_Int32);
+
+  for (const Ship& s : ships.getList())
+  {
+    appendRow(shipTable, { s.id, internString(s.name), s.shipclass, s.pilot, s.location });
+  }
+
+  const QMap<int, QMap<int,int> > inventories = inventory.getAllInventories();
+
+  Table& inventoryTable = addTable("shipInventory");
+  addColumn(inventoryTable, "shipId", TableSnapshotColumn_Int32);
+  addColumn(inventoryTable, "objectId", TableSnapshotColumn_Int32);
+  addColumn(inventoryTable, "quantity", TableSnapshotColumn_Int32);
+
+  foreach (int shipId, inventories.keys())
+  {
+    foreach (int objectId, inventories[shipId].keys())
+    {
+      appendRow(inventoryTable, { shipId, objectId, inventories[shipId][objectId] });
+    }
+  }
+}
+
+void TableSnapshot::addShipClasses(ShipClasses& shipClasses)
+{
+  const QMap<int,ShipClass> classes = shipClasses.getList();
+
+  Table& table = addTable("shipClasses");
+  addColumn(table, "id", TableSnapshotColumn_Int32);
+  addColumn(table, "name", TableSnapshotColumn_String);
+
+  foreach (int id, classes.keys())
+  {
+    appendRow(table, { id, internString(classes[id].name) });
+  }
+}
+
+/**
+ * Adds the missions, including their start and completion text (as the HTML that is
+ * shown on the missions tab).
+ */
+void TableSnapshot::addMissions(Missions& missions)
+{
+  Table& table = addTable("missions");
+  addColumn(table, "id", TableSnapshotColumn_Int32);
+  addColumn(table, "action", TableSnapshotColumn_Int32);
+  addColumn(table, "actionRawValue", TableSnapshotColumn_Int32);
+  addColumn(table, "objectiveId", TableSnapshotColumn_Int32);
+  addColumn(table, "objectiveLocation", TableSnapshotColumn_Int32);
+  addColumn(table, "prereqMissionId", TableSnapshotColumn_Int32);
+  addColumn(table, "startTextIndex", TableSnapshotColumn_Int32);
+  addColumn(table, "completeTextIndex", TableSnapshotColumn_Int32);
+  addColumn(table, "startText", TableSnapshotColumn_String);
+  addColumn(table, "completeText", TableSnapshotColumn_String);
+
+  const DenseIdTable<Mission>& list = missions.getList();
+  for (DenseIdTable<Mission>::const_iterator it = list.constBegin(); it != list.constEnd(); ++it)
+  {
+    appendRow(table, { it.key(), static_cast<int>(it->action), it->missionActionRawVal, it->objectiveId,
+                       it->objectiveLocation, it->prereqMissionId, it->startTextIndex, it->completeTextIndex,
+                       internString(it->startText), internString(it->completeText) });
+  }
+}
+
+/**
+ * Appends a little-endian 32-bit value to the output buffer.
+ */
+static void appendUInt32(QByteArray& out, quint32 value)
+{
+  uchar bytes[4];
+  qToLittleEndian<quint32>(value, bytes);
+  out.append(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+/**
+ * Appends a name to the output buffer as a fixed-length, NUL-padded field. Names are
+ * truncated if necessary so that they are always NUL-terminated.
+ */
+static void appendName(QByteArray& out, const QByteArray& name, int length)
+{
+  QByteArray field = name.left(length - 1);
+  field.append(QByteArray(length - field.size(), '\0'));
+  out.append(field);
+}
+
+/**
+ * Lays out the tables collected so far and writes them to the provided file.
+ * @return True if the file was written completely; false otherwise.
+ */
+bool TableSnapshot::write(const QString& path) const
+{
+  int columnCount = 0;
+  int dataSize = 0;
+  foreach (const Table& table, m_tables)
+  {
+    columnCount += table.columns.count();
+    dataSize += table.columns.count() * table.rowCount * static_cast<int>(sizeof(qint32));
+  }
+
+  const quint32 tableDirOffset = sizeof(TableSnapshotHeader);
+  const quint32 columnDirOffset = tableDirOffset + (m_tables.count() * sizeof(TableSnapshotTableEntry));
+  const quint32 dataOffset = columnDirOffset + (columnCount * sizeof(TableSnapshotColumnEntry));
+  const quint32 stringPoolOffset = dataOffset + dataSize;
+  const quint32 fileSize = stringPoolOffset + m_stringPool.size();
+
+  QByteArray out;
+  out.reserve(fileSize);
+
+  out.append(TABLE_SNAPSHOT_MAGIC, sizeof(TABLE_SNAPSHOT_MAGIC));
+  appendUInt32(out, TABLE_SNAPSHOT_VERSION);
+  appendUInt32(out, m_tables.count());
+  appendUInt32(out, tableDirOffset);
+  appendUInt32(out, stringPoolOffset);
+  appendUInt32(out, m_stringPool.size());
+  appendUInt32(out, fileSize);
+
+  quint32 nextColumnEntry = columnDirOffset;
+  foreach (const Table& table, m_tables)
+  {
+    appendName(out, table.name, TABLE_SNAPSHOT_TABLE_NAME_LEN);
+    appendUInt32(out, table.rowCount);
+    appendUInt32(out, table.columns.count());
+    appendUInt32(out, nextColumnEntry);
+    nextColumnEntry += table.columns.count() * sizeof(TableSnapshotColumnEntry);
+  }
+
+  quint32 nextColumnData = dataOffset;
+  foreach (const Table& table, m_tables)
+  {
+    foreach (const Column& column, table.columns)
+    {
+      appendName(out, column.name, TABLE_SNAPSHOT_COL_NAME_LEN);
+      appendUInt32(out, column.type);
+      appendUInt32(out, nextColumnData);
+      nextColumnData += table.rowCount * sizeof(qint32);
+    }
+  }
+
+  foreach (const Table& table, m_tables)
+  {
+    foreach (const Column& column, table.columns)
+    {
+      foreach (qint32 value, column.values)
+      {
+        appendUInt32(out, static_cast<quint32>(value));
+      }
+    }
+  }
+
+  out.append(m_stringPool);
+
+  QFile file(path);
+  return file.open(QIODevice::WriteOnly) && (file.write(out) == out.size());
+}
+
+TableSnapshot::Table& TableSnapshot::addTable(const QByteArray& name)
+{
+  Table table;
+  table.name = name;
+  table.rowCount = 0;
+  m_tables.append(table);
+  return m_tables.last();
+}
+
+void TableSnapshot::addColumn(Table& table, const QByteArray& name, TableSnapshotColumnType type)
+{
+  Column column;
+  column.name = name;
+  column.type = type;
+  table.columns.append(column);
+}
+
+/**
+ * Appends a row to the provided table, with one value for each of its columns. String
+ * values must already have been interned.
+ */
+void TableSnapshot::appendRow(Table& table, const QVector<qint32>& values)
+{
+  for (int col = 0; col < table.columns.count(); col++)
+  {
+    table.columns[col].values.append((col < values.count()) ? values.at(col) : 0);
+  }
+  table.rowCount++;
+}
+
+/**
+ * Returns the offset of the provided string in the string pool, adding it to the pool
+ * if it is not already there.
+ */
+qint32 TableSnapshot::internString(const QString& str)
+{
+  qint32 offset = m_stringOffsets.value(str, -1);
+
+  if (offset < 0)
+  {
+    offset = m_stringPool.size();
+    m_stringPool.append(str.toUtf8());
+    m_stringPool.append('\0');
+    m_stringOffsets.insert(str, offset);
+  }
+
+  return offset;
+}
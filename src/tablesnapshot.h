@@ -0,0 +1,115 @@
+#pragma once
+#include <stdint.h>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+#include "aliens.h"
+#include "facts.h"
+#include "invobject.h"
+#include "missions.h"
+#include "placeclasses.h"
+#include "places.h"
+#include "shipclasses.h"
+#include "shipinventory.h"
+#include "ships.h"
+
+#define TABLE_SNAPSHOT_MAGIC          "NRESNAP"
+#define TABLE_SNAPSHOT_VERSION        1
+#define TABLE_SNAPSHOT_TABLE_NAME_LEN 20
+#define TABLE_SNAPSHOT_COL_NAME_LEN   24
+
+/**
+ * Snapshot file layout. Every integer is little-endian and every offset is from the start
+ * of the file. The header is followed by one directory entry per table, then one directory
+ * entry per column (grouped by table), then the column data, and finally the string pool.
+ * Each column is a packed array of 32-bit values, one per row, starting on a 4-byte
+ * boundary, so that a reader can map the file and use the columns in place.
+ */
+typedef struct __attribute__((packed)) TableSnapshotHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t tableCount;
+  uint32_t tableDirOffset;
+  uint32_t stringPoolOffset;
+  uint32_t stringPoolSize;
+  uint32_t fileSize;
+} TableSnapshotHeader;
+
+static_assert(sizeof(TableSnapshotHeader) == 32, "TableSnapshotHeader packing does not match the file format");
+
+typedef struct __attribute__((packed)) TableSnapshotTableEntry
+{
+  char name[TABLE_SNAPSHOT_TABLE_NAME_LEN];
+  uint32_t rowCount;
+  uint32_t columnCount;
+  uint32_t columnDirOffset;
+} TableSnapshotTableEntry;
+
+static_assert(sizeof(TableSnapshotTableEntry) == 32, "TableSnapshotTableEntry packing does not match the file format");
+
+typedef struct __attribute__((packed)) TableSnapshotColumnEntry
+{
+  char name[TABLE_SNAPSHOT_COL_NAME_LEN];
+  uint32_t type;
+  uint32_t dataOffset;
+} TableSnapshotColumnEntry;
+
+static_assert(sizeof(TableSnapshotColumnEntry) == 32, "TableSnapshotColumnEntry packing does not match the file format");
+
+/**
+ * Type of the values in a snapshot column. String values are offsets into the string
+ * pool, where each string is stored once as NUL-terminated UTF-8. Offset 0 is always
+ * the empty string.
+ */
+enum TableSnapshotColumnType
+{
+  TableSnapshotColumn_Int32  = 0,
+  TableSnapshotColumn_String = 1
+};
+
+/**
+ * Collects the parsed data tables into a single column-oriented binary file, which
+ * analysis tools can map and read directly without decoding any of the game's DAT
+ * files. The standalone snapshot_dump utility is an example reader.
+ */
+class TableSnapshot
+{
+public:
+  TableSnapshot();
+  void addPlaces(Places& places);
+  void addPlaceClasses(PlaceClasses& pclasses);
+  void addAliens(Aliens& aliens);
+  void addObjects(InvObject& objects);
+  void addFacts(Facts& facts);
+  void addShips(Ships& ships, ShipInventory& inventory);
+  void addShipClasses(ShipClasses& shipClasses);
+  void addMissions(Missions& missions);
+  bool write(const QString& path) const;
+
+private:
+  struct Column
+  {
+    QByteArray name;
+    TableSnapshotColumnType type;
+    QVector<qint32> values;
+  };
+
+  struct Table
+  {
+    QByteArray name;
+    int rowCount;
+    QList<Column> columns;
+  };
+
+  QList<Table> m_tables;
+  QByteArray m_stringPool;
+  QHash<QString,qint32> m_stringOffsets;
+
+  Table& addTable(const QByteArray& name);
+  void addColumn(Table& table, const QByteArray& name, TableSnapshotColumnType type);
+  void appendRow(Table& table, const QVector<qint32>& values);
+  qint32 internString(const QString& str);
+};
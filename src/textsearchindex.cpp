@@ -0,0 +1,482 @@
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include <QtConcurrent>
+#include <QtEndian>
+#include <QMap>
+#include "textsearchindex.h"
+
+TextSearchIndex::TextSearchIndex()
+{
+
+}
+
+/**
+ * Splits the provided text into terms. A term is a run of letters and digits, which may
+ * include apostrophes between letters (as in contractions).
+ * @return List of the character offset and length of each term, in order.
+ */
+QVector<QPair<int,int> > TextSearchIndex::tokenize(const QString& text)
+{
+  QVector<QPair<int,int> > tokens;
+  const int size = text.size();
+  int pos = 0;
+
+  while (pos < size)
+  {
+    if (text.at(pos).isLetterOrNumber())
+    {
+      const int start = pos;
+      pos++;
+      while ((pos < size) &&
+             (text.at(pos).isLetterOrNumber() ||
+              ((text.at(pos) == QChar('\'')) && ((pos + 1) < size) && text.at(pos + 1).isLetter())))
+      {
+        pos++;
+      }
+      tokens.append(QPair<int,int>(start, pos - start));
+    }
+    else
+    {
+      pos++;
+    }
+  }
+
+  return tokens;
+}
+
+/**
+ * Adds a document to the index, appending an entry to the posting list of each of its terms.
+ * Since documents are only ever appended, every posting list remains sorted by document and
+ * then by position.
+ */
+void TextSearchIndex::addDocument(const TextSearchDocument& doc)
+{
+  const int docIndex = m_documents.size();
+  const QVector<QPair<int,int> > tokens = tokenize(doc.text);
+
+  m_documents.append(doc);
+  m_documentTermCounts.append(tokens.size());
+
+  for (int position = 0; position < tokens.size(); position++)
+  {
+    TextSearchPosting posting;
+    posting.document = docIndex;
+    posting.position = position;
+    posting.charOffset = tokens[position].first;
+    m_postings[doc.text.mid(tokens[position].first, tokens[position].second).toLower()].append(posting);
+  }
+}
+
+void TextSearchIndex::clear()
+{
+  m_documents.clear();
+  m_documentTermCounts.clear();
+  m_postings.clear();
+}
+
+int TextSearchIndex::documentCount() const
+{
+  return m_documents.size();
+}
+
+int TextSearchIndex::termCount() const
+{
+  return m_postings.size();
+}
+
+const TextSearchDocument& TextSearchIndex::document(int index) const
+{
+  return m_documents.at(index);
+}
+
+/**
+ * Finds the documents that contain every term in the provided query. Each document is scored by
+ * the frequency of each query term in it, weighted by the rarity of the term across all the
+ * documents and normalized by the document's length; documents in which the terms also appear
+ * consecutively (as the query phrase) score several times higher.
+ * @return Up to maxHits matching documents, in order of decreasing score.
+ */
+QVector<TextSearchHit> TextSearchIndex::search(const QString& query, int maxHits) const
+{
+  QVector<TextSearchHit> hits;
+  const QVector<QPair<int,int> > queryTokens = tokenize(query);
+  QVector<const QVector<TextSearchPosting>*> lists;
+  QVector<int> termLengths;
+  QVector<double> termWeights;
+
+  foreach (const QPair<int,int>& token, queryTokens)
+  {
+    const QString term = query.mid(token.first, token.second).toLower();
+    QHash<QString,QVector<TextSearchPosting> >::const_iterator it = m_postings.constFind(term);
+    if (it == m_postings.constEnd())
+    {
+      return hits;
+    }
+
+    // count the documents in which the term occurs to find its inverse document frequency
+    const QVector<TextSearchPosting>& postings = it.value();
+    int documentFrequency = 0;
+    int lastDocument = -1;
+    for (int i = 0; i < postings.size(); i++)
+    {
+      if (postings[i].document != lastDocument)
+      {
+        lastDocument = postings[i].document;
+        documentFrequency++;
+      }
+    }
+
+    lists.append(&postings);
+    termLengths.append(token.second);
+    termWeights.append(log(1.0 + (static_cast<double>(m_documents.size()) / documentFrequency)));
+  }
+
+  if (lists.isEmpty())
+  {
+    return hits;
+  }
+
+  const int termCount = lists.size();
+  QVector<int> cursors(termCount, 0);
+  QVector<int> ends(termCount, 0);
+  const QVector<TextSearchPosting>& firstList = *lists[0];
+  int firstCursor = 0;
+
+  // walk the documents of the first term's postings, advancing through each of the other
+  // lists alongside it; this works because every list is sorted by document
+  while (firstCursor < firstList.size())
+  {
+    const int docIndex = firstList[firstCursor].document;
+    bool allTermsPresent = true;
+
+    for (int t = 0; t < termCount; t++)
+    {
+      const QVector<TextSearchPosting>& list = *lists[t];
+      int& cursor = cursors[t];
+
+      if (t == 0)
+      {
+        cursor = firstCursor;
+      }
+      while ((cursor < list.size()) && (list[cursor].document < docIndex))
+      {
+        cursor++;
+      }
+
+      int end = cursor;
+      while ((end < list.size()) && (list[end].document == docIndex))
+      {
+        end++;
+      }
+      ends[t] = end;
+
+      if (end == cursor)
+      {
+        allTermsPresent = false;
+      }
+    }
+
+    if (allTermsPresent)
+    {
+      TextSearchHit hit;
+      hit.document = docIndex;
+      hit.score = 0.0;
+      hit.charOffset = firstList[firstCursor].charOffset;
+      hit.length = termLengths[0];
+
+      for (int t = 0; t < termCount; t++)
+      {
+        hit.score += (ends[t] - cursors[t]) * termWeights[t];
+      }
+      hit.score /= sqrt(static_cast<double>(qMax(m_documentTermCounts[docIndex], 1)));
+
+      // look for an occurrence of the terms in consecutive positions
+      if (termCount > 1)
+      {
+        bool phraseFound = false;
+        for (int p = cursors[0]; !phraseFound && (p < ends[0]); p++)
+        {
+          const int startPosition = (*lists[0])[p].position;
+          phraseFound = true;
+
+          for (int t = 1; phraseFound && (t < termCount); t++)
+          {
+            bool termFound = false;
+            for (int q = cursors[t]; !termFound && (q < ends[t]); q++)
+            {
+              if ((*lists[t])[q].position == (startPosition + t))
+              {
+                termFound = true;
+                if (t == (termCount - 1))
+                {
+                  hit.charOffset = (*lists[0])[p].charOffset;
+                  hit.length = (*lists[t])[q].charOffset + termLengths[t] - hit.charOffset;
+                }
+              }
+            }
+            phraseFound = termFound;
+          }
+        }
+
+        if (phraseFound)
+        {
+          hit.score *= 4.0;
+        }
+      }
+
+      hits.append(hit);
+    }
+
+    firstCursor = ends[0];
+  }
+
+  std::sort(hits.begin(), hits.end(), [](const TextSearchHit& a, const TextSearchHit& b)
+  {
+    return (a.score > b.score) || ((a.score == b.score) && (a.document < b.document));
+  });
+
+  if (hits.size() > maxHits)
+  {
+    hits.resize(maxHits);
+  }
+
+  return hits;
+}
+
+TextSearchIndexer::TextSearchIndexer(DatLibrary& lib, GameText& gtext, ConversationText& convText, QObject* parent) :
+  QObject(parent),
+  m_lib(&lib),
+  m_gtext(&gtext),
+  m_convText(&convText)
+{
+  connect(&m_watcher, &QFutureWatcher<TextSearchIndexPtr>::finished, this, &TextSearchIndexer::onFinished);
+}
+
+TextSearchIndexer::~TextSearchIndexer()
+{
+  cancel();
+}
+
+/**
+ * Discards the current index and starts building a new one on a worker thread. The
+ * finished() signal is emitted when the new index is available from index().
+ */
+void TextSearchIndexer::start(const TextSearchOwners& owners)
+{
+  cancel();
+  m_index.clear();
+  m_cancelRequested.store(0);
+  m_watcher.setFuture(QtConcurrent::run(this, &TextSearchIndexer::build, owners));
+}
+
+/**
+ * Stops the indexing in progress (if any) and waits for the worker thread to finish.
+ */
+void TextSearchIndexer::cancel()
+{
+  if (m_watcher.isRunning())
+  {
+    m_cancelRequested.store(1);
+    m_watcher.waitForFinished();
+  }
+}
+
+bool TextSearchIndexer::isRunning() const
+{
+  return m_watcher.isRunning();
+}
+
+/**
+ * Returns the most recently completed index, or a null pointer if there is none.
+ */
+TextSearchIndexPtr TextSearchIndexer::index() const
+{
+  return m_index;
+}
+
+void TextSearchIndexer::onFinished()
+{
+  m_index = m_watcher.result();
+  emit finished(m_index.isNull());
+}
+
+TextSearchTarget TextSearchIndexer::makeTarget(TextSearchTargetType type, int id)
+{
+  TextSearchTarget target;
+  target.type = type;
+  target.id = id;
+  target.raceId = -1;
+  target.topic = ConvTopicCategory_GreetingInitial;
+  target.thingId = -1;
+  return target;
+}
+
+/**
+ * Reads and indexes all of the game's text. This runs on a worker thread, and only uses
+ * the data library and the text parsers, which may be used from any thread.
+ * @return The completed index, or a null pointer if indexing was cancelled.
+ */
+TextSearchIndexPtr TextSearchIndexer::build(TextSearchOwners owners)
+{
+  QSharedPointer<TextSearchIndex> index(new TextSearchIndex());
+
+  addGameText(*index, owners);
+  addDialogue(*index);
+  addIndexedText(*index, TextSearchSource::MissionText, "MISTEXT.IDX", "MISTEXT.TXT", MISTEXT_FIRST_RECORD,
+                 TextSearchTargetType::Mission, owners.missionTextOwners);
+  addIndexedText(*index, TextSearchSource::ObjectText, "OBJTEXT.IDX", "OBJTEXT.TXT", OBJTEXT_FIRST_RECORD,
+                 TextSearchTargetType::Object, owners.objectTextOwners);
+
+  if (m_cancelRequested.load())
+  {
+    return TextSearchIndexPtr();
+  }
+
+  return index;
+}
+
+/**
+ * Indexes every string in GAMETEXT.TXT. These are the names and descriptions used by the
+ * data tables, so their owners are found by matching their text.
+ */
+void TextSearchIndexer::addGameText(TextSearchIndex& index, const TextSearchOwners& owners)
+{
+  const QMap<int,QString> strings = m_lib->getAllGameText();
+
+  for (QMap<int,QString>::const_iterator it = strings.constBegin();
+       (it != strings.constEnd()) && !m_cancelRequested.load(); ++it)
+  {
+    if (!it.value().trimmed().isEmpty())
+    {
+      TextSearchDocument doc;
+      doc.source = TextSearchSource::GameText;
+      doc.filename = "GAMETEXT.TXT";
+      doc.offset = it.key();
+      doc.text = it.value();
+      doc.target = owners.gameTextOwners.value(it.value(), makeTarget(TextSearchTargetType::None, -1));
+      index.addDocument(doc);
+    }
+  }
+}
+
+/**
+ * Indexes every line of dialogue in the TLKXC (individual) and TLKXR (race) files. Each line
+ * is attributed to the first topic that leads to it.
+ */
+void TextSearchIndexer::addDialogue(TextSearchIndex& index)
+{
+  foreach (QString filename, m_lib->getFilenamesByExtension(DatFileType::CONVERSE, ".TXT"))
+  {
+    ConvTableType tableType = ConvTableType_Invalid;
+    int id = 0;
+
+    if (m_cancelRequested.load())
+    {
+      break;
+    }
+
+    if (ConversationText::parseTLKXFilename(filename, tableType, id))
+    {
+      foreach (const ConvDialogueLine& line, m_convText->getDialogueLines(tableType, id))
+      {
+        TextSearchDocument doc;
+        doc.source = TextSearchSource::Dialogue;
+        doc.filename = filename;
+        doc.offset = line.offset;
+        doc.text = m_gtext->renderPlainText(line.text);
+        doc.target = dialogueTarget(tableType, id, line);
+
+        if (!doc.text.trimmed().isEmpty())
+        {
+          index.addDocument(doc);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Returns the target for a line of dialogue from the TLKX file of the specified alien or race.
+ * The line is attributed to the first topic that leads to it.
+ */
+TextSearchTarget TextSearchIndexer::dialogueTarget(ConvTableType tableType, int id, const ConvDialogueLine& line)
+{
+  TextSearchTarget target = makeTarget(TextSearchTargetType::Conversation,
+                                       (tableType == ConvTableType_Individual) ? id : -1);
+  target.raceId = (tableType == ConvTableType_Race) ? id : -1;
+
+  if (!line.topics.isEmpty())
+  {
+    target.topic = line.topics.first().first;
+    target.thingId = line.topics.first().second;
+  }
+
+  return target;
+}
+
+/**
+ * Reads an index of 32-bit offsets into a text file (such as MISTEXT.IDX or OBJTEXT.IDX).
+ * The records of the index file are numbered from firstRecord, and each number is looked up
+ * in the provided map of owner IDs. Strings that are referenced by more than one record are
+ * attributed to the first record that has an owner.
+ * @return Map of each valid string offset to the ID of its owner (or -1 if it has none).
+ */
+QMap<int,int> TextSearchIndexer::readTextOwners(const QByteArray& idxData, int txtSize, int firstRecord, const QHash<int,int>& owners)
+{
+  QMap<int,int> stringOwners;
+  const int recordCount = idxData.size() / 4;
+
+  for (int record = firstRecord; record < recordCount; record++)
+  {
+    int32_t offset = 0;
+    memcpy(&offset, idxData.constData() + (record * 4), 4);
+    offset = qFromLittleEndian<qint32>(offset);
+
+    if ((offset >= 0) && (offset < txtSize))
+    {
+      const int ownerId = owners.value(record - firstRecord, -1);
+      if (!stringOwners.contains(offset) || (stringOwners.value(offset) < 0))
+      {
+        stringOwners.insert(offset, ownerId);
+      }
+    }
+  }
+
+  return stringOwners;
+}
+
+/**
+ * Indexes a text file that is accompanied by an index of 32-bit offsets. Each string is only
+ * indexed once, regardless of how many records reference it.
+ */
+void TextSearchIndexer::addIndexedText(TextSearchIndex& index, TextSearchSource source, QString idxFilename, QString txtFilename,
+                                       int firstRecord, TextSearchTargetType ownerType, const QHash<int,int>& owners)
+{
+  QByteArray idxData;
+  QByteArray txtData;
+
+  if (m_lib->getFileByName(DatFileType::CONVERSE, idxFilename, idxData) &&
+      m_lib->getFileByName(DatFileType::CONVERSE, txtFilename, txtData))
+  {
+    const QMap<int,int> stringOwners = readTextOwners(idxData, txtData.size(), firstRecord, owners);
+
+    for (QMap<int,int>::const_iterator it = stringOwners.constBegin();
+         (it != stringOwners.constEnd()) && !m_cancelRequested.load(); ++it)
+    {
+      const GameTextString str = m_gtext->parseString(txtData.constData() + it.key(), txtData.size() - it.key());
+
+      TextSearchDocument doc;
+      doc.source = source;
+      doc.filename = txtFilename;
+      doc.offset = it.key();
+      doc.text = m_gtext->renderPlainText(str);
+      doc.target = makeTarget((it.value() >= 0) ? ownerType : TextSearchTargetType::None, it.value());
+
+      if (!doc.text.trimmed().isEmpty())
+      {
+        index.addDocument(doc);
+      }
+    }
+  }
+}
@@ -0,0 +1,169 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QPair>
+#include <QMap>
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QFutureWatcher>
+#include "datlibrary.h"
+#include "gametext.h"
+#include "conversationtext.h"
+
+#define TEXTSEARCH_MAX_HITS 500
+
+#define MISTEXT_FIRST_RECORD 1
+#define OBJTEXT_FIRST_RECORD 0
+
+enum class TextSearchSource
+{
+  GameText,
+  Dialogue,
+  MissionText,
+  ObjectText
+};
+
+enum class TextSearchTargetType
+{
+  None,
+  Fact,
+  Place,
+  Alien,
+  Object,
+  Ship,
+  Conversation,
+  Mission
+};
+
+/**
+ * Identifies the thing that owns a piece of text, so that the viewer can show it. For
+ * conversation text, the ID is that of the alien (or -1 if the line belongs to a race's
+ * generic dialogue, in which case the race ID is set instead), and the topic and thing
+ * ID select the topic that leads to the line (with a thing ID of -1 if none does).
+ */
+struct TextSearchTarget
+{
+  TextSearchTargetType type;
+  int id;
+  int raceId;
+  ConvTopicCategory topic;
+  int thingId;
+};
+
+/**
+ * A single searchable string, along with the file and byte offset at which it is stored.
+ */
+struct TextSearchDocument
+{
+  TextSearchSource source;
+  QString filename;
+  int offset;
+  QString text;
+  TextSearchTarget target;
+};
+
+/**
+ * A single occurrence of a term: the document in which it occurs, its position in the
+ * document's sequence of terms, and the offset of its first character in the text.
+ */
+struct TextSearchPosting
+{
+  int document;
+  int position;
+  int charOffset;
+};
+
+/**
+ * A document matching a search, with its relevance score and the span of text matched.
+ */
+struct TextSearchHit
+{
+  int document;
+  double score;
+  int charOffset;
+  int length;
+};
+
+/**
+ * Owners of the strings whose owners cannot be found from the text files themselves. These
+ * are gathered from the data tables before indexing starts: GAMETEXT strings are matched by
+ * their text, and mission and object text by their index in MISTEXT.IDX and OBJTEXT.IDX.
+ */
+struct TextSearchOwners
+{
+  QHash<QString,TextSearchTarget> gameTextOwners;
+  QHash<int,int> missionTextOwners;
+  QHash<int,int> objectTextOwners;
+};
+
+/**
+ * Inverted index over a set of text documents. Each document is split into lowercase
+ * terms, and each term maps to a posting list of its occurrences in document order.
+ * A search finds the documents containing every term of the query, ranks them by term
+ * frequency weighted by term rarity, and ranks documents containing the query as an
+ * exact phrase above the others.
+ */
+class TextSearchIndex
+{
+public:
+  TextSearchIndex();
+  void addDocument(const TextSearchDocument& doc);
+  void clear();
+  int documentCount() const;
+  int termCount() const;
+  const TextSearchDocument& document(int index) const;
+  QVector<TextSearchHit> search(const QString& query, int maxHits = TEXTSEARCH_MAX_HITS) const;
+
+  static QVector<QPair<int,int> > tokenize(const QString& text);
+
+private:
+  QVector<TextSearchDocument> m_documents;
+  QVector<int> m_documentTermCounts;
+  QHash<QString,QVector<TextSearchPosting> > m_postings;
+};
+
+typedef QSharedPointer<const TextSearchIndex> TextSearchIndexPtr;
+
+/**
+ * Builds a TextSearchIndex on a worker thread from GAMETEXT.TXT, every TLKXC and TLKXR
+ * dialogue file, MISTEXT.TXT and OBJTEXT.TXT.
+ */
+class TextSearchIndexer : public QObject
+{
+  Q_OBJECT
+
+public:
+  TextSearchIndexer(DatLibrary& lib, GameText& gtext, ConversationText& convText, QObject* parent = nullptr);
+  ~TextSearchIndexer();
+
+  void start(const TextSearchOwners& owners);
+  void cancel();
+  bool isRunning() const;
+  TextSearchIndexPtr index() const;
+
+  static TextSearchTarget makeTarget(TextSearchTargetType type, int id);
+  static TextSearchTarget dialogueTarget(ConvTableType tableType, int id, const ConvDialogueLine& line);
+  static QMap<int,int> readTextOwners(const QByteArray& idxData, int txtSize, int firstRecord, const QHash<int,int>& owners);
+
+signals:
+  void finished(bool cancelled);
+
+private slots:
+  void onFinished();
+
+private:
+  DatLibrary* m_lib;
+  GameText* m_gtext;
+  ConversationText* m_convText;
+  QAtomicInt m_cancelRequested;
+  QFutureWatcher<TextSearchIndexPtr> m_watcher;
+  TextSearchIndexPtr m_index;
+
+  TextSearchIndexPtr build(TextSearchOwners owners);
+  void addGameText(TextSearchIndex& index, const TextSearchOwners& owners);
+  void addDialogue(TextSearchIndex& index);
+  void addIndexedText(TextSearchIndex& index, TextSearchSource source, QString idxFilename, QString txtFilename,
+                      int firstRecord, TextSearchTargetType ownerType, const QHash<int,int>& owners);
+};
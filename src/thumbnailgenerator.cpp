@@ -0,0 +1,131 @@
+#include <QtConcurrent>
+#include <QPainter>
+#include "thumbnailgenerator.h"
+
+ThumbnailGenerator::ThumbnailGenerator(FullscreenImages& fsImages, StampImages& stamps, InvObject& invObject, QObject* parent) :
+  QObject(parent),
+  m_fullscreenImages(&fsImages),
+  m_stamps(&stamps),
+  m_invObject(&invObject)
+{
+  connect(&m_watcher, &QFutureWatcher<QImage>::resultReadyAt, this, &ThumbnailGenerator::onResultReadyAt);
+  connect(&m_watcher, &QFutureWatcher<QImage>::finished, this, &ThumbnailGenerator::finished);
+}
+
+ThumbnailGenerator::~ThumbnailGenerator()
+{
+  cancel();
+}
+
+/**
+ * Cancels any thumbnail generation currently in progress and starts decoding the
+ * provided list of images. The thumbnailReady() signal is emitted (in no particular
+ * order) with the index of each request as its thumbnail is completed.
+ */
+void ThumbnailGenerator::start(ThumbnailSource source, const QList<ThumbnailRequest>& requests)
+{
+  cancel();
+
+  ThumbnailDecoder decoder;
+  decoder.source = source;
+  decoder.fullscreenImages = m_fullscreenImages;
+  decoder.stamps = m_stamps;
+  decoder.invObject = m_invObject;
+
+  m_requests = requests;
+  m_watcher.setFuture(QtConcurrent::mapped(m_requests, decoder));
+}
+
+/**
+ * Stops the generation of any thumbnails that have not yet been started, and waits
+ * for those that are currently being decoded. After this returns, no worker thread
+ * is accessing the image data.
+ */
+void ThumbnailGenerator::cancel()
+{
+  if (m_watcher.isRunning())
+  {
+    m_watcher.cancel();
+    m_watcher.waitForFinished();
+  }
+}
+
+/**
+ * Returns true if thumbnails are still being generated.
+ */
+bool ThumbnailGenerator::isRunning() const
+{
+  return m_watcher.isRunning();
+}
+
+/**
+ * Forwards a finished thumbnail to any connected views, along with the index
+ * of the request that produced it.
+ */
+void ThumbnailGenerator::onResultReadyAt(int index)
+{
+  if (!m_watcher.isCanceled() && m_watcher.future().isResultReadyAt(index))
+  {
+    emit thumbnailReady(index, m_watcher.resultAt(index));
+  }
+}
+
+/**
+ * Produces a square thumbnail image of a fixed size from the provided image. Images
+ * larger than the thumbnail are downscaled with filtering; smaller images are only
+ * enlarged by whole multiples so that their pixels stay sharp.
+ */
+QImage ThumbnailGenerator::makeThumbnail(const QImage& img)
+{
+  QImage thumb(THUMBNAIL_SIZE, THUMBNAIL_SIZE, QImage::Format_ARGB32_Premultiplied);
+  thumb.fill(Qt::transparent);
+
+  if (!img.isNull() && (img.width() > 0) && (img.height() > 0))
+  {
+    QImage scaled;
+
+    if ((img.width() > THUMBNAIL_SIZE) || (img.height() > THUMBNAIL_SIZE))
+    {
+      scaled = img.convertToFormat(QImage::Format_ARGB32).scaled(THUMBNAIL_SIZE, THUMBNAIL_SIZE,
+                                                                 Qt::KeepAspectRatio,
+                                                                 Qt::SmoothTransformation);
+    }
+    else
+    {
+      const int factor = qMin(THUMBNAIL_SIZE / img.width(), THUMBNAIL_SIZE / img.height());
+      scaled = img.scaled(img.width() * factor, img.height() * factor,
+                          Qt::IgnoreAspectRatio, Qt::FastTransformation);
+    }
+
+    QPainter painter(&thumb);
+    painter.drawImage((THUMBNAIL_SIZE - scaled.width()) / 2, (THUMBNAIL_SIZE - scaled.height()) / 2, scaled);
+  }
+
+  return thumb;
+}
+
+/**
+ * Decodes the image described by the request and returns its thumbnail. If the image
+ * could not be decoded, a null image is returned.
+ */
+QImage ThumbnailDecoder::operator()(const ThumbnailRequest& request) const
+{
+  QImage img;
+  bool status = false;
+
+  if (source == ThumbnailSource::FullscreenImages)
+  {
+    status = fullscreenImages->getImage(request.dat, request.filename, img);
+  }
+  else if (source == ThumbnailSource::StampImages)
+  {
+    status = stamps->getFirstStamp(request.dat, request.filename, img);
+  }
+  else if (source == ThumbnailSource::InventoryImages)
+  {
+    status = invObject->getImage(request.objectId, img);
+  }
+
+  return status ? ThumbnailGenerator::makeThumbnail(img) : QImage();
+}
+
@@ -0,0 +1,82 @@
+#pragma once
+#include <QObject>
+#include <QImage>
+#include <QList>
+#include <QString>
+#include <QFutureWatcher>
+#include "datlibrary.h"
+#include "fullscreenimages.h"
+#include "stampimages.h"
+#include "invobject.h"
+
+#define THUMBNAIL_SIZE 96
+
+enum class ThumbnailSource
+{
+  FullscreenImages,
+  StampImages,
+  InventoryImages
+};
+
+/**
+ * Identifies a single image to be decoded into a thumbnail. The filename is used
+ * for the fullscreen and stamp image sets, while the object ID is used for the
+ * inventory image set.
+ */
+struct ThumbnailRequest
+{
+  DatFileType dat;
+  QString filename;
+  int objectId;
+};
+
+/**
+ * Function object that is run on the worker threads to decode a single image
+ * and reduce it to a thumbnail.
+ */
+struct ThumbnailDecoder
+{
+  typedef QImage result_type;
+
+  ThumbnailSource source;
+  FullscreenImages* fullscreenImages;
+  StampImages* stamps;
+  InvObject* invObject;
+
+  QImage operator()(const ThumbnailRequest& request) const;
+};
+
+/**
+ * Decodes sets of images on the global thread pool and produces fixed-size
+ * thumbnails from them. Each thumbnail is announced with a signal as soon as
+ * it is finished, so that a view can be filled in progressively.
+ */
+class ThumbnailGenerator : public QObject
+{
+  Q_OBJECT
+
+public:
+  ThumbnailGenerator(FullscreenImages& fsImages, StampImages& stamps, InvObject& invObject, QObject* parent = nullptr);
+  ~ThumbnailGenerator();
+
+  void start(ThumbnailSource source, const QList<ThumbnailRequest>& requests);
+  void cancel();
+  bool isRunning() const;
+
+  static QImage makeThumbnail(const QImage& img);
+
+signals:
+  void thumbnailReady(int index, QImage thumbnail);
+  void finished();
+
+private slots:
+  void onResultReadyAt(int index);
+
+private:
+  FullscreenImages* m_fullscreenImages;
+  StampImages* m_stamps;
+  InvObject* m_invObject;
+  QList<ThumbnailRequest> m_requests;
+  QFutureWatcher<QImage> m_watcher;
+};
+
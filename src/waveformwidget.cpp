@@ -0,0 +1,252 @@
+#include <QPainter>
+#include <math.h>
+#include <algorithm>
+#include "waveformwidget.h"
+
+#define WAVEFORM_MIN_SAMPLES_PER_PIXEL (1.0 / 16.0)
+#define WAVEFORM_ZOOM_STEP 1.25
+#define WAVEFORM_HEIGHT_FRACTION 0.5
+
+WaveformWidget::WaveformWidget(QWidget* parent) :
+  QWidget(parent),
+  m_selectedSound(-1),
+  m_viewStart(0.0),
+  m_samplesPerPixel(1.0),
+  m_dragStartView(0.0)
+{
+
+}
+
+QSize WaveformWidget::minimumSizeHint() const
+{
+  return QSize(100, 100);
+}
+
+QSize WaveformWidget::sizeHint() const
+{
+  return QSize(600, 260);
+}
+
+/**
+ * Sets the container analysis to be displayed, and zooms out to show all of it.
+ */
+void WaveformWidget::setAnalysis(SoundBankAnalysisPtr analysis)
+{
+  m_analysis = analysis;
+  m_selectedSound = -1;
+  showAll();
+}
+
+SoundBankAnalysisPtr WaveformWidget::analysis() const
+{
+  return m_analysis;
+}
+
+void WaveformWidget::clear()
+{
+  m_analysis.clear();
+  m_selectedSound = -1;
+  update();
+}
+
+/**
+ * Highlights the sound with the provided index in the container and zooms to fit it.
+ */
+void WaveformWidget::showSound(int soundIndex)
+{
+  if (m_analysis && (soundIndex >= 0) && (soundIndex < m_analysis->soundCount()))
+  {
+    const int start = m_analysis->soundStarts.at(soundIndex);
+    const int length = qMax(m_analysis->soundStarts.at(soundIndex + 1) - start, 1);
+    m_selectedSound = soundIndex;
+    m_samplesPerPixel = static_cast<double>(length) / qMax(width(), 1);
+    m_viewStart = start;
+    clampView();
+  }
+  update();
+}
+
+/**
+ * Zooms out to show every sound in the container.
+ */
+void WaveformWidget::showAll()
+{
+  if (m_analysis)
+  {
+    m_samplesPerPixel = static_cast<double>(qMax(m_analysis->pcm.size(), 1)) / qMax(width(), 1);
+    m_viewStart = 0.0;
+    clampView();
+  }
+  update();
+}
+
+/**
+ * Returns the index of the sound that contains the provided sample position,
+ * or -1 if it is outside the container.
+ */
+int WaveformWidget::soundAt(double sample) const
+{
+  int soundIndex = -1;
+
+  if (m_analysis && (sample >= 0.0) && (sample < m_analysis->pcm.size()))
+  {
+    const QVector<int>& starts = m_analysis->soundStarts;
+    soundIndex = static_cast<int>(std::upper_bound(starts.constBegin(), starts.constEnd(), static_cast<int>(sample)) - starts.constBegin()) - 1;
+
+    // sounds that failed to decode are empty, so skip forward to the one that holds the sample
+    while ((soundIndex < (m_analysis->soundCount() - 1)) && (starts.at(soundIndex + 1) <= sample))
+    {
+      soundIndex++;
+    }
+  }
+
+  return soundIndex;
+}
+
+/**
+ * Keeps the zoom level between the closest allowed zoom and the full container
+ * width, and keeps the view within the container.
+ */
+void WaveformWidget::clampView()
+{
+  if (m_analysis)
+  {
+    const double totalSamples = qMax(m_analysis->pcm.size(), 1);
+    const double maxSamplesPerPixel = totalSamples / qMax(width(), 1);
+    m_samplesPerPixel = qBound(qMin(WAVEFORM_MIN_SAMPLES_PER_PIXEL, maxSamplesPerPixel), m_samplesPerPixel, maxSamplesPerPixel);
+    m_viewStart = qBound(0.0, m_viewStart, qMax(totalSamples - (m_samplesPerPixel * width()), 0.0));
+  }
+}
+
+/**
+ * Draws the waveform in the upper part of the widget and the spectrogram in the lower
+ * part. Each column of the waveform is a vertical line spanning the minimum and maximum
+ * sample values in the range of samples covered by that column.
+ */
+void WaveformWidget::paintEvent(QPaintEvent* event)
+{
+  Q_UNUSED(event)
+
+  QPainter painter(this);
+  painter.fillRect(rect(), QColor(16, 16, 24));
+
+  if (!m_analysis || m_analysis->pcm.isEmpty())
+  {
+    return;
+  }
+
+  const int waveHeight = static_cast<int>(height() * WAVEFORM_HEIGHT_FRACTION);
+  const QRect waveRect(0, 0, width(), waveHeight);
+  const QRect specRect(0, waveHeight, width(), height() - waveHeight);
+  const double viewEnd = m_viewStart + (m_samplesPerPixel * width());
+
+  // highlight the selected sound
+  if ((m_selectedSound >= 0) && (m_selectedSound < m_analysis->soundCount()))
+  {
+    const double selStart = (m_analysis->soundStarts.at(m_selectedSound) - m_viewStart) / m_samplesPerPixel;
+    const double selEnd = (m_analysis->soundStarts.at(m_selectedSound + 1) - m_viewStart) / m_samplesPerPixel;
+    painter.fillRect(QRectF(selStart, 0, selEnd - selStart, waveHeight), QColor(40, 48, 72));
+  }
+
+  painter.setPen(QColor(64, 64, 80));
+  painter.drawLine(0, waveHeight / 2, width(), waveHeight / 2);
+
+  painter.setPen(QColor(96, 224, 128));
+  for (int x = 0; x < width(); x++)
+  {
+    const double columnStart = m_viewStart + (x * m_samplesPerPixel);
+    const int first = static_cast<int>(columnStart);
+    const int last = qMax(static_cast<int>(columnStart + m_samplesPerPixel), first + 1);
+    uint8_t minValue = 0;
+    uint8_t maxValue = 0;
+
+    if (first < m_analysis->pcm.size())
+    {
+      m_analysis->waveform.range(first, last, minValue, maxValue);
+      const int yMin = waveHeight - 1 - ((maxValue * (waveHeight - 1)) / 0xFF);
+      const int yMax = waveHeight - 1 - ((minValue * (waveHeight - 1)) / 0xFF);
+      painter.drawLine(x, yMin, x, yMax);
+    }
+  }
+
+  // only the part of the spectrogram that is in view is copied, and the copy is stretched
+  // to fill the lower part of the widget
+  if (!m_analysis->spectrogram.isNull())
+  {
+    const double frameStart = m_viewStart / SPECTROGRAM_HOP_SIZE;
+    const double frameEnd = qMin(viewEnd / SPECTROGRAM_HOP_SIZE, static_cast<double>(m_analysis->spectrogram.width()));
+    const int copyStart = static_cast<int>(frameStart);
+    const int copyEnd = qMin(static_cast<int>(frameEnd) + 1, m_analysis->spectrogram.width());
+    const QImage visible = m_analysis->spectrogram.copy(copyStart, 0, copyEnd - copyStart, m_analysis->spectrogram.height());
+    const QRectF source(frameStart - copyStart, 0, frameEnd - frameStart, visible.height());
+    const QRectF target(0, specRect.top(), (frameEnd - frameStart) * SPECTROGRAM_HOP_SIZE / m_samplesPerPixel, specRect.height());
+    painter.drawImage(target, visible, source);
+  }
+
+  // mark the boundaries between sounds
+  painter.setPen(QColor(160, 160, 176));
+  for (int soundIndex = 1; soundIndex < m_analysis->soundCount(); soundIndex++)
+  {
+    const int start = m_analysis->soundStarts.at(soundIndex);
+    if ((start > m_viewStart) && (start < viewEnd))
+    {
+      const int x = static_cast<int>((start - m_viewStart) / m_samplesPerPixel);
+      painter.drawLine(x, 0, x, height());
+    }
+  }
+}
+
+void WaveformWidget::mousePressEvent(QMouseEvent* event)
+{
+  m_dragStartPos = event->pos();
+  m_dragStartView = m_viewStart;
+}
+
+/**
+ * Pans the view while the mouse is dragged.
+ */
+void WaveformWidget::mouseMoveEvent(QMouseEvent* event)
+{
+  if (event->buttons() & Qt::LeftButton)
+  {
+    m_viewStart = m_dragStartView - ((event->pos().x() - m_dragStartPos.x()) * m_samplesPerPixel);
+    clampView();
+    update();
+  }
+}
+
+/**
+ * Selects the sound under the mouse and zooms to fit it.
+ */
+void WaveformWidget::mouseDoubleClickEvent(QMouseEvent* event)
+{
+  const int soundIndex = soundAt(m_viewStart + (event->pos().x() * m_samplesPerPixel));
+  if (soundIndex >= 0)
+  {
+    showSound(soundIndex);
+    emit soundActivated(soundIndex);
+  }
+}
+
+/**
+ * Zooms in or out, keeping the sample under the mouse in place.
+ */
+void WaveformWidget::wheelEvent(QWheelEvent* event)
+{
+  const double steps = event->angleDelta().y() / 120.0;
+  const double anchorX = event->pos().x();
+  const double anchorSample = m_viewStart + (anchorX * m_samplesPerPixel);
+
+  m_samplesPerPixel /= pow(WAVEFORM_ZOOM_STEP, steps);
+  clampView();
+  m_viewStart = anchorSample - (anchorX * m_samplesPerPixel);
+  clampView();
+  update();
+}
+
+void WaveformWidget::resizeEvent(QResizeEvent* event)
+{
+  QWidget::resizeEvent(event);
+  clampView();
+}
+
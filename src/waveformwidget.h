@@ -0,0 +1,53 @@
+#pragma once
+#include <QWidget>
+#include <QPoint>
+#include <QPaintEvent>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include "soundanalysis.h"
+
+/**
+ * Displays the waveform and spectrogram of all the sounds in an NNV container, laid end
+ * to end. The view can be zoomed with the mouse wheel and panned by dragging, and the
+ * waveform is drawn from the level-of-detail pyramid so that any zoom level is quick
+ * to render.
+ */
+class WaveformWidget : public QWidget
+{
+  Q_OBJECT
+
+public:
+  WaveformWidget(QWidget* parent = nullptr);
+
+  QSize minimumSizeHint() const override;
+  QSize sizeHint() const override;
+
+  void setAnalysis(SoundBankAnalysisPtr analysis);
+  SoundBankAnalysisPtr analysis() const;
+  void clear();
+  void showSound(int soundIndex);
+  void showAll();
+
+signals:
+  void soundActivated(int soundIndex);
+
+protected:
+  void paintEvent(QPaintEvent* event) override;
+  void mousePressEvent(QMouseEvent* event) override;
+  void mouseMoveEvent(QMouseEvent* event) override;
+  void mouseDoubleClickEvent(QMouseEvent* event) override;
+  void wheelEvent(QWheelEvent* event) override;
+  void resizeEvent(QResizeEvent* event) override;
+
+private:
+  SoundBankAnalysisPtr m_analysis;
+  int m_selectedSound;
+  double m_viewStart;
+  double m_samplesPerPixel;
+  QPoint m_dragStartPos;
+  double m_dragStartView;
+
+  int soundAt(double sample) const;
+  void clampView();
+};
+
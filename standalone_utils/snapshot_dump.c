@@ -0,0 +1,288 @@
+/**
+ * Reads the table snapshot files written by the Nomad Resource Explorer
+ * ("File > Export table snapshot...").
+ *
+ * A snapshot holds every parsed data table (places, planet and star
+ * classes, aliens, objects, facts, ships, ship classes, ship inventories,
+ * and missions) in a column-oriented layout. Every value is a little-endian
+ * 32-bit integer; string columns hold offsets into a pool of NUL-terminated
+ * UTF-8 strings at the end of the file. Because the columns are stored in
+ * place and 4-byte aligned, the file is simply mapped into memory and read
+ * directly, with no decoding step.
+ *
+ * Usage: snapshot_dump <snapshot-file> [table-name]
+ *  With only a filename, lists the tables and their columns.
+ *  With a table name, dumps that table to stdout as CSV.
+ *
+ * Note that this assumes a little-endian host, which is also what the
+ * explorer itself assumes when reading the game's data tables.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define SNAPSHOT_MAGIC          "NRESNAP"
+#define SNAPSHOT_VERSION        1
+#define SNAPSHOT_TABLE_NAME_LEN 20
+#define SNAPSHOT_COL_NAME_LEN   24
+
+#define COLUMN_TYPE_INT32  0
+#define COLUMN_TYPE_STRING 1
+
+typedef struct __attribute__((packed))
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t table_count;
+  uint32_t table_dir_offset;
+  uint32_t string_pool_offset;
+  uint32_t string_pool_size;
+  uint32_t file_size;
+} snapshot_header;
+
+typedef struct __attribute__((packed))
+{
+  char name[SNAPSHOT_TABLE_NAME_LEN];
+  uint32_t row_count;
+  uint32_t column_count;
+  uint32_t column_dir_offset;
+} snapshot_table_entry;
+
+typedef struct __attribute__((packed))
+{
+  char name[SNAPSHOT_COL_NAME_LEN];
+  uint32_t type;
+  uint32_t data_offset;
+} snapshot_column_entry;
+
+bool check_snapshot(const uint8_t* data, size_t size);
+void list_tables(const uint8_t* data);
+bool dump_table(const uint8_t* data, const char* tablename);
+void print_csv_string(const char* str);
+
+int main (int argc, char** argv)
+{
+  int status = 0;
+  int fd = -1;
+  struct stat st;
+  uint8_t* data = NULL;
+
+  if (argc < 2)
+  {
+    printf("Nomad Resource Explorer Table Snapshot Reader\nUsage: %s <snapshot_file> [table_name]\n", argv[0]);
+    return status;
+  }
+
+  fd = open(argv[1], O_RDONLY);
+  if (fd < 0)
+  {
+    fprintf(stderr, "Error: failed to open '%s'.\n", argv[1]);
+    return -1;
+  }
+
+  if ((fstat(fd, &st) != 0) || (st.st_size < (off_t)sizeof(snapshot_header)))
+  {
+    fprintf(stderr, "Error: '%s' is too small to be a table snapshot.\n", argv[1]);
+    close(fd);
+    return -1;
+  }
+
+  data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (data == MAP_FAILED)
+  {
+    fprintf(stderr, "Error: failed to map '%s'.\n", argv[1]);
+    return -1;
+  }
+
+  if (!check_snapshot(data, st.st_size))
+  {
+    status = -1;
+  }
+  else if (argc < 3)
+  {
+    list_tables(data);
+  }
+  else
+  {
+    status = dump_table(data, argv[2]) ? 0 : -1;
+  }
+
+  munmap(data, st.st_size);
+
+  return status;
+}
+
+/**
+ * Checks the header of the snapshot, and checks that every directory entry and
+ * column lies within the file, so that the rest of the utility can read the
+ * tables without any further bounds checks.
+ */
+bool check_snapshot(const uint8_t* data, size_t size)
+{
+  const snapshot_header* header = (const snapshot_header*)data;
+  const snapshot_table_entry* tables = NULL;
+  uint32_t table_idx = 0;
+  uint32_t col_idx = 0;
+
+  if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0)
+  {
+    fprintf(stderr, "Error: file is not a table snapshot.\n");
+    return false;
+  }
+
+  if (header->version != SNAPSHOT_VERSION)
+  {
+    fprintf(stderr, "Error: unsupported snapshot version %u (expected %d).\n", header->version, SNAPSHOT_VERSION);
+    return false;
+  }
+
+  if ((header->file_size != size) ||
+      ((uint64_t)header->table_dir_offset + ((uint64_t)header->table_count * sizeof(snapshot_table_entry)) > size) ||
+      ((uint64_t)header->string_pool_offset + header->string_pool_size > size) ||
+      (header->string_pool_size == 0) ||
+      (data[header->string_pool_offset + header->string_pool_size - 1] != '\0'))
+  {
+    fprintf(stderr, "Error: snapshot is truncated or corrupt.\n");
+    return false;
+  }
+
+  tables = (const snapshot_table_entry*)(data + header->table_dir_offset);
+  for (table_idx = 0; table_idx < header->table_count; table_idx++)
+  {
+    const snapshot_table_entry* table = &tables[table_idx];
+    const snapshot_column_entry* columns = (const snapshot_column_entry*)(data + table->column_dir_offset);
+
+    if ((uint64_t)table->column_dir_offset + ((uint64_t)table->column_count * sizeof(snapshot_column_entry)) > size)
+    {
+      fprintf(stderr, "Error: column directory of table %u is out of range.\n", table_idx);
+      return false;
+    }
+
+    for (col_idx = 0; col_idx < table->column_count; col_idx++)
+    {
+      if ((columns[col_idx].data_offset % sizeof(uint32_t) != 0) ||
+          ((uint64_t)columns[col_idx].data_offset + ((uint64_t)table->row_count * sizeof(uint32_t)) > size))
+      {
+        fprintf(stderr, "Error: data for column %u of table %u is out of range.\n", col_idx, table_idx);
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Prints the name and size of each table in the snapshot, followed by the names
+ * and types of its columns.
+ */
+void list_tables(const uint8_t* data)
+{
+  const snapshot_header* header = (const snapshot_header*)data;
+  const snapshot_table_entry* tables = (const snapshot_table_entry*)(data + header->table_dir_offset);
+  uint32_t table_idx = 0;
+  uint32_t col_idx = 0;
+
+  for (table_idx = 0; table_idx < header->table_count; table_idx++)
+  {
+    const snapshot_table_entry* table = &tables[table_idx];
+    const snapshot_column_entry* columns = (const snapshot_column_entry*)(data + table->column_dir_offset);
+
+    printf("%.*s (%u rows)\n", SNAPSHOT_TABLE_NAME_LEN, table->name, table->row_count);
+    for (col_idx = 0; col_idx < table->column_count; col_idx++)
+    {
+      printf("  %-*.*s %s\n", SNAPSHOT_COL_NAME_LEN, SNAPSHOT_COL_NAME_LEN, columns[col_idx].name,
+             (columns[col_idx].type == COLUMN_TYPE_STRING) ? "string" : "int32");
+    }
+  }
+}
+
+/**
+ * Dumps the named table to stdout as CSV, with a header row naming the columns.
+ * String values are looked up in the string pool.
+ */
+bool dump_table(const uint8_t* data, const char* tablename)
+{
+  const snapshot_header* header = (const snapshot_header*)data;
+  const snapshot_table_entry* tables = (const snapshot_table_entry*)(data + header->table_dir_offset);
+  const char* pool = (const char*)(data + header->string_pool_offset);
+  uint32_t table_idx = 0;
+  uint32_t col_idx = 0;
+  uint32_t row = 0;
+
+  for (table_idx = 0; table_idx < header->table_count; table_idx++)
+  {
+    const snapshot_table_entry* table = &tables[table_idx];
+    const snapshot_column_entry* columns = (const snapshot_column_entry*)(data + table->column_dir_offset);
+
+    if (strncmp(table->name, tablename, SNAPSHOT_TABLE_NAME_LEN) != 0)
+    {
+      continue;
+    }
+
+    for (col_idx = 0; col_idx < table->column_count; col_idx++)
+    {
+      printf("%s%.*s", (col_idx > 0) ? "," : "", SNAPSHOT_COL_NAME_LEN, columns[col_idx].name);
+    }
+    printf("\n");
+
+    for (row = 0; row < table->row_count; row++)
+    {
+      for (col_idx = 0; col_idx < table->column_count; col_idx++)
+      {
+        const int32_t* values = (const int32_t*)(data + columns[col_idx].data_offset);
+
+        if (col_idx > 0)
+        {
+          printf(",");
+        }
+
+        if (columns[col_idx].type == COLUMN_TYPE_STRING)
+        {
+          if ((values[row] >= 0) && ((uint32_t)values[row] < header->string_pool_size))
+          {
+            print_csv_string(pool + values[row]);
+          }
+        }
+        else
+        {
+          printf("%d", values[row]);
+        }
+      }
+      printf("\n");
+    }
+
+    return true;
+  }
+
+  fprintf(stderr, "Error: no table named '%s' in snapshot.\n", tablename);
+  return false;
+}
+
+/**
+ * Prints a string as a quoted CSV field, doubling any quotes within it.
+ */
+void print_csv_string(const char* str)
+{
+  putchar('"');
+  while (*str)
+  {
+    if (*str == '"')
+    {
+      putchar('"');
+    }
+    putchar(*str);
+    str++;
+  }
+  putchar('"');
+}